@@ -0,0 +1,360 @@
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "ArrowBatch.hpp"
+#include "Batch.hpp"
+#include "ImageMetadata.hpp"
+
+/**
+ * @brief One column and its buffers, laid out as the Arrow columnar format expects.
+ *
+ * Strings and lists use 64-bit offsets, the large variants, so a column never overflows however
+ * many rows a batch has. Columns append one row at a time.
+ */
+struct ArrowBatch::Column {
+  std::string Format;
+  std::string Name;
+  bool Nullable;
+  // Bytes per value of a fixed width column, 0 for the others
+  std::size_t Width;
+  std::int64_t Length = 0;
+  std::int64_t NullCount = 0;
+  std::vector<std::uint8_t> Validity;
+  // Length + 1 entries for strings and lists, empty otherwise
+  std::vector<std::int64_t> Offsets;
+  // String bytes or fixed width values
+  std::vector<std::uint8_t> Values;
+  std::vector<Column> Children;
+
+  Column(std::string format, std::string name, bool nullable, std::vector<Column> children = {}) :
+      Format(std::move(format)), Name(std::move(name)), Nullable(nullable), Width(widthOf(this->Format)),
+      Children(std::move(children)) {
+    if (this->Format == "U" || this->Format == "+L") {
+      this->Offsets.push_back(0);
+    }
+  }
+
+  void reserve(std::size_t rows) {
+    this->Validity.reserve(rows / 8 + 1);
+    if (!this->Offsets.empty()) {
+      this->Offsets.reserve(rows + 1);
+    }
+    this->Values.reserve(rows * this->Width);
+  }
+
+  void appendString(std::string_view value) {
+    this->Values.insert(this->Values.end(), value.begin(), value.end());
+    this->Offsets.push_back(static_cast<std::int64_t>(this->Values.size()));
+    this->mark(true);
+  }
+
+  void appendString(const std::optional<std::string>& value) {
+    if (value) {
+      this->appendString(std::string_view(value.value()));
+    } else {
+      this->appendNull();
+    }
+  }
+
+  template <typename T> void appendValue(T value) {
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    this->Values.insert(this->Values.end(), bytes, bytes + sizeof(T));
+    this->mark(true);
+  }
+
+  // Ends a list row after its elements were appended to the child column
+  void closeList() {
+    this->Offsets.push_back(this->Children[0].Length);
+    this->mark(true);
+  }
+
+  // Ends a struct row after a value was appended to each child column
+  void closeStruct() {
+    this->mark(true);
+  }
+
+  void appendNull() {
+    if (!this->Offsets.empty()) {
+      this->Offsets.push_back(this->Offsets.back());
+    }
+    this->Values.resize(this->Values.size() + this->Width);
+    this->mark(false);
+  }
+
+private:
+  static std::size_t widthOf(const std::string& format) {
+    if (format == "C") {
+      return 1;
+    }
+    if (format == "I") {
+      return 4;
+    }
+    if (format == "g") {
+      return 8;
+    }
+    return 0;
+  }
+
+  void mark(bool valid) {
+    if (this->Length % 8 == 0) {
+      this->Validity.push_back(0);
+    }
+    if (valid) {
+      this->Validity.back() |= static_cast<std::uint8_t>(1U << (this->Length % 8));
+    } else {
+      this->NullCount++;
+    }
+    this->Length++;
+  }
+};
+
+namespace {
+
+// The top level columns, in schema order
+enum ColumnIndex : std::size_t {
+  PathColumn,
+  ErrorColumn,
+  ImageHeightColumn,
+  ImageWidthColumn,
+  TitleColumn,
+  DescriptionColumn,
+  OrientationColumn,
+  CountryColumn,
+  CityColumn,
+  StateColumn,
+  LocationColumn,
+  KeywordsColumn,
+  RegionsColumn,
+};
+
+// The fields of a region struct, in schema order
+enum RegionIndex : std::size_t {
+  RegionName,
+  RegionType,
+  RegionDescription,
+  RegionUnit,
+  RegionX,
+  RegionY,
+  RegionW,
+  RegionH,
+  RegionD,
+};
+
+// Buffers of length 0 still need a valid address
+constexpr std::int64_t EMPTY_BUFFER = 0;
+
+struct SchemaData {
+  std::string Format;
+  std::string Name;
+  std::vector<ArrowSchema*> Children;
+};
+
+struct ArrayData {
+  // Keeps the buffers alive, shared by every array of one export
+  std::shared_ptr<const void> Owner;
+  std::vector<const void*> Buffers;
+  std::vector<ArrowArray*> Children;
+};
+
+void releaseSchema(ArrowSchema* schema) {
+  auto* data = static_cast<SchemaData*>(schema->private_data);
+  for (ArrowSchema* child : data->Children) {
+    if (child->release != nullptr) {
+      child->release(child);
+    }
+    delete child;
+  }
+  delete data;
+  schema->release = nullptr;
+}
+
+void releaseArray(ArrowArray* array) {
+  auto* data = static_cast<ArrayData*>(array->private_data);
+  for (ArrowArray* child : data->Children) {
+    if (child->release != nullptr) {
+      child->release(child);
+    }
+    delete child;
+  }
+  delete data;
+  array->release = nullptr;
+}
+
+const void* bufferOf(const void* data, std::size_t size) {
+  return size == 0 ? static_cast<const void*>(&EMPTY_BUFFER) : data;
+}
+
+} // namespace
+
+/**
+ * @brief Builds the columns of a batch of read results.
+ *
+ * @param results The results, such as from Batch::readMany, one row each.
+ */
+ArrowBatch::ArrowBatch(const std::vector<ReadResult>& results) {
+  std::vector<Column> regionFields;
+  regionFields.emplace_back("U", "name", false);
+  regionFields.emplace_back("U", "type", false);
+  regionFields.emplace_back("U", "description", true);
+  regionFields.emplace_back("U", "unit", false);
+  for (const char* name : {"x", "y", "w", "h"}) {
+    regionFields.emplace_back("g", name, false);
+  }
+  regionFields.emplace_back("g", "d", true);
+
+  std::vector<Column> columns;
+  columns.emplace_back("U", "path", false);
+  columns.emplace_back("U", "error", true);
+  columns.emplace_back("I", "image_height", true);
+  columns.emplace_back("I", "image_width", true);
+  columns.emplace_back("U", "title", true);
+  columns.emplace_back("U", "description", true);
+  columns.emplace_back("C", "orientation", true);
+  for (const char* name : {"country", "city", "state", "location"}) {
+    columns.emplace_back("U", name, true);
+  }
+  columns.emplace_back("+L", "keywords", true, std::vector<Column>{Column("U", "item", false)});
+  columns.emplace_back("+L", "regions", true,
+                       std::vector<Column>{Column("+s", "item", false, std::move(regionFields))});
+  for (auto& column : columns) {
+    column.reserve(results.size());
+  }
+
+  for (const auto& result : results) {
+    columns[PathColumn].appendString(std::string_view(result.Path.string()));
+    if (!result.ok() || !result.Metadata) {
+      columns[ErrorColumn].appendString(result.Error ? std::optional<std::string>(result.Error->Message)
+                                                     : std::nullopt);
+      for (std::size_t index = ImageHeightColumn; index <= RegionsColumn; index++) {
+        columns[index].appendNull();
+      }
+      continue;
+    }
+    const ImageMetadata& metadata = result.Metadata.value();
+    columns[ErrorColumn].appendNull();
+    columns[ImageHeightColumn].appendValue<std::uint32_t>(metadata.ImageHeight);
+    columns[ImageWidthColumn].appendValue<std::uint32_t>(metadata.ImageWidth);
+    columns[TitleColumn].appendString(metadata.Title);
+    columns[DescriptionColumn].appendString(metadata.Description);
+    if (metadata.Orientation) {
+      columns[OrientationColumn].appendValue<std::uint8_t>(
+          static_cast<std::uint8_t>(orientation_to_exif_value(metadata.Orientation.value())));
+    } else {
+      columns[OrientationColumn].appendNull();
+    }
+    columns[CountryColumn].appendString(metadata.Country);
+    columns[CityColumn].appendString(metadata.City);
+    columns[StateColumn].appendString(metadata.State);
+    columns[LocationColumn].appendString(metadata.Location);
+
+    Column& keywords = columns[KeywordsColumn];
+    if (metadata.KeywordInfo) {
+      for (const auto& path : metadata.KeywordInfo->toDelimitedPaths('/')) {
+        keywords.Children[0].appendString(std::string_view(path));
+      }
+      keywords.closeList();
+    } else {
+      keywords.appendNull();
+    }
+
+    Column& regions = columns[RegionsColumn];
+    if (metadata.RegionInfo) {
+      Column& region = regions.Children[0];
+      for (const auto& entry : metadata.RegionInfo->RegionList) {
+        region.Children[RegionName].appendString(std::string_view(entry.Name));
+        region.Children[RegionType].appendString(std::string_view(entry.Type));
+        region.Children[RegionDescription].appendString(entry.Description);
+        region.Children[RegionUnit].appendString(std::string_view(entry.Area.Unit));
+        region.Children[RegionX].appendValue(entry.Area.X);
+        region.Children[RegionY].appendValue(entry.Area.Y);
+        region.Children[RegionW].appendValue(entry.Area.W);
+        region.Children[RegionH].appendValue(entry.Area.H);
+        if (entry.Area.D) {
+          region.Children[RegionD].appendValue(entry.Area.D.value());
+        } else {
+          region.Children[RegionD].appendNull();
+        }
+        region.closeStruct();
+      }
+      regions.closeList();
+    } else {
+      regions.appendNull();
+    }
+  }
+
+  auto root = std::make_shared<Column>("+s", "", false, std::move(columns));
+  for (std::size_t row = 0; row < results.size(); row++) {
+    root->closeStruct();
+  }
+  this->m_root = std::move(root);
+}
+
+std::size_t ArrowBatch::size() const noexcept {
+  return static_cast<std::size_t>(this->m_root->Length);
+}
+
+void ArrowBatch::exportSchema(ArrowSchema* out) const {
+  exportColumnSchema(*this->m_root, out);
+}
+
+void ArrowBatch::exportArray(ArrowArray* out) const {
+  exportColumnArray(this->m_root, *this->m_root, out);
+}
+
+void ArrowBatch::exportColumnSchema(const Column& column, ArrowSchema* out) {
+  auto* data = new SchemaData{column.Format, column.Name, {}};
+  data->Children.reserve(column.Children.size());
+  for (const auto& child : column.Children) {
+    data->Children.push_back(new ArrowSchema{});
+    exportColumnSchema(child, data->Children.back());
+  }
+
+  *out = ArrowSchema{};
+  out->format = data->Format.c_str();
+  out->name = data->Name.c_str();
+  out->metadata = nullptr;
+  out->flags = column.Nullable ? ARROW_FLAG_NULLABLE : 0;
+  out->n_children = static_cast<std::int64_t>(data->Children.size());
+  out->children = data->Children.data();
+  out->dictionary = nullptr;
+  out->release = &releaseSchema;
+  out->private_data = data;
+}
+
+/**
+ * @brief Exports a column without copying its buffers.
+ *
+ * @param owner The root column, which every exported array keeps alive.
+ * @param column The column to export, owned by owner.
+ * @param out The struct to fill.
+ */
+void ArrowBatch::exportColumnArray(const std::shared_ptr<const Column>& owner, const Column& column,
+                                   ArrowArray* out) {
+  auto* data = new ArrayData{owner, {}, {}};
+  data->Buffers.push_back(column.NullCount > 0 ? column.Validity.data() : nullptr);
+  if (!column.Offsets.empty()) {
+    data->Buffers.push_back(column.Offsets.data());
+  }
+  if (column.Format == "U" || column.Width > 0) {
+    data->Buffers.push_back(bufferOf(column.Values.data(), column.Values.size()));
+  }
+  data->Children.reserve(column.Children.size());
+  for (const auto& child : column.Children) {
+    data->Children.push_back(new ArrowArray{});
+    exportColumnArray(owner, child, data->Children.back());
+  }
+
+  *out = ArrowArray{};
+  out->length = column.Length;
+  out->null_count = column.NullCount;
+  out->offset = 0;
+  out->n_buffers = static_cast<std::int64_t>(data->Buffers.size());
+  out->n_children = static_cast<std::int64_t>(data->Children.size());
+  out->buffers = data->Buffers.data();
+  out->children = data->Children.data();
+  out->dictionary = nullptr;
+  out->release = &releaseArray;
+  out->private_data = data;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ArrowCData.hpp"
+
+struct ReadResult;
+
+/**
+ * @brief Batch read results as columns, exported through the Arrow C Data Interface.
+ *
+ * Each result is one row of a struct array with the columns
+ *   path, error (large_utf8)
+ *   image_height, image_width (uint32)
+ *   title, description (large_utf8)
+ *   orientation (uint8, the EXIF value)
+ *   country, city, state, location (large_utf8)
+ *   keywords (large_list<large_utf8>, each applied or leaf keyword as its "/" delimited path)
+ *   regions (large_list<struct<name, type, description, unit: large_utf8, x, y, w, h, d: float64>>)
+ * Every column except path is nullable. A failed read has its error set and the other columns null.
+ *
+ * The columns are built once, and every export hands out pointers into them, kept alive by the
+ * exported arrays until the consumer releases them. Consumers such as pyarrow or polars take them
+ * without copying.
+ */
+class ArrowBatch {
+public:
+  explicit ArrowBatch(const std::vector<ReadResult>& results);
+
+  std::size_t size() const noexcept;
+
+  // Fill an uninitialized struct, which the caller releases through its release callback
+  void exportSchema(ArrowSchema* out) const;
+  void exportArray(ArrowArray* out) const;
+
+private:
+  struct Column;
+
+  std::shared_ptr<const Column> m_root;
+
+  static void exportColumnSchema(const Column& column, ArrowSchema* out);
+  static void exportColumnArray(const std::shared_ptr<const Column>& owner, const Column& column, ArrowArray* out);
+};
@@ -0,0 +1,784 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <exiv2/exiv2.hpp>
+
+#include "Batch.hpp"
+#include "FileUtils.hpp"
+#include "Logging.hpp"
+#include "MetadataSession.hpp"
+#include "ThreadPool.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string lowercase(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return value;
+}
+
+std::set<std::string> normalizeExtensions(const std::vector<std::string>& extensions) {
+  if (extensions.empty()) {
+    return FileUtils::imageExtensions();
+  }
+  std::set<std::string> normalized;
+  for (const auto& extension : extensions) {
+    normalized.insert(lowercase(extension.empty() || extension.front() == '.' ? extension : "." + extension));
+  }
+  return normalized;
+}
+
+// The size of a file, 0 when it cannot be read
+std::uint64_t fileSize(const fs::path& path) {
+  std::error_code ec;
+  const auto size = fs::file_size(path, ec);
+  return ec ? 0 : static_cast<std::uint64_t>(size);
+}
+
+ErrorInfo cancelledError(const fs::path& path) {
+  return ErrorInfo{ErrorCode::Cancelled, "The batch was cancelled", path};
+}
+
+/**
+ * @brief Counts the files of a batch and reports them to the progress callback, throttled.
+ *
+ * Workers record each file. Whichever worker first sees the interval elapsed reports, the
+ * others skip the report rather than wait for it, so a slow callback never stalls the batch.
+ */
+class ProgressTracker {
+public:
+  ProgressTracker(const BatchOptions& options, std::size_t total)
+      : m_callback(options.Progress), m_interval(std::chrono::milliseconds(options.ProgressIntervalMs)),
+        m_total(total), m_lastReport(std::chrono::steady_clock::now()) {
+  }
+
+  void record(std::uint64_t bytes, bool failed) {
+    ++this->m_done;
+    this->m_bytes += bytes;
+    if (failed) {
+      ++this->m_errors;
+    }
+    if (!this->m_callback) {
+      return;
+    }
+    std::unique_lock lock(this->m_reportMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - this->m_lastReport < this->m_interval) {
+      return;
+    }
+    this->m_lastReport = now;
+    this->report();
+  }
+
+  // Reports the final counts, from the thread which ran the batch
+  void finish() {
+    if (this->m_callback) {
+      std::lock_guard lock(this->m_reportMutex);
+      this->report();
+    }
+  }
+
+private:
+  ProgressCallback m_callback;
+  std::chrono::steady_clock::duration m_interval;
+  std::size_t m_total;
+  std::atomic<std::size_t> m_done{0};
+  std::atomic<std::uint64_t> m_bytes{0};
+  std::atomic<std::size_t> m_errors{0};
+  std::mutex m_reportMutex;
+  std::chrono::steady_clock::time_point m_lastReport;
+
+  void report() {
+    const BatchProgress progress{this->m_done.load(), this->m_total, this->m_bytes.load(), this->m_errors.load()};
+    // Runs on a pool worker, where an exception would end the batch without results
+    try {
+      this->m_callback(progress);
+    } catch (const std::exception& e) {
+      InternalLogger::warning("Progress callback failed: " + std::string(e.what()));
+    }
+  }
+};
+
+} // namespace
+
+namespace Batch {
+
+/**
+ * @brief Resolves how many tasks of a batch may run at once.
+ *
+ * @param requested The requested concurrency, 0 for the size of the shared pool.
+ * @param jobCount The number of jobs, the concurrency never exceeds it.
+ * @return At least 1.
+ */
+unsigned resolveThreadCount(unsigned requested, std::size_t jobCount) {
+  unsigned threads = requested > 0 ? requested : ThreadPool::shared()->size();
+  threads = std::max(threads, 1U);
+  if (jobCount < threads) {
+    threads = static_cast<unsigned>(std::max<std::size_t>(jobCount, 1));
+  }
+  return threads;
+}
+
+/**
+ * @brief Runs a body for every index on the shared pool.
+ *
+ * Each index is its own pool task, resubmitted to the back of the shared queue, so batches
+ * running at the same time take turns on the workers instead of one monopolizing them. An index
+ * which does not fit in the budget is parked in it rather than blocking its worker, and
+ * resubmitted by whichever task releases enough.
+ *
+ * @param count The number of indices.
+ * @param concurrency At most this many indices run at once, 0 for the size of the pool.
+ * @param body Called once per index, on a pool worker. Must not throw.
+ * @param budget Reserved around each call of body, when limited.
+ * @param footprint The bytes to reserve for an index, called only when the budget is limited.
+ */
+void forEachIndex(std::size_t count, unsigned concurrency, const std::function<void(std::size_t)>& body,
+                  const MemoryBudget& budget, const std::function<std::uint64_t(std::size_t)>& footprint) {
+  if (count == 0) {
+    return;
+  }
+  auto pool = ThreadPool::shared();
+  const unsigned lanes = resolveThreadCount(concurrency > 0 ? concurrency : pool->size(), count);
+
+  std::atomic<std::size_t> next{0};
+  TaskGroup group;
+  group.add(lanes);
+  MemoryBudget reservations = budget;
+  std::function<void()> lane = [&]() {
+    const std::size_t index = next.fetch_add(1);
+    if (index >= count) {
+      group.done();
+      return;
+    }
+    if (!reservations.limited() || !footprint) {
+      body(index);
+      pool->submit(lane);
+      return;
+    }
+    const std::uint64_t bytes = footprint(index);
+    auto run = [&, index, bytes]() {
+      body(index);
+      reservations.release(bytes);
+      pool->submit(lane);
+    };
+    if (reservations.acquireOrDefer(bytes, [&pool, run]() { pool->submit(run); })) {
+      run();
+    }
+  };
+  for (unsigned i = 0; i < lanes; ++i) {
+    pool->submit(lane);
+  }
+  pool->wait(group);
+}
+
+/**
+ * @brief Writes each metadata to its target on the shared pool.
+ *
+ * A failure is recorded in the result of that file and the batch continues. Targets should be
+ * distinct, two jobs for the same file race. Exceptions are not thrown.
+ *
+ * @param jobs The metadata and target path pairs, as for ImageMetadata::toFile(target).
+ * @param threads At most this many files are written at once, 0 for the size of the shared pool.
+ * @param options The options for every write.
+ * @param batch Progress reporting and cancellation. Files not reached once cancelled fail with ErrorCode::Cancelled.
+ * @return One result per job, in the order of the jobs.
+ */
+std::vector<FileResult> writeMany(const std::vector<WriteJob>& jobs, unsigned threads, const WriteOptions& options,
+                                  const BatchOptions& batch) {
+  std::vector<FileResult> results(jobs.size());
+  if (jobs.empty()) {
+    return results;
+  }
+
+  // The XMP toolkit must be initialized before it is used from several threads
+  Exiv2::XmpParser::initialize();
+
+  InternalLogger::debug("Writing " + std::to_string(jobs.size()) + " files");
+  ProgressTracker progress(batch, jobs.size());
+  const auto footprint = [&](std::size_t index) -> std::uint64_t {
+    return batch.Cancellation.cancelled() ? 0 : MemoryBudget::estimateFootprint(jobs[index].second);
+  };
+  forEachIndex(jobs.size(), threads, [&](std::size_t index) {
+    const auto& [metadata, target] = jobs[index];
+    results[index].Path = target;
+    if (batch.Cancellation.cancelled()) {
+      results[index].Error = cancelledError(target);
+      return;
+    }
+    try {
+      metadata.toFile(target, options);
+      progress.record(fileSize(target), false);
+    } catch (...) {
+      results[index].Error = currentErrorInfo(target);
+      progress.record(0, true);
+    }
+  }, batch.Memory, footprint);
+  progress.finish();
+  return results;
+}
+
+/**
+ * @brief Removes every field this library manages from each file on the shared pool, like ImageMetadata::clearFile.
+ *
+ * Each file is opened and rewritten once. A file which fails does not stop the others.
+ *
+ * @param paths The files to clear.
+ * @param threads At most this many files are cleared at once, 0 for the size of the shared pool.
+ * @param options The options for every write. The images themselves are cleared, the sidecar option does not apply.
+ * @param batch Progress reporting and cancellation. Files not reached once cancelled fail with ErrorCode::Cancelled.
+ * @return One result per path, in the order of the paths.
+ */
+std::vector<FileResult> clearMany(const std::vector<fs::path>& paths, unsigned threads, const WriteOptions& options,
+                                  const BatchOptions& batch) {
+  std::vector<FileResult> results(paths.size());
+  if (paths.empty()) {
+    return results;
+  }
+
+  Exiv2::XmpParser::initialize();
+
+  InternalLogger::debug("Clearing " + std::to_string(paths.size()) + " files");
+  ProgressTracker progress(batch, paths.size());
+  const auto footprint = [&](std::size_t index) -> std::uint64_t {
+    return batch.Cancellation.cancelled() ? 0 : MemoryBudget::estimateFootprint(paths[index]);
+  };
+  WriteOptions imageOptions = options;
+  imageOptions.Sidecar = false;
+  forEachIndex(paths.size(), threads, [&](std::size_t index) {
+    results[index].Path = paths[index];
+    if (batch.Cancellation.cancelled()) {
+      results[index].Error = cancelledError(paths[index]);
+      return;
+    }
+    try {
+      MetadataSession session(paths[index]);
+      session.clear();
+      session.commit(imageOptions);
+      progress.record(fileSize(paths[index]), false);
+    } catch (...) {
+      results[index].Error = currentErrorInfo(paths[index]);
+      progress.record(0, true);
+    }
+  }, batch.Memory, footprint);
+  progress.finish();
+  return results;
+}
+
+/**
+ * @brief Reads the metadata of each file on the shared pool.
+ *
+ * @param paths The files to read.
+ * @param threads At most this many files are read at once, 0 for the size of the shared pool.
+ * @param options The options for every read.
+ * @param batch Progress reporting and cancellation. Files not reached once cancelled fail with ErrorCode::Cancelled.
+ * @return One result per path, in the order of the paths.
+ */
+std::vector<ReadResult> readMany(const std::vector<fs::path>& paths, unsigned threads, const ReadOptions& options,
+                                 const BatchOptions& batch) {
+  std::vector<ReadResult> results(paths.size());
+  if (paths.empty()) {
+    return results;
+  }
+
+  Exiv2::XmpParser::initialize();
+
+  InternalLogger::debug("Reading " + std::to_string(paths.size()) + " files");
+  ProgressTracker progress(batch, paths.size());
+  const auto footprint = [&](std::size_t index) -> std::uint64_t {
+    return batch.Cancellation.cancelled() ? 0 : MemoryBudget::estimateFootprint(paths[index]);
+  };
+  forEachIndex(paths.size(), threads, [&](std::size_t index) {
+    results[index].Path = paths[index];
+    if (batch.Cancellation.cancelled()) {
+      results[index].Error = cancelledError(paths[index]);
+      return;
+    }
+    // Broken files are common in large batches, so they are reported without throwing
+    auto metadata = ImageMetadata::tryRead(paths[index], options);
+    if (metadata) {
+      results[index].Metadata = std::move(metadata).value();
+      progress.record(fileSize(paths[index]), false);
+    } else {
+      results[index].Error = metadata.error();
+      progress.record(0, true);
+    }
+  }, batch.Memory, footprint);
+  progress.finish();
+  return results;
+}
+
+// The columns are built once every file was read, so the results are briefly held twice
+ArrowBatch readManyArrow(const std::vector<fs::path>& paths, unsigned threads, const ReadOptions& options,
+                         const BatchOptions& batch) {
+  return ArrowBatch(readMany(paths, threads, options, batch));
+}
+
+/**
+ * @brief Rotates or flips each file on the shared pool, like ImageMetadata::rotate.
+ *
+ * Each file is opened and parsed once, and written once. When only the orientation changes, it is
+ * usually patched in place without rewriting the file.
+ *
+ * @param paths The files to rotate.
+ * @param operation The rotation or flip to apply to each displayed image.
+ * @param regions Which image the regions of the files are relative to.
+ * @param threads At most this many files are processed at once, 0 for the size of the shared pool.
+ * @param options The options for every write.
+ * @param batch Progress reporting and cancellation. Files not reached once cancelled fail with ErrorCode::Cancelled.
+ * @return One result per path, in the order of the paths.
+ */
+std::vector<FileResult> rotateMany(const std::vector<fs::path>& paths, ExifOrientation operation,
+                                   RegionSpace regions, unsigned threads, const WriteOptions& options,
+                                   const BatchOptions& batch) {
+  std::vector<FileResult> results(paths.size());
+  if (paths.empty()) {
+    return results;
+  }
+
+  Exiv2::XmpParser::initialize();
+
+  InternalLogger::debug("Rotating " + std::to_string(paths.size()) + " files");
+  ProgressTracker progress(batch, paths.size());
+  const auto footprint = [&](std::size_t index) -> std::uint64_t {
+    return batch.Cancellation.cancelled() ? 0 : MemoryBudget::estimateFootprint(paths[index]);
+  };
+  forEachIndex(paths.size(), threads, [&](std::size_t index) {
+    results[index].Path = paths[index];
+    if (batch.Cancellation.cancelled()) {
+      results[index].Error = cancelledError(paths[index]);
+      return;
+    }
+    try {
+      MetadataSession session(paths[index]);
+      ImageMetadata metadata = session.read();
+      metadata.rotate(operation, regions);
+      if (options.Sidecar) {
+        metadata.toFile(paths[index], options);
+      } else {
+        session.stage(metadata);
+        session.commit(options);
+      }
+      progress.record(fileSize(paths[index]), false);
+    } catch (...) {
+      results[index].Error = currentErrorInfo(paths[index]);
+      progress.record(0, true);
+    }
+  }, batch.Memory, footprint);
+  progress.finish();
+  return results;
+}
+
+/**
+ * @brief Renames a person in the files an index listed for them, on the shared pool.
+ *
+ * Each file is opened, read and written once. The regions are matched by name in the file as it is
+ * now, so an index which is behind the file still renames the right regions. Only the files are
+ * touched, so the index the occurrences came from can be updated by the caller, such as while
+ * holding a lock the batch should not run under.
+ *
+ * @param occurrences The files to rename in, such as from PersonIndex::find.
+ * @param from The name to replace.
+ * @param to The new name.
+ * @param type When given, only regions of this type are renamed.
+ * @param threads At most this many files are processed at once, 0 for the size of the shared pool.
+ * @param options The options for every write.
+ * @param batch Progress reporting and cancellation. Files not reached once cancelled fail with ErrorCode::Cancelled.
+ * @return One result per occurrence in the same order, with the metadata as written when it succeeded.
+ */
+std::vector<ReadResult> renameInFiles(const std::vector<PersonOccurrence>& occurrences, const std::string& from,
+                                      const std::string& to, const std::optional<std::string>& type, unsigned threads,
+                                      const WriteOptions& options, const BatchOptions& batch) {
+  std::vector<ReadResult> results(occurrences.size());
+  if (occurrences.empty()) {
+    return results;
+  }
+
+  Exiv2::XmpParser::initialize();
+
+  InternalLogger::debug("Renaming " + from + " in " + std::to_string(occurrences.size()) + " files");
+  ProgressTracker progress(batch, occurrences.size());
+  const auto footprint = [&](std::size_t i) -> std::uint64_t {
+    return batch.Cancellation.cancelled() ? 0 : MemoryBudget::estimateFootprint(occurrences[i].Image);
+  };
+  forEachIndex(occurrences.size(), threads, [&](std::size_t i) {
+    const fs::path& path = occurrences[i].Image;
+    results[i].Path = path;
+    if (batch.Cancellation.cancelled()) {
+      results[i].Error = cancelledError(path);
+      return;
+    }
+    try {
+      MetadataSession session(path);
+      ImageMetadata metadata = session.read();
+      if (metadata.RegionInfo.has_value()) {
+        for (auto& region : metadata.RegionInfo->RegionList) {
+          if (region.Name == from && (!type.has_value() || region.Type == *type)) {
+            region.Name = to;
+          }
+        }
+        session.stage(metadata);
+        session.commit(options);
+      }
+      results[i].Metadata = std::move(metadata);
+      progress.record(fileSize(path), false);
+    } catch (...) {
+      results[i].Error = currentErrorInfo(path);
+      progress.record(0, true);
+    }
+  }, batch.Memory, footprint);
+  progress.finish();
+  return results;
+}
+
+/**
+ * @brief Renames a person across every file the index lists for them, on the shared pool.
+ *
+ * Like renameInFiles, on the files index.find(from, type) lists. Renaming onto a name which is
+ * already used merges the two, afterwards the index only has the new name.
+ *
+ * @param index The index to take the files from, updated with what was written. Files which fail
+ *              keep their entries.
+ * @param from The name to replace.
+ * @param to The new name.
+ * @param type When given, only regions of this type are renamed.
+ * @param threads At most this many files are processed at once, 0 for the size of the shared pool.
+ * @param options The options for every write.
+ * @param batch Progress reporting and cancellation. Files not reached once cancelled fail with ErrorCode::Cancelled.
+ * @return One result per file the index listed for from, sorted by path.
+ */
+std::vector<FileResult> renamePerson(PersonIndex& index, const std::string& from, const std::string& to,
+                                     const std::optional<std::string>& type, unsigned threads,
+                                     const WriteOptions& options, const BatchOptions& batch) {
+  const auto written = renameInFiles(index.find(from, type), from, to, type, threads, options, batch);
+  index.add(written);
+
+  std::vector<FileResult> results;
+  results.reserve(written.size());
+  for (const auto& result : written) {
+    results.push_back(FileResult{result.Path, result.Error});
+  }
+  return results;
+}
+
+/**
+ * @brief Reads the metadata of each file on the shared pool into a catalog, and writes the catalog.
+ *
+ * Each file is identified before it is read, so a change during the read makes the record
+ * stale rather than wrong. Files which cannot be read are left out of the catalog.
+ *
+ * @param paths The files to read.
+ * @param target The catalog file, replaced atomically.
+ * @param threads At most this many files are read at once, 0 for the size of the shared pool.
+ * @param options The options for every read.
+ * @param batch Progress reporting and cancellation. A cancelled batch does not write the catalog.
+ * @return One result per path, in the order of the paths.
+ * @throws FileAccessError if the catalog cannot be written
+ */
+std::vector<FileResult> buildCatalog(const std::vector<fs::path>& paths, const fs::path& target, unsigned threads,
+                                     const ReadOptions& options, const BatchOptions& batch) {
+  std::vector<FileResult> results(paths.size());
+  CatalogWriter writer;
+  std::mutex writerMutex;
+
+  Exiv2::XmpParser::initialize();
+
+  InternalLogger::debug("Cataloging " + std::to_string(paths.size()) + " files");
+  ProgressTracker progress(batch, paths.size());
+  const auto footprint = [&](std::size_t index) -> std::uint64_t {
+    return batch.Cancellation.cancelled() ? 0 : MemoryBudget::estimateFootprint(paths[index]);
+  };
+  forEachIndex(paths.size(), threads, [&](std::size_t index) {
+    results[index].Path = paths[index];
+    if (batch.Cancellation.cancelled()) {
+      results[index].Error = cancelledError(paths[index]);
+      return;
+    }
+    const auto identity = FileUtils::identify(paths[index]);
+    if (!identity.has_value()) {
+      results[index].Error =
+          ErrorInfo{ErrorCode::FileAccess, "File does not exist: " + paths[index].string(), paths[index]};
+      progress.record(0, true);
+      return;
+    }
+    auto metadata = ImageMetadata::tryRead(paths[index], options);
+    if (!metadata) {
+      results[index].Error = metadata.error();
+      progress.record(0, true);
+      return;
+    }
+    {
+      std::lock_guard lock(writerMutex);
+      writer.add(paths[index], identity.value(), metadata.value());
+    }
+    progress.record(identity->Size, false);
+  }, batch.Memory, footprint);
+  progress.finish();
+
+  if (batch.Cancellation.cancelled()) {
+    InternalLogger::debug("Cataloging cancelled, " + target.string() + " is left unchanged");
+    return results;
+  }
+  writer.write(target);
+  return results;
+}
+
+namespace {
+
+// The previous catalog, or nothing if there is none yet or it cannot be used, so it is rebuilt
+std::optional<CatalogReader> openPrevious(const fs::path& catalog) {
+  std::error_code ec;
+  if (!fs::exists(catalog, ec)) {
+    return std::nullopt;
+  }
+  try {
+    return CatalogReader(catalog);
+  } catch (const ExifMwgBaseError& e) {
+    InternalLogger::warning("Rebuilding catalog " + catalog.string() + ": " + std::string(e.what()));
+    return std::nullopt;
+  }
+}
+
+/**
+ * @brief Writes a new catalog from the previous one and the listed files, reading only the ones which changed.
+ *
+ * @param complete Whether paths lists every file the catalog should hold, so records of other files are dropped.
+ *                 Otherwise they are copied unchecked.
+ */
+CatalogRefresh refresh(const std::vector<fs::path>& paths, const fs::path& catalog, bool complete, unsigned threads,
+                       const ReadOptions& options, const BatchOptions& batch) {
+  CatalogRefresh summary;
+  std::optional<CatalogReader> previous = openPrevious(catalog);
+  const std::size_t recorded = previous.has_value() ? previous->size() : 0;
+
+  // Stat every listed file first, in parallel, before anything is read
+  std::vector<std::optional<FileUtils::FileIdentity>> identities(paths.size());
+  forEachIndex(paths.size(), threads,
+               [&](std::size_t index) { identities[index] = FileUtils::identify(paths[index]); });
+
+  CatalogWriter writer;
+  std::vector<bool> listed(recorded, false);
+  std::vector<std::size_t> toRead;
+  std::vector<bool> isNew(paths.size(), true);
+  for (std::size_t index = 0; index < paths.size(); index++) {
+    const auto record = previous.has_value() ? previous->find(paths[index]) : std::nullopt;
+    if (record.has_value()) {
+      listed[record.value()] = true;
+      isNew[index] = false;
+    }
+    if (!identities[index].has_value()) {
+      // Gone since it was listed, or never was a regular file
+      if (record.has_value()) {
+        summary.Removed.emplace_back(previous->path(record.value()));
+      }
+      continue;
+    }
+    if (record.has_value() && previous->identity(record.value()) == identities[index].value()) {
+      writer.add(paths[index], identities[index].value(), previous->metadata(record.value()));
+      summary.Unchanged++;
+      continue;
+    }
+    toRead.push_back(index);
+  }
+  for (std::size_t record = 0; record < recorded; record++) {
+    if (listed[record]) {
+      continue;
+    }
+    if (complete) {
+      summary.Removed.emplace_back(previous->path(record));
+    } else {
+      writer.add(fs::path(previous->path(record)), previous->identity(record), previous->metadata(record));
+    }
+  }
+
+  InternalLogger::debug("Refreshing " + catalog.string() + ": " + std::to_string(summary.Unchanged) +
+                        " unchanged, " + std::to_string(toRead.size()) + " to read");
+  std::mutex summaryMutex;
+  std::vector<std::optional<ErrorInfo>> errors(toRead.size());
+  ProgressTracker progress(batch, toRead.size());
+  const auto footprint = [&](std::size_t slot) -> std::uint64_t {
+    return batch.Cancellation.cancelled() ? 0 : MemoryBudget::estimateFootprint(paths[toRead[slot]]);
+  };
+  if (!toRead.empty()) {
+    Exiv2::XmpParser::initialize();
+  }
+  forEachIndex(toRead.size(), threads, [&](std::size_t slot) {
+    const std::size_t index = toRead[slot];
+    if (batch.Cancellation.cancelled()) {
+      errors[slot] = cancelledError(paths[index]);
+      return;
+    }
+    auto metadata = ImageMetadata::tryRead(paths[index], options);
+    if (!metadata) {
+      errors[slot] = metadata.error();
+      progress.record(0, true);
+      return;
+    }
+    {
+      std::lock_guard lock(summaryMutex);
+      writer.add(paths[index], identities[index].value(), metadata.value());
+    }
+    progress.record(identities[index]->Size, false);
+  }, batch.Memory, footprint);
+  progress.finish();
+
+  // Reported in the order of the paths
+  for (std::size_t slot = 0; slot < toRead.size(); slot++) {
+    const std::size_t index = toRead[slot];
+    if (errors[slot].has_value()) {
+      summary.Errors.push_back(errors[slot].value());
+    } else {
+      (isNew[index] ? summary.Added : summary.Updated).push_back(paths[index]);
+    }
+  }
+
+  if (batch.Cancellation.cancelled()) {
+    InternalLogger::debug("Refresh cancelled, " + catalog.string() + " is left unchanged");
+    return summary;
+  }
+  // Windows cannot replace a file which is still mapped
+  previous.reset();
+  writer.write(catalog);
+  return summary;
+}
+
+} // namespace
+
+/**
+ * @brief Brings a catalog up to date with a listing of the files it should hold.
+ *
+ * Every listed file is identified with a single stat. A file whose size, modification time and
+ * inode match its record keeps the record without being read, new and changed files are read on
+ * the shared pool, and records of files which are not listed are dropped. A missing or unusable
+ * catalog is rebuilt from scratch. Only the image is identified, a changed sidecar alone does not
+ * cause a file to be read again.
+ *
+ * @param paths Every file the catalog should hold, such as from scanDirectory.
+ * @param catalog The catalog file, replaced atomically.
+ * @param threads At most this many files are identified or read at once, 0 for the size of the shared pool.
+ * @param options The options for every read.
+ * @param batch Progress reporting, counting only the files read, and cancellation. A cancelled refresh does not
+ *              write the catalog.
+ * @return What changed, and the files which could not be read.
+ * @throws FileAccessError if the catalog cannot be written
+ */
+CatalogRefresh refreshCatalog(const std::vector<fs::path>& paths, const fs::path& catalog, unsigned threads,
+                              const ReadOptions& options, const BatchOptions& batch) {
+  return refresh(paths, catalog, true, threads, options, batch);
+}
+
+/**
+ * @brief Updates the records of some files in a catalog, keeping every other record as it is.
+ *
+ * The listed files are handled like refreshCatalog does, but a listed file which no longer
+ * exists is removed, and the records of files which are not listed are kept without checking
+ * them. This suits the paths a DirectoryWatcher reports.
+ *
+ * @param paths The files which may have been created, changed or removed.
+ * @param catalog The catalog file, replaced atomically.
+ * @param threads At most this many files are identified or read at once, 0 for the size of the shared pool.
+ * @param options The options for every read.
+ * @param batch Progress reporting and cancellation. A cancelled update does not write the catalog.
+ * @return What changed, and the files which could not be read.
+ * @throws FileAccessError if the catalog cannot be written
+ */
+CatalogRefresh updateCatalog(const std::vector<fs::path>& paths, const fs::path& catalog, unsigned threads,
+                             const ReadOptions& options, const BatchOptions& batch) {
+  return refresh(paths, catalog, false, threads, options, batch);
+}
+
+bool matchesExtension(const fs::path& path, const std::vector<std::string>& extensions) {
+  return normalizeExtensions(extensions).count(lowercase(path.extension().string())) > 0;
+}
+
+/**
+ * @brief Lists the image files in a directory tree, scanning subdirectories in parallel.
+ *
+ * Symbolic links to directories are not followed, and directories which cannot be read are
+ * skipped with a warning.
+ *
+ * @param root The directory to scan.
+ * @param recursive Whether subdirectories are scanned.
+ * @param extensions The file extensions to match, with or without the dot. Empty for every
+ *                   format Exiv2 reads metadata from.
+ * @param batch Progress reporting, counting the files found, and cancellation. Once cancelled no
+ *              further directories are read, and the files found so far are returned.
+ * @return The matching files, sorted.
+ * @throws FileAccessError if root is not a directory
+ */
+std::vector<fs::path> scanDirectory(const fs::path& root, bool recursive, const std::vector<std::string>& extensions,
+                                    const BatchOptions& batch) {
+  if (!fs::is_directory(root)) {
+    throw FileAccessError("Not a directory: " + root.string());
+  }
+  const std::set<std::string> matched = normalizeExtensions(extensions);
+
+  auto pool = ThreadPool::shared();
+  TaskGroup group;
+  std::mutex foundMutex;
+  std::vector<fs::path> found;
+  ProgressTracker progress(batch, 0);
+
+  std::function<void(const fs::path&)> scan;
+  // Every scan is finished exactly once, or the wait below never returns
+  auto scanAndFinish = [&](const fs::path& directory) {
+    try {
+      scan(directory);
+    } catch (const std::exception& e) {
+      InternalLogger::warning("Unable to scan " + directory.string() + ": " + std::string(e.what()));
+    }
+    group.done();
+  };
+  scan = [&](const fs::path& directory) {
+    if (batch.Cancellation.cancelled()) {
+      return;
+    }
+    std::vector<fs::path> files;
+    std::error_code ec;
+    fs::directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::directory_iterator() && !batch.Cancellation.cancelled(); it.increment(ec)) {
+      const auto& entry = *it;
+      std::error_code typeError;
+      if (entry.is_directory(typeError) && !entry.is_symlink(typeError)) {
+        if (recursive) {
+          group.add();
+          // Subdirectories go on this worker's queue, where idle workers steal them
+          pool->spawn([&scanAndFinish, subdirectory = entry.path()]() { scanAndFinish(subdirectory); });
+        }
+      } else if (entry.is_regular_file(typeError) &&
+                 matched.count(lowercase(entry.path().extension().string())) > 0) {
+        files.push_back(entry.path());
+        progress.record(fileSize(entry.path()), false);
+      }
+    }
+    if (ec) {
+      InternalLogger::warning("Unable to scan " + directory.string() + ": " + ec.message());
+    }
+    std::lock_guard lock(foundMutex);
+    found.insert(found.end(), files.begin(), files.end());
+  };
+
+  group.add();
+  pool->submit([&]() { scanAndFinish(root); });
+  pool->wait(group);
+  progress.finish();
+
+  std::sort(found.begin(), found.end());
+  InternalLogger::debug("Found " + std::to_string(found.size()) + " images below " + root.string());
+  return found;
+}
+
+} // namespace Batch
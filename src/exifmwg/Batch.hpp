@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ArrowBatch.hpp"
+#include "BatchOptions.hpp"
+#include "Catalog.hpp"
+#include "Errors.hpp"
+#include "ImageMetadata.hpp"
+#include "MemoryBudget.hpp"
+#include "PersonIndex.hpp"
+#include "ReadOptions.hpp"
+#include "WriteOptions.hpp"
+
+/**
+ * @brief The outcome of one file in a batch operation.
+ */
+struct FileResult {
+  std::filesystem::path Path;
+  std::optional<ErrorInfo> Error;
+
+  bool ok() const noexcept {
+    return !Error.has_value();
+  }
+};
+
+/**
+ * @brief The metadata of one file in a batch read, or why it could not be read.
+ */
+struct ReadResult {
+  std::filesystem::path Path;
+  std::optional<ImageMetadata> Metadata;
+  std::optional<ErrorInfo> Error;
+
+  bool ok() const noexcept {
+    return !Error.has_value();
+  }
+};
+
+/**
+ * @brief What a catalog refresh found, and the files it could not read.
+ */
+struct CatalogRefresh {
+  // Files whose identity matched their record, which was kept without reading them
+  std::size_t Unchanged = 0;
+  std::vector<std::filesystem::path> Added;
+  std::vector<std::filesystem::path> Updated;
+  std::vector<std::filesystem::path> Removed;
+  // New or changed files which could not be read, and are left out of the catalog
+  std::vector<ErrorInfo> Errors;
+};
+
+// The metadata to write, and the file to write it to
+using WriteJob = std::pair<ImageMetadata, std::filesystem::path>;
+
+namespace Batch {
+
+// How many tasks of one batch run at once, 0 requests the size of the shared pool
+unsigned resolveThreadCount(unsigned requested, std::size_t jobCount);
+
+// Calls body for every index in [0, count) on the shared pool, at most concurrency at once, and waits.
+// With a limited budget, each index first reserves footprint(index) bytes of it.
+void forEachIndex(std::size_t count, unsigned concurrency, const std::function<void(std::size_t)>& body,
+                  const MemoryBudget& budget = MemoryBudget(),
+                  const std::function<std::uint64_t(std::size_t)>& footprint = {});
+
+std::vector<FileResult> writeMany(const std::vector<WriteJob>& jobs, unsigned threads = 0,
+                                  const WriteOptions& options = {}, const BatchOptions& batch = {});
+
+// Removes every field this library manages from each file like ImageMetadata::clearFile, one rewrite per file
+std::vector<FileResult> clearMany(const std::vector<std::filesystem::path>& paths, unsigned threads = 0,
+                                  const WriteOptions& options = {}, const BatchOptions& batch = {});
+
+std::vector<ReadResult> readMany(const std::vector<std::filesystem::path>& paths, unsigned threads = 0,
+                                 const ReadOptions& options = {}, const BatchOptions& batch = {});
+
+// Reads like readMany and returns the results as Arrow columns, one row per path
+ArrowBatch readManyArrow(const std::vector<std::filesystem::path>& paths, unsigned threads = 0,
+                         const ReadOptions& options = {}, const BatchOptions& batch = {});
+
+// Rotates or flips each file like ImageMetadata::rotate, opening and writing each file once
+std::vector<FileResult> rotateMany(const std::vector<std::filesystem::path>& paths, ExifOrientation operation,
+                                   RegionSpace regions = RegionSpace::Stored, unsigned threads = 0,
+                                   const WriteOptions& options = {}, const BatchOptions& batch = {});
+
+// Renames the regions called from to to in the files of occurrences, writing each file once. Returns the metadata
+// as written, for PersonIndex::add, without touching an index.
+std::vector<ReadResult> renameInFiles(const std::vector<PersonOccurrence>& occurrences, const std::string& from,
+                                      const std::string& to, const std::optional<std::string>& type = std::nullopt,
+                                      unsigned threads = 0, const WriteOptions& options = {},
+                                      const BatchOptions& batch = {});
+
+// Renames the regions called from to to in every file the index lists for from, writing each file once, and
+// updates the index. Renaming onto a name which exists merges the two.
+std::vector<FileResult> renamePerson(PersonIndex& index, const std::string& from, const std::string& to,
+                                     const std::optional<std::string>& type = std::nullopt, unsigned threads = 0,
+                                     const WriteOptions& options = {}, const BatchOptions& batch = {});
+
+// Reads each file like readMany into a CatalogWriter, and writes the catalog to target
+std::vector<FileResult> buildCatalog(const std::vector<std::filesystem::path>& paths,
+                                     const std::filesystem::path& target, unsigned threads = 0,
+                                     const ReadOptions& options = {}, const BatchOptions& batch = {});
+
+// Brings a catalog up to date with a complete listing of the files it should hold, such as from scanDirectory.
+// Only new and changed files are read, records of files not listed are dropped.
+CatalogRefresh refreshCatalog(const std::vector<std::filesystem::path>& paths, const std::filesystem::path& catalog,
+                              unsigned threads = 0, const ReadOptions& options = {}, const BatchOptions& batch = {});
+
+// Like refreshCatalog for the listed files only, such as those a DirectoryWatcher reported. Records of other
+// files are kept as they are, without checking them.
+CatalogRefresh updateCatalog(const std::vector<std::filesystem::path>& paths, const std::filesystem::path& catalog,
+                             unsigned threads = 0, const ReadOptions& options = {}, const BatchOptions& batch = {});
+
+// Whether a file has one of the extensions, matched like scanDirectory does
+bool matchesExtension(const std::filesystem::path& path, const std::vector<std::string>& extensions = {});
+
+// Lists the image files below root, matched by extension (case-insensitive), sorted
+std::vector<std::filesystem::path> scanDirectory(const std::filesystem::path& root, bool recursive = true,
+                                                 const std::vector<std::string>& extensions = {},
+                                                 const BatchOptions& batch = {});
+
+} // namespace Batch
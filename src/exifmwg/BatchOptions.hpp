@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "MemoryBudget.hpp"
+
+/**
+ * @brief Lets another thread stop a running batch operation.
+ *
+ * Copies share one flag, so a token kept by the caller cancels the batch it was passed to.
+ * Workers check it between files, a file already being read or written is finished.
+ */
+class CancellationToken {
+public:
+  CancellationToken() : m_cancelled(std::make_shared<std::atomic<bool>>(false)) {
+  }
+
+  void cancel() noexcept {
+    this->m_cancelled->store(true, std::memory_order_relaxed);
+  }
+
+  bool cancelled() const noexcept {
+    return this->m_cancelled->load(std::memory_order_relaxed);
+  }
+
+private:
+  std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+/**
+ * @brief How far a batch operation has come.
+ */
+struct BatchProgress {
+  std::size_t FilesDone = 0;
+  // 0 when the number of files is not known up front, as for a directory scan
+  std::size_t FilesTotal = 0;
+  // The size of the files done, as read from disk
+  std::uint64_t BytesRead = 0;
+  std::size_t Errors = 0;
+};
+
+// Takes the progress by value, so a Python callback may keep it
+using ProgressCallback = std::function<void(BatchProgress)>;
+
+/**
+ * @brief Progress reporting, cancellation and memory limits for the batch operations.
+ */
+struct BatchOptions {
+  // Called from a worker thread at most once per interval, and once more when the batch ends
+  ProgressCallback Progress;
+  std::uint32_t ProgressIntervalMs = 250;
+  CancellationToken Cancellation;
+  // Files wait to be opened while their estimated footprint does not fit, unlimited by default
+  MemoryBudget Memory;
+};
@@ -0,0 +1,458 @@
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "BinaryCodec.hpp"
+#include "Errors.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Presence bits of the optional ImageMetadata fields
+constexpr std::uint64_t TITLE_FIELD = 1U << 0U;
+constexpr std::uint64_t DESCRIPTION_FIELD = 1U << 1U;
+constexpr std::uint64_t REGION_INFO_FIELD = 1U << 2U;
+constexpr std::uint64_t ORIENTATION_FIELD = 1U << 3U;
+constexpr std::uint64_t KEYWORD_INFO_FIELD = 1U << 4U;
+constexpr std::uint64_t COUNTRY_FIELD = 1U << 5U;
+constexpr std::uint64_t CITY_FIELD = 1U << 6U;
+constexpr std::uint64_t STATE_FIELD = 1U << 7U;
+constexpr std::uint64_t LOCATION_FIELD = 1U << 8U;
+constexpr std::uint64_t ORIGINAL_PATH_FIELD = 1U << 9U;
+constexpr std::uint64_t ALL_FIELDS = (1U << 10U) - 1;
+
+class Writer {
+public:
+  explicit Writer(BinaryCodec::Tag tag) {
+    this->m_bytes.reserve(64);
+    this->byte(BinaryCodec::VERSION);
+    this->byte(static_cast<std::uint8_t>(tag));
+  }
+
+  void byte(std::uint8_t value) {
+    this->m_bytes.push_back(static_cast<char>(value));
+  }
+
+  void varint(std::uint64_t value) {
+    while (value >= 0x80) {
+      this->byte(static_cast<std::uint8_t>(value | 0x80));
+      value >>= 7U;
+    }
+    this->byte(static_cast<std::uint8_t>(value));
+  }
+
+  void real(double value) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+      this->byte(static_cast<std::uint8_t>(bits >> shift));
+    }
+  }
+
+  void string(std::string_view value) {
+    this->varint(value.size());
+    this->m_bytes.append(value);
+  }
+
+  std::string take() {
+    return std::move(this->m_bytes);
+  }
+
+private:
+  std::string m_bytes;
+};
+
+class Reader {
+public:
+  Reader(std::string_view bytes, BinaryCodec::Tag tag, const char* type) : m_bytes(bytes), m_type(type) {
+    if (this->m_bytes.size() < 2) {
+      this->fail("too short");
+    }
+    if (const auto version = this->byte(); version != BinaryCodec::VERSION) {
+      this->fail("unsupported version " + std::to_string(version));
+    }
+    if (this->byte() != static_cast<std::uint8_t>(tag)) {
+      this->fail("encodes a different type");
+    }
+  }
+
+  std::uint8_t byte() {
+    if (this->m_offset >= this->m_bytes.size()) {
+      this->fail("truncated");
+    }
+    return static_cast<std::uint8_t>(this->m_bytes[this->m_offset++]);
+  }
+
+  std::uint64_t varint() {
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      const std::uint8_t next = this->byte();
+      value |= static_cast<std::uint64_t>(next & 0x7FU) << shift;
+      if ((next & 0x80U) == 0) {
+        return value;
+      }
+    }
+    this->fail("varint too long");
+  }
+
+  // A varint which must fit the given maximum
+  std::uint64_t bounded(std::uint64_t maximum, const char* field) {
+    const std::uint64_t value = this->varint();
+    if (value > maximum) {
+      this->fail(std::string(field) + " out of range");
+    }
+    return value;
+  }
+
+  // An element count, each element takes at least a byte so it cannot exceed what is left
+  std::size_t count() {
+    return static_cast<std::size_t>(this->bounded(this->m_bytes.size() - this->m_offset, "count"));
+  }
+
+  bool flag() {
+    return this->bounded(1, "flag") == 1;
+  }
+
+  double real() {
+    std::uint64_t bits = 0;
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+      bits |= static_cast<std::uint64_t>(this->byte()) << shift;
+    }
+    double value = 0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  std::string string() {
+    const std::size_t length = this->count();
+    std::string value(this->m_bytes.substr(this->m_offset, length));
+    this->m_offset += length;
+    return value;
+  }
+
+  // Every byte must have been consumed
+  void finish() const {
+    if (this->m_offset != this->m_bytes.size()) {
+      this->fail("trailing bytes");
+    }
+  }
+
+  [[noreturn]] void fail(const std::string& reason) const {
+    throw InvalidStructureError("Invalid " + std::string(this->m_type) + " encoding: " + reason);
+  }
+
+private:
+  std::string_view m_bytes;
+  std::size_t m_offset = 0;
+  const char* m_type;
+};
+
+void writeArea(Writer& out, const XmpAreaStruct& area) {
+  out.varint(area.D.has_value() ? 1 : 0);
+  out.real(area.H);
+  out.real(area.W);
+  out.real(area.X);
+  out.real(area.Y);
+  out.string(area.Unit);
+  if (area.D) {
+    out.real(area.D.value());
+  }
+}
+
+XmpAreaStruct readArea(Reader& in) {
+  const bool hasD = in.flag();
+  const double h = in.real();
+  const double w = in.real();
+  const double x = in.real();
+  const double y = in.real();
+  std::string unit = in.string();
+  std::optional<double> d;
+  if (hasD) {
+    d = in.real();
+  }
+  return {h, w, x, y, std::move(unit), d};
+}
+
+void writeDimensions(Writer& out, const DimensionsStruct& dimensions) {
+  out.real(dimensions.H);
+  out.real(dimensions.W);
+  out.string(dimensions.Unit);
+}
+
+DimensionsStruct readDimensions(Reader& in) {
+  const double h = in.real();
+  const double w = in.real();
+  return {h, w, in.string()};
+}
+
+void writeRegion(Writer& out, const RegionInfoStruct::RegionStruct& region) {
+  writeArea(out, region.Area);
+  out.string(region.Name);
+  out.string(region.Type);
+  out.varint(region.Description.has_value() ? 1 : 0);
+  if (region.Description) {
+    out.string(region.Description.value());
+  }
+}
+
+RegionInfoStruct::RegionStruct readRegion(Reader& in) {
+  XmpAreaStruct area = readArea(in);
+  std::string name = in.string();
+  std::string type = in.string();
+  std::optional<std::string> description;
+  if (in.flag()) {
+    description = in.string();
+  }
+  return {std::move(area), std::move(name), std::move(type), std::move(description)};
+}
+
+void writeRegionInfo(Writer& out, const RegionInfoStruct& regionInfo) {
+  writeDimensions(out, regionInfo.AppliedToDimensions);
+  out.varint(regionInfo.RegionList.size());
+  for (const auto& region : regionInfo.RegionList) {
+    writeRegion(out, region);
+  }
+}
+
+RegionInfoStruct readRegionInfo(Reader& in) {
+  DimensionsStruct dimensions = readDimensions(in);
+  std::vector<RegionInfoStruct::RegionStruct> regions;
+  const std::size_t count = in.count();
+  regions.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    regions.push_back(readRegion(in));
+  }
+  RegionInfoStruct regionInfo(std::move(dimensions), {});
+  regionInfo.RegionList = std::move(regions);
+  return regionInfo;
+}
+
+// Applied is 0 when unset, 1 when false and 2 when true
+void writeKeyword(Writer& out, const KeywordInfoModel::KeywordStruct& keyword) {
+  out.string(keyword.Keyword);
+  out.varint(keyword.Applied.has_value() ? (keyword.Applied.value() ? 2 : 1) : 0);
+  out.varint(keyword.Children.size());
+  for (const auto& child : keyword.Children) {
+    writeKeyword(out, child);
+  }
+}
+
+KeywordInfoModel::KeywordStruct readKeyword(Reader& in, std::size_t depth) {
+  if (depth > BinaryCodec::MAX_KEYWORD_DEPTH) {
+    in.fail("keywords nested too deep");
+  }
+  std::string name = in.string();
+  std::optional<bool> applied;
+  if (const auto value = in.bounded(2, "applied"); value != 0) {
+    applied = value == 2;
+  }
+  std::vector<KeywordInfoModel::KeywordStruct> children;
+  const std::size_t count = in.count();
+  children.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    children.push_back(readKeyword(in, depth + 1));
+  }
+  // Moved in rather than passed to the constructor, which copies every level below
+  KeywordInfoModel::KeywordStruct keyword(std::move(name), {}, applied);
+  keyword.Children = std::move(children);
+  return keyword;
+}
+
+void writeKeywordInfo(Writer& out, const KeywordInfoModel& keywordInfo) {
+  out.varint(keywordInfo.Hierarchy.size());
+  for (const auto& keyword : keywordInfo.Hierarchy) {
+    writeKeyword(out, keyword);
+  }
+}
+
+KeywordInfoModel readKeywordInfo(Reader& in) {
+  std::vector<KeywordInfoModel::KeywordStruct> hierarchy;
+  const std::size_t count = in.count();
+  hierarchy.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    hierarchy.push_back(readKeyword(in, 1));
+  }
+  KeywordInfoModel keywordInfo(std::vector<KeywordInfoModel::KeywordStruct>{});
+  keywordInfo.Hierarchy = std::move(hierarchy);
+  return keywordInfo;
+}
+
+template <typename T> std::string encodeWith(BinaryCodec::Tag tag, const T& value, void (*write)(Writer&, const T&)) {
+  Writer out(tag);
+  write(out, value);
+  return out.take();
+}
+
+template <typename T> T decodeWith(std::string_view bytes, BinaryCodec::Tag tag, const char* type, T (*read)(Reader&)) {
+  Reader in(bytes, tag, type);
+  T value = read(in);
+  in.finish();
+  return value;
+}
+
+} // namespace
+
+std::string BinaryCodec::encode(const XmpAreaStruct& area) {
+  return encodeWith(Tag::XmpArea, area, &writeArea);
+}
+
+std::string BinaryCodec::encode(const DimensionsStruct& dimensions) {
+  return encodeWith(Tag::Dimensions, dimensions, &writeDimensions);
+}
+
+std::string BinaryCodec::encode(const RegionInfoStruct::RegionStruct& region) {
+  return encodeWith(Tag::Region, region, &writeRegion);
+}
+
+std::string BinaryCodec::encode(const RegionInfoStruct& regionInfo) {
+  return encodeWith(Tag::RegionInfo, regionInfo, &writeRegionInfo);
+}
+
+std::string BinaryCodec::encode(const KeywordInfoModel::KeywordStruct& keyword) {
+  return encodeWith(Tag::Keyword, keyword, &writeKeyword);
+}
+
+std::string BinaryCodec::encode(const KeywordInfoModel& keywordInfo) {
+  return encodeWith(Tag::KeywordInfo, keywordInfo, &writeKeywordInfo);
+}
+
+/**
+ * @brief Encodes every field of the metadata, including the file it was read from and its diagnostics.
+ */
+std::string BinaryCodec::encode(const ImageMetadata& metadata) {
+  Writer out(Tag::ImageMetadata);
+  out.varint(metadata.ImageHeight);
+  out.varint(metadata.ImageWidth);
+
+  std::uint64_t present = 0;
+  const std::pair<std::uint64_t, bool> fields[] = {{TITLE_FIELD, metadata.Title.has_value()},
+                                                   {DESCRIPTION_FIELD, metadata.Description.has_value()},
+                                                   {REGION_INFO_FIELD, metadata.RegionInfo.has_value()},
+                                                   {ORIENTATION_FIELD, metadata.Orientation.has_value()},
+                                                   {KEYWORD_INFO_FIELD, metadata.KeywordInfo.has_value()},
+                                                   {COUNTRY_FIELD, metadata.Country.has_value()},
+                                                   {CITY_FIELD, metadata.City.has_value()},
+                                                   {STATE_FIELD, metadata.State.has_value()},
+                                                   {LOCATION_FIELD, metadata.Location.has_value()},
+                                                   {ORIGINAL_PATH_FIELD, metadata.m_originalPath.has_value()}};
+  for (const auto& [field, set] : fields) {
+    if (set) {
+      present |= field;
+    }
+  }
+  out.varint(present);
+
+  if (metadata.Title) {
+    out.string(metadata.Title.value());
+  }
+  if (metadata.Description) {
+    out.string(metadata.Description.value());
+  }
+  if (metadata.RegionInfo) {
+    writeRegionInfo(out, metadata.RegionInfo.value());
+  }
+  if (metadata.Orientation) {
+    out.varint(static_cast<std::uint64_t>(orientation_to_int(metadata.Orientation.value())));
+  }
+  if (metadata.KeywordInfo) {
+    writeKeywordInfo(out, metadata.KeywordInfo.value());
+  }
+  for (const auto* field : {&metadata.Country, &metadata.City, &metadata.State, &metadata.Location}) {
+    if (*field) {
+      out.string(field->value());
+    }
+  }
+  if (metadata.m_originalPath) {
+    out.string(metadata.m_originalPath->string());
+  }
+
+  out.varint(metadata.Diagnostics.size());
+  for (const auto& diagnostic : metadata.Diagnostics) {
+    out.varint(static_cast<std::uint64_t>(diagnostic.Code));
+    out.string(diagnostic.Message);
+    out.string(diagnostic.Path.string());
+  }
+  return out.take();
+}
+
+template <> XmpAreaStruct BinaryCodec::decode<XmpAreaStruct>(std::string_view bytes) {
+  return decodeWith(bytes, Tag::XmpArea, "XmpArea", &readArea);
+}
+
+template <> DimensionsStruct BinaryCodec::decode<DimensionsStruct>(std::string_view bytes) {
+  return decodeWith(bytes, Tag::Dimensions, "Dimensions", &readDimensions);
+}
+
+template <>
+RegionInfoStruct::RegionStruct BinaryCodec::decode<RegionInfoStruct::RegionStruct>(std::string_view bytes) {
+  return decodeWith(bytes, Tag::Region, "Region", &readRegion);
+}
+
+template <> RegionInfoStruct BinaryCodec::decode<RegionInfoStruct>(std::string_view bytes) {
+  return decodeWith(bytes, Tag::RegionInfo, "RegionInfo", &readRegionInfo);
+}
+
+template <>
+KeywordInfoModel::KeywordStruct BinaryCodec::decode<KeywordInfoModel::KeywordStruct>(std::string_view bytes) {
+  Reader in(bytes, Tag::Keyword, "Keyword");
+  auto keyword = readKeyword(in, 1);
+  in.finish();
+  return keyword;
+}
+
+template <> KeywordInfoModel BinaryCodec::decode<KeywordInfoModel>(std::string_view bytes) {
+  return decodeWith(bytes, Tag::KeywordInfo, "KeywordInfo", &readKeywordInfo);
+}
+
+template <> ImageMetadata BinaryCodec::decode<ImageMetadata>(std::string_view bytes) {
+  Reader in(bytes, Tag::ImageMetadata, "ImageMetadata");
+  ImageMetadata metadata;
+  metadata.ImageHeight = static_cast<std::uint32_t>(in.bounded(std::numeric_limits<std::uint32_t>::max(), "height"));
+  metadata.ImageWidth = static_cast<std::uint32_t>(in.bounded(std::numeric_limits<std::uint32_t>::max(), "width"));
+  const std::uint64_t present = in.varint();
+  if ((present & ~ALL_FIELDS) != 0) {
+    in.fail("unknown fields");
+  }
+
+  if ((present & TITLE_FIELD) != 0) {
+    metadata.Title = in.string();
+  }
+  if ((present & DESCRIPTION_FIELD) != 0) {
+    metadata.Description = in.string();
+  }
+  if ((present & REGION_INFO_FIELD) != 0) {
+    metadata.RegionInfo = readRegionInfo(in);
+  }
+  if ((present & ORIENTATION_FIELD) != 0) {
+    metadata.Orientation = orientation_from_int(static_cast<int>(in.bounded(8, "orientation")));
+  }
+  if ((present & KEYWORD_INFO_FIELD) != 0) {
+    metadata.KeywordInfo = readKeywordInfo(in);
+  }
+  const std::pair<std::uint64_t, std::optional<std::string>*> locations[] = {{COUNTRY_FIELD, &metadata.Country},
+                                                                             {CITY_FIELD, &metadata.City},
+                                                                             {STATE_FIELD, &metadata.State},
+                                                                             {LOCATION_FIELD, &metadata.Location}};
+  for (const auto& [field, value] : locations) {
+    if ((present & field) != 0) {
+      *value = in.string();
+    }
+  }
+  if ((present & ORIGINAL_PATH_FIELD) != 0) {
+    metadata.m_originalPath = fs::path(in.string());
+  }
+
+  const std::size_t diagnostics = in.count();
+  metadata.Diagnostics.reserve(diagnostics);
+  for (std::size_t i = 0; i < diagnostics; i++) {
+    ErrorInfo diagnostic;
+    // Cancelled is the highest code
+    diagnostic.Code = static_cast<ErrorCode>(in.bounded(static_cast<std::uint64_t>(ErrorCode::Cancelled), "error code"));
+    diagnostic.Message = in.string();
+    diagnostic.Path = in.string();
+    metadata.Diagnostics.push_back(std::move(diagnostic));
+  }
+  in.finish();
+  return metadata;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "DimensionsStruct.hpp"
+#include "ImageMetadata.hpp"
+#include "KeywordInfoModel.hpp"
+#include "RegionInfoStruct.hpp"
+#include "XmpAreaStruct.hpp"
+
+/**
+ * @brief The compact binary encoding behind toBytes() and fromBytes() of the model types.
+ *
+ * An encoding starts with the format version and a tag naming the type, followed by the
+ * fields in declaration order. Integers and lengths are LEB128 varints, doubles are 8 bytes
+ * little endian, strings are a length and their UTF-8 bytes, and unset optionals cost a bit in
+ * a presence mask. Nested structures are written inline without a header of their own.
+ *
+ * Unlike equality, an ImageMetadata encoding includes the file it was read from and the
+ * diagnostics of a lenient read, so a decoded copy can still be written back with toFile().
+ * Decoding checks every length against the input and throws InvalidStructureError on anything
+ * which is not an encoding of the requested type.
+ */
+class BinaryCodec {
+public:
+  static constexpr std::uint8_t VERSION = 1;
+  // Keyword hierarchies nested deeper than this are rejected when decoding
+  static constexpr std::size_t MAX_KEYWORD_DEPTH = 256;
+
+  enum class Tag : std::uint8_t {
+    XmpArea = 1,
+    Dimensions = 2,
+    Region = 3,
+    RegionInfo = 4,
+    Keyword = 5,
+    KeywordInfo = 6,
+    ImageMetadata = 7,
+  };
+
+  static std::string encode(const XmpAreaStruct& area);
+  static std::string encode(const DimensionsStruct& dimensions);
+  static std::string encode(const RegionInfoStruct::RegionStruct& region);
+  static std::string encode(const RegionInfoStruct& regionInfo);
+  static std::string encode(const KeywordInfoModel::KeywordStruct& keyword);
+  static std::string encode(const KeywordInfoModel& keywordInfo);
+  static std::string encode(const ImageMetadata& metadata);
+
+  template <typename T> static T decode(std::string_view bytes);
+};
+
+template <> XmpAreaStruct BinaryCodec::decode<XmpAreaStruct>(std::string_view bytes);
+template <> DimensionsStruct BinaryCodec::decode<DimensionsStruct>(std::string_view bytes);
+template <>
+RegionInfoStruct::RegionStruct BinaryCodec::decode<RegionInfoStruct::RegionStruct>(std::string_view bytes);
+template <> RegionInfoStruct BinaryCodec::decode<RegionInfoStruct>(std::string_view bytes);
+template <>
+KeywordInfoModel::KeywordStruct BinaryCodec::decode<KeywordInfoModel::KeywordStruct>(std::string_view bytes);
+template <> KeywordInfoModel BinaryCodec::decode<KeywordInfoModel>(std::string_view bytes);
+template <> ImageMetadata BinaryCodec::decode<ImageMetadata>(std::string_view bytes);
@@ -0,0 +1,10 @@
+#pragma once
+#include <concepts>
+#include <string>
+#include <string_view>
+
+template <typename T>
+concept BinarySerializable = requires(const T& obj, std::string_view bytes) {
+  { T::fromBytes(bytes) } -> std::same_as<T>;
+  { obj.toBytes() } -> std::same_as<std::string>;
+};
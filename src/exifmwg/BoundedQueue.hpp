@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+/**
+ * @brief A blocking multi-producer, multi-consumer FIFO with a fixed capacity.
+ *
+ * Producers block while the queue is full, consumers while it is empty. Once closed, pushes
+ * are refused and consumers drain what is left, then receive nothing.
+ */
+template <typename T> class BoundedQueue {
+public:
+  explicit BoundedQueue(std::size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  // Blocks until there is room. Returns false, dropping the item, if the queue was closed.
+  bool push(T item) {
+    std::unique_lock lock(m_mutex);
+    m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+    if (m_closed) {
+      return false;
+    }
+    m_items.push_back(std::move(item));
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  // Blocks until there is an item. Returns nothing once the queue is closed and drained.
+  std::optional<T> pop() {
+    std::unique_lock lock(m_mutex);
+    m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+    if (m_items.empty()) {
+      return std::nullopt;
+    }
+    T item = std::move(m_items.front());
+    m_items.pop_front();
+    m_notFull.notify_one();
+    return item;
+  }
+
+  // Wakes every waiting producer and consumer
+  void close() {
+    {
+      std::lock_guard lock(m_mutex);
+      m_closed = true;
+    }
+    m_notFull.notify_all();
+    m_notEmpty.notify_all();
+  }
+
+  std::size_t capacity() const noexcept {
+    return m_capacity;
+  }
+
+private:
+  const std::size_t m_capacity;
+  std::deque<T> m_items;
+  bool m_closed = false;
+  std::mutex m_mutex;
+  std::condition_variable m_notFull;
+  std::condition_variable m_notEmpty;
+};
@@ -0,0 +1,580 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Catalog.hpp"
+#include "Errors.hpp"
+#include "Logging.hpp"
+
+namespace fs = std::filesystem;
+
+using namespace CatalogFormat;
+
+namespace {
+
+constexpr std::uint64_t SECTION_ALIGNMENT = 8;
+
+std::uint64_t alignUp(std::uint64_t value) {
+  return (value + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+// Array indices and string offsets are 32 bit in the format
+std::uint32_t toIndex(std::size_t value, const char* what) {
+  if (value >= NO_STRING) {
+    throw InvalidStructureError(std::string("Too many ") + what + " for a catalog");
+  }
+  return static_cast<std::uint32_t>(value);
+}
+
+template <typename T> void writeArray(std::ofstream& out, const std::vector<T>& values) {
+  out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+void writePadding(std::ofstream& out, std::uint64_t position) {
+  static constexpr char zeros[SECTION_ALIGNMENT] = {};
+  out.write(zeros, static_cast<std::streamsize>(alignUp(position) - position));
+}
+
+// Whether count elements of the given size fit in the file from offset on
+bool sectionFits(std::uint64_t offset, std::uint64_t count, std::uint64_t size, std::uint64_t length) {
+  return offset % SECTION_ALIGNMENT == 0 && offset <= length && count <= (length - offset) / size;
+}
+
+bool rangeFits(std::uint64_t first, std::uint64_t count, std::uint64_t total) {
+  return first <= total && count <= total - first;
+}
+
+} // namespace
+
+CatalogFormat::StringRef CatalogWriter::intern(const std::string& value) {
+  auto found = this->m_stringIndex.find(value);
+  if (found != this->m_stringIndex.end()) {
+    return found->second;
+  }
+  const StringRef ref{toIndex(this->m_strings.size(), "string bytes"), toIndex(value.size(), "string bytes")};
+  toIndex(this->m_strings.size() + value.size(), "string bytes");
+  this->m_strings += value;
+  this->m_stringIndex.emplace(value, ref);
+  return ref;
+}
+
+CatalogFormat::StringRef CatalogWriter::intern(const std::optional<std::string>& value) {
+  return value.has_value() ? this->intern(value.value()) : StringRef{NO_STRING, 0};
+}
+
+/**
+ * @brief Appends a keyword hierarchy breadth first, so every list of siblings is contiguous.
+ */
+void CatalogWriter::addKeywords(const std::vector<KeywordInfoModel::KeywordStruct>& roots, Record& record) {
+  std::vector<const KeywordInfoModel::KeywordStruct*> pending;
+  const auto appendSiblings = [&](const std::vector<KeywordInfoModel::KeywordStruct>& siblings) {
+    const std::uint32_t first = toIndex(this->m_keywords.size(), "keywords");
+    for (const auto& keyword : siblings) {
+      Keyword entry{};
+      entry.Value = this->intern(keyword.Keyword);
+      entry.Applied = keyword.Applied.has_value() ? static_cast<std::int32_t>(keyword.Applied.value()) : APPLIED_UNSET;
+      this->m_keywords.push_back(entry);
+      pending.push_back(&keyword);
+    }
+    return first;
+  };
+
+  record.FirstKeyword = appendSiblings(roots);
+  record.KeywordCount = toIndex(roots.size(), "keywords");
+  for (std::size_t next = record.FirstKeyword; next < this->m_keywords.size(); next++) {
+    const auto& children = pending[next - record.FirstKeyword]->Children;
+    const std::uint32_t firstChild = appendSiblings(children);
+    this->m_keywords[next].FirstChild = firstChild;
+    this->m_keywords[next].ChildCount = toIndex(children.size(), "keywords");
+  }
+}
+
+/**
+ * @brief Adds the metadata of a file, replacing any record already added for the same path.
+ *
+ * The strings, regions and keywords of a replaced record stay in the file unreferenced.
+ *
+ * @param path The image file, stored as an absolute path.
+ * @param identity The identity of the file when its metadata was read.
+ * @param metadata The metadata read from it.
+ * @throws InvalidStructureError if the catalog outgrows the 32 bit indices of the format
+ */
+void CatalogWriter::add(const fs::path& path, const FileUtils::FileIdentity& identity, const ImageMetadata& metadata) {
+  std::string key = FileUtils::lookupKey(path);
+
+  Record record{};
+  record.Path = this->intern(key);
+  record.Device = identity.Device;
+  record.Inode = identity.Inode;
+  record.Size = identity.Size;
+  record.ModifiedNs = identity.ModifiedNs;
+  record.ImageHeight = metadata.ImageHeight;
+  record.ImageWidth = metadata.ImageWidth;
+  record.Orientation =
+      metadata.Orientation.has_value() ? static_cast<std::int32_t>(metadata.Orientation.value()) : NO_ORIENTATION;
+  record.Title = this->intern(metadata.Title);
+  record.Description = this->intern(metadata.Description);
+  record.Country = this->intern(metadata.Country);
+  record.City = this->intern(metadata.City);
+  record.State = this->intern(metadata.State);
+  record.Location = this->intern(metadata.Location);
+  record.DimensionsUnit = StringRef{NO_STRING, 0};
+
+  if (metadata.RegionInfo.has_value()) {
+    const auto& regionInfo = metadata.RegionInfo.value();
+    record.Flags |= RECORD_HAS_REGION_INFO;
+    record.DimensionsH = regionInfo.AppliedToDimensions.H;
+    record.DimensionsW = regionInfo.AppliedToDimensions.W;
+    record.DimensionsUnit = this->intern(regionInfo.AppliedToDimensions.Unit);
+    record.FirstRegion = toIndex(this->m_regions.size(), "regions");
+    record.RegionCount = toIndex(regionInfo.RegionList.size(), "regions");
+    for (const auto& region : regionInfo.RegionList) {
+      Region entry{};
+      entry.H = region.Area.H;
+      entry.W = region.Area.W;
+      entry.X = region.Area.X;
+      entry.Y = region.Area.Y;
+      if (region.Area.D.has_value()) {
+        entry.D = region.Area.D.value();
+        entry.Flags |= REGION_HAS_D;
+      }
+      entry.Unit = this->intern(region.Area.Unit);
+      entry.Name = this->intern(region.Name);
+      entry.Type = this->intern(region.Type);
+      entry.Description = this->intern(region.Description);
+      this->m_regions.push_back(entry);
+    }
+  }
+
+  if (metadata.KeywordInfo.has_value()) {
+    record.Flags |= RECORD_HAS_KEYWORD_INFO;
+    this->addKeywords(metadata.KeywordInfo->Hierarchy, record);
+  }
+
+  auto existing = this->m_recordIndex.find(key);
+  if (existing != this->m_recordIndex.end()) {
+    this->m_records[existing->second] = record;
+    return;
+  }
+  this->m_recordIndex.emplace(key, this->m_records.size());
+  this->m_records.push_back(record);
+  this->m_keys.push_back(std::move(key));
+}
+
+/**
+ * @brief Adds the metadata of a file with its current identity.
+ *
+ * @throws FileAccessError if the file does not exist
+ */
+void CatalogWriter::add(const fs::path& path, const ImageMetadata& metadata) {
+  const auto identity = FileUtils::identify(path);
+  if (!identity.has_value()) {
+    throw FileAccessError("File does not exist: " + path.string());
+  }
+  this->add(path, identity.value(), metadata);
+}
+
+std::size_t CatalogWriter::size() const noexcept {
+  return this->m_records.size();
+}
+
+/**
+ * @brief Writes the catalog, replacing target atomically.
+ *
+ * @param target The catalog file.
+ * @param durability Whether the catalog, and its directory, are flushed before returning.
+ * @throws FileAccessError if the file cannot be written or renamed
+ */
+void CatalogWriter::write(const fs::path& target, DurabilityLevel durability) const {
+  std::vector<std::size_t> order(this->m_records.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [this](std::size_t lhs, std::size_t rhs) { return this->m_keys[lhs] < this->m_keys[rhs]; });
+  std::vector<Record> sorted;
+  sorted.reserve(order.size());
+  for (const auto index : order) {
+    sorted.push_back(this->m_records[index]);
+  }
+
+  Header header{};
+  std::memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+  header.Version = VERSION;
+  header.ByteOrder = BYTE_ORDER_MARK;
+  header.RecordCount = sorted.size();
+  header.RegionCount = this->m_regions.size();
+  header.KeywordCount = this->m_keywords.size();
+  header.StringBytes = this->m_strings.size();
+  header.RecordsOffset = alignUp(sizeof(Header));
+  header.RegionsOffset = alignUp(header.RecordsOffset + header.RecordCount * sizeof(Record));
+  header.KeywordsOffset = alignUp(header.RegionsOffset + header.RegionCount * sizeof(Region));
+  header.StringsOffset = alignUp(header.KeywordsOffset + header.KeywordCount * sizeof(Keyword));
+
+  const fs::path tempPath = FileUtils::temporaryPathFor(target);
+  try {
+    {
+      std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+      if (!out) {
+        throw FileAccessError("Unable to create " + tempPath.string());
+      }
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      writePadding(out, sizeof(header));
+      writeArray(out, sorted);
+      writePadding(out, header.RecordsOffset + header.RecordCount * sizeof(Record));
+      writeArray(out, this->m_regions);
+      writePadding(out, header.RegionsOffset + header.RegionCount * sizeof(Region));
+      writeArray(out, this->m_keywords);
+      writePadding(out, header.KeywordsOffset + header.KeywordCount * sizeof(Keyword));
+      out.write(this->m_strings.data(), static_cast<std::streamsize>(this->m_strings.size()));
+      if (!out.flush()) {
+        throw FileAccessError("Unable to write " + tempPath.string());
+      }
+    }
+    FileUtils::syncFile(tempPath, durability);
+    FileUtils::replaceFile(tempPath, target, durability);
+  } catch (...) {
+    std::error_code ec;
+    fs::remove(tempPath, ec);
+    throw;
+  }
+  InternalLogger::debug("Wrote catalog of " + std::to_string(sorted.size()) + " files to " + target.string());
+}
+
+/**
+ * @brief Maps a catalog file and checks its header.
+ *
+ * @param path The catalog file.
+ * @throws FileAccessError if the file cannot be opened or mapped
+ * @throws InvalidStructureError if it is not a catalog of this version and byte order, or is truncated
+ */
+CatalogReader::CatalogReader(const fs::path& path) : m_path(path) {
+#ifdef _WIN32
+  HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw FileAccessError("Unable to open catalog " + path.string());
+  }
+  LARGE_INTEGER size{};
+  if (!::GetFileSizeEx(file, &size)) {
+    ::CloseHandle(file);
+    throw FileAccessError("Unable to read the size of catalog " + path.string());
+  }
+  this->m_length = static_cast<std::size_t>(size.QuadPart);
+  if (this->m_length < sizeof(Header)) {
+    ::CloseHandle(file);
+    throw InvalidStructureError("Not a catalog: " + path.string());
+  }
+  HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  ::CloseHandle(file);
+  if (mapping == nullptr) {
+    throw FileAccessError("Unable to map catalog " + path.string());
+  }
+  void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    ::CloseHandle(mapping);
+    throw FileAccessError("Unable to map catalog " + path.string());
+  }
+  this->m_mapping = mapping;
+  this->m_data = static_cast<const std::byte*>(view);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw FileAccessError("Unable to open catalog " + path.string() + ": " + std::strerror(errno));
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw FileAccessError("Unable to stat catalog " + path.string() + ": " + std::strerror(errno));
+  }
+  this->m_length = static_cast<std::size_t>(info.st_size);
+  if (this->m_length < sizeof(Header)) {
+    ::close(fd);
+    throw InvalidStructureError("Not a catalog: " + path.string());
+  }
+  void* view = ::mmap(nullptr, this->m_length, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED) {
+    throw FileAccessError("Unable to map catalog " + path.string() + ": " + std::strerror(errno));
+  }
+  // Lookups are binary searches, read-ahead would mostly load records which are never touched
+  ::posix_madvise(view, this->m_length, POSIX_MADV_RANDOM);
+  this->m_data = static_cast<const std::byte*>(view);
+#endif
+
+  try {
+    this->validate();
+  } catch (...) {
+    this->unmap();
+    throw;
+  }
+}
+
+CatalogReader::~CatalogReader() {
+  this->unmap();
+}
+
+CatalogReader::CatalogReader(CatalogReader&& other) noexcept :
+    m_data(std::exchange(other.m_data, nullptr)), m_length(std::exchange(other.m_length, 0)),
+    m_mapping(std::exchange(other.m_mapping, nullptr)), m_path(std::move(other.m_path)) {
+}
+
+CatalogReader& CatalogReader::operator=(CatalogReader&& other) noexcept {
+  if (this != &other) {
+    this->unmap();
+    this->m_data = std::exchange(other.m_data, nullptr);
+    this->m_length = std::exchange(other.m_length, 0);
+    this->m_mapping = std::exchange(other.m_mapping, nullptr);
+    this->m_path = std::move(other.m_path);
+  }
+  return *this;
+}
+
+void CatalogReader::unmap() noexcept {
+  if (this->m_data == nullptr) {
+    return;
+  }
+#ifdef _WIN32
+  ::UnmapViewOfFile(this->m_data);
+  ::CloseHandle(static_cast<HANDLE>(this->m_mapping));
+#else
+  ::munmap(const_cast<std::byte*>(this->m_data), this->m_length);
+#endif
+  this->m_data = nullptr;
+  this->m_mapping = nullptr;
+  this->m_length = 0;
+}
+
+/**
+ * @brief Checks the header and that every section lies within the file.
+ *
+ * Ranges within a record are checked when the record is read.
+ */
+void CatalogReader::validate() const {
+  const Header& header = this->header();
+  if (std::memcmp(header.Magic, MAGIC, sizeof(MAGIC)) != 0) {
+    throw InvalidStructureError("Not a catalog: " + this->m_path.string());
+  }
+  if (header.ByteOrder != BYTE_ORDER_MARK) {
+    throw InvalidStructureError("Catalog " + this->m_path.string() + " was written with a different byte order");
+  }
+  if (header.Version != VERSION) {
+    throw InvalidStructureError("Unsupported catalog version " + std::to_string(header.Version) + " in " +
+                                this->m_path.string());
+  }
+  const std::uint64_t length = this->m_length;
+  if (!sectionFits(header.RecordsOffset, header.RecordCount, sizeof(Record), length) ||
+      !sectionFits(header.RegionsOffset, header.RegionCount, sizeof(Region), length) ||
+      !sectionFits(header.KeywordsOffset, header.KeywordCount, sizeof(Keyword), length) ||
+      !sectionFits(header.StringsOffset, header.StringBytes, 1, length)) {
+    throw InvalidStructureError("Truncated catalog: " + this->m_path.string());
+  }
+}
+
+const Header& CatalogReader::header() const noexcept {
+  return *reinterpret_cast<const Header*>(this->m_data);
+}
+
+const Record& CatalogReader::record(std::size_t index) const {
+  if (index >= this->size()) {
+    throw InvalidStructureError("Catalog record " + std::to_string(index) + " out of range");
+  }
+  return reinterpret_cast<const Record*>(this->m_data + this->header().RecordsOffset)[index];
+}
+
+std::string_view CatalogReader::string(const StringRef& ref) const {
+  if (ref.Offset == NO_STRING) {
+    return {};
+  }
+  if (!rangeFits(ref.Offset, ref.Length, this->header().StringBytes)) {
+    throw InvalidStructureError("Catalog string out of range in " + this->m_path.string());
+  }
+  return {reinterpret_cast<const char*>(this->m_data + this->header().StringsOffset) + ref.Offset, ref.Length};
+}
+
+std::optional<std::string> CatalogReader::optionalString(const StringRef& ref) const {
+  if (ref.Offset == NO_STRING) {
+    return std::nullopt;
+  }
+  return std::string(this->string(ref));
+}
+
+std::size_t CatalogReader::size() const noexcept {
+  return static_cast<std::size_t>(this->header().RecordCount);
+}
+
+std::optional<std::size_t> CatalogReader::find(const fs::path& path) const {
+  const std::string key = FileUtils::lookupKey(path);
+  std::size_t low = 0;
+  std::size_t high = this->size();
+  while (low < high) {
+    const std::size_t middle = low + (high - low) / 2;
+    const int order = this->string(this->record(middle).Path).compare(key);
+    if (order == 0) {
+      return middle;
+    }
+    if (order < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string_view CatalogReader::path(std::size_t index) const {
+  return this->string(this->record(index).Path);
+}
+
+FileUtils::FileIdentity CatalogReader::identity(std::size_t index) const {
+  const Record& entry = this->record(index);
+  return FileUtils::FileIdentity{entry.Device, entry.Inode, entry.Size, entry.ModifiedNs};
+}
+
+/**
+ * @brief Builds the keyword hierarchy of one record.
+ *
+ * The writer appends the keywords of a record breadth first, so the children of each keyword
+ * start exactly where the children of the keywords before it end. Requiring that layout means
+ * no two keywords share or overlap a range of children, so at most the keywords the record owns
+ * are decoded, each once, and the hierarchy is built bottom up without recursion.
+ *
+ * @param entry The record.
+ * @return The root keywords.
+ * @throws InvalidStructureError if a range of children is out of place, or the hierarchy is too deep
+ */
+std::vector<KeywordInfoModel::KeywordStruct> CatalogReader::keywords(const Record& entry) const {
+  const Header& header = this->header();
+  if (!rangeFits(entry.FirstKeyword, entry.KeywordCount, header.KeywordCount)) {
+    throw InvalidStructureError("Catalog keywords out of range in " + this->m_path.string());
+  }
+  const Keyword* keywords = reinterpret_cast<const Keyword*>(this->m_data + header.KeywordsOffset);
+  const std::uint64_t first = entry.FirstKeyword;
+
+  // The end of the keywords claimed so far, and the depth of each, roots first
+  std::uint64_t end = first + entry.KeywordCount;
+  std::vector<std::uint32_t> depths(entry.KeywordCount, 1);
+  for (std::uint64_t index = first; index < end; index++) {
+    const Keyword& keyword = keywords[index];
+    if (keyword.ChildCount == 0) {
+      continue;
+    }
+    if (keyword.FirstChild != end || !rangeFits(keyword.FirstChild, keyword.ChildCount, header.KeywordCount)) {
+      throw InvalidStructureError("Catalog keyword children out of range in " + this->m_path.string());
+    }
+    const std::uint32_t depth = depths[index - first] + 1;
+    if (depth > MAX_KEYWORD_DEPTH) {
+      throw InvalidStructureError("Catalog keywords nested too deeply in " + this->m_path.string());
+    }
+    depths.insert(depths.end(), keyword.ChildCount, depth);
+    end += keyword.ChildCount;
+  }
+
+  // Children always come after their parent, so building from the end finds them complete
+  std::vector<KeywordInfoModel::KeywordStruct> built;
+  built.reserve(end - first);
+  for (std::uint64_t index = first; index < end; index++) {
+    const Keyword& keyword = keywords[index];
+    std::optional<bool> applied;
+    if (keyword.Applied != APPLIED_UNSET) {
+      applied = keyword.Applied != 0;
+    }
+    built.emplace_back(std::string(this->string(keyword.Value)), std::vector<KeywordInfoModel::KeywordStruct>{},
+                       applied);
+  }
+  for (std::uint64_t index = end; index-- > first;) {
+    const Keyword& keyword = keywords[index];
+    auto& children = built[index - first].Children;
+    children.reserve(keyword.ChildCount);
+    for (std::uint32_t child = 0; child < keyword.ChildCount; child++) {
+      children.push_back(std::move(built[keyword.FirstChild - first + child]));
+    }
+  }
+  // Only the roots are left complete, the rest were moved into their parents
+  built.erase(built.begin() + static_cast<std::ptrdiff_t>(entry.KeywordCount), built.end());
+  return built;
+}
+
+/**
+ * @brief Builds the metadata of one record.
+ *
+ * @param index The record, in path order.
+ * @return The metadata, with its original path set to the recorded file.
+ * @throws InvalidStructureError if the record refers outside the catalog
+ */
+ImageMetadata CatalogReader::metadata(std::size_t index) const {
+  const Record& entry = this->record(index);
+  ImageMetadata metadata(entry.ImageHeight, entry.ImageWidth);
+  metadata.m_originalPath = fs::path(std::string(this->string(entry.Path)));
+  if (entry.Orientation != NO_ORIENTATION) {
+    metadata.Orientation = orientation_from_int(entry.Orientation);
+  }
+  metadata.Title = this->optionalString(entry.Title);
+  metadata.Description = this->optionalString(entry.Description);
+  metadata.Country = this->optionalString(entry.Country);
+  metadata.City = this->optionalString(entry.City);
+  metadata.State = this->optionalString(entry.State);
+  metadata.Location = this->optionalString(entry.Location);
+
+  const Header& header = this->header();
+  if ((entry.Flags & RECORD_HAS_REGION_INFO) != 0) {
+    if (!rangeFits(entry.FirstRegion, entry.RegionCount, header.RegionCount)) {
+      throw InvalidStructureError("Catalog regions out of range in " + this->m_path.string());
+    }
+    const Region* regions = reinterpret_cast<const Region*>(this->m_data + header.RegionsOffset) + entry.FirstRegion;
+    std::vector<RegionInfoStruct::RegionStruct> regionList;
+    regionList.reserve(entry.RegionCount);
+    for (std::uint32_t i = 0; i < entry.RegionCount; i++) {
+      const Region& region = regions[i];
+      std::optional<double> d;
+      if ((region.Flags & REGION_HAS_D) != 0) {
+        d = region.D;
+      }
+      regionList.emplace_back(XmpAreaStruct(region.H, region.W, region.X, region.Y,
+                                            std::string(this->string(region.Unit)), d),
+                              std::string(this->string(region.Name)), std::string(this->string(region.Type)),
+                              this->optionalString(region.Description));
+    }
+    metadata.RegionInfo = RegionInfoStruct(
+        DimensionsStruct(entry.DimensionsH, entry.DimensionsW, std::string(this->string(entry.DimensionsUnit))),
+        regionList);
+  }
+
+  if ((entry.Flags & RECORD_HAS_KEYWORD_INFO) != 0) {
+    metadata.KeywordInfo = KeywordInfoModel(this->keywords(entry));
+  }
+  return metadata;
+}
+
+/**
+ * @brief Returns the recorded metadata of a file, unless the file changed since it was recorded.
+ *
+ * @param path The image file.
+ * @return The metadata, or nothing if the file is not in the catalog, no longer exists, or
+ *         its identity differs.
+ */
+std::optional<ImageMetadata> CatalogReader::lookup(const fs::path& path) const {
+  const auto index = this->find(path);
+  if (!index.has_value()) {
+    return std::nullopt;
+  }
+  const auto current = FileUtils::identify(path);
+  if (!current.has_value() || current.value() != this->identity(index.value())) {
+    return std::nullopt;
+  }
+  return this->metadata(index.value());
+}
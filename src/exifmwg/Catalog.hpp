@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "CatalogFormat.hpp"
+#include "FileUtils.hpp"
+#include "ImageMetadata.hpp"
+#include "WriteOptions.hpp"
+
+/**
+ * @brief Collects parsed metadata and writes it as a catalog file which CatalogReader maps.
+ *
+ * Each record is keyed by the absolute path of its image and the identity the image had when
+ * it was read. Adding a path a second time replaces its record. Identical strings, such as
+ * repeated locations and keywords, are stored once.
+ */
+class CatalogWriter {
+public:
+  void add(const std::filesystem::path& path, const FileUtils::FileIdentity& identity, const ImageMetadata& metadata);
+  // Identifies the file now, so call it right after the metadata was read
+  void add(const std::filesystem::path& path, const ImageMetadata& metadata);
+
+  std::size_t size() const noexcept;
+
+  // Writes into a temporary file next to target and renames it over target
+  void write(const std::filesystem::path& target, DurabilityLevel durability = DurabilityLevel::Deferred) const;
+
+private:
+  std::vector<CatalogFormat::Record> m_records;
+  std::vector<std::string> m_keys;
+  std::unordered_map<std::string, std::size_t> m_recordIndex;
+  std::vector<CatalogFormat::Region> m_regions;
+  std::vector<CatalogFormat::Keyword> m_keywords;
+  std::string m_strings;
+  std::unordered_map<std::string, CatalogFormat::StringRef> m_stringIndex;
+
+  CatalogFormat::StringRef intern(const std::string& value);
+  CatalogFormat::StringRef intern(const std::optional<std::string>& value);
+  void addKeywords(const std::vector<KeywordInfoModel::KeywordStruct>& roots, CatalogFormat::Record& record);
+};
+
+/**
+ * @brief A catalog file mapped read-only, read in place without parsing it up front.
+ *
+ * Opening only maps the file and checks its header, so the pages of a record are read from disk
+ * the first time it is looked up. Each lookup is a binary search over the records, and only the
+ * metadata of the matched record is built. The reader is move-only and unmaps the file when
+ * destroyed. Concurrent lookups are safe.
+ */
+class CatalogReader {
+public:
+  explicit CatalogReader(const std::filesystem::path& path);
+  ~CatalogReader();
+
+  CatalogReader(const CatalogReader&) = delete;
+  CatalogReader& operator=(const CatalogReader&) = delete;
+  CatalogReader(CatalogReader&& other) noexcept;
+  CatalogReader& operator=(CatalogReader&& other) noexcept;
+
+  std::size_t size() const noexcept;
+
+  // The index of the record of a file, in path order
+  std::optional<std::size_t> find(const std::filesystem::path& path) const;
+  std::string_view path(std::size_t index) const;
+  FileUtils::FileIdentity identity(std::size_t index) const;
+  ImageMetadata metadata(std::size_t index) const;
+
+  // The metadata of a file if it is in the catalog and has not changed since it was recorded
+  std::optional<ImageMetadata> lookup(const std::filesystem::path& path) const;
+
+private:
+  const std::byte* m_data = nullptr;
+  std::size_t m_length = 0;
+  // The mapping object on Windows, unused elsewhere
+  void* m_mapping = nullptr;
+  std::filesystem::path m_path;
+
+  const CatalogFormat::Header& header() const noexcept;
+  const CatalogFormat::Record& record(std::size_t index) const;
+  std::string_view string(const CatalogFormat::StringRef& ref) const;
+  std::optional<std::string> optionalString(const CatalogFormat::StringRef& ref) const;
+  std::vector<KeywordInfoModel::KeywordStruct> keywords(const CatalogFormat::Record& entry) const;
+  void validate() const;
+  void unmap() noexcept;
+};
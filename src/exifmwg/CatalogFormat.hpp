@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The on-disk layout of a metadata catalog, read in place from a mapping of the file.
+ *
+ *   Header | Record[RecordCount] | Region[RegionCount] | Keyword[KeywordCount] | string bytes
+ *
+ * Every section starts 8 byte aligned. Records are sorted by path, so a lookup is a binary
+ * search over the mapped records. The regions of a record, the root keywords of a record and
+ * the children of a keyword are each a contiguous range of their array. The keywords of a record
+ * are stored breadth first, the children of each keyword directly after those of the keyword
+ * before it, and are nested at most MAX_KEYWORD_DEPTH deep. Strings are not terminated and may be shared by several references.
+ * Values are stored in the byte order of the writer, which a reader with a different one rejects.
+ */
+namespace CatalogFormat {
+
+inline constexpr char MAGIC[8] = {'E', 'X', 'M', 'W', 'G', 'C', 'A', 'T'};
+inline constexpr std::uint32_t VERSION = 1;
+// Reads back differently on a machine with the other byte order
+inline constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+// The offset of a StringRef which is not set
+inline constexpr std::uint32_t NO_STRING = 0xFFFFFFFF;
+inline constexpr std::int32_t NO_ORIENTATION = -1;
+
+inline constexpr std::uint32_t RECORD_HAS_REGION_INFO = 1U << 0;
+inline constexpr std::uint32_t RECORD_HAS_KEYWORD_INFO = 1U << 1;
+inline constexpr std::uint32_t REGION_HAS_D = 1U << 0;
+
+// An Applied value of a keyword
+inline constexpr std::int32_t APPLIED_UNSET = -1;
+// Root keywords are at depth 1
+inline constexpr std::uint32_t MAX_KEYWORD_DEPTH = 256;
+
+struct StringRef {
+  std::uint32_t Offset;
+  std::uint32_t Length;
+};
+
+struct Header {
+  char Magic[8];
+  std::uint32_t Version;
+  std::uint32_t ByteOrder;
+  std::uint64_t RecordCount;
+  std::uint64_t RegionCount;
+  std::uint64_t KeywordCount;
+  std::uint64_t StringBytes;
+  std::uint64_t RecordsOffset;
+  std::uint64_t RegionsOffset;
+  std::uint64_t KeywordsOffset;
+  std::uint64_t StringsOffset;
+};
+
+struct Record {
+  StringRef Path;
+  std::uint64_t Device;
+  std::uint64_t Inode;
+  std::uint64_t Size;
+  std::int64_t ModifiedNs;
+  std::int32_t ImageHeight;
+  std::int32_t ImageWidth;
+  std::int32_t Orientation;
+  std::uint32_t Flags;
+  StringRef Title;
+  StringRef Description;
+  StringRef Country;
+  StringRef City;
+  StringRef State;
+  StringRef Location;
+  double DimensionsH;
+  double DimensionsW;
+  StringRef DimensionsUnit;
+  std::uint32_t FirstRegion;
+  std::uint32_t RegionCount;
+  std::uint32_t FirstKeyword;
+  std::uint32_t KeywordCount;
+};
+
+struct Region {
+  double H;
+  double W;
+  double X;
+  double Y;
+  double D;
+  StringRef Unit;
+  StringRef Name;
+  StringRef Type;
+  StringRef Description;
+  std::uint32_t Flags;
+  std::uint32_t Reserved;
+};
+
+struct Keyword {
+  StringRef Value;
+  std::uint32_t FirstChild;
+  std::uint32_t ChildCount;
+  std::int32_t Applied;
+  std::uint32_t Reserved;
+};
+
+// The sizes are part of the format
+static_assert(sizeof(Header) == 80);
+static_assert(sizeof(Record) == 144);
+static_assert(sizeof(Region) == 80);
+static_assert(sizeof(Keyword) == 24);
+
+} // namespace CatalogFormat
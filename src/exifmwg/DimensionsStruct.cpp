@@ -1,7 +1,9 @@
 #include <utility>
 
+#include "BinaryCodec.hpp"
 #include "DimensionsStruct.hpp"
 #include "Errors.hpp"
+#include "JsonCodec.hpp"
 #include "XmpUtils.hpp"
 
 /**
@@ -26,36 +28,51 @@ DimensionsStruct::DimensionsStruct(double h, double w, std::string unit) : H(h),
  * @param baseKey The base key prefix for the dimension fields.
  * @return A populated DimensionsStruct object.
  * @throws MissingFieldError if any field is missing
+ * @throws InvalidStructureError if the height or width is not a number
  */
 DimensionsStruct DimensionsStruct::fromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey) {
+  return tryFromXmp(xmpData, baseKey).value();
+}
 
-  double h = 0.0;
-  double w = 0.0;
-  std::string unit;
-
-  // Parse individual dimension fields
-  auto hKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/stDim:h"));
-  if (hKey != xmpData.end()) {
-    h = std::stod(hKey->toString());
-  } else {
-    throw MissingFieldError("No height found in dimensions struct");
+/**
+ * @brief Parses a DimensionsStruct from XMP data, reporting a missing or invalid field as an error value.
+ *
+ * @param xmpData The Exiv2::XmpData object containing the XMP metadata.
+ * @param baseKey The base key prefix for the dimension fields.
+ * @return The dimensions, or the error fromXmp() would throw.
+ */
+Result<DimensionsStruct> DimensionsStruct::tryFromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey) {
+  auto h = XmpUtils::readRequiredDouble(xmpData, baseKey + "/stDim:h", "height", "dimensions struct");
+  if (!h) {
+    return h.error();
   }
-
-  auto wKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/stDim:w"));
-  if (wKey != xmpData.end()) {
-    w = std::stod(wKey->toString());
-  } else {
-    throw MissingFieldError("No width found in dimensions struct");
+  auto w = XmpUtils::readRequiredDouble(xmpData, baseKey + "/stDim:w", "width", "dimensions struct");
+  if (!w) {
+    return w.error();
   }
 
   auto unitKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/stDim:unit"));
-  if (unitKey != xmpData.end()) {
-    unit = unitKey->toString();
-  } else {
-    throw MissingFieldError("No unit found in dimensions struct");
+  if (unitKey == xmpData.end()) {
+    return ErrorInfo{ErrorCode::MissingField, "No unit found in dimensions struct", {}};
   }
 
-  return {h, w, unit};
+  return DimensionsStruct(h.value(), w.value(), unitKey->toString());
+}
+
+DimensionsStruct DimensionsStruct::fromBytes(std::string_view bytes) {
+  return BinaryCodec::decode<DimensionsStruct>(bytes);
+}
+
+std::string DimensionsStruct::toBytes() const {
+  return BinaryCodec::encode(*this);
+}
+
+DimensionsStruct DimensionsStruct::fromJson(std::string_view json) {
+  return JsonCodec::decode<DimensionsStruct>(json);
+}
+
+std::string DimensionsStruct::toJson() const {
+  return JsonCodec::encode(*this);
 }
 
 /**
@@ -2,11 +2,15 @@
 
 #include <concepts>
 #include <string>
+#include <string_view>
 #include <tuple>
 
 #include <exiv2/exiv2.hpp>
 
+#include "BinarySerializable.hpp"
+#include "JsonSerializable.hpp"
 #include "PythonBindable.hpp"
+#include "Result.hpp"
 #include "XmpSerializable.hpp"
 
 class DimensionsStruct {
@@ -19,8 +23,17 @@ public:
 
   // XMP serialization
   static DimensionsStruct fromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey = "");
+  static Result<DimensionsStruct> tryFromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey = "");
   void toXmp(Exiv2::XmpData& xmpData, const std::string& basePath = "") const;
 
+  // Binary serialization
+  static DimensionsStruct fromBytes(std::string_view bytes);
+  std::string toBytes() const;
+
+  // JSON serialization
+  static DimensionsStruct fromJson(std::string_view json);
+  std::string toJson() const;
+
   // Python bindable
   std::string to_string() const;
 
@@ -47,3 +60,5 @@ static_assert(std::copy_constructible<DimensionsStruct>);
 static_assert(std::equality_comparable<DimensionsStruct>);
 static_assert(XmpSerializable<DimensionsStruct>);
 static_assert(PythonBindableRepr<DimensionsStruct>);
+static_assert(BinarySerializable<DimensionsStruct>);
+static_assert(JsonSerializable<DimensionsStruct>);
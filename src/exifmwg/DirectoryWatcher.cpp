@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <set>
+#include <system_error>
+#include <utility>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "Batch.hpp"
+#include "DirectoryWatcher.hpp"
+#include "Errors.hpp"
+#include "Logging.hpp"
+
+namespace fs = std::filesystem;
+
+#ifdef __linux__
+namespace {
+
+// IN_CREATE is watched for new directories. Created files are skipped, they are reported once closed after writing.
+constexpr std::uint32_t WATCH_EVENTS =
+    IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF;
+
+// Whether path is the directory itself or below it
+bool isWithin(const fs::path& path, const fs::path& directory) {
+  return std::mismatch(directory.begin(), directory.end(), path.begin(), path.end()).first == directory.end();
+}
+
+} // namespace
+#endif
+
+/**
+ * @brief Starts watching a directory.
+ *
+ * @param root The directory to watch.
+ * @param recursive Whether subdirectories, including ones created later, are watched.
+ * @param extensions The file extensions to report, matched like Batch::scanDirectory. Empty for every
+ *                   format Exiv2 reads metadata from.
+ * @throws FileAccessError if root is not a directory or cannot be watched
+ * @throws ExifMwgBaseError if the platform has no inotify
+ */
+DirectoryWatcher::DirectoryWatcher(const fs::path& root, bool recursive, const std::vector<std::string>& extensions) :
+    m_root(root), m_recursive(recursive), m_extensions(extensions) {
+#ifdef __linux__
+  if (!fs::is_directory(root)) {
+    throw FileAccessError("Not a directory: " + root.string());
+  }
+  this->m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (this->m_fd < 0) {
+    throw FileAccessError("Unable to start watching " + root.string() + ": " + std::strerror(errno));
+  }
+  try {
+    this->watchTree(root, nullptr);
+  } catch (...) {
+    ::close(this->m_fd);
+    throw;
+  }
+#else
+  throw ExifMwgBaseError("Watching directories needs inotify, which is only available on Linux");
+#endif
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+#ifdef __linux__
+  if (this->m_fd >= 0) {
+    ::close(this->m_fd);
+  }
+#endif
+}
+
+bool DirectoryWatcher::supported() noexcept {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+const fs::path& DirectoryWatcher::root() const noexcept {
+  return this->m_root;
+}
+
+bool DirectoryWatcher::rescanNeeded() const noexcept {
+  return this->m_rescanNeeded;
+}
+
+/**
+ * @brief Watches a directory, and its subdirectories when recursive.
+ *
+ * @param directory The directory to add.
+ * @param found When set, the images already in the tree are appended to it, for a directory which
+ *              appeared after watching started.
+ * @throws FileAccessError if the root cannot be watched. Subdirectories which cannot be are skipped
+ *         with a warning.
+ */
+void DirectoryWatcher::watchTree(const fs::path& directory, std::vector<fs::path>* found) {
+#ifdef __linux__
+  const int wd = ::inotify_add_watch(this->m_fd, directory.c_str(), WATCH_EVENTS | IN_ONLYDIR | IN_DONT_FOLLOW);
+  if (wd < 0) {
+    if (directory == this->m_root) {
+      throw FileAccessError("Unable to watch " + directory.string() + ": " + std::strerror(errno));
+    }
+    // Too many watches also ends up here, the files below are then missed
+    InternalLogger::warning("Unable to watch " + directory.string() + ": " + std::strerror(errno));
+    this->m_watchFailed = true;
+    return;
+  }
+  // A directory moved within the tree keeps its watch, which now has this path
+  this->m_watches[wd] = directory;
+  this->m_movedAway.erase(wd);
+
+  if (!this->m_recursive && found == nullptr) {
+    return;
+  }
+  std::error_code ec;
+  fs::directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec);
+  for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+    std::error_code typeError;
+    if (it->is_directory(typeError) && !it->is_symlink(typeError)) {
+      if (this->m_recursive) {
+        this->watchTree(it->path(), found);
+      }
+    } else if (found != nullptr && it->is_regular_file(typeError) &&
+               Batch::matchesExtension(it->path(), this->m_extensions)) {
+      found->push_back(it->path());
+    }
+  }
+#else
+  static_cast<void>(directory);
+  static_cast<void>(found);
+#endif
+}
+
+/**
+ * @brief Stops watching a directory which left the tree, and the directories below it.
+ *
+ * The watches are forgotten once their IN_IGNORED arrives.
+ *
+ * @param directory The path the directory had in the tree.
+ */
+void DirectoryWatcher::unwatchTree(const fs::path& directory) {
+#ifdef __linux__
+  for (const auto& [wd, path] : this->m_watches) {
+    if (this->m_movedAway.count(wd) > 0 && isWithin(path, directory)) {
+      ::inotify_rm_watch(this->m_fd, wd);
+    }
+  }
+#else
+  static_cast<void>(directory);
+#endif
+}
+
+/**
+ * @brief Waits for events without collecting them.
+ *
+ * Only the descriptor is used, so this may run without the lock guarding the watcher, such as the GIL,
+ * before a poll(0) under it.
+ *
+ * @param timeoutMs How long to wait, 0 to only check, -1 to wait until something happens.
+ * @return Whether events are pending.
+ * @throws FileAccessError if waiting fails
+ */
+bool DirectoryWatcher::wait(int timeoutMs) const {
+#ifdef __linux__
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  pollfd ready{this->m_fd, POLLIN, 0};
+  int remainingMs = timeoutMs;
+  while (true) {
+    const int count = ::poll(&ready, 1, remainingMs);
+    if (count >= 0) {
+      return count > 0;
+    }
+    if (errno != EINTR) {
+      throw FileAccessError("Unable to wait for events for " + this->m_root.string() + ": " + std::strerror(errno));
+    }
+    if (timeoutMs > 0) {
+      const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+      remainingMs = static_cast<int>(std::max<std::chrono::milliseconds::rep>(left.count(), 0));
+    }
+  }
+#else
+  static_cast<void>(timeoutMs);
+  return false;
+#endif
+}
+
+/**
+ * @brief Returns the image files affected since the last call.
+ *
+ * A path may be reported for a file which no longer exists, when it was removed or moved away.
+ *
+ * @param timeoutMs How long to wait for the first event, 0 to only collect what is pending, -1 to wait
+ *                  until something happens.
+ * @return The affected files, sorted and without duplicates.
+ * @throws FileAccessError if waiting for or reading the events fails
+ */
+std::vector<fs::path> DirectoryWatcher::poll(int timeoutMs) {
+  this->m_rescanNeeded = std::exchange(this->m_watchFailed, false);
+  std::set<fs::path> changed;
+#ifdef __linux__
+  if (!this->wait(timeoutMs)) {
+    return {};
+  }
+
+  alignas(inotify_event) char buffer[64 * 1024];
+  while (true) {
+    const ssize_t length = ::read(this->m_fd, buffer, sizeof(buffer));
+    if (length < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      throw FileAccessError("Unable to read events for " + this->m_root.string() + ": " + std::strerror(errno));
+    }
+    for (ssize_t offset = 0; offset < length;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+      if ((event->mask & IN_Q_OVERFLOW) != 0) {
+        InternalLogger::warning("Events were dropped while watching " + this->m_root.string());
+        this->m_rescanNeeded = true;
+        continue;
+      }
+      auto watch = this->m_watches.find(event->wd);
+      if (watch == this->m_watches.end()) {
+        continue;
+      }
+      if ((event->mask & IN_IGNORED) != 0) {
+        this->m_movedAway.erase(event->wd);
+        this->m_watches.erase(watch);
+        continue;
+      }
+      if ((event->mask & IN_MOVE_SELF) != 0) {
+        // Follows the IN_MOVED_FROM of the old parent, and the IN_MOVED_TO of the new one when that is in the
+        // tree, which watched it again under its new path. Only a directory which left the tree is dropped,
+        // with the watches below it.
+        if (this->m_movedAway.count(event->wd) > 0) {
+          this->unwatchTree(watch->second);
+        }
+        continue;
+      }
+      if (event->len == 0) {
+        continue;
+      }
+      const fs::path path = watch->second / event->name;
+
+      if ((event->mask & IN_ISDIR) != 0) {
+        if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0 && this->m_recursive) {
+          std::vector<fs::path> found;
+          this->watchTree(path, &found);
+          changed.insert(found.begin(), found.end());
+        } else if ((event->mask & IN_MOVED_FROM) != 0) {
+          // The files which were in it are no longer at these paths, but were never reported
+          this->m_rescanNeeded = true;
+          for (const auto& [movedWd, movedPath] : this->m_watches) {
+            if (isWithin(movedPath, path)) {
+              this->m_movedAway.insert(movedWd);
+            }
+          }
+        }
+        continue;
+      }
+      if ((event->mask & IN_CREATE) != 0 || !Batch::matchesExtension(path, this->m_extensions)) {
+        continue;
+      }
+      changed.insert(path);
+    }
+  }
+  this->m_rescanNeeded = this->m_rescanNeeded || std::exchange(this->m_watchFailed, false);
+#else
+  static_cast<void>(this->wait(timeoutMs));
+#endif
+  return {changed.begin(), changed.end()};
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Collects the image files created, changed, moved or removed below a directory, using inotify.
+ *
+ * Every directory of the tree is watched, and directories created or moved into it later are
+ * added as they appear, with the images already inside them reported. Files are reported once
+ * they are closed after writing, renamed into place or have their timestamps changed, so a file
+ * still being written is not reported early. A directory renamed within the tree is watched under
+ * its new path. When the kernel drops events, or a directory is moved away from its path, the
+ * reported paths are incomplete and rescanNeeded() is set.
+ *
+ * Only available on Linux. Not thread safe, poll() from one thread. wait() may run concurrently.
+ */
+class DirectoryWatcher {
+public:
+  explicit DirectoryWatcher(const std::filesystem::path& root, bool recursive = true,
+                            const std::vector<std::string>& extensions = {});
+  ~DirectoryWatcher();
+
+  DirectoryWatcher(const DirectoryWatcher&) = delete;
+  DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+  // Waits up to timeoutMs for a change, -1 for no limit, then returns the affected files, sorted
+  std::vector<std::filesystem::path> poll(int timeoutMs = 0);
+  // Waits up to timeoutMs for a change without collecting it, safe to call while another thread polls
+  bool wait(int timeoutMs) const;
+  // Whether events were lost during the last poll(), so a full refresh is needed
+  bool rescanNeeded() const noexcept;
+
+  const std::filesystem::path& root() const noexcept;
+
+  static bool supported() noexcept;
+
+private:
+  std::filesystem::path m_root;
+  bool m_recursive;
+  std::vector<std::string> m_extensions;
+  int m_fd = -1;
+  std::unordered_map<int, std::filesystem::path> m_watches;
+  bool m_rescanNeeded = false;
+  // A subdirectory could not be watched, reported by the next poll()
+  bool m_watchFailed = false;
+  // Watches of directories moved from their path, until they are watched again within the tree or dropped
+  std::unordered_set<int> m_movedAway;
+
+  void watchTree(const std::filesystem::path& directory, std::vector<std::filesystem::path>* found);
+  void unwatchTree(const std::filesystem::path& directory);
+};
@@ -1,5 +1,8 @@
 #pragma once
+#include <exception>
+#include <filesystem>
 #include <stdexcept>
+#include <string>
 
 class ExifMwgBaseError : public std::runtime_error {
 public:
@@ -25,3 +28,65 @@ class MissingFieldError : public InvalidStructureError {
 public:
   using InvalidStructureError::InvalidStructureError;
 };
+
+// Identifies the exception class an error would be thrown as. The values are public, new codes are appended.
+enum class ErrorCode {
+  FileAccess = 0,
+  Exiv2 = 1,
+  InvalidStructure = 2,
+  MissingField = 3,
+  Unknown = 4,
+  // The batch was cancelled before the file was reached
+  Cancelled = 5,
+};
+
+// An error reported as a value, for batch operations which continue past a failed file
+struct ErrorInfo {
+  ErrorCode Code = ErrorCode::Unknown;
+  std::string Message;
+  std::filesystem::path Path;
+};
+
+/**
+ * @brief Throws an error reported as a value as the exception class its code identifies.
+ */
+[[noreturn]] inline void throwError(const ErrorInfo& error) {
+  switch (error.Code) {
+  case ErrorCode::FileAccess:
+    throw FileAccessError(error.Message);
+  case ErrorCode::Exiv2:
+    throw Exiv2Error(error.Message);
+  case ErrorCode::InvalidStructure:
+    throw InvalidStructureError(error.Message);
+  case ErrorCode::MissingField:
+    throw MissingFieldError(error.Message);
+  case ErrorCode::Unknown:
+  case ErrorCode::Cancelled:
+    break;
+  }
+  throw ExifMwgBaseError(error.Message);
+}
+
+/**
+ * @brief Describes the exception currently being handled. Must be called from within a catch block.
+ *
+ * @param path The file the error belongs to.
+ */
+inline ErrorInfo currentErrorInfo(const std::filesystem::path& path) {
+  try {
+    throw;
+  } catch (const MissingFieldError& e) {
+    return {ErrorCode::MissingField, e.what(), path};
+  } catch (const InvalidStructureError& e) {
+    return {ErrorCode::InvalidStructure, e.what(), path};
+  } catch (const Exiv2Error& e) {
+    return {ErrorCode::Exiv2, e.what(), path};
+  } catch (const FileAccessError& e) {
+    return {ErrorCode::FileAccess, e.what(), path};
+  } catch (const std::exception& e) {
+    return {ErrorCode::Unknown, e.what(), path};
+  } catch (...) {
+    // Anything else would escape the worker thread and terminate the process
+    return {ErrorCode::Unknown, "Unknown error", path};
+  }
+}
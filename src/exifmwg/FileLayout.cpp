@@ -0,0 +1,274 @@
+#include <array>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "FileLayout.hpp"
+#include "Logging.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::uint16_t TIFF_MAGIC = 42;
+constexpr std::uint16_t ORIENTATION_TAG = 0x0112;
+constexpr std::uint16_t XML_PACKET_TAG = 0x02BC;
+constexpr std::uint16_t TIFF_TYPE_BYTE = 1;
+constexpr std::uint16_t TIFF_TYPE_SHORT = 3;
+constexpr std::uint16_t TIFF_TYPE_UNDEFINED = 7;
+// Values of up to 4 bytes are stored inline in the entry instead of at an offset
+constexpr std::uint32_t IFD_INLINE_SIZE = 4;
+constexpr std::uintmax_t TIFF_HEADER_SIZE = 8;
+constexpr std::uintmax_t IFD_ENTRY_SIZE = 12;
+// Offset of the value field inside an IFD entry: tag (2), type (2), count (4)
+constexpr std::uintmax_t IFD_VALUE_OFFSET = 8;
+
+constexpr unsigned char JPEG_MARKER = 0xFF;
+constexpr unsigned char JPEG_SOI = 0xD8;
+constexpr unsigned char JPEG_SOS = 0xDA;
+constexpr unsigned char JPEG_EOI = 0xD9;
+constexpr unsigned char JPEG_APP1 = 0xE1;
+constexpr unsigned char JPEG_TEM = 0x01;
+constexpr unsigned char JPEG_RST0 = 0xD0;
+constexpr unsigned char JPEG_RST7 = 0xD7;
+constexpr std::array<char, 6> EXIF_HEADER = {'E', 'x', 'i', 'f', '\0', '\0'};
+constexpr std::string_view XMP_HEADER{"http://ns.adobe.com/xap/1.0/\0", 29};
+constexpr std::string_view XPACKET_START = "<?xpacket";
+
+bool readBytes(std::ifstream& file, std::uintmax_t offset, char* buffer, std::size_t count) {
+  file.seekg(static_cast<std::streamoff>(offset));
+  file.read(buffer, static_cast<std::streamsize>(count));
+  return file.good();
+}
+
+std::uint16_t toUInt16(const char* bytes, bool bigEndian) {
+  const auto b0 = static_cast<std::uint16_t>(static_cast<unsigned char>(bytes[0]));
+  const auto b1 = static_cast<std::uint16_t>(static_cast<unsigned char>(bytes[1]));
+  return bigEndian ? static_cast<std::uint16_t>((b0 << 8U) | b1) : static_cast<std::uint16_t>((b1 << 8U) | b0);
+}
+
+std::uint32_t toUInt32(const char* bytes, bool bigEndian) {
+  std::uint32_t value = 0;
+  for (std::size_t i = 0; i < 4; ++i) {
+    const auto byte = static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[bigEndian ? i : 3 - i]));
+    value = (value << 8U) | byte;
+  }
+  return value;
+}
+
+/**
+ * @brief Walks IFD0 of a TIFF structure starting at tiffBase, which must end before limit.
+ */
+void scanTiff(std::ifstream& file, std::uintmax_t tiffBase, std::uintmax_t limit, FileLayout& layout) {
+  std::array<char, TIFF_HEADER_SIZE> header{};
+  if (tiffBase + TIFF_HEADER_SIZE > limit || !readBytes(file, tiffBase, header.data(), header.size())) {
+    return;
+  }
+
+  bool bigEndian = false;
+  if (header[0] == 'M' && header[1] == 'M') {
+    bigEndian = true;
+  } else if (header[0] != 'I' || header[1] != 'I') {
+    return;
+  }
+  if (toUInt16(&header[2], bigEndian) != TIFF_MAGIC) {
+    return;
+  }
+
+  const std::uintmax_t ifdOffset = tiffBase + toUInt32(&header[4], bigEndian);
+  std::array<char, 2> countBytes{};
+  if (ifdOffset + countBytes.size() > limit || !readBytes(file, ifdOffset, countBytes.data(), countBytes.size())) {
+    return;
+  }
+  const std::uint16_t entryCount = toUInt16(countBytes.data(), bigEndian);
+
+  for (std::uint16_t i = 0; i < entryCount; ++i) {
+    const std::uintmax_t entryOffset = ifdOffset + countBytes.size() + (i * IFD_ENTRY_SIZE);
+    std::array<char, IFD_ENTRY_SIZE> entry{};
+    if (entryOffset + IFD_ENTRY_SIZE > limit || !readBytes(file, entryOffset, entry.data(), entry.size())) {
+      return;
+    }
+    const std::uint16_t tag = toUInt16(&entry[0], bigEndian);
+    const std::uint16_t type = toUInt16(&entry[2], bigEndian);
+    const std::uint32_t count = toUInt32(&entry[4], bigEndian);
+
+    // Only a single inline SHORT can be safely overwritten in place
+    if (tag == ORIENTATION_TAG && type == TIFF_TYPE_SHORT && count == 1) {
+      layout.OrientationOffset = entryOffset + IFD_VALUE_OFFSET;
+      layout.BigEndian = bigEndian;
+    } else if (tag == XML_PACKET_TAG && (type == TIFF_TYPE_BYTE || type == TIFF_TYPE_UNDEFINED) &&
+               count > IFD_INLINE_SIZE) {
+      const std::uintmax_t packetOffset = tiffBase + toUInt32(&entry[IFD_VALUE_OFFSET], bigEndian);
+      if (packetOffset + count <= limit) {
+        layout.XmpPacketOffset = packetOffset;
+        layout.XmpPacketLength = count;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Walks the JPEG marker segments up to the start of scan, looking for the Exif and XMP APP1 segments.
+ */
+void scanJpeg(std::ifstream& file, std::uintmax_t fileSize, FileLayout& layout) {
+  std::uintmax_t offset = 2;
+  while (offset + 4 <= fileSize) {
+    std::array<char, 4> marker{};
+    if (!readBytes(file, offset, marker.data(), marker.size())) {
+      return;
+    }
+    if (static_cast<unsigned char>(marker[0]) != JPEG_MARKER) {
+      return;
+    }
+    const auto type = static_cast<unsigned char>(marker[1]);
+    if (type == JPEG_MARKER) {
+      // Fill byte
+      offset += 1;
+      continue;
+    }
+    if (type == JPEG_SOS || type == JPEG_EOI) {
+      return;
+    }
+    if (type == JPEG_TEM || (type >= JPEG_RST0 && type <= JPEG_RST7)) {
+      // Standalone markers carry no length
+      offset += 2;
+      continue;
+    }
+
+    const std::uintmax_t segmentLength = toUInt16(&marker[2], true);
+    const std::uintmax_t dataStart = offset + 4;
+    const std::uintmax_t segmentEnd = offset + 2 + segmentLength;
+    if (segmentLength < 2 || segmentEnd > fileSize) {
+      return;
+    }
+
+    if (type == JPEG_APP1 && segmentLength >= 2 + EXIF_HEADER.size()) {
+      std::array<char, EXIF_HEADER.size()> exifHeader{};
+      if (readBytes(file, dataStart, exifHeader.data(), exifHeader.size()) && exifHeader == EXIF_HEADER) {
+        scanTiff(file, dataStart + EXIF_HEADER.size(), segmentEnd, layout);
+      }
+    }
+    if (type == JPEG_APP1 && segmentLength > 2 + XMP_HEADER.size() && !layout.XmpPacketOffset.has_value()) {
+      std::array<char, XMP_HEADER.size()> xmpHeader{};
+      if (readBytes(file, dataStart, xmpHeader.data(), xmpHeader.size()) &&
+          std::string_view(xmpHeader.data(), xmpHeader.size()) == XMP_HEADER) {
+        layout.XmpPacketOffset = dataStart + XMP_HEADER.size();
+        layout.XmpPacketLength = segmentEnd - layout.XmpPacketOffset.value();
+      }
+    }
+    offset = segmentEnd;
+  }
+}
+
+} // namespace
+
+/**
+ * @brief Locates the patchable metadata values of a JPEG or TIFF file.
+ *
+ * This reads only the file headers, IFD0 and segment headers, never the image data. Any structure which
+ * cannot be parsed simply leaves the corresponding offset unset.
+ *
+ * @param path The image file to scan.
+ * @return The located offsets.
+ */
+FileLayout FileLayout::scan(const fs::path& path) {
+  FileLayout layout;
+
+  std::error_code ec;
+  const std::uintmax_t fileSize = fs::file_size(path, ec);
+  if (ec) {
+    return layout;
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  std::array<char, 2> magic{};
+  if (!file || !readBytes(file, 0, magic.data(), magic.size())) {
+    return layout;
+  }
+
+  if (static_cast<unsigned char>(magic[0]) == JPEG_MARKER && static_cast<unsigned char>(magic[1]) == JPEG_SOI) {
+    scanJpeg(file, fileSize, layout);
+  } else if ((magic[0] == 'I' && magic[1] == 'I') || (magic[0] == 'M' && magic[1] == 'M')) {
+    scanTiff(file, 0, fileSize, layout);
+  }
+
+  return layout;
+}
+
+/**
+ * @brief Overwrites the 2 byte orientation value in place.
+ *
+ * The value currently on disk is checked against the expected orientation first, so a file
+ * changed since it was scanned is never patched.
+ *
+ * @param path The image file, which must be the one this layout was scanned from.
+ * @param expected The orientation believed to be stored in the file.
+ * @param updated The orientation to store.
+ * @return true if the value was patched, false if the caller must fall back to a full rewrite.
+ */
+bool FileLayout::patchOrientation(const fs::path& path, ExifOrientation expected, ExifOrientation updated) const {
+  if (!this->OrientationOffset.has_value()) {
+    return false;
+  }
+
+  std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+  if (!file) {
+    return false;
+  }
+
+  const auto offset = static_cast<std::streamoff>(this->OrientationOffset.value());
+  std::array<char, 2> current{};
+  file.seekg(offset);
+  file.read(current.data(), current.size());
+  if (!file.good() || toUInt16(current.data(), this->BigEndian) != orientation_to_exif_value(expected)) {
+    InternalLogger::debug("Orientation on disk changed since scan of " + path.string());
+    return false;
+  }
+
+  const auto value = static_cast<std::uint16_t>(orientation_to_exif_value(updated));
+  std::array<char, 2> bytes{};
+  const auto high = static_cast<char>((value >> 8U) & 0xFFU);
+  const auto low = static_cast<char>(value & 0xFFU);
+  bytes[0] = this->BigEndian ? high : low;
+  bytes[1] = this->BigEndian ? low : high;
+
+  file.seekp(offset);
+  file.write(bytes.data(), bytes.size());
+  file.flush();
+  return file.good();
+}
+
+/**
+ * @brief Overwrites the XMP packet in place with one of exactly the same length.
+ *
+ * The region on disk must still start with a packet wrapper, anything else means the file
+ * changed since it was scanned, or the packet was stored without the wrapper and its padding.
+ *
+ * @param path The image file, which must be the one this layout was scanned from.
+ * @param packet The serialized packet, including its wrapper and padding.
+ * @return true if the packet was replaced, false if the caller must fall back to a full rewrite.
+ */
+bool FileLayout::patchXmpPacket(const fs::path& path, const std::string& packet) const {
+  if (!this->XmpPacketOffset.has_value() || packet.size() != this->XmpPacketLength) {
+    return false;
+  }
+
+  std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+  if (!file) {
+    return false;
+  }
+
+  const auto offset = static_cast<std::streamoff>(this->XmpPacketOffset.value());
+  std::array<char, XPACKET_START.size()> current{};
+  file.seekg(offset);
+  file.read(current.data(), current.size());
+  if (!file.good() || std::string_view(current.data(), current.size()) != XPACKET_START) {
+    InternalLogger::debug("No XMP packet wrapper at the scanned offset of " + path.string());
+    return false;
+  }
+
+  file.seekp(offset);
+  file.write(packet.data(), static_cast<std::streamsize>(packet.size()));
+  file.flush();
+  return file.good();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "Orientation.hpp"
+
+/**
+ * @brief Byte offsets of metadata values which can be patched without rewriting the file.
+ *
+ * Only JPEG (Exif APP1) and classic TIFF containers are scanned, any other format produces
+ * an empty layout and callers fall back to a full Exiv2 rewrite.
+ */
+class FileLayout {
+public:
+  // Absolute offset of the Exif.Image.Orientation value, when it is a single SHORT stored inline in IFD0
+  std::optional<std::uintmax_t> OrientationOffset;
+  // Byte order of the TIFF structure holding the Exif data
+  bool BigEndian = false;
+  // Absolute offset and length of the XMP packet, from the JPEG APP1 segment or the TIFF XMLPacket tag
+  std::optional<std::uintmax_t> XmpPacketOffset;
+  std::uintmax_t XmpPacketLength = 0;
+
+  static FileLayout scan(const std::filesystem::path& path);
+
+  bool patchOrientation(const std::filesystem::path& path, ExifOrientation expected, ExifOrientation updated) const;
+  bool patchXmpPacket(const std::filesystem::path& path, const std::string& packet) const;
+};
@@ -0,0 +1,311 @@
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "Errors.hpp"
+#include "FileUtils.hpp"
+#include "Logging.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string lastError() {
+  return std::strerror(errno);
+}
+
+#ifdef _WIN32
+void syncDescriptor(const fs::path& path, DurabilityLevel /*level*/) {
+  // _commit flushes both data and metadata, there is no data-only variant
+  int fd = _wopen(path.c_str(), _O_RDWR | _O_BINARY);
+  if (fd < 0) {
+    throw FileAccessError("Unable to open " + path.string() + " for syncing: " + lastError());
+  }
+  const int result = _commit(fd);
+  _close(fd);
+  if (result != 0) {
+    throw FileAccessError("Unable to sync " + path.string() + ": " + lastError());
+  }
+}
+#else
+void syncDescriptor(const fs::path& path, DurabilityLevel level) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw FileAccessError("Unable to open " + path.string() + " for syncing: " + lastError());
+  }
+#if defined(__APPLE__)
+  // No fdatasync on macOS
+  static_cast<void>(level);
+  const int result = ::fsync(fd);
+#else
+  const int result = (level == DurabilityLevel::FileData) ? ::fdatasync(fd) : ::fsync(fd);
+#endif
+  ::close(fd);
+  if (result != 0) {
+    throw FileAccessError("Unable to sync " + path.string() + ": " + lastError());
+  }
+}
+#endif
+
+#ifdef __linux__
+/**
+ * @brief Copies through the kernel, without the data passing through userspace.
+ *
+ * @return The method used, or nothing if neither is supported here and the caller should fall back.
+ */
+std::optional<FileUtils::CopyMethod> kernelCopy(const fs::path& source, const fs::path& target, bool overwrite) {
+  int in = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+  if (in < 0) {
+    throw FileAccessError("Unable to open " + source.string() + " for copying: " + lastError());
+  }
+  struct stat sourceStat {};
+  if (::fstat(in, &sourceStat) != 0) {
+    ::close(in);
+    throw FileAccessError("Unable to stat " + source.string() + ": " + lastError());
+  }
+  const int createFlags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | (overwrite ? 0 : O_EXCL);
+  int out = ::open(target.c_str(), createFlags, sourceStat.st_mode & 07777);
+  if (out < 0) {
+    const std::string error = lastError();
+    ::close(in);
+    throw FileAccessError("Unable to create " + target.string() + ": " + error);
+  }
+
+  std::optional<FileUtils::CopyMethod> method;
+  if (::ioctl(out, FICLONE, in) == 0) {
+    method = FileUtils::CopyMethod::Reflink;
+  } else {
+    auto remaining = static_cast<std::size_t>(sourceStat.st_size);
+    bool copied = true;
+    while (remaining > 0) {
+      const ssize_t written = ::copy_file_range(in, nullptr, out, nullptr, remaining, 0);
+      if (written <= 0) {
+        // Unsupported here (EXDEV, ENOSYS, EOPNOTSUPP, ...), or the source shrank, the fallback copies it all again
+        copied = false;
+        break;
+      }
+      remaining -= static_cast<std::size_t>(written);
+    }
+    if (copied) {
+      method = FileUtils::CopyMethod::CopyFileRange;
+    }
+  }
+  if (method.has_value()) {
+    // The umask applied on creation, and an overwritten target kept its own mode
+    static_cast<void>(::fchmod(out, sourceStat.st_mode & 07777));
+  }
+  ::close(in);
+  ::close(out);
+  return method;
+}
+#endif
+
+} // namespace
+
+namespace FileUtils {
+
+std::string copyMethodName(CopyMethod method) {
+  switch (method) {
+  case CopyMethod::Reflink:
+    return "reflink";
+  case CopyMethod::CopyFileRange:
+    return "copy_file_range";
+  case CopyMethod::Fallback:
+    return "copy_file";
+  }
+  return "unknown";
+}
+
+const std::set<std::string>& imageExtensions() {
+  static const std::set<std::string> extensions = {
+      ".jpg", ".jpeg", ".jpe", ".tif", ".tiff", ".png", ".webp", ".heic", ".heif", ".avif", ".jxl", ".jp2",
+      ".psd", ".dng", ".cr2", ".cr3", ".crw", ".nef", ".arw", ".orf", ".rw2", ".raf", ".pef", ".srw", ".mrw"};
+  return extensions;
+}
+
+std::string lookupKey(const fs::path& path) {
+  std::error_code ec;
+  const fs::path absolute = fs::absolute(path, ec);
+  return (ec ? path : absolute).lexically_normal().string();
+}
+
+/**
+ * @brief Identifies a regular file with a single stat call.
+ *
+ * The modification time keeps nanoseconds where the platform records them, so two writes within
+ * the same second still differ on most filesystems.
+ *
+ * @param path The file to identify.
+ * @return The identity, or nothing if the file does not exist or is not a regular file.
+ */
+std::optional<FileIdentity> identify(const fs::path& path) {
+  FileIdentity identity;
+#ifdef _WIN32
+  struct _stat64 info {};
+  if (::_wstat64(path.c_str(), &info) != 0 || (info.st_mode & _S_IFMT) != _S_IFREG) {
+    return std::nullopt;
+  }
+  identity.ModifiedNs = static_cast<std::int64_t>(info.st_mtime) * 1000000000;
+#else
+  struct stat info {};
+  if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+    return std::nullopt;
+  }
+  identity.Inode = static_cast<std::uint64_t>(info.st_ino);
+#if defined(__APPLE__)
+  identity.ModifiedNs = static_cast<std::int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+  identity.ModifiedNs = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+#endif
+  identity.Device = static_cast<std::uint64_t>(info.st_dev);
+  identity.Size = static_cast<std::uint64_t>(info.st_size);
+  return identity;
+}
+
+bool sameFile(const fs::path& first, const fs::path& second) {
+  std::error_code ec;
+  // Compares the device and inode, false when either does not exist
+  return fs::equivalent(first, second, ec) && !ec;
+}
+
+/**
+ * @brief Copies a file, preferring a reflink clone, then an in-kernel copy, then std::filesystem.
+ *
+ * On Linux, FICLONE makes the copy share the extents of the source on filesystems which
+ * support it (XFS, btrfs), and copy_file_range avoids copying through userspace elsewhere.
+ * Other platforms always use std::filesystem::copy_file.
+ *
+ * @param source The file to copy.
+ * @param target The new file.
+ * @param overwrite Whether an existing target is replaced, otherwise it is an error.
+ * @return The mechanism which copied the data.
+ * @throws FileAccessError if the copy fails, or the target is the source itself
+ */
+CopyMethod copyFile(const fs::path& source, const fs::path& target, bool overwrite) {
+  // Opening the target truncates it, which would empty the source before anything is copied
+  if (sameFile(source, target)) {
+    throw FileAccessError("Unable to copy " + source.string() + " onto itself as " + target.string());
+  }
+  CopyMethod method = CopyMethod::Fallback;
+#ifdef __linux__
+  if (auto kernelMethod = kernelCopy(source, target, overwrite)) {
+    method = kernelMethod.value();
+  } else {
+    // The target now exists, created by the attempt
+    overwrite = true;
+  }
+#endif
+  if (method == CopyMethod::Fallback) {
+    try {
+      fs::copy_file(source, target, overwrite ? fs::copy_options::overwrite_existing : fs::copy_options::none);
+    } catch (const fs::filesystem_error& e) {
+      throw FileAccessError("Failed to copy " + source.string() + ": " + std::string(e.what()));
+    }
+  }
+  InternalLogger::debug("Copied " + source.string() + " to " + target.string() + " using " + copyMethodName(method));
+  return method;
+}
+
+/**
+ * @brief Picks an unused hidden file name in the same directory as the target.
+ *
+ * @param target The file which will be replaced.
+ * @return A path which did not exist when checked.
+ */
+fs::path temporaryPathFor(const fs::path& target) {
+  std::random_device device;
+  const fs::path directory = target.parent_path();
+  fs::path candidate;
+  do {
+    std::ostringstream name;
+    name << "." << target.filename().string() << ".exifmwg-" << std::hex << device() << device() << ".tmp";
+    candidate = directory / name.str();
+  } while (fs::exists(candidate));
+  return candidate;
+}
+
+/**
+ * @brief Flushes the contents of a file to storage.
+ *
+ * FileData only flushes the data and what is needed to read it back (fdatasync), the other
+ * levels flush the file metadata as well (fsync).
+ *
+ * @param path The file to flush.
+ * @param level How much to flush.
+ * @throws FileAccessError if the file cannot be opened or flushed
+ */
+void syncFile(const fs::path& path, DurabilityLevel level) {
+  if (level == DurabilityLevel::Deferred) {
+    return;
+  }
+  syncDescriptor(path, level);
+}
+
+/**
+ * @brief Flushes the entries of a directory to storage, making a rename within it durable.
+ *
+ * @param directory The directory to flush.
+ * @throws FileAccessError if the directory cannot be opened or flushed
+ */
+void syncDirectory(const fs::path& directory) {
+#ifdef _WIN32
+  // NTFS journals the rename itself, and directories cannot be opened through the CRT
+  static_cast<void>(directory);
+#else
+  const fs::path target = directory.empty() ? fs::path(".") : directory;
+  int fd = ::open(target.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    throw FileAccessError("Unable to open directory " + target.string() + " for syncing: " + lastError());
+  }
+  const int result = ::fsync(fd);
+  ::close(fd);
+  if (result != 0) {
+    throw FileAccessError("Unable to sync directory " + target.string() + ": " + lastError());
+  }
+#endif
+}
+
+/**
+ * @brief Atomically replaces the target with the source.
+ *
+ * The source should already be synced as required, the rename is only durable once the
+ * directory is synced, which FileAndDirectory does.
+ *
+ * @param source The finished file, in the same directory as the target.
+ * @param target The file to replace.
+ * @param level The durability level of the write.
+ * @throws FileAccessError if the rename or the directory sync fails
+ */
+void replaceFile(const fs::path& source, const fs::path& target, DurabilityLevel level) {
+  try {
+    fs::rename(source, target);
+  } catch (const fs::filesystem_error& e) {
+    throw FileAccessError("Failed to replace " + target.string() + ": " + std::string(e.what()));
+  }
+  if (level == DurabilityLevel::FileAndDirectory) {
+    syncDirectory(target.parent_path());
+  }
+  InternalLogger::debug("Replaced " + target.string());
+}
+
+} // namespace FileUtils
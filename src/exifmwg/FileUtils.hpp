@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <string>
+
+#include "WriteOptions.hpp"
+
+namespace FileUtils {
+
+// How copyFile copied the data, cheapest first
+enum class CopyMethod {
+  // The target shares the extents of the source (FICLONE), no data is copied
+  Reflink,
+  // The kernel copied the data (copy_file_range), possibly server-side or with shared extents
+  CopyFileRange,
+  // std::filesystem::copy_file
+  Fallback,
+};
+
+std::string copyMethodName(CopyMethod method);
+
+// A regular file as one stat saw it. Any write, rename over it or replacement changes at least one field.
+struct FileIdentity {
+  std::uint64_t Device = 0;
+  // Always 0 on Windows
+  std::uint64_t Inode = 0;
+  std::uint64_t Size = 0;
+  std::int64_t ModifiedNs = 0;
+
+  bool operator==(const FileIdentity&) const = default;
+};
+
+// Lowercase extensions, with the dot, of the formats Exiv2 can read metadata from
+const std::set<std::string>& imageExtensions();
+
+// The absolute, lexically normalized form of a path, so different spellings of a file compare equal
+std::string lookupKey(const std::filesystem::path& path);
+
+// Stats a file once. Nothing if it does not exist or is not a regular file.
+std::optional<FileIdentity> identify(const std::filesystem::path& path);
+
+// Whether both paths name the same existing file, through another spelling, a hardlink or a symlink
+bool sameFile(const std::filesystem::path& first, const std::filesystem::path& second);
+
+// Copies a file with the cheapest mechanism the platform and filesystem support, preserving its permissions
+CopyMethod copyFile(const std::filesystem::path& source, const std::filesystem::path& target, bool overwrite);
+
+// An unused path next to the target, so renaming it over the target stays on one filesystem
+std::filesystem::path temporaryPathFor(const std::filesystem::path& target);
+
+// Flushes a file to storage as far as the level requires. Deferred does nothing.
+void syncFile(const std::filesystem::path& path, DurabilityLevel level);
+
+// Flushes a directory entry change, such as a rename, to storage. A no-op on Windows.
+void syncDirectory(const std::filesystem::path& directory);
+
+// Renames source over target, then syncs the directory if the level requires it
+void replaceFile(const std::filesystem::path& source, const std::filesystem::path& target, DurabilityLevel level);
+
+} // namespace FileUtils
@@ -1,13 +1,79 @@
+#include <algorithm>
+#include <cctype>
 #include <utility>
 
+#include "BinaryCodec.hpp"
 #include "Errors.hpp"
+#include "FileUtils.hpp"
 #include "ImageMetadata.hpp"
+#include "JsonCodec.hpp"
 #include "Logging.hpp"
+#include "MetadataCache.hpp"
 #include "MetadataKeys.hpp"
+#include "MetadataSession.hpp"
 #include "XmpUtils.hpp"
 
 namespace fs = std::filesystem;
 
+namespace {
+
+// Datasets may repeat, so every matching one is removed
+void eraseIptcKey(Exiv2::IptcData& iptcData, const char* key) {
+  const Exiv2::IptcKey iptcKey(key);
+  for (auto it = iptcData.findKey(iptcKey); it != iptcData.end(); it = iptcData.findKey(iptcKey)) {
+    iptcData.erase(it);
+  }
+}
+
+void eraseExifKey(Exiv2::ExifData& exifData, const char* key) {
+  auto it = exifData.findKey(Exiv2::ExifKey(key));
+  if (it != exifData.end()) {
+    exifData.erase(it);
+  }
+}
+
+std::string lowercase(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return value;
+}
+
+std::string uppercase(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+  return value;
+}
+
+// The sidecar named after the whole file name, IMG_0001.CR2.xmp, which no other image can share
+fs::path fullNameSidecar(const fs::path& imagePath) {
+  fs::path sidecar = imagePath;
+  sidecar += ".xmp";
+  return sidecar;
+}
+
+// Whether another image in the same directory differs only in its extension, so it would have the same
+// IMG_0001.xmp sidecar. Only the extensions Exiv2 reads, in lower or upper case, are checked.
+bool sharesStem(const fs::path& imagePath) {
+  const std::string ownExtension = lowercase(imagePath.extension().string());
+  for (const auto& extension : FileUtils::imageExtensions()) {
+    // Also skips the other case of the own extension, the same file on a case-insensitive filesystem
+    if (extension == ownExtension) {
+      continue;
+    }
+    for (const auto& spelling : {extension, uppercase(extension)}) {
+      fs::path sibling = imagePath;
+      sibling.replace_extension(spelling);
+      std::error_code ec;
+      if (fs::is_regular_file(sibling, ec)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace
+
 /**
  * @brief Constructs an ImageMetadata object with various optional metadata fields.
  *
@@ -40,35 +106,157 @@ ImageMetadata::ImageMetadata(int imageHeight, int imageWidth, std::optional<std:
     Country(std::move(country)), City(std::move(city)), State(std::move(state)), Location(std::move(location)) {
 }
 
-ImageMetadata::ImageMetadata(const fs::path& path) {
-  this->m_originalPath = path;
-  if (!fs::exists(path) || !fs::is_regular_file(path)) {
-    throw FileAccessError("File does not exist: " + path.string());
+/**
+ * @brief Reads the metadata of an image, and its XMP sidecar depending on the policy.
+ *
+ * @param path The image file.
+ * @param options Controls whether and how an XMP sidecar is combined with the embedded metadata.
+ * @throws FileAccessError if the image does not exist
+ * @throws Exiv2Error if Exiv2 fails to read the image or the sidecar
+ * @throws InvalidStructureError if a region structure is malformed
+ */
+ImageMetadata::ImageMetadata(const fs::path& path, const ReadOptions& options) :
+    ImageMetadata(tryRead(path, options).value()) {
+}
+
+/**
+ * @brief Reads the metadata of an image, returning any failure as an error value.
+ *
+ * A missing file or malformed metadata structure is reported without throwing. Errors raised
+ * by Exiv2 itself while opening the file are caught and converted. When the shared
+ * MetadataCache is enabled, a file unchanged since it was last read is not parsed again.
+ *
+ * @param path The image file.
+ * @param options Controls whether and how an XMP sidecar is combined with the embedded metadata.
+ * @return The metadata, or the error the constructor would throw, with its path set.
+ */
+Result<ImageMetadata> ImageMetadata::tryRead(const fs::path& path, const ReadOptions& options) {
+  auto& cache = MetadataCache::shared();
+  if (!cache.enabled()) {
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) {
+      return ErrorInfo{ErrorCode::FileAccess, "File does not exist: " + path.string(), path};
+    }
+    return readFile(path, options);
   }
-  try {
-    auto image = Exiv2::ImageFactory::open(path.string());
-    image->readMetadata();
 
-    auto& exifData = image->exifData();
-    auto& xmpData = image->xmpData();
-    auto& iptcData = image->iptcData();
+  const std::uint64_t generation = cache.generation();
+  const auto identity = FileUtils::identify(path);
+  if (!identity.has_value()) {
+    return ErrorInfo{ErrorCode::FileAccess, "File does not exist: " + path.string(), path};
+  }
+  MetadataCache::Stamp stamp{identity.value(), std::nullopt, options.Sidecar, options.Lenient};
+  if (options.Sidecar != SidecarPolicy::Ignore) {
+    stamp.Sidecar = FileUtils::identify(sidecarPath(path));
+  }
+  if (auto cached = cache.lookup(path, stamp)) {
+    cached->rebase(path);
+    return std::move(cached).value();
+  }
 
-    this->ImageHeight = image->pixelHeight();
-    this->ImageWidth = image->pixelWidth();
+  auto metadata = readFile(path, options);
+  if (metadata) {
+    cache.store(path, stamp, generation, metadata.value());
+  }
+  return metadata;
+}
 
-    // Read all metadata using private methods
-    readOrientation(exifData);
-    readTitleAndDescription(xmpData, iptcData);
-    readLocationData(xmpData, iptcData);
-    readRegionInfo(xmpData);
-    readKeywordInfo(xmpData);
+/**
+ * @brief Points a cached copy at the path it is returned for.
+ *
+ * Entries are shared by every spelling of a file, but toFile() and the diagnostics use the path
+ * as the caller spelled it, relative to the working directory at the time.
+ *
+ * @param path The path the copy is returned for.
+ */
+void ImageMetadata::rebase(const fs::path& path) {
+  if (this->m_originalPath.has_value()) {
+    const fs::path previousSidecar = sidecarPath(this->m_originalPath.value());
+    for (auto& diagnostic : this->Diagnostics) {
+      if (diagnostic.Path == this->m_originalPath.value()) {
+        diagnostic.Path = path;
+      } else if (diagnostic.Path == previousSidecar) {
+        diagnostic.Path = sidecarPath(path);
+      }
+    }
+  }
+  this->m_originalPath = path;
+}
 
-  } catch (const Exiv2::Error& e) {
-    throw Exiv2Error("Exiv2 error while reading: " + std::string(e.what()));
+Result<ImageMetadata> ImageMetadata::readFile(const fs::path& path, const ReadOptions& options) {
+  try {
+    auto metadata = MetadataSession(path).tryRead(options.Lenient);
+    if (metadata && options.Sidecar != SidecarPolicy::Ignore) {
+      if (auto error = metadata.value().applySidecar(sidecarPath(path), options.Sidecar, options.Lenient)) {
+        return *error;
+      }
+    }
+    return metadata;
+  } catch (...) {
+    return currentErrorInfo(path);
   }
 }
 
-void ImageMetadata::toFile(const std::optional<fs::path>& newPath) {
+/**
+ * @brief The XMP sidecar read for an image.
+ *
+ * Sidecars are usually named after the image with its extension replaced, IMG_0001.xmp for
+ * IMG_0001.CR2. A RAW and JPEG pair would share that name, so a sidecar named after the whole
+ * file name, IMG_0001.CR2.xmp, is preferred when it exists.
+ *
+ * @param imagePath The image.
+ * @return IMG_0001.CR2.xmp if it exists, otherwise IMG_0001.xmp, whether or not that exists.
+ */
+fs::path ImageMetadata::sidecarPath(const fs::path& imagePath) {
+  fs::path sidecar = fullNameSidecar(imagePath);
+  std::error_code ec;
+  if (fs::exists(sidecar, ec)) {
+    return sidecar;
+  }
+  sidecar = imagePath;
+  sidecar.replace_extension(".xmp");
+  return sidecar;
+}
+
+/**
+ * @brief The XMP sidecar a write for an image goes to.
+ *
+ * Like sidecarPath(), except that another image in the same directory with the same stem makes
+ * the write use the full file name form, so it cannot overwrite the metadata of that image.
+ */
+fs::path ImageMetadata::sidecarTarget(const fs::path& imagePath) {
+  fs::path sidecar = sidecarPath(imagePath);
+  if (sidecar != fullNameSidecar(imagePath) && sharesStem(imagePath)) {
+    return fullNameSidecar(imagePath);
+  }
+  return sidecar;
+}
+
+ImageMetadata ImageMetadata::fromBytes(std::string_view bytes) {
+  return BinaryCodec::decode<ImageMetadata>(bytes);
+}
+
+std::string ImageMetadata::toBytes() const {
+  return BinaryCodec::encode(*this);
+}
+
+ImageMetadata ImageMetadata::fromJson(std::string_view json) {
+  return JsonCodec::decode<ImageMetadata>(json);
+}
+
+std::string ImageMetadata::toJson() const {
+  return JsonCodec::encode(*this);
+}
+
+std::vector<ImageMetadata> ImageMetadata::fromJsonArray(std::string_view json) {
+  return JsonCodec::decode<std::vector<ImageMetadata>>(json);
+}
+
+std::string ImageMetadata::toJsonArray(const std::vector<ImageMetadata>& metadata) {
+  return JsonCodec::encode(metadata);
+}
+
+void ImageMetadata::toFile(const std::optional<fs::path>& newPath, const WriteOptions& options) const {
   fs::path targetPath;
   if (newPath.has_value()) {
     targetPath = newPath.value();
@@ -78,35 +266,118 @@ void ImageMetadata::toFile(const std::optional<fs::path>& newPath) {
     throw FileAccessError("Unable to determine the target path");
   }
 
-  if (this->m_originalPath.has_value() && (this->m_originalPath.value() != targetPath)) {
-    try {
-      fs::copy_file(this->m_originalPath.value(), targetPath, fs::copy_options::overwrite_existing);
-    } catch (const fs::filesystem_error& e) {
-      throw FileAccessError("Failed to copy file to new path: " + std::string(e.what()));
-    }
+  // Another spelling of the original, or a link to it, is written in place
+  const bool copying = this->m_originalPath.has_value() && (this->m_originalPath.value() != targetPath) &&
+                       !FileUtils::sameFile(this->m_originalPath.value(), targetPath);
+  if (copying && options.Atomic && !options.Sidecar) {
+    this->toNewFileAtomically(targetPath, options);
+    return;
   }
 
-  try {
-    auto image = Exiv2::ImageFactory::open(targetPath.string());
-    image->readMetadata();
+  if (copying) {
+    FileUtils::copyFile(this->m_originalPath.value(), targetPath, true);
+  }
 
-    auto& xmpData = image->xmpData();
-    auto& exifData = image->exifData();
-    auto& iptcData = image->iptcData();
+  if (options.Sidecar) {
+    this->toSidecar(sidecarTarget(targetPath), options);
+    // A read through the cache may have stamped the previous sidecar within the same timestamp tick
+    MetadataCache::shared().invalidate(targetPath);
+    return;
+  }
 
-    // Write all metadata using private methods
-    writeTitleAndDescription(xmpData, iptcData);
-    writeOrientation(exifData);
-    writeLocationData(xmpData, iptcData);
-    writeRegionInfo(xmpData);
-    writeKeywordInfo(xmpData);
+  MetadataSession session(targetPath);
+  session.stage(*this);
+  session.commit(options);
+}
 
-    image->writeMetadata();
-  } catch (const Exiv2::Error& e) {
-    throw Exiv2Error("Exiv2 error while writing: " + std::string(e.what()));
+/**
+ * @brief Rotates or flips the image as displayed, without touching the pixels.
+ *
+ * The new orientation is the current one followed by operation, so rotating by Rotate90CW twice
+ * turns the image upside down. A missing orientation is treated as Horizontal. The image
+ * dimensions describe the stored pixels and are kept.
+ *
+ * @param operation The rotation or flip to apply to the displayed image.
+ * @param regions Which image the regions are relative to. Regions on the stored image stay valid as
+ *                they are. Regions on the displayed image are transformed by operation, with the
+ *                applied dimensions swapped by a quarter turn.
+ */
+void ImageMetadata::rotate(ExifOrientation operation, RegionSpace regions) {
+  this->Orientation = orientation_compose(this->Orientation.value_or(ExifOrientation::Horizontal), operation);
+  if (regions == RegionSpace::Displayed && this->RegionInfo.has_value()) {
+    this->RegionInfo = this->RegionInfo->toDisplay(operation);
   }
 }
 
+/**
+ * @brief Removes every field this library manages from a file, and from this object.
+ *
+ * Other metadata in the file is left alone. The image is rewritten once.
+ *
+ * @param path The file to clear, or the file this metadata was read from when not given.
+ * @param options Atomicity and durability of the rewrite. The image itself is cleared, the sidecar option does not
+ *                apply.
+ * @throws FileAccessError if no path is known, the file does not exist, or the temporary copy, rename or sync fails
+ * @throws Exiv2Error if Exiv2 fails to read or write the file
+ */
+void ImageMetadata::clearFile(const std::optional<fs::path>& path, const WriteOptions& options) {
+  fs::path targetPath;
+  if (path.has_value()) {
+    targetPath = path.value();
+  } else if (this->m_originalPath.has_value()) {
+    targetPath = this->m_originalPath.value();
+  } else {
+    throw FileAccessError("Unable to determine the target path");
+  }
+
+  WriteOptions imageOptions = options;
+  imageOptions.Sidecar = false;
+  MetadataSession session(targetPath);
+  session.clear();
+  session.commit(imageOptions);
+
+  this->Title = std::nullopt;
+  this->Description = std::nullopt;
+  this->RegionInfo = std::nullopt;
+  this->Orientation = std::nullopt;
+  this->KeywordInfo = std::nullopt;
+  this->Country = std::nullopt;
+  this->City = std::nullopt;
+  this->State = std::nullopt;
+  this->Location = std::nullopt;
+  this->Diagnostics.clear();
+}
+
+/**
+ * @brief Copies the original to a temporary file next to the target, writes it, then renames it over the target.
+ *
+ * The target never exists in a partially written state, and the copy is only made once.
+ */
+void ImageMetadata::toNewFileAtomically(const fs::path& targetPath, const WriteOptions& options) const {
+  const fs::path tempPath = FileUtils::temporaryPathFor(targetPath);
+  try {
+    // A copy failing partway has already created the temporary file
+    FileUtils::copyFile(this->m_originalPath.value(), tempPath, false);
+
+    // The temporary copy is private, so it is written in place and synced once below
+    WriteOptions inPlace = options;
+    inPlace.Atomic = false;
+    inPlace.Durability = DurabilityLevel::Deferred;
+    {
+      MetadataSession session(tempPath);
+      session.stage(*this);
+      session.commit(inPlace);
+    }
+    FileUtils::syncFile(tempPath, options.Durability);
+    FileUtils::replaceFile(tempPath, targetPath, options.Durability);
+  } catch (...) {
+    std::error_code ec;
+    fs::remove(tempPath, ec);
+    throw;
+  }
+  MetadataCache::shared().invalidate(targetPath);
+}
+
 std::string ImageMetadata::to_string() const {
   std::ostringstream oss;
 
@@ -144,6 +415,213 @@ std::string ImageMetadata::to_string() const {
   return oss.str();
 }
 
+/**
+ * @brief Populates every field from an opened image whose metadata has already been read.
+ *
+ * @param image The opened Exiv2 image.
+ * @param lenient Whether malformed regions and keywords are skipped and recorded in Diagnostics.
+ * @return The first malformed structure found, if any. Never set for a lenient read.
+ */
+std::optional<ErrorInfo> ImageMetadata::readFromImage(Exiv2::Image& image, bool lenient) {
+  auto& exifData = image.exifData();
+  auto& xmpData = image.xmpData();
+  auto& iptcData = image.iptcData();
+
+  this->ImageHeight = image.pixelHeight();
+  this->ImageWidth = image.pixelWidth();
+
+  // Read all metadata using private methods
+  readOrientation(exifData);
+  readTitleAndDescription(xmpData, iptcData);
+  readLocationData(xmpData, iptcData);
+  auto error = readRegionInfo(xmpData, lenient);
+  readKeywordInfo(xmpData, lenient);
+  return error;
+}
+
+/**
+ * @brief Applies every set field to the in-memory metadata of an opened image.
+ *
+ * Nothing is written to disk, the caller decides when to call writeMetadata().
+ *
+ * @param image The opened Exiv2 image.
+ */
+void ImageMetadata::writeToImage(Exiv2::Image& image) const {
+  auto& xmpData = image.xmpData();
+  auto& exifData = image.exifData();
+  auto& iptcData = image.iptcData();
+
+  // Write all metadata using private methods
+  writeTitleAndDescription(xmpData, iptcData);
+  writeOrientation(exifData);
+  writeLocationData(xmpData, iptcData);
+  writeRegionInfo(xmpData);
+  writeKeywordInfo(xmpData);
+}
+
+/**
+ * @brief Removes every field from the in-memory metadata of an opened image.
+ *
+ * @param image The opened Exiv2 image.
+ */
+void ImageMetadata::clearFromImage(Exiv2::Image& image) {
+  auto& xmpData = image.xmpData();
+  auto& exifData = image.exifData();
+  auto& iptcData = image.iptcData();
+
+  clearTitleAndDescription(xmpData, iptcData, exifData);
+  clearOrientation(exifData, xmpData);
+  clearLocationData(xmpData, iptcData);
+  clearRegionInfo(xmpData);
+  clearKeywordInfo(xmpData, iptcData);
+}
+
+/**
+ * @brief Combines the fields of an XMP sidecar into the metadata read from the image.
+ *
+ * Nothing changes when the sidecar does not exist.
+ *
+ * @param sidecar The sidecar file.
+ * @param policy Merge overlays the fields the sidecar sets, Authoritative replaces every field.
+ * @param lenient Whether malformed entries of the sidecar are skipped and added to Diagnostics.
+ * @return Why the sidecar could not be read, in which case nothing changed.
+ */
+std::optional<ErrorInfo> ImageMetadata::applySidecar(const fs::path& sidecar, SidecarPolicy policy, bool lenient) {
+  if (!fs::exists(sidecar)) {
+    InternalLogger::debug("No sidecar found at " + sidecar.string());
+    return std::nullopt;
+  }
+
+  ImageMetadata fromSidecar;
+  try {
+    auto image = Exiv2::ImageFactory::open(sidecar.string());
+    image->readMetadata();
+    if (auto error = fromSidecar.readFromSidecar(image->xmpData(), lenient)) {
+      error->Path = sidecar;
+      return error;
+    }
+  } catch (const Exiv2::Error& e) {
+    return ErrorInfo{ErrorCode::Exiv2, "Exiv2 error while reading: " + std::string(e.what()), sidecar};
+  }
+
+  auto overlay = [policy](auto& field, const auto& sidecarField) {
+    if (policy == SidecarPolicy::Authoritative || sidecarField.has_value()) {
+      field = sidecarField;
+    }
+  };
+  overlay(this->Title, fromSidecar.Title);
+  overlay(this->Description, fromSidecar.Description);
+  overlay(this->RegionInfo, fromSidecar.RegionInfo);
+  overlay(this->Orientation, fromSidecar.Orientation);
+  overlay(this->Country, fromSidecar.Country);
+  overlay(this->City, fromSidecar.City);
+  overlay(this->State, fromSidecar.State);
+  overlay(this->Location, fromSidecar.Location);
+  // Keywords are always read, possibly empty
+  if (policy == SidecarPolicy::Authoritative || !fromSidecar.KeywordInfo->Hierarchy.empty()) {
+    this->KeywordInfo = fromSidecar.KeywordInfo;
+  }
+  for (auto& diagnostic : fromSidecar.Diagnostics) {
+    diagnostic.Path = sidecar;
+    this->Diagnostics.push_back(std::move(diagnostic));
+  }
+  return std::nullopt;
+}
+
+/**
+ * @brief Populates every field except the dimensions from the XMP of a sidecar.
+ *
+ * @return The first malformed structure found, if any. Never set for a lenient read.
+ */
+std::optional<ErrorInfo> ImageMetadata::readFromSidecar(const Exiv2::XmpData& xmpData, bool lenient) {
+  // The IPTC fallbacks do not apply to a sidecar
+  const Exiv2::IptcData noIptc;
+
+  auto orientKey = xmpData.findKey(Exiv2::XmpKey(MetadataKeys::Xmp::TiffOrientation));
+  if (orientKey != xmpData.end()) {
+    this->Orientation = orientation_from_exif_value(static_cast<int>(orientKey->toInt64()));
+  } else {
+    this->Orientation = std::nullopt;
+  }
+  readTitleAndDescription(xmpData, noIptc);
+  readLocationData(xmpData, noIptc);
+  auto error = readRegionInfo(xmpData, lenient);
+  readKeywordInfo(xmpData, lenient);
+  return error;
+}
+
+/**
+ * @brief Applies every set field to the XMP of a sidecar.
+ */
+void ImageMetadata::writeToSidecar(Exiv2::XmpData& xmpData) const {
+  // The IPTC mirrors of the fields are not stored in a sidecar
+  Exiv2::IptcData discardedIptc;
+
+  writeTitleAndDescription(xmpData, discardedIptc);
+  if (this->Orientation) {
+    xmpData[MetadataKeys::Xmp::TiffOrientation] = orientation_to_exif_value(*this->Orientation);
+  }
+  writeLocationData(xmpData, discardedIptc);
+  writeRegionInfo(xmpData);
+  writeKeywordInfo(xmpData);
+}
+
+/**
+ * @brief Writes the metadata to an XMP sidecar, updating it if it already exists.
+ *
+ * An atomic write updates a temporary copy of the sidecar and renames it over the sidecar, like
+ * an atomic image write. Either way, the sidecar is flushed as the durability level requires.
+ *
+ * @param sidecar The sidecar file.
+ * @param options Whether the write is atomic, and its durability.
+ * @throws Exiv2Error if Exiv2 fails to read or write the sidecar
+ * @throws FileAccessError if the temporary copy cannot be made, synced or renamed
+ */
+void ImageMetadata::toSidecar(const fs::path& sidecar, const WriteOptions& options) const {
+  if (!options.Atomic) {
+    this->writeSidecarFile(sidecar, fs::exists(sidecar));
+    FileUtils::syncFile(sidecar, options.Durability);
+    InternalLogger::debug("Wrote sidecar " + sidecar.string());
+    return;
+  }
+
+  const fs::path tempPath = FileUtils::temporaryPathFor(sidecar);
+  try {
+    // The existing sidecar may hold XMP this library does not manage, which is kept
+    const bool existing = fs::exists(sidecar);
+    if (existing) {
+      FileUtils::copyFile(sidecar, tempPath, false);
+    }
+    this->writeSidecarFile(tempPath, existing);
+    FileUtils::syncFile(tempPath, options.Durability);
+    FileUtils::replaceFile(tempPath, sidecar, options.Durability);
+  } catch (...) {
+    std::error_code ec;
+    fs::remove(tempPath, ec);
+    throw;
+  }
+  InternalLogger::debug("Wrote sidecar " + sidecar.string() + " atomically");
+}
+
+void ImageMetadata::writeSidecarFile(const fs::path& path, bool existing) const {
+  try {
+    Exiv2::Image::UniquePtr image;
+    if (existing) {
+      image = Exiv2::ImageFactory::open(path.string());
+      image->readMetadata();
+    } else {
+      image = Exiv2::ImageFactory::create(Exiv2::ImageType::xmp, path.string());
+    }
+    // Exiv2 converts the XMP into Exif and IPTC on read, and back on write, which would undo the changes below
+    image->clearExifData();
+    image->clearIptcData();
+    this->writeToSidecar(image->xmpData());
+    image->writeMetadata();
+  } catch (const Exiv2::Error& e) {
+    throw Exiv2Error("Exiv2 error while writing: " + std::string(e.what()));
+  }
+}
+
 // Private helper methods for reading metadata
 void ImageMetadata::readOrientation(const Exiv2::ExifData& exifData) {
   auto orientKey = exifData.findKey(Exiv2::ExifKey(MetadataKeys::Exif::Orientation));
@@ -231,21 +709,31 @@ void ImageMetadata::readLocationData(const Exiv2::XmpData& xmpData, const Exiv2:
   }
 }
 
-void ImageMetadata::readRegionInfo(const Exiv2::XmpData& xmpData) {
+std::optional<ErrorInfo> ImageMetadata::readRegionInfo(const Exiv2::XmpData& xmpData, bool lenient) {
+  this->RegionInfo = std::nullopt;
   auto regionInfoKey = xmpData.findKey(Exiv2::XmpKey(MetadataKeys::Xmp::Regions));
-  if (regionInfoKey != xmpData.end()) {
-    this->RegionInfo = RegionInfoStruct::fromXmp(xmpData);
-  } else {
-    this->RegionInfo = std::nullopt;
+  if (regionInfoKey == xmpData.end()) {
+    return std::nullopt;
   }
+  auto regionInfo = RegionInfoStruct::tryFromXmp(xmpData, lenient ? &this->Diagnostics : nullptr);
+  if (!regionInfo) {
+    if (!lenient) {
+      return regionInfo.error();
+    }
+    // Without the dimensions no region can be interpreted
+    this->Diagnostics.push_back({regionInfo.error().Code, "Skipped all regions: " + regionInfo.error().Message, {}});
+    return std::nullopt;
+  }
+  this->RegionInfo = std::move(regionInfo).value();
+  return std::nullopt;
 }
 
-void ImageMetadata::readKeywordInfo(const Exiv2::XmpData& xmpData) {
-  this->KeywordInfo = KeywordInfoModel::fromXmp(xmpData);
+void ImageMetadata::readKeywordInfo(const Exiv2::XmpData& xmpData, bool lenient) {
+  this->KeywordInfo = KeywordInfoModel::fromXmp(xmpData, lenient ? &this->Diagnostics : nullptr);
 }
 
 // Private helper methods for writing metadata
-void ImageMetadata::writeTitleAndDescription(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData) {
+void ImageMetadata::writeTitleAndDescription(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData) const {
   if (this->Title) {
     xmpData[MetadataKeys::Xmp::Title] = *this->Title;
   }
@@ -255,13 +743,13 @@ void ImageMetadata::writeTitleAndDescription(Exiv2::XmpData& xmpData, Exiv2::Ipt
   }
 }
 
-void ImageMetadata::writeOrientation(Exiv2::ExifData& exifData) {
+void ImageMetadata::writeOrientation(Exiv2::ExifData& exifData) const {
   if (this->Orientation) {
     exifData[MetadataKeys::Exif::Orientation] = orientation_to_exif_value(*this->Orientation);
   }
 }
 
-void ImageMetadata::writeLocationData(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData) {
+void ImageMetadata::writeLocationData(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData) const {
   if (this->Country) {
     iptcData[MetadataKeys::Iptc::CountryName] = *this->Country;
     xmpData[MetadataKeys::Xmp::IptcCountryName] = *this->Country;
@@ -280,14 +768,54 @@ void ImageMetadata::writeLocationData(Exiv2::XmpData& xmpData, Exiv2::IptcData&
   }
 }
 
-void ImageMetadata::writeRegionInfo(Exiv2::XmpData& xmpData) {
+void ImageMetadata::writeRegionInfo(Exiv2::XmpData& xmpData) const {
   if (this->RegionInfo) {
     this->RegionInfo.value().toXmp(xmpData);
   }
 }
 
-void ImageMetadata::writeKeywordInfo(Exiv2::XmpData& xmpData) {
+void ImageMetadata::writeKeywordInfo(Exiv2::XmpData& xmpData) const {
   if (this->KeywordInfo) {
     this->KeywordInfo.value().toXmp(xmpData);
   }
 }
+
+// Private helper methods for clearing metadata
+void ImageMetadata::clearRegionInfo(Exiv2::XmpData& xmpData) {
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::Regions);
+}
+
+void ImageMetadata::clearOrientation(Exiv2::ExifData& exifData, Exiv2::XmpData& xmpData) {
+  eraseExifKey(exifData, MetadataKeys::Exif::Orientation);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::TiffOrientation);
+}
+
+void ImageMetadata::clearKeywordInfo(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData) {
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::Keywords);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::KeywordInfo);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::AcdseeCategories);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::MicrosoftLastKeywordXMP);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::DigiKamTagsList);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::LightroomHierarchicalSubject);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::MediaProCatalogSets);
+  eraseIptcKey(iptcData, MetadataKeys::Iptc::CatalogSets);
+}
+
+void ImageMetadata::clearTitleAndDescription(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData,
+                                             Exiv2::ExifData& exifData) {
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::Title);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::Description);
+  eraseIptcKey(iptcData, MetadataKeys::Iptc::Caption);
+  eraseExifKey(exifData, MetadataKeys::Exif::ImageDescription);
+}
+
+void ImageMetadata::clearLocationData(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData) {
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::IptcCountryName);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::PhotoshopCity);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::PhotoshopState);
+  XmpUtils::clearXmpKey(xmpData, MetadataKeys::Xmp::IptcLocation);
+  eraseIptcKey(iptcData, MetadataKeys::Iptc::CountryName);
+  eraseIptcKey(iptcData, MetadataKeys::Iptc::City);
+  eraseIptcKey(iptcData, MetadataKeys::Iptc::ProvinceState);
+  eraseIptcKey(iptcData, MetadataKeys::Iptc::SubLocation);
+}
@@ -4,13 +4,21 @@
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "BinarySerializable.hpp"
 #include "DimensionsStruct.hpp"
+#include "Errors.hpp"
+#include "JsonSerializable.hpp"
 #include "KeywordInfoModel.hpp"
 #include "Orientation.hpp"
 #include "PythonBindable.hpp"
+#include "ReadOptions.hpp"
 #include "RegionInfoStruct.hpp"
+#include "RegionTransform.hpp"
+#include "Result.hpp"
+#include "WriteOptions.hpp"
 #include "XmpAreaStruct.hpp"
 
 class ImageMetadata {
@@ -26,10 +34,15 @@ public:
   std::optional<std::string> City;
   std::optional<std::string> State;
   std::optional<std::string> Location;
+  // What a lenient read skipped. Not part of equality, it describes the file rather than the metadata.
+  std::vector<ErrorInfo> Diagnostics;
 
   ImageMetadata() = default;
 
-  explicit ImageMetadata(const std::filesystem::path& path);
+  explicit ImageMetadata(const std::filesystem::path& path, const ReadOptions& options = {});
+
+  // Reads like the constructor, but returns the error instead of throwing it
+  static Result<ImageMetadata> tryRead(const std::filesystem::path& path, const ReadOptions& options = {});
 
   // This is used mostly in Python level testing, to construct expected structures
   ImageMetadata(int imageHeight, int imageWidth, std::optional<std::string> title = std::nullopt,
@@ -40,8 +53,28 @@ public:
                 std::optional<std::string> country = std::nullopt, std::optional<std::string> city = std::nullopt,
                 std::optional<std::string> state = std::nullopt, std::optional<std::string> location = std::nullopt);
 
-  void toFile(const std::optional<std::filesystem::path>& newPath = std::nullopt);
-  void clearFile(const std::optional<std::filesystem::path>& path = std::nullopt);
+  // Opens and parses the target again, since a copyable value does not keep the image it was read from open.
+  // A read-modify-write which parses the file only once goes through MetadataSession instead.
+  void toFile(const std::optional<std::filesystem::path>& newPath = std::nullopt, const WriteOptions& options = {}) const;
+  void clearFile(const std::optional<std::filesystem::path>& path = std::nullopt, const WriteOptions& options = {});
+
+  // Rotates or flips the image as displayed by composing operation with the orientation. The pixels are
+  // untouched, regions relative to the displayed image are transformed along with it.
+  void rotate(ExifOrientation operation, RegionSpace regions = RegionSpace::Stored);
+
+  // The XMP sidecar which belongs to an image: IMG_0001.CR2.xmp when it exists, otherwise IMG_0001.xmp
+  static std::filesystem::path sidecarPath(const std::filesystem::path& imagePath);
+
+  // Binary serialization, which keeps the original path and diagnostics equality ignores
+  static ImageMetadata fromBytes(std::string_view bytes);
+  std::string toBytes() const;
+
+  // JSON serialization in the structure of the test fixtures, with SourceFile set to the original path
+  static ImageMetadata fromJson(std::string_view json);
+  std::string toJson() const;
+  // A whole list as one JSON array
+  static std::vector<ImageMetadata> fromJsonArray(std::string_view json);
+  static std::string toJsonArray(const std::vector<ImageMetadata>& metadata);
 
   // Python bindable
   std::string to_string() const;
@@ -55,30 +88,65 @@ public:
   }
 
 private:
+  // Sessions read into and write from the private helpers below
+  friend class MetadataSession;
+  // Catalog records carry the path of the file they were read from
+  friend class CatalogReader;
+  // And so do binary and JSON encodings
+  friend class BinaryCodec;
+  friend class JsonCodec;
+
   std::optional<std::filesystem::path> m_originalPath;
 
+  // tryRead() without the cache, for a path already known to be a regular file
+  static Result<ImageMetadata> readFile(const std::filesystem::path& path, const ReadOptions& options);
+  // Moves the original path, and the diagnostics which name it or its sidecar, to another spelling of the file
+  void rebase(const std::filesystem::path& path);
+
+  // Applies every read or write helper against an already opened image. Reading stops at the
+  // first malformed structure, which is returned.
+  std::optional<ErrorInfo> readFromImage(Exiv2::Image& image, bool lenient = false);
+  void writeToImage(Exiv2::Image& image) const;
+
+  void toNewFileAtomically(const std::filesystem::path& targetPath, const WriteOptions& options) const;
+
+  // Sidecars only hold XMP, the orientation is stored as Xmp.tiff.Orientation
+  std::optional<ErrorInfo> applySidecar(const std::filesystem::path& sidecar, SidecarPolicy policy, bool lenient);
+  std::optional<ErrorInfo> readFromSidecar(const Exiv2::XmpData& xmpData, bool lenient);
+  void writeToSidecar(Exiv2::XmpData& xmpData) const;
+  void toSidecar(const std::filesystem::path& sidecar, const WriteOptions& options) const;
+  void writeSidecarFile(const std::filesystem::path& path, bool existing) const;
+  // Where a sidecar write goes, the full file name form when another image shares the stem
+  static std::filesystem::path sidecarTarget(const std::filesystem::path& imagePath);
+
   // Private helper methods for reading metadata
   void readOrientation(const Exiv2::ExifData& exifData);
   void readTitleAndDescription(const Exiv2::XmpData& xmpData, const Exiv2::IptcData& iptcData);
   void readLocationData(const Exiv2::XmpData& xmpData, const Exiv2::IptcData& iptcData);
-  void readRegionInfo(const Exiv2::XmpData& xmpData);
-  void readKeywordInfo(const Exiv2::XmpData& xmpData);
+  // A lenient read records malformed entries in Diagnostics and keeps the rest
+  std::optional<ErrorInfo> readRegionInfo(const Exiv2::XmpData& xmpData, bool lenient);
+  void readKeywordInfo(const Exiv2::XmpData& xmpData, bool lenient);
 
   // Private helper methods for writing metadata
-  void writeTitleAndDescription(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData);
-  void writeOrientation(Exiv2::ExifData& exifData);
-  void writeLocationData(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData);
-  void writeRegionInfo(Exiv2::XmpData& xmpData);
-  void writeKeywordInfo(Exiv2::XmpData& xmpData);
-
-  // Private helper methods for clearing metadata
-  void clearRegionInfo(Exiv2::XmpData& xmpData);
-  void clearOrientation(Exiv2::ExifData& exifData);
-  void clearKeywordInfo(Exiv2::XmpData& xmpData);
-  void clearTitleAndDescription(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData, Exiv2::ExifData& exifData);
+  void writeTitleAndDescription(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData) const;
+  void writeOrientation(Exiv2::ExifData& exifData) const;
+  void writeLocationData(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData) const;
+  void writeRegionInfo(Exiv2::XmpData& xmpData) const;
+  void writeKeywordInfo(Exiv2::XmpData& xmpData) const;
+
+  // Private helper methods for clearing metadata, these remove every source a field is read from
+  static void clearFromImage(Exiv2::Image& image);
+  static void clearRegionInfo(Exiv2::XmpData& xmpData);
+  static void clearOrientation(Exiv2::ExifData& exifData, Exiv2::XmpData& xmpData);
+  static void clearKeywordInfo(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData);
+  static void clearTitleAndDescription(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData,
+                                       Exiv2::ExifData& exifData);
+  static void clearLocationData(Exiv2::XmpData& xmpData, Exiv2::IptcData& iptcData);
 };
 
 // Equality operators
 static_assert(std::copy_constructible<ImageMetadata>);
 static_assert(std::equality_comparable<ImageMetadata>);
 static_assert(PythonBindableRepr<ImageMetadata>);
+static_assert(BinarySerializable<ImageMetadata>);
+static_assert(JsonSerializable<ImageMetadata>);
@@ -0,0 +1,864 @@
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+#include "Errors.hpp"
+#include "JsonCodec.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class Writer {
+public:
+  explicit Writer(std::string& out) : m_out(out) {
+  }
+
+  void raw(std::string_view text) {
+    this->m_out.append(text);
+  }
+
+  // Escapes quotes, backslashes and control characters, everything else is copied through as UTF-8
+  void string(std::string_view value) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    this->m_out.push_back('"');
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < value.size(); i++) {
+      const auto c = static_cast<unsigned char>(value[i]);
+      if (c >= 0x20 && c != '"' && c != '\\') {
+        continue;
+      }
+      this->m_out.append(value.substr(start, i - start));
+      start = i + 1;
+      switch (c) {
+      case '"':
+        this->m_out.append("\\\"");
+        break;
+      case '\\':
+        this->m_out.append("\\\\");
+        break;
+      case '\n':
+        this->m_out.append("\\n");
+        break;
+      case '\r':
+        this->m_out.append("\\r");
+        break;
+      case '\t':
+        this->m_out.append("\\t");
+        break;
+      default:
+        this->m_out.append("\\u00");
+        this->m_out.push_back(HEX[c >> 4U]);
+        this->m_out.push_back(HEX[c & 0xFU]);
+      }
+    }
+    this->m_out.append(value.substr(start));
+    this->m_out.push_back('"');
+  }
+
+  void optionalString(const std::optional<std::string>& value) {
+    if (value) {
+      this->string(value.value());
+    } else {
+      this->raw("null");
+    }
+  }
+
+  // The shortest text which reads back as the same double, with a ".0" kept on whole numbers
+  void number(double value) {
+    if (!std::isfinite(value)) {
+      throw InvalidStructureError("JSON cannot represent the number " + std::to_string(value));
+    }
+    std::array<char, 32> buffer{};
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    const std::string_view text(buffer.data(), static_cast<std::size_t>(result.ptr - buffer.data()));
+    this->m_out.append(text);
+    if (text.find_first_of(".e") == std::string_view::npos) {
+      this->m_out.append(".0");
+    }
+  }
+
+  void optionalNumber(const std::optional<double>& value) {
+    if (value) {
+      this->number(value.value());
+    } else {
+      this->raw("null");
+    }
+  }
+
+  void integer(std::uint64_t value) {
+    std::array<char, 24> buffer{};
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    this->m_out.append(buffer.data(), result.ptr);
+  }
+
+private:
+  std::string& m_out;
+};
+
+class Reader {
+public:
+  Reader(std::string_view json, const char* type) : m_json(json), m_type(type) {
+  }
+
+  // The next character after any whitespace, without consuming it. '\0' at the end.
+  char peek() {
+    while (this->m_offset < this->m_json.size()) {
+      const char c = this->m_json[this->m_offset];
+      if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+        return c;
+      }
+      this->m_offset++;
+    }
+    return '\0';
+  }
+
+  void expect(char expected) {
+    if (this->peek() != expected) {
+      this->fail(std::string("expected '") + expected + "'");
+    }
+    this->m_offset++;
+  }
+
+  // Consumes a null if one is next
+  bool null() {
+    if (this->peek() != 'n') {
+      return false;
+    }
+    this->literal("null");
+    return true;
+  }
+
+  bool boolean() {
+    const char c = this->peek();
+    if (c == 't') {
+      this->literal("true");
+      return true;
+    }
+    if (c == 'f') {
+      this->literal("false");
+      return false;
+    }
+    this->fail("expected a boolean");
+  }
+
+  void beginObject() {
+    this->enter();
+    this->expect('{');
+  }
+
+  // Reads the next key of the innermost object, false once it has ended
+  bool nextKey(std::string& key) {
+    if (this->peek() == '}') {
+      this->m_offset++;
+      this->m_levels.pop_back();
+      return false;
+    }
+    if (!this->m_levels.back()) {
+      this->expect(',');
+    }
+    this->m_levels.back() = false;
+    key = this->string();
+    this->expect(':');
+    return true;
+  }
+
+  void beginArray() {
+    this->enter();
+    this->expect('[');
+  }
+
+  // Whether the innermost array has another element, which the caller reads next
+  bool nextElement() {
+    if (this->peek() == ']') {
+      this->m_offset++;
+      this->m_levels.pop_back();
+      return false;
+    }
+    if (!this->m_levels.back()) {
+      this->expect(',');
+    }
+    this->m_levels.back() = false;
+    return true;
+  }
+
+  std::string string() {
+    this->expect('"');
+    std::string value;
+    while (true) {
+      const std::size_t start = this->m_offset;
+      while (this->m_offset < this->m_json.size()) {
+        const auto c = static_cast<unsigned char>(this->m_json[this->m_offset]);
+        if (c == '"' || c == '\\' || c < 0x20) {
+          break;
+        }
+        this->m_offset++;
+      }
+      value.append(this->m_json.substr(start, this->m_offset - start));
+      if (this->m_offset >= this->m_json.size()) {
+        this->fail("unterminated string");
+      }
+      const char c = this->m_json[this->m_offset++];
+      if (c == '"') {
+        return value;
+      }
+      if (c != '\\') {
+        this->fail("control character in string");
+      }
+      this->escape(value);
+    }
+  }
+
+  std::optional<std::string> optionalString() {
+    if (this->null()) {
+      return std::nullopt;
+    }
+    return this->string();
+  }
+
+  double number() {
+    const std::string_view token = this->numberToken();
+    double value = 0;
+    const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (result.ec != std::errc() || result.ptr != token.data() + token.size()) {
+      this->fail("invalid number '" + std::string(token) + "'");
+    }
+    return value;
+  }
+
+  std::optional<double> optionalNumber() {
+    if (this->null()) {
+      return std::nullopt;
+    }
+    return this->number();
+  }
+
+  // A whole number between 0 and maximum, written either as an integer or a double such as 683.0
+  std::uint64_t unsignedInteger(std::uint64_t maximum, const char* field) {
+    const std::string_view token = this->numberToken();
+    std::uint64_t value = 0;
+    const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (result.ec == std::errc() && result.ptr == token.data() + token.size()) {
+      if (value > maximum) {
+        this->fail(std::string(field) + " out of range");
+      }
+      return value;
+    }
+    double real = 0;
+    const auto realResult = std::from_chars(token.data(), token.data() + token.size(), real);
+    if (realResult.ec != std::errc() || realResult.ptr != token.data() + token.size() || real < 0 ||
+        real > static_cast<double>(maximum) || std::floor(real) != real) {
+      this->fail(std::string(field) + " is not a whole number in range");
+    }
+    return static_cast<std::uint64_t>(real);
+  }
+
+  // Skips over any value, for keys which are not part of the model
+  void skip() {
+    std::string key;
+    switch (this->peek()) {
+    case '{':
+      this->beginObject();
+      while (this->nextKey(key)) {
+        this->skip();
+      }
+      break;
+    case '[':
+      this->beginArray();
+      while (this->nextElement()) {
+        this->skip();
+      }
+      break;
+    case '"':
+      this->string();
+      break;
+    case 't':
+    case 'f':
+      this->boolean();
+      break;
+    case 'n':
+      this->literal("null");
+      break;
+    default:
+      this->number();
+    }
+  }
+
+  // Only whitespace may follow the value
+  void finish() {
+    if (this->peek() != '\0' || this->m_offset != this->m_json.size()) {
+      this->fail("trailing characters");
+    }
+  }
+
+  [[noreturn]] void fail(const std::string& reason) const {
+    throw InvalidStructureError("Invalid " + std::string(this->m_type) + " JSON at offset " +
+                                std::to_string(this->m_offset) + ": " + reason);
+  }
+
+  [[noreturn]] void missing(const char* field, const char* object) const {
+    throw MissingFieldError("No " + std::string(field) + " found in " + object + " JSON");
+  }
+
+private:
+  std::string_view m_json;
+  std::size_t m_offset = 0;
+  const char* m_type;
+  // Whether each open object or array is still before its first member
+  std::vector<bool> m_levels;
+
+  void enter() {
+    if (this->m_levels.size() >= JsonCodec::MAX_DEPTH) {
+      this->fail("nested too deep");
+    }
+    this->m_levels.push_back(true);
+  }
+
+  void literal(std::string_view word) {
+    if (this->m_json.substr(this->m_offset, word.size()) != word) {
+      this->fail("invalid literal");
+    }
+    this->m_offset += word.size();
+  }
+
+  std::string_view numberToken() {
+    this->peek();
+    const std::size_t start = this->m_offset;
+    while (this->m_offset < this->m_json.size() &&
+           std::string_view("+-0123456789.eE").find(this->m_json[this->m_offset]) != std::string_view::npos) {
+      this->m_offset++;
+    }
+    if (start == this->m_offset) {
+      this->fail("expected a value");
+    }
+    return this->m_json.substr(start, this->m_offset - start);
+  }
+
+  std::uint32_t hex4() {
+    if (this->m_json.size() - this->m_offset < 4) {
+      this->fail("truncated escape");
+    }
+    std::uint32_t value = 0;
+    const char* begin = this->m_json.data() + this->m_offset;
+    const auto result = std::from_chars(begin, begin + 4, value, 16);
+    if (result.ec != std::errc() || result.ptr != begin + 4) {
+      this->fail("invalid escape");
+    }
+    this->m_offset += 4;
+    return value;
+  }
+
+  // Decodes the escape after a backslash, a \u escape and its low surrogate are appended as UTF-8
+  void escape(std::string& value) {
+    if (this->m_offset >= this->m_json.size()) {
+      this->fail("unterminated string");
+    }
+    const char c = this->m_json[this->m_offset++];
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+      value.push_back(c);
+      return;
+    case 'b':
+      value.push_back('\b');
+      return;
+    case 'f':
+      value.push_back('\f');
+      return;
+    case 'n':
+      value.push_back('\n');
+      return;
+    case 'r':
+      value.push_back('\r');
+      return;
+    case 't':
+      value.push_back('\t');
+      return;
+    case 'u':
+      break;
+    default:
+      this->fail("invalid escape");
+    }
+
+    std::uint32_t codePoint = this->hex4();
+    if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+      this->fail("unpaired surrogate");
+    }
+    if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+      if (this->m_json.substr(this->m_offset, 2) != "\\u") {
+        this->fail("unpaired surrogate");
+      }
+      this->m_offset += 2;
+      const std::uint32_t low = this->hex4();
+      if (low < 0xDC00 || low > 0xDFFF) {
+        this->fail("unpaired surrogate");
+      }
+      codePoint = 0x10000 + ((codePoint - 0xD800) << 10U) + (low - 0xDC00);
+    }
+
+    if (codePoint < 0x80) {
+      value.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+      value.push_back(static_cast<char>(0xC0 | (codePoint >> 6U)));
+      value.push_back(static_cast<char>(0x80 | (codePoint & 0x3FU)));
+    } else if (codePoint < 0x10000) {
+      value.push_back(static_cast<char>(0xE0 | (codePoint >> 12U)));
+      value.push_back(static_cast<char>(0x80 | ((codePoint >> 6U) & 0x3FU)));
+      value.push_back(static_cast<char>(0x80 | (codePoint & 0x3FU)));
+    } else {
+      value.push_back(static_cast<char>(0xF0 | (codePoint >> 18U)));
+      value.push_back(static_cast<char>(0x80 | ((codePoint >> 12U) & 0x3FU)));
+      value.push_back(static_cast<char>(0x80 | ((codePoint >> 6U) & 0x3FU)));
+      value.push_back(static_cast<char>(0x80 | (codePoint & 0x3FU)));
+    }
+  }
+};
+
+// The key order of every object follows the fixtures
+void writeArea(Writer& out, const XmpAreaStruct& area) {
+  out.raw("{\"H\":");
+  out.number(area.H);
+  out.raw(",\"Unit\":");
+  out.string(area.Unit);
+  out.raw(",\"W\":");
+  out.number(area.W);
+  out.raw(",\"X\":");
+  out.number(area.X);
+  out.raw(",\"Y\":");
+  out.number(area.Y);
+  out.raw(",\"D\":");
+  out.optionalNumber(area.D);
+  out.raw("}");
+}
+
+XmpAreaStruct readArea(Reader& in) {
+  std::optional<double> h;
+  std::optional<double> w;
+  std::optional<double> x;
+  std::optional<double> y;
+  std::optional<double> d;
+  std::string unit = "normalized";
+  std::string key;
+  in.beginObject();
+  while (in.nextKey(key)) {
+    if (key == "H") {
+      h = in.number();
+    } else if (key == "W") {
+      w = in.number();
+    } else if (key == "X") {
+      x = in.number();
+    } else if (key == "Y") {
+      y = in.number();
+    } else if (key == "D") {
+      d = in.optionalNumber();
+    } else if (key == "Unit") {
+      unit = in.optionalString().value_or("normalized");
+    } else {
+      in.skip();
+    }
+  }
+  if (!h || !w || !x || !y) {
+    in.missing(!h ? "H" : !w ? "W" : !x ? "X" : "Y", "xmp area");
+  }
+  return {h.value(), w.value(), x.value(), y.value(), std::move(unit), d};
+}
+
+void writeDimensions(Writer& out, const DimensionsStruct& dimensions) {
+  out.raw("{\"H\":");
+  out.number(dimensions.H);
+  out.raw(",\"W\":");
+  out.number(dimensions.W);
+  out.raw(",\"Unit\":");
+  out.string(dimensions.Unit);
+  out.raw("}");
+}
+
+DimensionsStruct readDimensions(Reader& in) {
+  std::optional<double> h;
+  std::optional<double> w;
+  std::optional<std::string> unit;
+  std::string key;
+  in.beginObject();
+  while (in.nextKey(key)) {
+    if (key == "H") {
+      h = in.number();
+    } else if (key == "W") {
+      w = in.number();
+    } else if (key == "Unit") {
+      unit = in.string();
+    } else {
+      in.skip();
+    }
+  }
+  if (!h || !w || !unit) {
+    in.missing(!h ? "H" : !w ? "W" : "Unit", "dimensions");
+  }
+  return {h.value(), w.value(), std::move(unit).value()};
+}
+
+void writeRegion(Writer& out, const RegionInfoStruct::RegionStruct& region) {
+  out.raw("{\"Area\":");
+  writeArea(out, region.Area);
+  out.raw(",\"Name\":");
+  out.string(region.Name);
+  out.raw(",\"Type\":");
+  out.string(region.Type);
+  out.raw(",\"Description\":");
+  out.optionalString(region.Description);
+  out.raw("}");
+}
+
+RegionInfoStruct::RegionStruct readRegion(Reader& in) {
+  std::optional<XmpAreaStruct> area;
+  std::optional<std::string> name;
+  std::optional<std::string> type;
+  std::optional<std::string> description;
+  std::string key;
+  in.beginObject();
+  while (in.nextKey(key)) {
+    if (key == "Area") {
+      area = readArea(in);
+    } else if (key == "Name") {
+      name = in.string();
+    } else if (key == "Type") {
+      type = in.string();
+    } else if (key == "Description") {
+      description = in.optionalString();
+    } else {
+      in.skip();
+    }
+  }
+  if (!area || !name || !type) {
+    in.missing(!area ? "Area" : !name ? "Name" : "Type", "region");
+  }
+  return {std::move(area).value(), std::move(name).value(), std::move(type).value(), std::move(description)};
+}
+
+void writeRegionInfo(Writer& out, const RegionInfoStruct& regionInfo) {
+  out.raw("{\"AppliedToDimensions\":");
+  writeDimensions(out, regionInfo.AppliedToDimensions);
+  out.raw(",\"RegionList\":[");
+  for (std::size_t i = 0; i < regionInfo.RegionList.size(); i++) {
+    if (i > 0) {
+      out.raw(",");
+    }
+    writeRegion(out, regionInfo.RegionList[i]);
+  }
+  out.raw("]}");
+}
+
+RegionInfoStruct readRegionInfo(Reader& in) {
+  std::optional<DimensionsStruct> dimensions;
+  std::vector<RegionInfoStruct::RegionStruct> regions;
+  std::string key;
+  in.beginObject();
+  while (in.nextKey(key)) {
+    if (key == "AppliedToDimensions") {
+      dimensions = readDimensions(in);
+    } else if (key == "RegionList") {
+      regions.clear();
+      in.beginArray();
+      while (in.nextElement()) {
+        regions.push_back(readRegion(in));
+      }
+    } else {
+      in.skip();
+    }
+  }
+  if (!dimensions) {
+    in.missing("AppliedToDimensions", "region info");
+  }
+  RegionInfoStruct regionInfo(std::move(dimensions).value(), {});
+  regionInfo.RegionList = std::move(regions);
+  return regionInfo;
+}
+
+void writeKeyword(Writer& out, const KeywordInfoModel::KeywordStruct& keyword) {
+  out.raw("{\"Keyword\":");
+  out.string(keyword.Keyword);
+  out.raw(",\"Applied\":");
+  out.raw(keyword.Applied.has_value() ? (keyword.Applied.value() ? "true" : "false") : "null");
+  out.raw(",\"Children\":[");
+  for (std::size_t i = 0; i < keyword.Children.size(); i++) {
+    if (i > 0) {
+      out.raw(",");
+    }
+    writeKeyword(out, keyword.Children[i]);
+  }
+  out.raw("]}");
+}
+
+std::vector<KeywordInfoModel::KeywordStruct> readKeywords(Reader& in);
+
+KeywordInfoModel::KeywordStruct readKeyword(Reader& in) {
+  std::optional<std::string> name;
+  std::optional<bool> applied;
+  std::vector<KeywordInfoModel::KeywordStruct> children;
+  std::string key;
+  in.beginObject();
+  while (in.nextKey(key)) {
+    if (key == "Keyword") {
+      name = in.string();
+    } else if (key == "Applied") {
+      applied = in.null() ? std::nullopt : std::optional<bool>(in.boolean());
+    } else if (key == "Children") {
+      children = readKeywords(in);
+    } else {
+      in.skip();
+    }
+  }
+  if (!name) {
+    in.missing("Keyword", "keyword");
+  }
+  // Moved in rather than passed to the constructor, which copies every level below
+  KeywordInfoModel::KeywordStruct keyword(std::move(name).value(), {}, applied);
+  keyword.Children = std::move(children);
+  return keyword;
+}
+
+// An array of keywords, null for none
+std::vector<KeywordInfoModel::KeywordStruct> readKeywords(Reader& in) {
+  std::vector<KeywordInfoModel::KeywordStruct> keywords;
+  if (in.null()) {
+    return keywords;
+  }
+  in.beginArray();
+  while (in.nextElement()) {
+    keywords.push_back(readKeyword(in));
+  }
+  return keywords;
+}
+
+void writeKeywordInfo(Writer& out, const KeywordInfoModel& keywordInfo) {
+  out.raw("{\"Hierarchy\":[");
+  for (std::size_t i = 0; i < keywordInfo.Hierarchy.size(); i++) {
+    if (i > 0) {
+      out.raw(",");
+    }
+    writeKeyword(out, keywordInfo.Hierarchy[i]);
+  }
+  out.raw("]}");
+}
+
+KeywordInfoModel readKeywordInfo(Reader& in) {
+  KeywordInfoModel keywordInfo(std::vector<KeywordInfoModel::KeywordStruct>{});
+  std::string key;
+  in.beginObject();
+  while (in.nextKey(key)) {
+    if (key == "Hierarchy") {
+      keywordInfo.Hierarchy = readKeywords(in);
+    } else {
+      in.skip();
+    }
+  }
+  return keywordInfo;
+}
+
+void writeMetadata(Writer& out, const ImageMetadata& metadata, const std::optional<fs::path>& source) {
+  out.raw("{\"SourceFile\":");
+  if (source) {
+    out.string(source->string());
+  } else {
+    out.raw("null");
+  }
+  out.raw(",\"ImageHeight\":");
+  out.integer(metadata.ImageHeight);
+  out.raw(",\"ImageWidth\":");
+  out.integer(metadata.ImageWidth);
+  out.raw(",\"Title\":");
+  out.optionalString(metadata.Title);
+  out.raw(",\"Description\":");
+  out.optionalString(metadata.Description);
+  out.raw(",\"RegionInfo\":");
+  if (metadata.RegionInfo) {
+    writeRegionInfo(out, metadata.RegionInfo.value());
+  } else {
+    out.raw("null");
+  }
+  out.raw(",\"Orientation\":");
+  if (metadata.Orientation) {
+    out.integer(static_cast<std::uint64_t>(orientation_to_exif_value(metadata.Orientation.value())));
+  } else {
+    out.raw("null");
+  }
+  out.raw(",\"KeywordInfo\":");
+  if (metadata.KeywordInfo) {
+    writeKeywordInfo(out, metadata.KeywordInfo.value());
+  } else {
+    out.raw("null");
+  }
+  out.raw(",\"Country\":");
+  out.optionalString(metadata.Country);
+  out.raw(",\"City\":");
+  out.optionalString(metadata.City);
+  out.raw(",\"State\":");
+  out.optionalString(metadata.State);
+  out.raw(",\"Location\":");
+  out.optionalString(metadata.Location);
+  out.raw("}");
+}
+
+ImageMetadata readMetadata(Reader& in, std::optional<fs::path>& source) {
+  ImageMetadata metadata;
+  bool hasHeight = false;
+  bool hasWidth = false;
+  std::string key;
+  in.beginObject();
+  while (in.nextKey(key)) {
+    if (key == "ImageHeight") {
+      metadata.ImageHeight = static_cast<std::uint32_t>(
+          in.unsignedInteger(std::numeric_limits<std::uint32_t>::max(), "ImageHeight"));
+      hasHeight = true;
+    } else if (key == "ImageWidth") {
+      metadata.ImageWidth =
+          static_cast<std::uint32_t>(in.unsignedInteger(std::numeric_limits<std::uint32_t>::max(), "ImageWidth"));
+      hasWidth = true;
+    } else if (key == "Title") {
+      metadata.Title = in.optionalString();
+    } else if (key == "Description") {
+      metadata.Description = in.optionalString();
+    } else if (key == "RegionInfo") {
+      metadata.RegionInfo = in.null() ? std::nullopt : std::optional<RegionInfoStruct>(readRegionInfo(in));
+    } else if (key == "Orientation") {
+      metadata.Orientation =
+          in.null() ? std::nullopt
+                    : std::optional<ExifOrientation>(
+                          orientation_from_exif_value(static_cast<int>(in.unsignedInteger(8, "Orientation"))));
+    } else if (key == "KeywordInfo") {
+      metadata.KeywordInfo = in.null() ? std::nullopt : std::optional<KeywordInfoModel>(readKeywordInfo(in));
+    } else if (key == "Country") {
+      metadata.Country = in.optionalString();
+    } else if (key == "City") {
+      metadata.City = in.optionalString();
+    } else if (key == "State") {
+      metadata.State = in.optionalString();
+    } else if (key == "Location") {
+      metadata.Location = in.optionalString();
+    } else if (key == "SourceFile") {
+      auto path = in.optionalString();
+      source = path ? std::optional<fs::path>(std::move(path).value()) : std::nullopt;
+    } else {
+      in.skip();
+    }
+  }
+  if (!hasHeight || !hasWidth) {
+    in.missing(!hasHeight ? "ImageHeight" : "ImageWidth", "image metadata");
+  }
+  return metadata;
+}
+
+template <typename T> std::string encodeWith(const T& value, void (*write)(Writer&, const T&)) {
+  std::string json;
+  json.reserve(256);
+  Writer out(json);
+  write(out, value);
+  return json;
+}
+
+template <typename T> T decodeWith(std::string_view json, const char* type, T (*read)(Reader&)) {
+  Reader in(json, type);
+  T value = read(in);
+  in.finish();
+  return value;
+}
+
+} // namespace
+
+std::string JsonCodec::encode(const XmpAreaStruct& area) {
+  return encodeWith(area, &writeArea);
+}
+
+std::string JsonCodec::encode(const DimensionsStruct& dimensions) {
+  return encodeWith(dimensions, &writeDimensions);
+}
+
+std::string JsonCodec::encode(const RegionInfoStruct::RegionStruct& region) {
+  return encodeWith(region, &writeRegion);
+}
+
+std::string JsonCodec::encode(const RegionInfoStruct& regionInfo) {
+  return encodeWith(regionInfo, &writeRegionInfo);
+}
+
+std::string JsonCodec::encode(const KeywordInfoModel::KeywordStruct& keyword) {
+  return encodeWith(keyword, &writeKeyword);
+}
+
+std::string JsonCodec::encode(const KeywordInfoModel& keywordInfo) {
+  return encodeWith(keywordInfo, &writeKeywordInfo);
+}
+
+std::string JsonCodec::encode(const ImageMetadata& metadata) {
+  std::string json;
+  json.reserve(1024);
+  Writer out(json);
+  writeMetadata(out, metadata, metadata.m_originalPath);
+  return json;
+}
+
+std::string JsonCodec::encode(const std::vector<ImageMetadata>& metadata) {
+  std::string json;
+  json.reserve(metadata.size() * 1024 + 2);
+  Writer out(json);
+  out.raw("[");
+  for (std::size_t i = 0; i < metadata.size(); i++) {
+    if (i > 0) {
+      out.raw(",");
+    }
+    writeMetadata(out, metadata[i], metadata[i].m_originalPath);
+  }
+  out.raw("]");
+  return json;
+}
+
+template <> XmpAreaStruct JsonCodec::decode<XmpAreaStruct>(std::string_view json) {
+  return decodeWith(json, "XmpArea", &readArea);
+}
+
+template <> DimensionsStruct JsonCodec::decode<DimensionsStruct>(std::string_view json) {
+  return decodeWith(json, "Dimensions", &readDimensions);
+}
+
+template <> RegionInfoStruct::RegionStruct JsonCodec::decode<RegionInfoStruct::RegionStruct>(std::string_view json) {
+  return decodeWith(json, "Region", &readRegion);
+}
+
+template <> RegionInfoStruct JsonCodec::decode<RegionInfoStruct>(std::string_view json) {
+  return decodeWith(json, "RegionInfo", &readRegionInfo);
+}
+
+template <>
+KeywordInfoModel::KeywordStruct JsonCodec::decode<KeywordInfoModel::KeywordStruct>(std::string_view json) {
+  return decodeWith(json, "Keyword", &readKeyword);
+}
+
+template <> KeywordInfoModel JsonCodec::decode<KeywordInfoModel>(std::string_view json) {
+  return decodeWith(json, "KeywordInfo", &readKeywordInfo);
+}
+
+template <> ImageMetadata JsonCodec::decode<ImageMetadata>(std::string_view json) {
+  Reader in(json, "ImageMetadata");
+  std::optional<fs::path> source;
+  ImageMetadata metadata = readMetadata(in, source);
+  in.finish();
+  metadata.m_originalPath = std::move(source);
+  return metadata;
+}
+
+template <> std::vector<ImageMetadata> JsonCodec::decode<std::vector<ImageMetadata>>(std::string_view json) {
+  Reader in(json, "ImageMetadata list");
+  std::vector<ImageMetadata> metadata;
+  in.beginArray();
+  while (in.nextElement()) {
+    std::optional<fs::path> source;
+    metadata.push_back(readMetadata(in, source));
+    metadata.back().m_originalPath = std::move(source);
+  }
+  in.finish();
+  return metadata;
+}
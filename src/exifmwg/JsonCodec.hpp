@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DimensionsStruct.hpp"
+#include "ImageMetadata.hpp"
+#include "KeywordInfoModel.hpp"
+#include "RegionInfoStruct.hpp"
+#include "XmpAreaStruct.hpp"
+
+/**
+ * @brief The JSON encoding behind toJson() and fromJson() of the model types.
+ *
+ * Objects use the key names and order of the fixtures in tests/fixtures: PascalCase field
+ * names, unset optionals written as null, the orientation as its EXIF value, and an
+ * ImageMetadata starting with the SourceFile it was read from. Encoding appends straight into
+ * one string without building a document first, and decoding parses straight into the model.
+ *
+ * Decoding skips keys it does not know, such as the flat keyword tags exiftool adds, and
+ * treats a missing optional as null. A missing required field throws MissingFieldError, and
+ * anything else which is not valid JSON of the expected shape throws InvalidStructureError.
+ */
+class JsonCodec {
+public:
+  // Objects and arrays nested deeper than this are rejected when decoding
+  static constexpr std::size_t MAX_DEPTH = 512;
+
+  static std::string encode(const XmpAreaStruct& area);
+  static std::string encode(const DimensionsStruct& dimensions);
+  static std::string encode(const RegionInfoStruct::RegionStruct& region);
+  static std::string encode(const RegionInfoStruct& regionInfo);
+  static std::string encode(const KeywordInfoModel::KeywordStruct& keyword);
+  static std::string encode(const KeywordInfoModel& keywordInfo);
+  static std::string encode(const ImageMetadata& metadata);
+  // A JSON array of every metadata, written into one buffer
+  static std::string encode(const std::vector<ImageMetadata>& metadata);
+
+  template <typename T> static T decode(std::string_view json);
+};
+
+template <> XmpAreaStruct JsonCodec::decode<XmpAreaStruct>(std::string_view json);
+template <> DimensionsStruct JsonCodec::decode<DimensionsStruct>(std::string_view json);
+template <> RegionInfoStruct::RegionStruct JsonCodec::decode<RegionInfoStruct::RegionStruct>(std::string_view json);
+template <> RegionInfoStruct JsonCodec::decode<RegionInfoStruct>(std::string_view json);
+template <>
+KeywordInfoModel::KeywordStruct JsonCodec::decode<KeywordInfoModel::KeywordStruct>(std::string_view json);
+template <> KeywordInfoModel JsonCodec::decode<KeywordInfoModel>(std::string_view json);
+template <> ImageMetadata JsonCodec::decode<ImageMetadata>(std::string_view json);
+template <> std::vector<ImageMetadata> JsonCodec::decode<std::vector<ImageMetadata>>(std::string_view json);
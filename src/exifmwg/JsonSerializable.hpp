@@ -0,0 +1,10 @@
+#pragma once
+#include <concepts>
+#include <string>
+#include <string_view>
+
+template <typename T>
+concept JsonSerializable = requires(const T& obj, std::string_view json) {
+  { T::fromJson(json) } -> std::same_as<T>;
+  { obj.toJson() } -> std::same_as<std::string>;
+};
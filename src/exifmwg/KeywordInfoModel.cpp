@@ -1,20 +1,43 @@
 #include <algorithm>
 #include <utility>
 
+#include "BinaryCodec.hpp"
 #include "Errors.hpp"
+#include "JsonCodec.hpp"
 #include "KeywordInfoModel.hpp"
 #include "Logging.hpp"
 #include "MetadataKeys.hpp"
 
 #include "XmpUtils.hpp"
 
+namespace {
+
+// Whether any XMP key lies below the given struct path
+bool hasNode(const Exiv2::XmpData& xmpData, const std::string& path) {
+  const std::string prefix = path + "/";
+  return std::any_of(xmpData.begin(), xmpData.end(),
+                     [&prefix](const Exiv2::Xmpdatum& item) { return item.key().starts_with(prefix); });
+}
+
+// A node whose keyword is missing. Only those later in the list are worth looking for.
+bool skipMalformedNode(const Exiv2::XmpData& xmpData, const std::string& path, std::vector<ErrorInfo>* skipped) {
+  if (skipped == nullptr || !hasNode(xmpData, path)) {
+    return false;
+  }
+  skipped->push_back({ErrorCode::MissingField, "Skipped keyword node " + path + ": mwg-kw:Keyword key not found", {}});
+  return true;
+}
+
+} // namespace
+
 KeywordInfoModel::KeywordStruct::KeywordStruct(std::string keyword, const std::vector<KeywordStruct>& children,
                                                std::optional<bool> applied) :
     Keyword(std::move(keyword)), Applied(applied), Children(children) {
 }
 
 KeywordInfoModel::KeywordStruct KeywordInfoModel::KeywordStruct::fromXmp(const Exiv2::XmpData& xmpData,
-                                                                         const std::string& basePath) {
+                                                                         const std::string& basePath,
+                                                                         std::vector<ErrorInfo>* skipped) {
   std::string keywordValue;
   std::optional<bool> appliedValue;
   std::vector<KeywordStruct> children;
@@ -45,10 +68,14 @@ KeywordInfoModel::KeywordStruct KeywordInfoModel::KeywordStruct::fromXmp(const E
 
     auto childKeywordIt = xmpData.findKey(Exiv2::XmpKey(childKeywordKey));
     if (childKeywordIt == xmpData.end()) {
+      if (skipMalformedNode(xmpData, childPath, skipped)) {
+        childIndex++;
+        continue;
+      }
       break;
     }
 
-    KeywordStruct child = KeywordStruct::fromXmp(xmpData, childPath);
+    KeywordStruct child = KeywordStruct::fromXmp(xmpData, childPath, skipped);
     children.push_back(child);
     childIndex++;
   }
@@ -56,6 +83,22 @@ KeywordInfoModel::KeywordStruct KeywordInfoModel::KeywordStruct::fromXmp(const E
   return KeywordInfoModel::KeywordStruct(keywordValue, children, appliedValue);
 }
 
+KeywordInfoModel::KeywordStruct KeywordInfoModel::KeywordStruct::fromBytes(std::string_view bytes) {
+  return BinaryCodec::decode<KeywordInfoModel::KeywordStruct>(bytes);
+}
+
+std::string KeywordInfoModel::KeywordStruct::toBytes() const {
+  return BinaryCodec::encode(*this);
+}
+
+KeywordInfoModel::KeywordStruct KeywordInfoModel::KeywordStruct::fromJson(std::string_view json) {
+  return JsonCodec::decode<KeywordInfoModel::KeywordStruct>(json);
+}
+
+std::string KeywordInfoModel::KeywordStruct::toJson() const {
+  return JsonCodec::encode(*this);
+}
+
 void KeywordInfoModel::KeywordStruct::toXmp(Exiv2::XmpData& xmpData, const std::string& basePath) const {
   xmpData[basePath + "/mwg-kw:Keyword"] = Keyword;
 
@@ -126,7 +169,7 @@ KeywordInfoModel::KeywordInfoModel(const std::vector<std::string>& delimitedStri
   sortKeywordVector(Hierarchy);
 }
 
-KeywordInfoModel KeywordInfoModel::fromXmp(const Exiv2::XmpData& xmpData) {
+KeywordInfoModel KeywordInfoModel::fromXmp(const Exiv2::XmpData& xmpData, std::vector<ErrorInfo>* skipped) {
   std::vector<KeywordStruct> hierarchy;
   std::string basePath = "Xmp.mwg-kw.Keywords/mwg-kw:Hierarchy";
   int index = 1;
@@ -137,10 +180,14 @@ KeywordInfoModel KeywordInfoModel::fromXmp(const Exiv2::XmpData& xmpData) {
 
     auto keywordIt = xmpData.findKey(Exiv2::XmpKey(keywordKey));
     if (keywordIt == xmpData.end()) {
+      if (skipMalformedNode(xmpData, itemPath, skipped)) {
+        index++;
+        continue;
+      }
       break;
     }
 
-    KeywordStruct keywordStruct = KeywordStruct::fromXmp(xmpData, itemPath);
+    KeywordStruct keywordStruct = KeywordStruct::fromXmp(xmpData, itemPath, skipped);
     hierarchy.push_back(keywordStruct);
     index++;
   }
@@ -181,6 +228,22 @@ KeywordInfoModel KeywordInfoModel::fromXmp(const Exiv2::XmpData& xmpData) {
   return KeywordInfoModel(hierarchy);
 }
 
+KeywordInfoModel KeywordInfoModel::fromBytes(std::string_view bytes) {
+  return BinaryCodec::decode<KeywordInfoModel>(bytes);
+}
+
+std::string KeywordInfoModel::toBytes() const {
+  return BinaryCodec::encode(*this);
+}
+
+KeywordInfoModel KeywordInfoModel::fromJson(std::string_view json) {
+  return JsonCodec::decode<KeywordInfoModel>(json);
+}
+
+std::string KeywordInfoModel::toJson() const {
+  return JsonCodec::encode(*this);
+}
+
 void KeywordInfoModel::toXmp(Exiv2::XmpData& xmpData) const {
   InternalLogger::debug("Writing MWG Keywords hierarchy");
 
@@ -374,12 +437,16 @@ void KeywordInfoModel::mergeKeywordIntoHierarchy(std::vector<KeywordStruct>& hie
   }
 }
 
-std::string KeywordInfoModel::buildDelimitedPaths(char delimiter) const {
+std::vector<std::string> KeywordInfoModel::toDelimitedPaths(char delimiter) const {
   std::vector<std::string> paths;
   for (const auto& keyword : Hierarchy) {
     writeHierarchicalPaths(paths, keyword, "", delimiter);
   }
-  return XmpUtils::joinStrings(paths, ',');
+  return paths;
+}
+
+std::string KeywordInfoModel::buildDelimitedPaths(char delimiter) const {
+  return XmpUtils::joinStrings(toDelimitedPaths(delimiter), ',');
 }
 
 void KeywordInfoModel::writeHierarchicalPaths(std::vector<std::string>& paths, const KeywordStruct& keyword,
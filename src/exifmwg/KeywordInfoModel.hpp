@@ -2,10 +2,14 @@
 #include <compare>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <exiv2/exiv2.hpp>
 
+#include "BinarySerializable.hpp"
+#include "Errors.hpp"
+#include "JsonSerializable.hpp"
 #include "PythonBindable.hpp"
 #include "XmpSerializable.hpp"
 
@@ -22,9 +26,19 @@ public:
                            std::optional<bool> applied = std::nullopt);
 
     // XMP serialization
-    static KeywordStruct fromXmp(const Exiv2::XmpData& xmpData, const std::string& basePath);
+    // With skipped set, child nodes without a keyword are appended to it instead of ending the children
+    static KeywordStruct fromXmp(const Exiv2::XmpData& xmpData, const std::string& basePath,
+                                 std::vector<ErrorInfo>* skipped = nullptr);
     void toXmp(Exiv2::XmpData& xmpData, const std::string& basePath) const;
 
+    // Binary serialization
+    static KeywordStruct fromBytes(std::string_view bytes);
+    std::string toBytes() const;
+
+    // JSON serialization
+    static KeywordStruct fromJson(std::string_view json);
+    std::string toJson() const;
+
     // Python bindable
     std::string to_string() const;
 
@@ -61,15 +75,27 @@ public:
   explicit KeywordInfoModel(const std::vector<std::string>& delimitedStrings, char delimiter = '/');
 
   // XMP serialization
-  static KeywordInfoModel fromXmp(const Exiv2::XmpData& xmpData);
+  // With skipped set, nodes without a keyword are appended to it instead of ending the hierarchy
+  static KeywordInfoModel fromXmp(const Exiv2::XmpData& xmpData, std::vector<ErrorInfo>* skipped = nullptr);
   void toXmp(Exiv2::XmpData& xmpData) const;
 
+  // Binary serialization
+  static KeywordInfoModel fromBytes(std::string_view bytes);
+  std::string toBytes() const;
+
+  // JSON serialization
+  static KeywordInfoModel fromJson(std::string_view json);
+  std::string toJson() const;
+
   // IPTC serialization (special case)
   // TODO:IPTC 255??
 
   // Python bindable
   std::string to_string() const;
 
+  // The applied and leaf keywords as delimited paths, the form the flat keyword tags store
+  std::vector<std::string> toDelimitedPaths(char delimiter = '/') const;
+
   // Operators
   KeywordInfoModel& operator|=(const KeywordInfoModel& other);
   KeywordInfoModel operator|(const KeywordInfoModel& other) const;
@@ -101,8 +127,12 @@ static_assert(std::copy_constructible<KeywordInfoModel::KeywordStruct>);
 static_assert(std::totally_ordered<KeywordInfoModel::KeywordStruct>, "KeywordStruct must be totally ordered!");
 static_assert(XmpSerializableWithKey<KeywordInfoModel::KeywordStruct>);
 static_assert(PythonBindableRepr<KeywordInfoModel::KeywordStruct>);
+static_assert(BinarySerializable<KeywordInfoModel::KeywordStruct>);
+static_assert(JsonSerializable<KeywordInfoModel::KeywordStruct>);
 
 static_assert(std::copy_constructible<KeywordInfoModel>);
 static_assert(std::equality_comparable<KeywordInfoModel>);
 static_assert(XmpSerializable<KeywordInfoModel>);
 static_assert(PythonBindableRepr<KeywordInfoModel>);
+static_assert(BinarySerializable<KeywordInfoModel>);
+static_assert(JsonSerializable<KeywordInfoModel>);
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <condition_variable>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "MemoryBudget.hpp"
+
+namespace {
+
+// Allowance for the parsed Exif, IPTC and XMP trees of one file
+constexpr std::uint64_t PARSED_METADATA_ESTIMATE = 256 * 1024;
+
+} // namespace
+
+MemoryBudget::MemoryBudget() : MemoryBudget(0) {
+}
+
+/**
+ * @brief Creates a budget.
+ *
+ * @param limit The bytes which may be in use at once, 0 for no limit.
+ */
+MemoryBudget::MemoryBudget(std::uint64_t limit) : m_state(std::make_shared<State>()) {
+  this->m_state->Limit = limit;
+}
+
+bool MemoryBudget::fits(const State& state, std::uint64_t bytes) noexcept {
+  return state.InUse == 0 || bytes <= state.Limit - std::min(state.InUse, state.Limit);
+}
+
+bool MemoryBudget::tryAcquire(std::uint64_t bytes) {
+  if (!this->limited()) {
+    return true;
+  }
+  std::lock_guard lock(this->m_state->Mutex);
+  if (!this->m_state->Waiters.empty() || !fits(*this->m_state, bytes)) {
+    return false;
+  }
+  this->m_state->InUse += bytes;
+  return true;
+}
+
+bool MemoryBudget::acquireOrDefer(std::uint64_t bytes, std::function<void()> onAcquired) {
+  if (!this->limited()) {
+    return true;
+  }
+  std::lock_guard lock(this->m_state->Mutex);
+  if (this->m_state->Waiters.empty() && fits(*this->m_state, bytes)) {
+    this->m_state->InUse += bytes;
+    return true;
+  }
+  this->m_state->Waiters.push_back({bytes, std::move(onAcquired)});
+  return false;
+}
+
+void MemoryBudget::acquire(std::uint64_t bytes) {
+  std::mutex mutex;
+  std::condition_variable acquired;
+  bool done = false;
+  const bool immediate = this->acquireOrDefer(bytes, [&]() {
+    std::lock_guard lock(mutex);
+    done = true;
+    acquired.notify_one();
+  });
+  if (!immediate) {
+    std::unique_lock lock(mutex);
+    acquired.wait(lock, [&done] { return done; });
+  }
+}
+
+/**
+ * @brief Returns bytes to the budget, and admits the waiting requests which now fit.
+ */
+void MemoryBudget::release(std::uint64_t bytes) {
+  if (!this->limited()) {
+    return;
+  }
+  std::vector<std::function<void()>> admitted;
+  {
+    std::lock_guard lock(this->m_state->Mutex);
+    this->m_state->InUse -= std::min(bytes, this->m_state->InUse);
+    auto& waiters = this->m_state->Waiters;
+    while (!waiters.empty() && fits(*this->m_state, waiters.front().Bytes)) {
+      this->m_state->InUse += waiters.front().Bytes;
+      admitted.push_back(std::move(waiters.front().OnAcquired));
+      waiters.pop_front();
+    }
+  }
+  // Outside the lock, a callback may acquire or release again
+  for (auto& onAcquired : admitted) {
+    onAcquired();
+  }
+}
+
+bool MemoryBudget::limited() const noexcept {
+  return this->m_state->Limit > 0;
+}
+
+std::uint64_t MemoryBudget::limit() const noexcept {
+  return this->m_state->Limit;
+}
+
+std::uint64_t MemoryBudget::inUse() const {
+  std::lock_guard lock(this->m_state->Mutex);
+  return this->m_state->InUse;
+}
+
+std::uint64_t MemoryBudget::estimateFootprint(const std::filesystem::path& path) {
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(path, ec);
+  return (ec ? 0 : static_cast<std::uint64_t>(size)) + PARSED_METADATA_ESTIMATE;
+}
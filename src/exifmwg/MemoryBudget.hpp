@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief Caps the estimated memory of the files batch operations have open at once.
+ *
+ * Copies share one budget, so a budget passed to several batches caps them together. Requests
+ * are admitted in arrival order, one which does not fit waits, and requests after it wait too
+ * so a large file is not starved by smaller ones. A request larger than the whole budget is
+ * admitted once nothing else is in use. A limit of 0 admits everything.
+ */
+class MemoryBudget {
+public:
+  MemoryBudget();
+  explicit MemoryBudget(std::uint64_t limit);
+
+  // Reserves bytes if they fit now, without waiting
+  bool tryAcquire(std::uint64_t bytes);
+  // Reserves bytes if they fit now and returns true. Otherwise returns false and queues the
+  // request, and onAcquired is called from the thread of a later release() once it is reserved.
+  bool acquireOrDefer(std::uint64_t bytes, std::function<void()> onAcquired);
+  // Blocks the calling thread until bytes are reserved. Not for pool workers.
+  void acquire(std::uint64_t bytes);
+  void release(std::uint64_t bytes);
+
+  bool limited() const noexcept;
+  std::uint64_t limit() const noexcept;
+  std::uint64_t inUse() const;
+
+  // The estimated memory of opening and parsing a file: its size, as Exiv2 may read or map all
+  // of it, plus the parsed metadata
+  static std::uint64_t estimateFootprint(const std::filesystem::path& path);
+
+private:
+  struct Waiter {
+    std::uint64_t Bytes;
+    std::function<void()> OnAcquired;
+  };
+
+  struct State {
+    std::uint64_t Limit;
+    std::uint64_t InUse = 0;
+    std::deque<Waiter> Waiters;
+    std::mutex Mutex;
+  };
+
+  std::shared_ptr<State> m_state;
+
+  static bool fits(const State& state, std::uint64_t bytes) noexcept;
+};
@@ -0,0 +1,136 @@
+#include <utility>
+
+#include "MetadataCache.hpp"
+
+namespace fs = std::filesystem;
+
+MetadataCache::MetadataCache(std::size_t capacity) : m_capacity(capacity) {
+}
+
+bool MetadataCache::enabled() const noexcept {
+  return this->m_capacity.load(std::memory_order_relaxed) > 0;
+}
+
+std::uint64_t MetadataCache::generation() const noexcept {
+  return this->m_generation.load();
+}
+
+/**
+ * @brief Returns a copy of the cached metadata of a file, if it was parsed from the same file state.
+ *
+ * An entry whose stamp no longer matches is dropped, as the file it describes is gone.
+ *
+ * @param path The image file.
+ * @param stamp The current identity of the file and its sidecar, and the read options.
+ * @return The metadata, or nothing on a miss.
+ */
+std::optional<ImageMetadata> MetadataCache::lookup(const fs::path& path, const Stamp& stamp) {
+  const std::string key = FileUtils::lookupKey(path);
+  std::lock_guard lock(this->m_mutex);
+  auto found = this->m_index.find(key);
+  if (found == this->m_index.end()) {
+    this->m_misses++;
+    return std::nullopt;
+  }
+  if (!(found->second->FileStamp == stamp)) {
+    this->m_entries.erase(found->second);
+    this->m_index.erase(found);
+    this->m_misses++;
+    return std::nullopt;
+  }
+  this->m_entries.splice(this->m_entries.begin(), this->m_entries, found->second);
+  this->m_hits++;
+  return found->second->Metadata;
+}
+
+/**
+ * @brief Caches the metadata parsed from a file, unless an invalidation happened while it was read.
+ *
+ * @param path The image file.
+ * @param stamp The identity of the file and its sidecar taken before parsing, and the read options.
+ * @param generation The generation() read before the stamp was taken.
+ * @param metadata The parsed metadata.
+ */
+void MetadataCache::store(const fs::path& path, const Stamp& stamp, std::uint64_t generation,
+                          const ImageMetadata& metadata) {
+  if (!this->enabled()) {
+    return;
+  }
+  const std::string key = FileUtils::lookupKey(path);
+  std::lock_guard lock(this->m_mutex);
+  // A write may have finished between the stamp and the parse, in the same timestamp tick
+  if (this->m_generation.load() != generation) {
+    return;
+  }
+  auto found = this->m_index.find(key);
+  if (found != this->m_index.end()) {
+    this->m_entries.erase(found->second);
+    this->m_index.erase(found);
+  }
+  this->m_entries.push_front(Entry{key, stamp, metadata});
+  this->m_index.emplace(key, this->m_entries.begin());
+  this->evictBeyond(this->m_capacity.load());
+}
+
+void MetadataCache::invalidate(const fs::path& path) {
+  if (!this->enabled()) {
+    return;
+  }
+  const std::string key = FileUtils::lookupKey(path);
+  std::lock_guard lock(this->m_mutex);
+  this->m_generation++;
+  auto found = this->m_index.find(key);
+  if (found != this->m_index.end()) {
+    this->m_entries.erase(found->second);
+    this->m_index.erase(found);
+  }
+}
+
+void MetadataCache::clear() {
+  std::lock_guard lock(this->m_mutex);
+  this->m_generation++;
+  this->m_entries.clear();
+  this->m_index.clear();
+}
+
+void MetadataCache::resize(std::size_t capacity) {
+  std::lock_guard lock(this->m_mutex);
+  this->m_capacity = capacity;
+  this->evictBeyond(capacity);
+}
+
+void MetadataCache::evictBeyond(std::size_t capacity) {
+  while (this->m_entries.size() > capacity) {
+    this->m_index.erase(this->m_entries.back().Key);
+    this->m_entries.pop_back();
+    this->m_evictions++;
+  }
+}
+
+MetadataCacheStats MetadataCache::stats() const {
+  std::lock_guard lock(this->m_mutex);
+  MetadataCacheStats stats;
+  stats.Capacity = this->m_capacity.load();
+  stats.Entries = this->m_entries.size();
+  stats.Hits = this->m_hits;
+  stats.Misses = this->m_misses;
+  stats.Evictions = this->m_evictions;
+  return stats;
+}
+
+MetadataCache& MetadataCache::shared() {
+  static MetadataCache cache;
+  return cache;
+}
+
+void MetadataCache::configureShared(std::size_t capacity) {
+  shared().resize(capacity);
+}
+
+MetadataCacheStats MetadataCache::sharedStats() {
+  return shared().stats();
+}
+
+void MetadataCache::clearShared() {
+  shared().clear();
+}
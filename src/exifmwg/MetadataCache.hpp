@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "FileUtils.hpp"
+#include "ImageMetadata.hpp"
+#include "ReadOptions.hpp"
+
+/**
+ * @brief A snapshot of the counters of a MetadataCache.
+ */
+struct MetadataCacheStats {
+  std::size_t Capacity = 0;
+  std::size_t Entries = 0;
+  std::uint64_t Hits = 0;
+  // Lookups with no entry, or an entry for a file which has changed since
+  std::uint64_t Misses = 0;
+  std::uint64_t Evictions = 0;
+};
+
+/**
+ * @brief Remembers the metadata parsed from recently read files, least recently used first out.
+ *
+ * An entry is only returned while the file, and its sidecar when the read options use one, still
+ * has the identity a single stat saw before it was parsed. A file changed by any other process
+ * therefore misses, and every write made through this library also invalidates its entry, so a
+ * change within the timestamp granularity of the filesystem is not missed either. Failed reads
+ * are not cached. A capacity of 0 disables the cache.
+ */
+class MetadataCache {
+public:
+  // What a cached read depends on, as seen before the file was parsed
+  struct Stamp {
+    FileUtils::FileIdentity Image;
+    std::optional<FileUtils::FileIdentity> Sidecar;
+    SidecarPolicy Policy = SidecarPolicy::Ignore;
+    bool Lenient = false;
+
+    bool operator==(const Stamp&) const = default;
+  };
+
+  explicit MetadataCache(std::size_t capacity = 0);
+
+  MetadataCache(const MetadataCache&) = delete;
+  MetadataCache& operator=(const MetadataCache&) = delete;
+
+  bool enabled() const noexcept;
+  // Read before stamping a file. An entry is only stored if nothing was invalidated since.
+  std::uint64_t generation() const noexcept;
+
+  // A copy of the entry for the file if its stamp still matches
+  std::optional<ImageMetadata> lookup(const std::filesystem::path& path, const Stamp& stamp);
+  void store(const std::filesystem::path& path, const Stamp& stamp, std::uint64_t generation,
+             const ImageMetadata& metadata);
+  // Drops the entry of a file which is about to be, or has been, written
+  void invalidate(const std::filesystem::path& path);
+  void clear();
+  // Evicts the least recently used entries beyond the new capacity. 0 disables the cache.
+  void resize(std::size_t capacity);
+
+  MetadataCacheStats stats() const;
+
+  // The cache in front of every ImageMetadata read, disabled until configureShared() sizes it
+  static MetadataCache& shared();
+  static void configureShared(std::size_t capacity);
+  static MetadataCacheStats sharedStats();
+  static void clearShared();
+
+private:
+  struct Entry {
+    std::string Key;
+    Stamp FileStamp;
+    ImageMetadata Metadata;
+  };
+
+  // Most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+  std::atomic<std::size_t> m_capacity;
+  std::atomic<std::uint64_t> m_generation{0};
+  std::uint64_t m_hits = 0;
+  std::uint64_t m_misses = 0;
+  std::uint64_t m_evictions = 0;
+  mutable std::mutex m_mutex;
+
+  void evictBeyond(std::size_t capacity);
+};
@@ -32,6 +32,10 @@ constexpr const char* Description = "Xmp.dc.description";
 constexpr const char* IptcCountryName = "Xmp.iptc.CountryName";
 constexpr const char* IptcLocation = "Xmp.iptc.Location";
 
+// TIFF (mapped to XMP), used for the orientation in sidecars
+// https://exiv2.org/tags-xmp-tiff.html
+constexpr const char* TiffOrientation = "Xmp.tiff.Orientation";
+
 // Photoshop
 // https://exiv2.org/tags-xmp-photoshop.html
 constexpr const char* PhotoshopCity = "Xmp.photoshop.City";
@@ -0,0 +1,153 @@
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <exiv2/exiv2.hpp>
+
+#include "BoundedQueue.hpp"
+#include "Logging.hpp"
+#include "MetadataPipeline.hpp"
+#include "ThreadPool.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Sent from a pool task to the coordinator when a stage of a file completes
+struct PipelineEvent {
+  std::size_t Index;
+  // Set once the file was read, nothing once it was written
+  std::optional<ImageMetadata> Metadata;
+};
+
+} // namespace
+
+/**
+ * @brief Configures the pipeline.
+ *
+ * @param window How many files may be in flight at once, which bounds the memory in use.
+ * @param options The options for every write.
+ * @param memory Each file reserves its estimated footprint from it, from before it is read until
+ *               it is written or dropped. Unlimited by default.
+ */
+MetadataPipeline::MetadataPipeline(std::size_t window, const WriteOptions& options, const MemoryBudget& memory) :
+    m_window(window > 0 ? window : 1), m_options(options), m_memory(memory) {
+}
+
+std::size_t MetadataPipeline::window() const noexcept {
+  return this->m_window;
+}
+
+const MemoryBudget& MetadataPipeline::memory() const noexcept {
+  return this->m_memory;
+}
+
+/**
+ * @brief Runs every path through read, transform and write.
+ *
+ * Files which fail to read are not transformed, and files the transform declines are not
+ * written. A failure in any stage is recorded in the result of that file, nothing is thrown.
+ *
+ * @param paths The files to process.
+ * @param transform Called on this thread for each file which was read.
+ * @return One result per path, in the order of the paths.
+ */
+std::vector<FileResult> MetadataPipeline::run(const std::vector<fs::path>& paths, const Transform& transform) const {
+  std::vector<FileResult> results(paths.size());
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    results[i].Path = paths[i];
+  }
+  if (paths.empty()) {
+    return results;
+  }
+
+  // The XMP toolkit must be initialized before it is used from several threads
+  Exiv2::XmpParser::initialize();
+
+  auto pool = ThreadPool::shared();
+  // Each in-flight file has at most one unconsumed event, so pushes from pool tasks never block
+  BoundedQueue<PipelineEvent> events(this->m_window);
+  // Each result is only touched by the stage currently holding its file
+  std::size_t nextPath = 0;
+  std::size_t inFlight = 0;
+  std::size_t written = 0;
+  // The bytes reserved from the memory budget by each file in flight
+  std::vector<std::uint64_t> reserved(paths.size(), 0);
+  auto finish = [&](std::size_t index) {
+    --inFlight;
+    this->m_memory.release(reserved[index]);
+  };
+
+  auto submitRead = [&](std::size_t index) {
+    pool->submit([&, index]() {
+      PipelineEvent event{index, std::nullopt};
+      // The coordinator waits for an event from every file, so one is pushed whatever is thrown
+      try {
+        auto metadata = ImageMetadata::tryRead(paths[index]);
+        if (metadata) {
+          event.Metadata = std::move(metadata).value();
+        } else {
+          results[index].Error = metadata.error();
+        }
+      } catch (...) {
+        event.Metadata = std::nullopt;
+        results[index].Error = currentErrorInfo(paths[index]);
+      }
+      events.push(std::move(event));
+    });
+  };
+  auto submitWrite = [&](std::size_t index, ImageMetadata metadata) {
+    pool->submit([&, index, metadata = std::move(metadata)]() {
+      try {
+        metadata.toFile(std::nullopt, this->m_options);
+      } catch (...) {
+        results[index].Error = currentErrorInfo(paths[index]);
+      }
+      events.push({index, std::nullopt});
+    });
+  };
+
+  InternalLogger::debug("Pipeline over " + std::to_string(paths.size()) + " files with a window of " +
+                        std::to_string(this->m_window));
+  while (nextPath < paths.size() || inFlight > 0) {
+    while (nextPath < paths.size() && inFlight < this->m_window) {
+      if (this->m_memory.limited()) {
+        const std::uint64_t bytes = MemoryBudget::estimateFootprint(paths[nextPath]);
+        if (inFlight == 0) {
+          // None of this run's files would release memory, so waiting on events cannot help
+          this->m_memory.acquire(bytes);
+        } else if (!this->m_memory.tryAcquire(bytes)) {
+          break;
+        }
+        reserved[nextPath] = bytes;
+      }
+      submitRead(nextPath++);
+      ++inFlight;
+    }
+
+    auto event = events.pop();
+    if (!event->Metadata.has_value()) {
+      // Written, or failed to read
+      finish(event->Index);
+      continue;
+    }
+
+    const std::size_t index = event->Index;
+    bool write = false;
+    try {
+      write = transform(event->Metadata.value());
+    } catch (...) {
+      results[index].Error = currentErrorInfo(paths[index]);
+    }
+    if (write) {
+      submitWrite(index, std::move(event->Metadata.value()));
+      ++written;
+    } else {
+      finish(index);
+    }
+  }
+
+  InternalLogger::debug("Pipeline wrote " + std::to_string(written) + " files");
+  return results;
+}
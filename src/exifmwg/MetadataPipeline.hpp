@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+#include "Batch.hpp"
+#include "ImageMetadata.hpp"
+#include "MemoryBudget.hpp"
+#include "WriteOptions.hpp"
+
+/**
+ * @brief Reads, transforms and writes back many files, with the three stages running concurrently.
+ *
+ * The thread which calls run() coordinates: it submits reads to the shared thread pool, runs
+ * the transform on each file as its read completes, and submits the changed files back to the
+ * pool to be written. Reading and writing therefore overlap the transform. Pool tasks never
+ * block, at most `window` files are between being submitted for reading and being finished,
+ * and with a limited memory budget a file is only submitted once its footprint fits.
+ */
+class MetadataPipeline {
+public:
+  // Modifies the metadata in place, and returns whether it should be written back
+  using Transform = std::function<bool(ImageMetadata&)>;
+
+  explicit MetadataPipeline(std::size_t window = 64, const WriteOptions& options = {},
+                            const MemoryBudget& memory = MemoryBudget());
+
+  std::vector<FileResult> run(const std::vector<std::filesystem::path>& paths, const Transform& transform) const;
+
+  std::size_t window() const noexcept;
+  const MemoryBudget& memory() const noexcept;
+
+private:
+  std::size_t m_window;
+  WriteOptions m_options;
+  // Shares its state with the budget passed in, so run() can reserve from a const pipeline
+  mutable MemoryBudget m_memory;
+};
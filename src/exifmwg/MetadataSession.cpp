@@ -0,0 +1,351 @@
+#include <cstdint>
+#include <string>
+
+#include "Errors.hpp"
+#include "FileUtils.hpp"
+#include "Logging.hpp"
+#include "MetadataCache.hpp"
+#include "MetadataKeys.hpp"
+#include "MetadataSession.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Generous upper bound of the <?xpacket ... ?> header and trailer around the serialized XMP
+constexpr std::size_t XMP_WRAPPER_SIZE = 128;
+
+/**
+ * @brief Whether a staged field is set and differs from what is stored.
+ */
+template <typename T> bool isChanged(const std::optional<T>& staged, const std::optional<T>& stored) {
+  return staged.has_value() && staged != stored;
+}
+
+/**
+ * @brief Writes the in-memory metadata of an image through Exiv2.
+ *
+ * With padding requested, the XMP packet is serialized here with that much whitespace
+ * reserved, and Exiv2 is told to write the packet as-is.
+ *
+ * @throws Exiv2Error if Exiv2 fails to write the file
+ */
+void writeImage(Exiv2::Image& image, const WriteOptions& options) {
+  const bool padded = options.XmpPadding > 0 && !image.xmpData().empty();
+  try {
+    if (padded) {
+      std::string packet;
+      if (Exiv2::XmpParser::encode(packet, image.xmpData(), Exiv2::XmpParser::useCompactFormat,
+                                   options.XmpPadding) != 0) {
+        throw Exiv2Error("Unable to encode XMP packet for " + image.io().path());
+      }
+      image.setXmpPacket(packet);
+      image.writeXmpFromPacket(true);
+      image.xmpData().usePacket(true);
+    }
+    image.writeMetadata();
+  } catch (const Exiv2::Error& e) {
+    image.writeXmpFromPacket(false);
+    image.xmpData().usePacket(false);
+    throw Exiv2Error("Exiv2 error while writing: " + std::string(e.what()));
+  }
+  if (padded) {
+    // Later stages must be serialized from the XMP data again
+    image.writeXmpFromPacket(false);
+    image.xmpData().usePacket(false);
+  }
+}
+
+} // namespace
+
+/**
+ * @brief Opens the image and parses all of its metadata.
+ *
+ * @param path The image file to open.
+ * @throws FileAccessError if the path is not an existing regular file
+ * @throws Exiv2Error if Exiv2 is unable to open or parse the file
+ */
+MetadataSession::MetadataSession(const fs::path& path) : m_path(path) {
+  if (!fs::exists(path) || !fs::is_regular_file(path)) {
+    throw FileAccessError("File does not exist: " + path.string());
+  }
+  try {
+    this->m_image = Exiv2::ImageFactory::open(path.string());
+    this->m_image->readMetadata();
+  } catch (const Exiv2::Error& e) {
+    throw Exiv2Error("Exiv2 error while reading: " + std::string(e.what()));
+  }
+  this->scanLayout();
+}
+
+const fs::path& MetadataSession::path() const noexcept {
+  return this->m_path;
+}
+
+/**
+ * @brief Whether changes have been staged which are not yet committed.
+ */
+bool MetadataSession::isDirty() const noexcept {
+  return this->m_dirty;
+}
+
+/**
+ * @brief Builds an ImageMetadata from the metadata parsed when the session was opened.
+ *
+ * Any staged changes are reflected, as they are applied to the same in-memory metadata.
+ *
+ * @param lenient Whether malformed regions and keywords are skipped and recorded in Diagnostics.
+ * @return The metadata, with its original path set to this session's file.
+ * @throws Exiv2Error if a value cannot be converted
+ * @throws InvalidStructureError if a region structure is malformed
+ */
+ImageMetadata MetadataSession::read(bool lenient) const {
+  return this->tryRead(lenient).value();
+}
+
+/**
+ * @brief Builds an ImageMetadata like read(), returning any failure as an error value.
+ *
+ * @param lenient Whether malformed regions and keywords are skipped and recorded in Diagnostics.
+ * @return The metadata, or the error read() would throw, with its path set to this session's file.
+ */
+Result<ImageMetadata> MetadataSession::tryRead(bool lenient) const {
+  ImageMetadata metadata;
+  metadata.m_originalPath = this->m_path;
+  try {
+    if (auto error = metadata.readFromImage(*this->m_image, lenient)) {
+      error->Path = this->m_path;
+      return *error;
+    }
+  } catch (const Exiv2::Error& e) {
+    return ErrorInfo{ErrorCode::Exiv2, "Exiv2 error while reading: " + std::string(e.what()), this->m_path};
+  }
+  for (auto& diagnostic : metadata.Diagnostics) {
+    diagnostic.Path = this->m_path;
+  }
+  return metadata;
+}
+
+/**
+ * @brief Applies the set fields of the given metadata to the in-memory image metadata.
+ *
+ * Nothing touches the disk until commit() is called. Staging may be repeated, later values win.
+ *
+ * @param metadata The metadata to apply.
+ * @throws Exiv2Error if a value cannot be set
+ */
+void MetadataSession::stage(const ImageMetadata& metadata) {
+  this->trackChanges(metadata);
+  try {
+    metadata.writeToImage(*this->m_image);
+  } catch (const Exiv2::Error& e) {
+    throw Exiv2Error("Exiv2 error while writing: " + std::string(e.what()));
+  }
+  this->m_dirty = true;
+}
+
+/**
+ * @brief Removes every field this library manages in memory. Nothing is written until commit() is called.
+ */
+void MetadataSession::clear() {
+  ImageMetadata::clearFromImage(*this->m_image);
+  // Removing data is never patched in place
+  this->m_requiresRewrite = true;
+  this->m_dirty = true;
+}
+
+/**
+ * @brief Writes the staged metadata to the file.
+ *
+ * A session without staged changes does not touch the file. Changes are patched in place
+ * when possible, otherwise the file is fully rewritten by Exiv2.
+ *
+ * @param options Padding, in-place, atomicity and durability behaviour for the write.
+ * @throws Exiv2Error if Exiv2 fails to write the file
+ * @throws FileAccessError if the temporary copy, rename or sync fails
+ */
+void MetadataSession::commit(const WriteOptions& options) {
+  if (!this->m_dirty) {
+    InternalLogger::debug("Nothing staged for " + this->m_path.string() + ", skipping write");
+    return;
+  }
+
+  try {
+    // Patches are made directly to the file, which an atomic write must not do
+    if (options.Atomic || this->m_requiresRewrite || !this->patchInPlace(options)) {
+      this->rewrite(options);
+    }
+    if (!options.Atomic) {
+      FileUtils::syncFile(this->m_path, options.Durability);
+    }
+  } catch (...) {
+    // A failed write may still have changed the file
+    MetadataCache::shared().invalidate(this->m_path);
+    throw;
+  }
+  MetadataCache::shared().invalidate(this->m_path);
+
+  this->m_pendingOrientation = std::nullopt;
+  this->m_xmpChanged = false;
+  this->m_requiresRewrite = false;
+  this->m_dirty = false;
+}
+
+/**
+ * @brief Locates the in-place patchable values and records what is currently stored in them.
+ */
+void MetadataSession::scanLayout() {
+  this->m_layout = FileLayout::scan(this->m_path);
+  this->m_diskOrientation = std::nullopt;
+  if (!this->m_layout.OrientationOffset.has_value()) {
+    return;
+  }
+  const auto& exifData = this->m_image->exifData();
+  auto orientKey = exifData.findKey(Exiv2::ExifKey(MetadataKeys::Exif::Orientation));
+  if (orientKey != exifData.end()) {
+    this->m_diskOrientation = orientation_from_exif_value(static_cast<int>(orientKey->toInt64()));
+  }
+}
+
+/**
+ * @brief Records which parts of the file staging this metadata changes.
+ */
+void MetadataSession::trackChanges(const ImageMetadata& metadata) {
+  if (this->m_requiresRewrite) {
+    return;
+  }
+  if (!this->m_diskOrientation.has_value() && !this->m_layout.XmpPacketOffset.has_value()) {
+    // Nothing can be patched, so any change is a rewrite
+    this->m_requiresRewrite = true;
+    return;
+  }
+
+  // Staging must work on files a strict read rejects, such as after a lenient read
+  const auto read = this->tryRead(true);
+  if (!read.ok() || !read.value().Diagnostics.empty()) {
+    // The diff cannot see what was skipped, so write everything
+    this->m_requiresRewrite = true;
+    return;
+  }
+  const ImageMetadata& current = read.value();
+
+  // These are mirrored into IPTC, which is never patched
+  if (isChanged(metadata.Description, current.Description) || isChanged(metadata.Country, current.Country) ||
+      isChanged(metadata.City, current.City) || isChanged(metadata.State, current.State) ||
+      isChanged(metadata.Location, current.Location)) {
+    this->m_requiresRewrite = true;
+    return;
+  }
+  if (isChanged(metadata.Title, current.Title) || isChanged(metadata.RegionInfo, current.RegionInfo) ||
+      isChanged(metadata.KeywordInfo, current.KeywordInfo)) {
+    this->m_xmpChanged = true;
+  }
+  if (isChanged(metadata.Orientation, current.Orientation)) {
+    this->m_pendingOrientation = metadata.Orientation;
+  }
+}
+
+/**
+ * @brief Applies the tracked changes without moving any data in the file.
+ *
+ * @return false if some change could not be patched, the caller must then rewrite the file.
+ */
+bool MetadataSession::patchInPlace(const WriteOptions& options) {
+  if (this->m_pendingOrientation.has_value() && !this->m_diskOrientation.has_value()) {
+    return false;
+  }
+  if (this->m_xmpChanged && (!options.InPlaceXmp || !this->patchXmp())) {
+    return false;
+  }
+  if (this->m_pendingOrientation.has_value()) {
+    if (!this->m_layout.patchOrientation(this->m_path, this->m_diskOrientation.value(),
+                                         this->m_pendingOrientation.value())) {
+      return false;
+    }
+    InternalLogger::debug("Patched orientation in place for " + this->m_path.string());
+    this->m_diskOrientation = this->m_pendingOrientation;
+  }
+  if (!this->m_xmpChanged && !this->m_pendingOrientation.has_value()) {
+    InternalLogger::debug("Staged metadata matches " + this->m_path.string() + ", skipping write");
+  }
+  return true;
+}
+
+/**
+ * @brief Serializes the in-memory XMP to exactly the size of the packet on disk and overwrites it.
+ */
+bool MetadataSession::patchXmp() {
+  if (!this->m_layout.XmpPacketOffset.has_value()) {
+    return false;
+  }
+  const auto& xmpData = this->m_image->xmpData();
+  const auto length = static_cast<std::size_t>(this->m_layout.XmpPacketLength);
+  std::string packet;
+  try {
+    // An exact length encode which does not fit is a toolkit error, so check the unwrapped size first
+    if (Exiv2::XmpParser::encode(packet, xmpData,
+                                 Exiv2::XmpParser::useCompactFormat | Exiv2::XmpParser::omitPacketWrapper) != 0 ||
+        packet.size() + XMP_WRAPPER_SIZE > length) {
+      return false;
+    }
+    if (Exiv2::XmpParser::encode(packet, xmpData,
+                                 Exiv2::XmpParser::useCompactFormat | Exiv2::XmpParser::exactPacketLength,
+                                 static_cast<std::uint32_t>(length)) != 0) {
+      return false;
+    }
+  } catch (const Exiv2::Error& e) {
+    InternalLogger::debug("Unable to encode an in place XMP packet: " + std::string(e.what()));
+    return false;
+  }
+  if (!this->m_layout.patchXmpPacket(this->m_path, packet)) {
+    return false;
+  }
+  InternalLogger::debug("Patched XMP packet in place for " + this->m_path.string());
+  return true;
+}
+
+/**
+ * @brief Writes all in-memory metadata through Exiv2, which rewrites the whole file.
+ *
+ * With the atomic option, the rewrite happens on a copy next to the file, which then replaces it.
+ */
+void MetadataSession::rewrite(const WriteOptions& options) {
+  if (options.Atomic) {
+    this->rewriteAtomically(options);
+  } else {
+    writeImage(*this->m_image, options);
+  }
+  // The file structure may have moved
+  this->scanLayout();
+}
+
+/**
+ * @brief Writes the metadata into a temporary copy of the file and renames it over the file.
+ *
+ * A failure at any point leaves the original file untouched and removes the copy.
+ */
+void MetadataSession::rewriteAtomically(const WriteOptions& options) {
+  const fs::path tempPath = FileUtils::temporaryPathFor(this->m_path);
+  try {
+    // A copy failing partway has already created the temporary file
+    FileUtils::copyFile(this->m_path, tempPath, false);
+
+    Exiv2::Image::UniquePtr temp;
+    try {
+      temp = Exiv2::ImageFactory::open(tempPath.string());
+      temp->readMetadata();
+      temp->setMetadata(*this->m_image);
+    } catch (const Exiv2::Error& e) {
+      throw Exiv2Error("Exiv2 error while writing: " + std::string(e.what()));
+    }
+    writeImage(*temp, options);
+    // Closes the copy before it is synced and renamed
+    temp.reset();
+    FileUtils::syncFile(tempPath, options.Durability);
+    FileUtils::replaceFile(tempPath, this->m_path, options.Durability);
+  } catch (...) {
+    std::error_code ec;
+    fs::remove(tempPath, ec);
+    throw;
+  }
+}
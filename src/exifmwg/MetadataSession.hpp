@@ -0,0 +1,68 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+
+#include <exiv2/exiv2.hpp>
+
+#include "FileLayout.hpp"
+#include "ImageMetadata.hpp"
+#include "Orientation.hpp"
+#include "Result.hpp"
+#include "WriteOptions.hpp"
+
+/**
+ * @brief Keeps one opened Exiv2 image alive across a read-modify-write cycle.
+ *
+ * The file is opened and parsed exactly once, when the session is constructed. The parsed
+ * Exif, IPTC and XMP stay in memory, so reading, staging changes and committing them does
+ * not pay for a second parse of the file.
+ *
+ * Changes which do not require moving any data are patched in place on commit():
+ *  - the orientation, when the file stores it as an inline SHORT
+ *  - XMP-only fields (title, regions, keywords), when the new packet fits the existing one
+ * Anything else is a full rewrite. Fields which are equal to what is already stored do not
+ * count as changes.
+ *
+ * ImageMetadata(path) followed by toFile() does not share a session, each opens and parses the
+ * file on its own. Only a read-modify-write made through one session parses the file once.
+ */
+class MetadataSession {
+public:
+  explicit MetadataSession(const std::filesystem::path& path);
+
+  // The opened image is owned exclusively
+  MetadataSession(const MetadataSession&) = delete;
+  MetadataSession& operator=(const MetadataSession&) = delete;
+  MetadataSession(MetadataSession&&) noexcept = default;
+  MetadataSession& operator=(MetadataSession&&) noexcept = default;
+  ~MetadataSession() = default;
+
+  const std::filesystem::path& path() const noexcept;
+  bool isDirty() const noexcept;
+
+  ImageMetadata read(bool lenient = false) const;
+  Result<ImageMetadata> tryRead(bool lenient = false) const;
+  void stage(const ImageMetadata& metadata);
+  void clear();
+  void commit(const WriteOptions& options = {});
+
+private:
+  std::filesystem::path m_path;
+  Exiv2::Image::UniquePtr m_image;
+  bool m_dirty = false;
+
+  // In-place patching state
+  FileLayout m_layout;
+  std::optional<ExifOrientation> m_diskOrientation;
+  std::optional<ExifOrientation> m_pendingOrientation;
+  bool m_xmpChanged = false;
+  bool m_requiresRewrite = false;
+
+  void scanLayout();
+  void trackChanges(const ImageMetadata& metadata);
+  bool patchInPlace(const WriteOptions& options);
+  bool patchXmp();
+  void rewrite(const WriteOptions& options);
+  void rewriteAtomically(const WriteOptions& options);
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 enum class ExifOrientation : int {
   // Set but not a valid value
   Undefined = 0,
@@ -83,3 +85,31 @@ constexpr const char* orientation_to_string(ExifOrientation orientation) noexcep
     return "Unknown";
   }
 }
+
+// ORIENTATION_COMPOSITION[a][b] displays the stored image like orientation a followed by orientation b, by
+// EXIF value. The 8 orientations are the dihedral group of a rectangle, Undefined acts as Horizontal.
+inline constexpr std::array<std::array<int, 9>, 9> ORIENTATION_COMPOSITION = {{
+    {1, 1, 2, 3, 4, 5, 6, 7, 8},
+    {1, 1, 2, 3, 4, 5, 6, 7, 8},
+    {2, 2, 1, 4, 3, 8, 7, 6, 5},
+    {3, 3, 4, 1, 2, 7, 8, 5, 6},
+    {4, 4, 3, 2, 1, 6, 5, 8, 7},
+    {5, 5, 6, 7, 8, 1, 2, 3, 4},
+    {6, 6, 5, 8, 7, 4, 3, 2, 1},
+    {7, 7, 8, 5, 6, 3, 4, 1, 2},
+    {8, 8, 7, 6, 5, 2, 1, 4, 3},
+}};
+
+// The orientation which displays the stored image as orientation does, then rotated or flipped by operation
+constexpr ExifOrientation orientation_compose(ExifOrientation orientation, ExifOrientation operation) noexcept {
+  const int first = orientation_to_int(orientation_from_int(orientation_to_int(orientation)));
+  const int second = orientation_to_int(orientation_from_int(orientation_to_int(operation)));
+  return static_cast<ExifOrientation>(ORIENTATION_COMPOSITION[first][second]);
+}
+
+static_assert(orientation_compose(ExifOrientation::Rotate90CW, ExifOrientation::Rotate90CW) ==
+              ExifOrientation::Rotate180);
+static_assert(orientation_compose(ExifOrientation::Rotate90CW, ExifOrientation::Rotate270CW) ==
+              ExifOrientation::Horizontal);
+static_assert(orientation_compose(ExifOrientation::MirrorHorizontal, ExifOrientation::Rotate90CW) ==
+              ExifOrientation::MirrorHorizontalAndRotate90CW);
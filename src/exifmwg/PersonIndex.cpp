@@ -0,0 +1,113 @@
+#include <algorithm>
+
+#include "Batch.hpp"
+#include "FileUtils.hpp"
+#include "PersonIndex.hpp"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Indexes the regions of an image by name, replacing what was indexed for it before.
+ *
+ * Regions with an empty name are not indexed. An image without named regions is removed.
+ *
+ * @param image The image the regions belong to.
+ * @param regions The regions of the image.
+ */
+void PersonIndex::add(const fs::path& image, const RegionInfoStruct& regions) {
+  this->remove(image);
+
+  const std::string key = FileUtils::lookupKey(image);
+  std::vector<std::string> names;
+  for (std::size_t position = 0; position < regions.RegionList.size(); position++) {
+    const auto& region = regions.RegionList[position];
+    if (region.Name.empty()) {
+      continue;
+    }
+    this->m_names[region.Name][key].push_back(Posting{position, region.Type});
+    names.push_back(region.Name);
+  }
+  if (names.empty()) {
+    return;
+  }
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  this->m_images.emplace(key, IndexedImage{image, std::move(names)});
+}
+
+/**
+ * @brief Indexes the results of a batch read.
+ *
+ * @param results The results, such as from Batch::readMany. A file read without regions is removed,
+ *                a file which could not be read keeps what was indexed for it.
+ */
+void PersonIndex::add(const std::vector<ReadResult>& results) {
+  for (const auto& result : results) {
+    if (!result.ok() || !result.Metadata.has_value()) {
+      continue;
+    }
+    if (result.Metadata->RegionInfo.has_value()) {
+      this->add(result.Path, result.Metadata->RegionInfo.value());
+    } else {
+      this->remove(result.Path);
+    }
+  }
+}
+
+void PersonIndex::remove(const fs::path& image) {
+  auto indexed = this->m_images.find(FileUtils::lookupKey(image));
+  if (indexed == this->m_images.end()) {
+    return;
+  }
+  for (const auto& name : indexed->second.Names) {
+    auto postings = this->m_names.find(name);
+    postings->second.erase(indexed->first);
+    if (postings->second.empty()) {
+      this->m_names.erase(postings);
+    }
+  }
+  this->m_images.erase(indexed);
+}
+
+std::size_t PersonIndex::size() const noexcept {
+  return this->m_names.size();
+}
+
+std::size_t PersonIndex::imageCount() const noexcept {
+  return this->m_images.size();
+}
+
+std::vector<std::string> PersonIndex::names(const std::optional<std::string>& type) const {
+  std::vector<std::string> found;
+  for (const auto& [name, images] : this->m_names) {
+    const bool matches = !type.has_value() || std::any_of(images.begin(), images.end(), [&](const auto& image) {
+                           return std::any_of(image.second.begin(), image.second.end(),
+                                              [&](const Posting& posting) { return posting.Type == *type; });
+                         });
+    if (matches) {
+      found.push_back(name);
+    }
+  }
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+std::vector<PersonOccurrence> PersonIndex::find(const std::string& name, const std::optional<std::string>& type) const {
+  auto postings = this->m_names.find(name);
+  if (postings == this->m_names.end()) {
+    return {};
+  }
+  std::vector<PersonOccurrence> found;
+  for (const auto& [key, regions] : postings->second) {
+    PersonOccurrence occurrence{this->m_images.at(key).Path, {}};
+    for (const auto& posting : regions) {
+      if (!type.has_value() || posting.Type == *type) {
+        occurrence.Positions.push_back(posting.Position);
+      }
+    }
+    if (!occurrence.Positions.empty()) {
+      found.push_back(std::move(occurrence));
+    }
+  }
+  return found;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "RegionInfoStruct.hpp"
+
+struct ReadResult;
+
+/**
+ * @brief The regions of one image which carry a name.
+ */
+struct PersonOccurrence {
+  std::filesystem::path Image;
+  // The positions of the regions in the RegionList of the image, ascending
+  std::vector<std::size_t> Positions;
+};
+
+/**
+ * @brief An inverted index from region names to the images and regions which carry them.
+ *
+ * Built incrementally: adding an image again replaces what was indexed for it, so the results
+ * of a later batch read of changed files can be added on top. Images are keyed by their absolute,
+ * normalized path, so "a.jpg" and "./a.jpg" are the same image. Looking a name up does not touch
+ * the files. Not thread safe, concurrent reads of a const index are.
+ */
+class PersonIndex {
+public:
+  // Replaces the regions indexed for image
+  void add(const std::filesystem::path& image, const RegionInfoStruct& regions);
+  // Adds each successful read, files read without regions are removed. Failed reads are skipped.
+  void add(const std::vector<ReadResult>& results);
+  void remove(const std::filesystem::path& image);
+
+  // The number of distinct names
+  std::size_t size() const noexcept;
+  std::size_t imageCount() const noexcept;
+
+  // Every name, sorted, only those of regions of type when given
+  std::vector<std::string> names(const std::optional<std::string>& type = std::nullopt) const;
+  // The images with a region of name, sorted by path, only regions of type when given
+  std::vector<PersonOccurrence> find(const std::string& name,
+                                     const std::optional<std::string>& type = std::nullopt) const;
+
+private:
+  struct Posting {
+    std::size_t Position;
+    std::string Type;
+  };
+
+  struct IndexedImage {
+    // The path the image was last added with
+    std::filesystem::path Path;
+    // The names indexed for the image, to replace or remove them
+    std::vector<std::string> Names;
+  };
+
+  // Name to the lookup key of each image to the regions with that name
+  std::unordered_map<std::string, std::map<std::string, std::vector<Posting>>> m_names;
+  // Images by FileUtils::lookupKey, so every spelling of a path is the same image
+  std::map<std::string, IndexedImage> m_images;
+};
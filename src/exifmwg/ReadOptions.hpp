@@ -0,0 +1,23 @@
+#pragma once
+
+/**
+ * @brief How an XMP sidecar next to the image is combined with the embedded metadata.
+ */
+enum class SidecarPolicy {
+  // The sidecar is never read
+  Ignore,
+  // Fields set in the sidecar replace the embedded ones, the rest come from the image
+  Merge,
+  // Every field comes from the sidecar when one exists, only the dimensions come from the image
+  Authoritative,
+};
+
+/**
+ * @brief Options controlling how ImageMetadata reads a file.
+ */
+struct ReadOptions {
+  SidecarPolicy Sidecar = SidecarPolicy::Ignore;
+  // Skip malformed regions and keyword nodes, recording them in ImageMetadata::Diagnostics,
+  // instead of failing the whole read
+  bool Lenient = false;
+};
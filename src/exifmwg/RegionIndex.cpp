@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "Errors.hpp"
+#include "RegionIndex.hpp"
+
+namespace {
+
+// The intersection over union of two boxes, 0 when either is empty
+double overlapRatio(double leftA, double topA, double rightA, double bottomA, double leftB, double topB, double rightB,
+                    double bottomB) noexcept {
+  const double width = std::min(rightA, rightB) - std::max(leftA, leftB);
+  const double height = std::min(bottomA, bottomB) - std::max(topA, topB);
+  if (width <= 0.0 || height <= 0.0) {
+    return 0.0;
+  }
+  const double intersection = width * height;
+  const double combined = (rightA - leftA) * (bottomA - topA) + (rightB - leftB) * (bottomB - topB) - intersection;
+  return combined > 0.0 ? intersection / combined : 0.0;
+}
+
+} // namespace
+
+/**
+ * @brief Creates an empty index.
+ *
+ * @param cellsPerSide The grid resolution along each axis. Finer grids test fewer regions per query
+ *                     but record large regions in more cells. Cells are only allocated once a region
+ *                     touches them, so an empty index is small whatever the resolution.
+ * @throws InvalidStructureError if cellsPerSide is 0 or above 4096
+ */
+RegionIndex::RegionIndex(std::size_t cellsPerSide) : m_cellsPerSide(cellsPerSide) {
+  if (cellsPerSide == 0 || cellsPerSide > 4096) {
+    throw InvalidStructureError("A region index needs between 1 and 4096 cells per side, not " +
+                                std::to_string(cellsPerSide));
+  }
+}
+
+/**
+ * @brief Adds the regions of an image.
+ *
+ * Areas which are not normalized are divided by the applied dimensions. Areas with non-finite
+ * coordinates, or in pixels of an image with no dimensions, are left out.
+ *
+ * @param image The image the regions belong to. Adding an image again indexes its regions again.
+ * @param regions The regions, relative to the stored image.
+ * @throws InvalidStructureError if the index would hold 2^32 - 1 regions or more
+ */
+void RegionIndex::add(const std::filesystem::path& image, const RegionInfoStruct& regions) {
+  if (this->m_entries.size() + regions.RegionList.size() >= std::numeric_limits<std::uint32_t>::max()) {
+    throw InvalidStructureError("A region index holds at most 2^32 - 1 regions");
+  }
+  const auto imageId = static_cast<std::uint32_t>(this->m_images.size());
+  bool added = false;
+
+  for (std::size_t position = 0; position < regions.RegionList.size(); position++) {
+    const auto& region = regions.RegionList[position];
+    XmpAreaStruct area = region.Area;
+    if (area.Unit != "normalized") {
+      const auto& dimensions = regions.AppliedToDimensions;
+      if (!(dimensions.W > 0.0) || !(dimensions.H > 0.0)) {
+        continue;
+      }
+      area.X /= dimensions.W;
+      area.W /= dimensions.W;
+      area.Y /= dimensions.H;
+      area.H /= dimensions.H;
+    }
+    if (!std::isfinite(area.X) || !std::isfinite(area.Y) || !std::isfinite(area.W) || !std::isfinite(area.H)) {
+      continue;
+    }
+
+    const auto entryId = static_cast<std::uint32_t>(this->m_entries.size());
+    // MWG areas are centered on X and Y
+    const Entry entry{imageId,
+                      static_cast<std::uint32_t>(position),
+                      this->intern(region.Name),
+                      this->intern(region.Type),
+                      area.X - area.W / 2.0,
+                      area.Y - area.H / 2.0,
+                      area.X + area.W / 2.0,
+                      area.Y + area.H / 2.0};
+    this->m_entries.push_back(entry);
+    this->m_areas.push_back(area.W * area.H);
+    for (std::size_t row = this->cell(entry.Top); row <= this->cell(entry.Bottom); row++) {
+      for (std::size_t column = this->cell(entry.Left); column <= this->cell(entry.Right); column++) {
+        this->m_cells[row * this->m_cellsPerSide + column].push_back(entryId);
+      }
+    }
+    added = true;
+  }
+
+  if (added) {
+    this->m_images.push_back(image);
+  }
+}
+
+std::size_t RegionIndex::size() const noexcept {
+  return this->m_entries.size();
+}
+
+/**
+ * @brief Finds the regions whose bounds overlap a box.
+ *
+ * @return The regions, edges touching the box included, in the order they were added.
+ */
+std::vector<IndexedRegion> RegionIndex::overlapping(double left, double top, double right, double bottom) const {
+  if (!(left <= right) || !(top <= bottom)) {
+    return {};
+  }
+  const std::size_t firstRow = this->cell(top);
+  const std::size_t lastRow = this->cell(bottom);
+  const std::size_t firstColumn = this->cell(left);
+  const std::size_t lastColumn = this->cell(right);
+
+  std::vector<std::uint32_t> candidates;
+  if ((lastRow - firstRow + 1) * (lastColumn - firstColumn + 1) > this->m_cells.size()) {
+    // The box touches more cells than hold regions, so walk the stored cells instead
+    for (const auto& [key, entries] : this->m_cells) {
+      const std::size_t row = key / this->m_cellsPerSide;
+      const std::size_t column = key % this->m_cellsPerSide;
+      if (firstRow <= row && row <= lastRow && firstColumn <= column && column <= lastColumn) {
+        candidates.insert(candidates.end(), entries.begin(), entries.end());
+      }
+    }
+  } else {
+    for (std::size_t row = firstRow; row <= lastRow; row++) {
+      for (std::size_t column = firstColumn; column <= lastColumn; column++) {
+        const auto entries = this->m_cells.find(row * this->m_cellsPerSide + column);
+        if (entries != this->m_cells.end()) {
+          candidates.insert(candidates.end(), entries->second.begin(), entries->second.end());
+        }
+      }
+    }
+  }
+  // A region spanning several cells is a candidate once per cell
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+  std::vector<IndexedRegion> found;
+  for (std::uint32_t id : candidates) {
+    const Entry& entry = this->m_entries[id];
+    if (entry.Left <= right && left <= entry.Right && entry.Top <= bottom && top <= entry.Bottom) {
+      found.push_back(this->region(id));
+    }
+  }
+  return found;
+}
+
+/**
+ * @brief Finds the regions covering more than a fraction of the frame.
+ *
+ * @param fraction Between 0 and 1, so 0.25 finds regions larger than a quarter of the image.
+ */
+std::vector<IndexedRegion> RegionIndex::largerThan(double fraction) const {
+  std::vector<IndexedRegion> found;
+  for (std::size_t id = 0; id < this->m_areas.size(); id++) {
+    if (this->m_areas[id] > fraction) {
+      found.push_back(this->region(static_cast<std::uint32_t>(id)));
+    }
+  }
+  return found;
+}
+
+/**
+ * @brief Finds regions which tag the same thing twice, such as a face written by two tools.
+ *
+ * Only regions of the same image with the same name are compared, so the cost grows with the
+ * number of regions rather than its square.
+ *
+ * @param minOverlap The intersection over union from which two boxes count as the same, in (0, 1].
+ * @return Each pair once, the region added first on the left, ordered by image then position.
+ */
+std::vector<std::pair<IndexedRegion, IndexedRegion>> RegionIndex::duplicates(double minOverlap) const {
+  std::vector<std::uint32_t> order(this->m_entries.size());
+  for (std::size_t id = 0; id < order.size(); id++) {
+    order[id] = static_cast<std::uint32_t>(id);
+  }
+  // Entries are added image by image, so sorting by name within an image groups the candidates
+  std::stable_sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+    const Entry& lhs = this->m_entries[a];
+    const Entry& rhs = this->m_entries[b];
+    return lhs.Image != rhs.Image ? lhs.Image < rhs.Image : lhs.Name < rhs.Name;
+  });
+
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+  for (std::size_t start = 0; start < order.size();) {
+    const Entry& first = this->m_entries[order[start]];
+    std::size_t end = start + 1;
+    while (end < order.size() && this->m_entries[order[end]].Image == first.Image &&
+           this->m_entries[order[end]].Name == first.Name) {
+      end++;
+    }
+    for (std::size_t i = start; i < end; i++) {
+      const Entry& a = this->m_entries[order[i]];
+      for (std::size_t j = i + 1; j < end; j++) {
+        const Entry& b = this->m_entries[order[j]];
+        if (overlapRatio(a.Left, a.Top, a.Right, a.Bottom, b.Left, b.Top, b.Right, b.Bottom) >= minOverlap) {
+          pairs.emplace_back(order[i], order[j]);
+        }
+      }
+    }
+    start = end;
+  }
+
+  std::sort(pairs.begin(), pairs.end());
+  std::vector<std::pair<IndexedRegion, IndexedRegion>> found;
+  found.reserve(pairs.size());
+  for (const auto& [a, b] : pairs) {
+    found.emplace_back(this->region(a), this->region(b));
+  }
+  return found;
+}
+
+std::uint32_t RegionIndex::intern(const std::string& value) {
+  auto [it, inserted] = this->m_stringIndex.try_emplace(value, static_cast<std::uint32_t>(this->m_strings.size()));
+  if (inserted) {
+    this->m_strings.push_back(value);
+  }
+  return it->second;
+}
+
+// The cell holding a coordinate along either axis, coordinates outside the frame land on its edge
+std::size_t RegionIndex::cell(double coordinate) const noexcept {
+  const double scaled = std::floor(coordinate * static_cast<double>(this->m_cellsPerSide));
+  if (!(scaled > 0.0)) {
+    return 0;
+  }
+  return std::min(static_cast<std::size_t>(std::min(scaled, 1e9)), this->m_cellsPerSide - 1);
+}
+
+IndexedRegion RegionIndex::region(std::uint32_t id) const {
+  const Entry& entry = this->m_entries[id];
+  return IndexedRegion{this->m_images[entry.Image], entry.Position, this->m_strings[entry.Name],
+                       this->m_strings[entry.Type], entry.Left, entry.Top, entry.Right, entry.Bottom};
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "RegionInfoStruct.hpp"
+
+/**
+ * @brief A region of one image, as returned by RegionIndex queries.
+ */
+struct IndexedRegion {
+  std::filesystem::path Image;
+  // The position of the region in the RegionList of its image
+  std::size_t Position;
+  std::string Name;
+  std::string Type;
+  // The bounds, in normalized coordinates of the stored image
+  double Left;
+  double Top;
+  double Right;
+  double Bottom;
+
+  // The fraction of the frame the region covers
+  double area() const noexcept {
+    return (this->Right - this->Left) * (this->Bottom - this->Top);
+  }
+};
+
+/**
+ * @brief A uniform grid over normalized coordinates, holding the regions of many images.
+ *
+ * Each region is recorded in every cell its bounds touch, so a box query only tests the regions
+ * of the cells the box touches. Only cells holding regions are stored. Areas in pixels are normalized against the applied dimensions,
+ * areas which cannot be are left out. Names and paths are stored once each. Queries on a const
+ * index are safe to run concurrently.
+ */
+class RegionIndex {
+public:
+  explicit RegionIndex(std::size_t cellsPerSide = 32);
+
+  void add(const std::filesystem::path& image, const RegionInfoStruct& regions);
+
+  std::size_t size() const noexcept;
+
+  // Regions whose bounds overlap the box, edges included, in the order they were added
+  std::vector<IndexedRegion> overlapping(double left, double top, double right, double bottom) const;
+  // Regions covering more than fraction of the frame, in the order they were added
+  std::vector<IndexedRegion> largerThan(double fraction) const;
+  // Pairs of regions of the same image with the same name, whose intersection over union is at least minOverlap
+  std::vector<std::pair<IndexedRegion, IndexedRegion>> duplicates(double minOverlap = 0.5) const;
+
+private:
+  struct Entry {
+    std::uint32_t Image;
+    std::uint32_t Position;
+    std::uint32_t Name;
+    std::uint32_t Type;
+    double Left;
+    double Top;
+    double Right;
+    double Bottom;
+  };
+
+  std::size_t m_cellsPerSide;
+  std::vector<Entry> m_entries;
+  // The area of each entry, scanned on its own by largerThan()
+  std::vector<double> m_areas;
+  // The entries touching each cell keyed by row * m_cellsPerSide + column, only for cells touched
+  std::unordered_map<std::size_t, std::vector<std::uint32_t>> m_cells;
+  std::vector<std::filesystem::path> m_images;
+  std::vector<std::string> m_strings;
+  std::unordered_map<std::string, std::uint32_t> m_stringIndex;
+
+  std::uint32_t intern(const std::string& value);
+  std::size_t cell(double coordinate) const noexcept;
+  IndexedRegion region(std::uint32_t entry) const;
+};
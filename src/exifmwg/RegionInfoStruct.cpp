@@ -1,9 +1,14 @@
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <utility>
 
+#include "BinaryCodec.hpp"
 #include "Errors.hpp"
+#include "JsonCodec.hpp"
 #include "Logging.hpp"
 #include "RegionInfoStruct.hpp"
+#include "RegionTransform.hpp"
 #include "XmpUtils.hpp"
 
 RegionInfoStruct::RegionStruct::RegionStruct(XmpAreaStruct area, std::string name, std::string type,
@@ -13,7 +18,15 @@ RegionInfoStruct::RegionStruct::RegionStruct(XmpAreaStruct area, std::string nam
 
 RegionInfoStruct::RegionStruct RegionInfoStruct::RegionStruct::fromXmp(const Exiv2::XmpData& xmpData,
                                                                        const std::string& baseKey) {
-  XmpAreaStruct area = XmpAreaStruct::fromXmp(xmpData, baseKey + "/mwg-rs:Area");
+  return tryFromXmp(xmpData, baseKey).value();
+}
+
+Result<RegionInfoStruct::RegionStruct> RegionInfoStruct::RegionStruct::tryFromXmp(const Exiv2::XmpData& xmpData,
+                                                                                  const std::string& baseKey) {
+  auto area = XmpAreaStruct::tryFromXmp(xmpData, baseKey + "/mwg-rs:Area");
+  if (!area) {
+    return area.error();
+  }
 
   std::string name_val;
   std::string type_val;
@@ -23,14 +36,14 @@ RegionInfoStruct::RegionStruct RegionInfoStruct::RegionStruct::fromXmp(const Exi
   if (nameKey != xmpData.end()) {
     name_val = XmpUtils::cleanXmpText(nameKey->toString());
   } else {
-    throw MissingFieldError("No name found in region info struct");
+    return ErrorInfo{ErrorCode::MissingField, "No name found in region info struct", {}};
   }
 
   auto typeKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/mwg-rs:Type"));
   if (typeKey != xmpData.end()) {
     type_val = typeKey->toString();
   } else {
-    throw MissingFieldError("No type found in region info struct");
+    return ErrorInfo{ErrorCode::MissingField, "No type found in region info struct", {}};
   }
 
   auto descKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/mwg-rs:Description"));
@@ -38,7 +51,7 @@ RegionInfoStruct::RegionStruct RegionInfoStruct::RegionStruct::fromXmp(const Exi
     desc_val = descKey->toString();
   }
 
-  return {area, name_val, type_val, desc_val};
+  return RegionStruct(std::move(area).value(), name_val, type_val, desc_val);
 }
 
 std::string RegionInfoStruct::RegionStruct::to_string() const {
@@ -52,6 +65,22 @@ std::string RegionInfoStruct::RegionStruct::to_string() const {
   return repr;
 }
 
+RegionInfoStruct::RegionStruct RegionInfoStruct::RegionStruct::fromBytes(std::string_view bytes) {
+  return BinaryCodec::decode<RegionInfoStruct::RegionStruct>(bytes);
+}
+
+std::string RegionInfoStruct::RegionStruct::toBytes() const {
+  return BinaryCodec::encode(*this);
+}
+
+RegionInfoStruct::RegionStruct RegionInfoStruct::RegionStruct::fromJson(std::string_view json) {
+  return JsonCodec::decode<RegionInfoStruct::RegionStruct>(json);
+}
+
+std::string RegionInfoStruct::RegionStruct::toJson() const {
+  return JsonCodec::encode(*this);
+}
+
 void RegionInfoStruct::RegionStruct::toXmp(Exiv2::XmpData& xmpData, const std::string& itemPath) const {
   // Write the Area struct
   std::string areaPath = itemPath + "/mwg-rs:Area";
@@ -72,10 +101,88 @@ RegionInfoStruct::RegionInfoStruct(DimensionsStruct appliedToDimensions,
     AppliedToDimensions(std::move(appliedToDimensions)), RegionList(regionList) {
 }
 
+/**
+ * @brief Builds the regions from arrays, such as detector output.
+ *
+ * @param appliedToDimensions The dimensions the areas refer to.
+ * @param areas One row per region of h, w, x and y, then d when columns is 5. A NaN d leaves it unset.
+ * @param columns 4 or 5.
+ * @param names The name of each region.
+ * @param types The type of each region.
+ * @param unit The unit of every area.
+ * @param descriptions The description of each region, or empty for none.
+ * @throws InvalidStructureError if the arrays do not have one entry per region, or an h, w, x or y is
+ *         not finite
+ */
+RegionInfoStruct::RegionInfoStruct(DimensionsStruct appliedToDimensions, std::span<const double> areas,
+                                   std::size_t columns, const std::vector<std::string>& names,
+                                   const std::vector<std::string>& types, const std::string& unit,
+                                   const std::vector<std::optional<std::string>>& descriptions) :
+    AppliedToDimensions(std::move(appliedToDimensions)) {
+  if (columns != 4 && columns != AREA_COLUMNS) {
+    throw InvalidStructureError("Areas need 4 or 5 columns, not " + std::to_string(columns));
+  }
+  const std::size_t count = names.size();
+  if (areas.size() != count * columns || types.size() != count ||
+      (!descriptions.empty() && descriptions.size() != count)) {
+    throw InvalidStructureError("Expected an area, type and description for each of " + std::to_string(count) +
+                                " names, got " + std::to_string(areas.size() / columns) + " areas, " +
+                                std::to_string(types.size()) + " types and " + std::to_string(descriptions.size()) +
+                                " descriptions");
+  }
+
+  this->RegionList.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    const double* row = areas.data() + i * columns;
+    if (!std::all_of(row, row + 4, [](double value) { return std::isfinite(value); })) {
+      throw InvalidStructureError("Area " + std::to_string(i) + " is not finite");
+    }
+    std::optional<double> d;
+    if (columns == AREA_COLUMNS && !std::isnan(row[4])) {
+      d = row[4];
+    }
+    this->RegionList.emplace_back(XmpAreaStruct(row[0], row[1], row[2], row[3], unit, d), names[i], types[i],
+                                  descriptions.empty() ? std::nullopt : descriptions[i]);
+  }
+}
+
+std::vector<double> RegionInfoStruct::areaArray() const {
+  std::vector<double> areas;
+  areas.reserve(this->RegionList.size() * AREA_COLUMNS);
+  for (const auto& region : this->RegionList) {
+    const XmpAreaStruct& area = region.Area;
+    areas.insert(areas.end(),
+                 {area.H, area.W, area.X, area.Y, area.D.value_or(std::numeric_limits<double>::quiet_NaN())});
+  }
+  return areas;
+}
+
+RegionInfoStruct RegionInfoStruct::toDisplay(ExifOrientation orientation) const {
+  return RegionTransform::toDisplay(*this, orientation);
+}
+
+RegionInfoStruct RegionInfoStruct::toStored(ExifOrientation orientation) const {
+  return RegionTransform::toDisplay(*this, RegionTransform::inverse(orientation));
+}
+
 RegionInfoStruct RegionInfoStruct::fromXmp(const Exiv2::XmpData& xmpData) {
+  return tryFromXmp(xmpData).value();
+}
+
+/**
+ * @brief Parses the MWG regions, reporting a malformed structure as an error value.
+ *
+ * @param xmpData The XMP data to read from.
+ * @param skipped When set, a malformed region is appended to it and left out of the result.
+ *                The dimensions are still required.
+ * @return The regions, or the first malformed structure.
+ */
+Result<RegionInfoStruct> RegionInfoStruct::tryFromXmp(const Exiv2::XmpData& xmpData, std::vector<ErrorInfo>* skipped) {
   // Parse AppliedToDimensions
-  DimensionsStruct appliedToDimensions_val =
-      DimensionsStruct::fromXmp(xmpData, "Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions");
+  auto appliedToDimensions_val = DimensionsStruct::tryFromXmp(xmpData, "Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions");
+  if (!appliedToDimensions_val) {
+    return appliedToDimensions_val.error();
+  }
   std::vector<RegionInfoStruct::RegionStruct> regionList_val;
 
   // Parse RegionList
@@ -92,11 +199,35 @@ RegionInfoStruct RegionInfoStruct::fromXmp(const Exiv2::XmpData& xmpData) {
     }
 
     InternalLogger::debug("Reading key " + baseKey);
-    regionList_val.push_back(RegionInfoStruct::RegionStruct::fromXmp(xmpData, baseKey));
+    auto region = RegionInfoStruct::RegionStruct::tryFromXmp(xmpData, baseKey);
+    if (region) {
+      regionList_val.push_back(std::move(region).value());
+    } else if (skipped != nullptr) {
+      skipped->push_back(
+          {region.error().Code, "Skipped region " + std::to_string(regionIndex) + ": " + region.error().Message, {}});
+    } else {
+      return region.error();
+    }
     regionIndex++;
   }
 
-  return {appliedToDimensions_val, regionList_val};
+  return RegionInfoStruct(std::move(appliedToDimensions_val).value(), regionList_val);
+}
+
+RegionInfoStruct RegionInfoStruct::fromBytes(std::string_view bytes) {
+  return BinaryCodec::decode<RegionInfoStruct>(bytes);
+}
+
+std::string RegionInfoStruct::toBytes() const {
+  return BinaryCodec::encode(*this);
+}
+
+RegionInfoStruct RegionInfoStruct::fromJson(std::string_view json) {
+  return JsonCodec::decode<RegionInfoStruct>(json);
+}
+
+std::string RegionInfoStruct::toJson() const {
+  return JsonCodec::encode(*this);
 }
 
 void RegionInfoStruct::toXmp(Exiv2::XmpData& xmpData) const {
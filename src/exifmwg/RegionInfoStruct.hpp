@@ -1,12 +1,20 @@
 #pragma once
 
+#include <cstddef>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <exiv2/exiv2.hpp>
 
+#include "BinarySerializable.hpp"
 #include "DimensionsStruct.hpp"
+#include "JsonSerializable.hpp"
+#include "Orientation.hpp"
 #include "PythonBindable.hpp"
+#include "Result.hpp"
 #include "XmpAreaStruct.hpp"
 #include "XmpSerializable.hpp"
 
@@ -23,8 +31,17 @@ public:
 
     // XMP serialization
     static RegionStruct fromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey);
+    static Result<RegionStruct> tryFromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey);
     void toXmp(Exiv2::XmpData& xmpData, const std::string& itemPath) const;
 
+    // Binary serialization
+    static RegionStruct fromBytes(std::string_view bytes);
+    std::string toBytes() const;
+
+    // JSON serialization
+    static RegionStruct fromJson(std::string_view json);
+    std::string toJson() const;
+
     // Python bindable
     std::string to_string() const;
 
@@ -37,12 +54,38 @@ public:
   DimensionsStruct AppliedToDimensions;
   std::vector<RegionStruct> RegionList;
 
+  // The columns of areaArray(), in this order
+  static constexpr std::size_t AREA_COLUMNS = 5;
+
   RegionInfoStruct(DimensionsStruct appliedToDimensions, const std::vector<RegionStruct>& regionList);
+  // Builds the regions from a row-major array of areas, one row of h, w, x, y and optionally d per region
+  RegionInfoStruct(DimensionsStruct appliedToDimensions, std::span<const double> areas, std::size_t columns,
+                   const std::vector<std::string>& names, const std::vector<std::string>& types,
+                   const std::string& unit = "normalized",
+                   const std::vector<std::optional<std::string>>& descriptions = {});
+
+  // The areas as a row-major array of AREA_COLUMNS columns, h, w, x, y and d, with NaN for no d
+  std::vector<double> areaArray() const;
+
+  // The regions on the image as displayed with orientation, with the dimensions swapped if it turns
+  RegionInfoStruct toDisplay(ExifOrientation orientation) const;
+  // The reverse of toDisplay, from regions on the displayed image back to the stored one
+  RegionInfoStruct toStored(ExifOrientation orientation) const;
 
   // XMP serialization
   static RegionInfoStruct fromXmp(const Exiv2::XmpData& xmpData);
+  // With skipped set, malformed regions are appended to it and left out instead of failing the parse
+  static Result<RegionInfoStruct> tryFromXmp(const Exiv2::XmpData& xmpData, std::vector<ErrorInfo>* skipped = nullptr);
   void toXmp(Exiv2::XmpData& xmpData) const;
 
+  // Binary serialization
+  static RegionInfoStruct fromBytes(std::string_view bytes);
+  std::string toBytes() const;
+
+  // JSON serialization
+  static RegionInfoStruct fromJson(std::string_view json);
+  std::string toJson() const;
+
   // Python bindable
   std::string to_string() const;
 
@@ -54,7 +97,11 @@ public:
 static_assert(std::copy_constructible<RegionInfoStruct::RegionStruct>);
 static_assert(std::equality_comparable<RegionInfoStruct::RegionStruct>);
 static_assert(XmpSerializableWithKey<RegionInfoStruct::RegionStruct>);
+static_assert(BinarySerializable<RegionInfoStruct::RegionStruct>);
+static_assert(JsonSerializable<RegionInfoStruct::RegionStruct>);
 
 static_assert(std::copy_constructible<RegionInfoStruct>);
 static_assert(std::equality_comparable<RegionInfoStruct>);
 static_assert(XmpSerializable<RegionInfoStruct>);
+static_assert(BinarySerializable<RegionInfoStruct>);
+static_assert(JsonSerializable<RegionInfoStruct>);
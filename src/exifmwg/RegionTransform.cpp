@@ -0,0 +1,169 @@
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Errors.hpp"
+#include "RegionInfoStruct.hpp"
+#include "RegionTransform.hpp"
+
+namespace {
+
+// Where a stored point lands: the axes are swapped first, then each displayed axis may be flipped
+struct Mapping {
+  bool Swap;
+  bool FlipX;
+  bool FlipY;
+};
+
+Mapping mappingFor(ExifOrientation orientation) noexcept {
+  switch (orientation) {
+  case ExifOrientation::MirrorHorizontal:
+    return {false, true, false};
+  case ExifOrientation::Rotate180:
+    return {false, true, true};
+  case ExifOrientation::MirrorVertical:
+    return {false, false, true};
+  case ExifOrientation::MirrorHorizontalAndRotate270CW:
+    return {true, false, false};
+  case ExifOrientation::Rotate90CW:
+    return {true, true, false};
+  case ExifOrientation::MirrorHorizontalAndRotate90CW:
+    return {true, true, true};
+  case ExifOrientation::Rotate270CW:
+    return {true, false, true};
+  default:
+    return {false, false, false};
+  }
+}
+
+// The areas of one unit, gathered into columns for the kernel and scattered back after
+struct AreaGroup {
+  std::vector<std::size_t> Indices;
+  std::vector<double> H;
+  std::vector<double> W;
+  std::vector<double> X;
+  std::vector<double> Y;
+
+  void add(std::size_t index, const XmpAreaStruct& area) {
+    this->Indices.push_back(index);
+    this->H.push_back(area.H);
+    this->W.push_back(area.W);
+    this->X.push_back(area.X);
+    this->Y.push_back(area.Y);
+  }
+
+  RegionTransform::AreaColumns columns() {
+    return {this->H, this->W, this->X, this->Y};
+  }
+
+  void scatter(std::vector<RegionInfoStruct::RegionStruct>& regions) const {
+    for (std::size_t i = 0; i < this->Indices.size(); i++) {
+      XmpAreaStruct& area = regions[this->Indices[i]].Area;
+      area.H = this->H[i];
+      area.W = this->W[i];
+      area.X = this->X[i];
+      area.Y = this->Y[i];
+    }
+  }
+};
+
+} // namespace
+
+ExifOrientation RegionTransform::inverse(ExifOrientation orientation) noexcept {
+  // Every orientation but the two quarter turns is its own inverse
+  switch (orientation) {
+  case ExifOrientation::Rotate90CW:
+    return ExifOrientation::Rotate270CW;
+  case ExifOrientation::Rotate270CW:
+    return ExifOrientation::Rotate90CW;
+  case ExifOrientation::Undefined:
+    return ExifOrientation::Horizontal;
+  default:
+    return orientation;
+  }
+}
+
+bool RegionTransform::swapsAxes(ExifOrientation orientation) noexcept {
+  return mappingFor(orientation).Swap;
+}
+
+/**
+ * @brief Maps areas from the stored image to the displayed one, in place.
+ *
+ * @param orientation The EXIF orientation of the image.
+ * @param areas The area centers and sizes, in the unit of the extents.
+ * @param extentX The width of the stored image, 1 for normalized areas.
+ * @param extentY The height of the stored image, 1 for normalized areas.
+ * @throws InvalidStructureError if the columns differ in length
+ */
+void RegionTransform::toDisplay(ExifOrientation orientation, const AreaColumns& areas, double extentX,
+                                double extentY) {
+  const std::size_t count = areas.X.size();
+  if (areas.Y.size() != count || areas.W.size() != count || areas.H.size() != count) {
+    throw InvalidStructureError("Area columns differ in length");
+  }
+  const Mapping mapping = mappingFor(orientation);
+  // With the axes swapped, the displayed x runs along the stored y, so is flipped against its extent
+  const double scaleX = mapping.FlipX ? -1.0 : 1.0;
+  const double scaleY = mapping.FlipY ? -1.0 : 1.0;
+  const double offsetX = mapping.FlipX ? (mapping.Swap ? extentY : extentX) : 0.0;
+  const double offsetY = mapping.FlipY ? (mapping.Swap ? extentX : extentY) : 0.0;
+
+  double* h = areas.H.data();
+  double* w = areas.W.data();
+  double* x = areas.X.data();
+  double* y = areas.Y.data();
+  // The branch is hoisted out of the loops, leaving each loop free of conditionals to vectorize
+  if (!mapping.Swap) {
+    for (std::size_t i = 0; i < count; i++) {
+      x[i] = offsetX + scaleX * x[i];
+      y[i] = offsetY + scaleY * y[i];
+    }
+    return;
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    const double storedX = x[i];
+    const double storedW = w[i];
+    x[i] = offsetX + scaleX * y[i];
+    y[i] = offsetY + scaleY * storedX;
+    w[i] = h[i];
+    h[i] = storedW;
+  }
+}
+
+void RegionTransform::toStored(ExifOrientation orientation, const AreaColumns& areas, double extentX,
+                               double extentY) {
+  toDisplay(inverse(orientation), areas, extentX, extentY);
+}
+
+/**
+ * @brief Maps every area of regions to the image displayed with orientation.
+ *
+ * Normalized areas are mapped against a unit square. Areas in another unit, such as pixels, are
+ * mapped against the applied dimensions. The diameter of a circle is unchanged.
+ *
+ * @param regions The regions, relative to the image before orientation is applied.
+ * @param orientation The orientation to apply.
+ * @return The regions relative to the displayed image, with the applied dimensions swapped if the
+ *         orientation turns the image.
+ */
+RegionInfoStruct RegionTransform::toDisplay(const RegionInfoStruct& regions, ExifOrientation orientation) {
+  RegionInfoStruct result(regions);
+  AreaGroup normalized;
+  AreaGroup other;
+  for (std::size_t i = 0; i < result.RegionList.size(); i++) {
+    const XmpAreaStruct& area = result.RegionList[i].Area;
+    (area.Unit == "normalized" ? normalized : other).add(i, area);
+  }
+
+  toDisplay(orientation, normalized.columns());
+  toDisplay(orientation, other.columns(), regions.AppliedToDimensions.W, regions.AppliedToDimensions.H);
+  normalized.scatter(result.RegionList);
+  other.scatter(result.RegionList);
+
+  if (swapsAxes(orientation)) {
+    std::swap(result.AppliedToDimensions.W, result.AppliedToDimensions.H);
+  }
+  return result;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <span>
+
+#include "Orientation.hpp"
+
+class RegionInfoStruct;
+
+// Which image the regions of a file are relative to
+enum class RegionSpace {
+  // The image as stored, before the orientation is applied, as MWG specifies
+  Stored,
+  // The image as displayed, with the orientation applied, as some tools write them
+  Displayed
+};
+
+/**
+ * @brief Maps region areas between the stored image and the image as displayed for an EXIF orientation.
+ *
+ * MWG areas are relative to the stored pixels, before the orientation is applied. Each orientation is
+ * one of the 8 symmetries of a rectangle: an optional swap of the axes followed by optional flips. The
+ * kernel works on separate columns of centers and sizes, so the loop over the areas is a few fused
+ * multiply-adds per element which the compiler vectorizes.
+ */
+namespace RegionTransform {
+
+/**
+ * @brief The centers and sizes of a set of areas, one column per field, all the same length.
+ */
+struct AreaColumns {
+  std::span<double> H;
+  std::span<double> W;
+  std::span<double> X;
+  std::span<double> Y;
+};
+
+// The orientation which undoes orientation, Undefined is treated as Horizontal
+ExifOrientation inverse(ExifOrientation orientation) noexcept;
+// Whether the displayed image has the width and height of the stored one swapped
+bool swapsAxes(ExifOrientation orientation) noexcept;
+
+// Maps areas in place from an image of extentX by extentY to the image displayed with orientation
+void toDisplay(ExifOrientation orientation, const AreaColumns& areas, double extentX = 1.0, double extentY = 1.0);
+// Maps areas in place from the displayed image of extentX by extentY back to the stored image
+void toStored(ExifOrientation orientation, const AreaColumns& areas, double extentX = 1.0, double extentY = 1.0);
+
+// Maps every area of regions to the image displayed with orientation, swapping the dimensions if it turns
+RegionInfoStruct toDisplay(const RegionInfoStruct& regions, ExifOrientation orientation);
+
+} // namespace RegionTransform
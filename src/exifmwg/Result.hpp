@@ -0,0 +1,59 @@
+#pragma once
+
+#include <utility>
+#include <variant>
+
+#include "Errors.hpp"
+
+/**
+ * @brief A value, or the error which prevented producing it, in the manner of std::expected.
+ *
+ * Used on paths where failures are common, such as batch reads over many slightly broken
+ * files, so reporting one does not pay for throwing and unwinding. value() throws the error
+ * as its exception class, which is how the throwing API is built on top of this one.
+ */
+template <typename T> class Result {
+public:
+  // Implicit, so a function returning a Result can return either a value or an ErrorInfo
+  Result(T value) : m_state(std::in_place_index<0>, std::move(value)) {
+  }
+  Result(ErrorInfo error) : m_state(std::in_place_index<1>, std::move(error)) {
+  }
+
+  bool ok() const noexcept {
+    return this->m_state.index() == 0;
+  }
+
+  explicit operator bool() const noexcept {
+    return this->ok();
+  }
+
+  T& value() & {
+    this->throwIfError();
+    return std::get<0>(this->m_state);
+  }
+
+  const T& value() const& {
+    this->throwIfError();
+    return std::get<0>(this->m_state);
+  }
+
+  T&& value() && {
+    this->throwIfError();
+    return std::get<0>(std::move(this->m_state));
+  }
+
+  // Only valid when !ok()
+  const ErrorInfo& error() const {
+    return std::get<1>(this->m_state);
+  }
+
+private:
+  std::variant<T, ErrorInfo> m_state;
+
+  void throwIfError() const {
+    if (!this->ok()) {
+      throwError(this->error());
+    }
+  }
+};
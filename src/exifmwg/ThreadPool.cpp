@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <utility>
+
+#include "Logging.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+
+// The pool and queue index of the worker running on this thread, if any
+thread_local const ThreadPool* tl_pool = nullptr;
+thread_local std::size_t tl_index = 0;
+
+std::mutex g_sharedMutex;
+std::shared_ptr<ThreadPool> g_shared;
+unsigned g_sharedThreads = 0;
+
+} // namespace
+
+void TaskGroup::add(std::size_t count) {
+  std::lock_guard lock(this->m_mutex);
+  this->m_outstanding += count;
+}
+
+void TaskGroup::done() {
+  std::lock_guard lock(this->m_mutex);
+  if (--this->m_outstanding == 0) {
+    this->m_finished.notify_all();
+  }
+}
+
+bool TaskGroup::finished() const {
+  std::lock_guard lock(this->m_mutex);
+  return this->m_outstanding == 0;
+}
+
+/**
+ * @brief Starts the workers.
+ *
+ * @param threads The number of workers, 0 for one per hardware thread.
+ */
+ThreadPool::ThreadPool(unsigned threads) {
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  this->m_local.reserve(threads);
+  for (unsigned i = 0; i < threads; ++i) {
+    this->m_local.push_back(std::make_unique<WorkerQueue>());
+  }
+  this->m_workers.reserve(threads);
+  for (unsigned i = 0; i < threads; ++i) {
+    this->m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+  InternalLogger::debug("Started a thread pool with " + std::to_string(threads) + " workers");
+}
+
+/**
+ * @brief Runs every queued task, then stops the workers.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(this->m_sleepMutex);
+    this->m_stopping = true;
+  }
+  this->m_wake.notify_all();
+  for (auto& worker : this->m_workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Queues a task at the end of the shared queue.
+ */
+void ThreadPool::submit(Task task) {
+  ++this->m_pending;
+  {
+    std::lock_guard lock(this->m_globalMutex);
+    this->m_global.push_back(std::move(task));
+  }
+  this->notifyQueued();
+}
+
+/**
+ * @brief Queues a task on the current worker's own queue, or the shared queue from any other thread.
+ */
+void ThreadPool::spawn(Task task) {
+  const auto index = this->currentWorkerIndex();
+  if (index < 0) {
+    this->submit(std::move(task));
+    return;
+  }
+  ++this->m_pending;
+  {
+    auto& local = *this->m_local[static_cast<std::size_t>(index)];
+    std::lock_guard lock(local.Mutex);
+    local.Tasks.push_back(std::move(task));
+  }
+  this->notifyQueued();
+}
+
+void ThreadPool::wait(TaskGroup& group) {
+  const auto index = this->currentWorkerIndex();
+  if (index < 0) {
+    std::unique_lock lock(group.m_mutex);
+    group.m_finished.wait(lock, [&group] { return group.m_outstanding == 0; });
+    return;
+  }
+  // Blocking here could leave no worker to run the group's tasks
+  while (!group.finished()) {
+    if (!this->runPendingTask(static_cast<std::size_t>(index))) {
+      std::unique_lock lock(group.m_mutex);
+      group.m_finished.wait_for(lock, std::chrono::milliseconds(1), [&group] { return group.m_outstanding == 0; });
+    }
+  }
+}
+
+unsigned ThreadPool::size() const noexcept {
+  return static_cast<unsigned>(this->m_workers.size());
+}
+
+ThreadPoolStats ThreadPool::stats() const {
+  ThreadPoolStats stats;
+  stats.Threads = this->size();
+  stats.Queued = static_cast<std::size_t>(std::max<std::int64_t>(this->m_pending.load(), 0));
+  stats.Active = this->m_active.load();
+  stats.Submitted = this->m_submitted.load();
+  stats.Completed = this->m_completed.load();
+  stats.Stolen = this->m_stolen.load();
+  return stats;
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::shared() {
+  std::lock_guard lock(g_sharedMutex);
+  if (!g_shared) {
+    g_shared = std::make_shared<ThreadPool>(g_sharedThreads);
+  }
+  return g_shared;
+}
+
+void ThreadPool::configureShared(unsigned threads) {
+  std::shared_ptr<ThreadPool> previous;
+  {
+    std::lock_guard lock(g_sharedMutex);
+    g_sharedThreads = threads;
+    previous = std::move(g_shared);
+  }
+  // The previous pool stops once its last batch releases it, the next one starts on first use
+}
+
+ThreadPoolStats ThreadPool::sharedStats() {
+  return shared()->stats();
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+  tl_pool = this;
+  tl_index = index;
+  while (true) {
+    {
+      std::unique_lock lock(this->m_sleepMutex);
+      this->m_wake.wait(lock, [this] { return this->m_stopping || this->m_pending.load() > 0; });
+      if (this->m_stopping && this->m_pending.load() <= 0) {
+        break;
+      }
+    }
+    if (!this->runPendingTask(index)) {
+      // A task was counted but not queued yet
+      std::this_thread::yield();
+    }
+  }
+  tl_pool = nullptr;
+}
+
+/**
+ * @brief Takes the newest task of the worker's own queue, else the oldest shared one, else steals the oldest of another worker.
+ */
+bool ThreadPool::takeTask(std::size_t index, Task& task) {
+  {
+    auto& local = *this->m_local[index];
+    std::lock_guard lock(local.Mutex);
+    if (!local.Tasks.empty()) {
+      task = std::move(local.Tasks.back());
+      local.Tasks.pop_back();
+      return true;
+    }
+  }
+  {
+    std::lock_guard lock(this->m_globalMutex);
+    if (!this->m_global.empty()) {
+      task = std::move(this->m_global.front());
+      this->m_global.pop_front();
+      return true;
+    }
+  }
+  for (std::size_t offset = 1; offset < this->m_local.size(); ++offset) {
+    auto& victim = *this->m_local[(index + offset) % this->m_local.size()];
+    std::lock_guard lock(victim.Mutex);
+    if (!victim.Tasks.empty()) {
+      task = std::move(victim.Tasks.front());
+      victim.Tasks.pop_front();
+      ++this->m_stolen;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::runPendingTask(std::size_t index) {
+  Task task;
+  if (!this->takeTask(index, task)) {
+    return false;
+  }
+  --this->m_pending;
+  ++this->m_active;
+  try {
+    task();
+  } catch (const std::exception& e) {
+    InternalLogger::error("Unhandled exception in a pool task: " + std::string(e.what()));
+  } catch (...) {
+    InternalLogger::error("Unhandled exception in a pool task");
+  }
+  --this->m_active;
+  ++this->m_completed;
+  return true;
+}
+
+void ThreadPool::notifyQueued() {
+  ++this->m_submitted;
+  {
+    // Orders the count before a worker's predicate check, so the wakeup is not lost
+    std::lock_guard lock(this->m_sleepMutex);
+  }
+  this->m_wake.notify_one();
+}
+
+std::ptrdiff_t ThreadPool::currentWorkerIndex() const noexcept {
+  return tl_pool == this ? static_cast<std::ptrdiff_t>(tl_index) : -1;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A snapshot of the counters of a ThreadPool.
+ */
+struct ThreadPoolStats {
+  unsigned Threads = 0;
+  // Tasks waiting in any queue
+  std::size_t Queued = 0;
+  // Tasks currently running
+  std::size_t Active = 0;
+  std::uint64_t Submitted = 0;
+  std::uint64_t Completed = 0;
+  // Tasks a worker took from another worker's queue
+  std::uint64_t Stolen = 0;
+};
+
+/**
+ * @brief Counts outstanding tasks so a caller can wait for all of them.
+ */
+class TaskGroup {
+public:
+  void add(std::size_t count = 1);
+  void done();
+  bool finished() const;
+
+private:
+  friend class ThreadPool;
+
+  std::size_t m_outstanding = 0;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_finished;
+};
+
+/**
+ * @brief A fixed set of worker threads with one task queue per worker and a shared queue.
+ *
+ * submit() appends to the shared queue, which keeps separate batches interleaved in arrival
+ * order. spawn() from a worker pushes onto that worker's own queue, which it runs newest first
+ * for locality, while idle workers steal the oldest tasks from it. Every batch API runs on the
+ * shared() instance, so concurrent batches never start more threads than it has.
+ */
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(unsigned threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void submit(Task task);
+  void spawn(Task task);
+
+  // Blocks until every task of the group is done. A worker of this pool runs other tasks meanwhile.
+  void wait(TaskGroup& group);
+
+  unsigned size() const noexcept;
+  ThreadPoolStats stats() const;
+
+  // The pool used by all batch APIs. Callers keep the returned pointer for the length of a batch.
+  static std::shared_ptr<ThreadPool> shared();
+  // Replaces the shared pool. Batches already running finish on the previous one. 0 means one per hardware thread.
+  static void configureShared(unsigned threads);
+  static ThreadPoolStats sharedStats();
+
+private:
+  struct WorkerQueue {
+    std::deque<Task> Tasks;
+    std::mutex Mutex;
+  };
+
+  std::vector<std::unique_ptr<WorkerQueue>> m_local;
+  std::deque<Task> m_global;
+  std::mutex m_globalMutex;
+  std::vector<std::thread> m_workers;
+
+  // Queued tasks, incremented before a task is queued so it never underflows
+  std::atomic<std::int64_t> m_pending{0};
+  std::atomic<std::size_t> m_active{0};
+  std::atomic<std::uint64_t> m_submitted{0};
+  std::atomic<std::uint64_t> m_completed{0};
+  std::atomic<std::uint64_t> m_stolen{0};
+  bool m_stopping = false;
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wake;
+
+  void workerLoop(std::size_t index);
+  bool takeTask(std::size_t index, Task& task);
+  bool runPendingTask(std::size_t index);
+  void notifyQueued();
+  std::ptrdiff_t currentWorkerIndex() const noexcept;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief How far a write is flushed to storage before it returns.
+ */
+enum class DurabilityLevel {
+  // Flushing is deferred to the operating system
+  Deferred,
+  // The file contents are flushed (fdatasync)
+  FileData,
+  // The file and its directory entry are flushed (fsync of both)
+  FileAndDirectory,
+};
+
+/**
+ * @brief Options controlling how ImageMetadata and MetadataSession write a file.
+ */
+struct WriteOptions {
+  // Whitespace reserved inside the XMP packet on a full rewrite, so later edits can be made in place.
+  // 0 keeps the packet exactly as Exiv2 would serialize it.
+  std::uint32_t XmpPadding = 2048;
+  // Overwrite the existing XMP packet in place when only XMP fields changed and the new packet fits
+  bool InPlaceXmp = true;
+  // Write only an XMP sidecar next to the image (see ImageMetadata::sidecarPath), leaving the image untouched.
+  // Atomic and Durability apply to the sidecar.
+  bool Sidecar = false;
+  // Write a temporary copy next to the file and rename it over the file, instead of rewriting it in place
+  bool Atomic = false;
+  DurabilityLevel Durability = DurabilityLevel::Deferred;
+};
@@ -1,6 +1,8 @@
 #include <utility>
 
+#include "BinaryCodec.hpp"
 #include "Errors.hpp"
+#include "JsonCodec.hpp"
 #include "Logging.hpp"
 #include "XmpAreaStruct.hpp"
 #include "XmpUtils.hpp"
@@ -10,47 +12,58 @@ XmpAreaStruct::XmpAreaStruct(double h, double w, double x, double y, std::string
 }
 
 XmpAreaStruct XmpAreaStruct::fromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey) {
-  double h = 0.0;
-  double w = 0.0;
-  double x = 0.0;
-  double y = 0.0;
-  std::optional<double> d;
-  std::string unit = "normalized";
+  return tryFromXmp(xmpData, baseKey).value();
+}
 
-  auto hKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/stArea:h"));
-  if (hKey != xmpData.end()) {
-    h = std::stod(hKey->toString());
-  } else {
-    throw MissingFieldError("No height found in xmp area struct");
+Result<XmpAreaStruct> XmpAreaStruct::tryFromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey) {
+  auto h = XmpUtils::readRequiredDouble(xmpData, baseKey + "/stArea:h", "height", "xmp area struct");
+  if (!h) {
+    return h.error();
   }
-  auto wKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/stArea:w"));
-  if (wKey != xmpData.end()) {
-    w = std::stod(wKey->toString());
-  } else {
-    throw MissingFieldError("No width found in xmp area struct");
+  auto w = XmpUtils::readRequiredDouble(xmpData, baseKey + "/stArea:w", "width", "xmp area struct");
+  if (!w) {
+    return w.error();
   }
-  auto xKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/stArea:x"));
-  if (xKey != xmpData.end()) {
-    x = std::stod(xKey->toString());
-  } else {
-    throw MissingFieldError("No x found in xmp area struct");
+  auto x = XmpUtils::readRequiredDouble(xmpData, baseKey + "/stArea:x", "x", "xmp area struct");
+  if (!x) {
+    return x.error();
   }
-  auto yKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/stArea:y"));
-  if (yKey != xmpData.end()) {
-    y = std::stod(yKey->toString());
-  } else {
-    throw MissingFieldError("No y found in xmp area struct");
+  auto y = XmpUtils::readRequiredDouble(xmpData, baseKey + "/stArea:y", "y", "xmp area struct");
+  if (!y) {
+    return y.error();
   }
+
+  std::optional<double> d;
   auto dKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/stArea:d"));
   if (dKey != xmpData.end()) {
-    d = std::stod(dKey->toString());
+    d = XmpUtils::parseDouble(dKey->toString());
+    if (!d) {
+      return ErrorInfo{ErrorCode::InvalidStructure, "Invalid d '" + dKey->toString() + "' in xmp area struct", {}};
+    }
   }
+  std::string unit = "normalized";
   auto unitKey = xmpData.findKey(Exiv2::XmpKey(baseKey + "/stArea:unit"));
   if (unitKey != xmpData.end()) {
     unit = unitKey->toString();
   }
 
-  return {h, w, x, y, unit, d};
+  return XmpAreaStruct(h.value(), w.value(), x.value(), y.value(), unit, d);
+}
+
+XmpAreaStruct XmpAreaStruct::fromBytes(std::string_view bytes) {
+  return BinaryCodec::decode<XmpAreaStruct>(bytes);
+}
+
+std::string XmpAreaStruct::toBytes() const {
+  return BinaryCodec::encode(*this);
+}
+
+XmpAreaStruct XmpAreaStruct::fromJson(std::string_view json) {
+  return JsonCodec::decode<XmpAreaStruct>(json);
+}
+
+std::string XmpAreaStruct::toJson() const {
+  return JsonCodec::encode(*this);
 }
 
 void XmpAreaStruct::toXmp(Exiv2::XmpData& xmpData, const std::string& basePath) const {
@@ -3,10 +3,14 @@
 #include <concepts>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include <exiv2/exiv2.hpp>
 
+#include "BinarySerializable.hpp"
+#include "JsonSerializable.hpp"
 #include "PythonBindable.hpp"
+#include "Result.hpp"
 #include "XmpSerializable.hpp"
 
 class XmpAreaStruct {
@@ -22,8 +26,17 @@ public:
 
   // XMP serialization
   static XmpAreaStruct fromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey = "");
+  static Result<XmpAreaStruct> tryFromXmp(const Exiv2::XmpData& xmpData, const std::string& baseKey = "");
   void toXmp(Exiv2::XmpData& xmpData, const std::string& basePath = "") const;
 
+  // Binary serialization
+  static XmpAreaStruct fromBytes(std::string_view bytes);
+  std::string toBytes() const;
+
+  // JSON serialization
+  static XmpAreaStruct fromJson(std::string_view json);
+  std::string toJson() const;
+
   // Python bindable
   std::string to_string() const;
 
@@ -44,3 +57,5 @@ static_assert(std::copy_constructible<XmpAreaStruct>);
 static_assert(std::equality_comparable<XmpAreaStruct>);
 static_assert(XmpSerializable<XmpAreaStruct>);
 static_assert(PythonBindableRepr<XmpAreaStruct>);
+static_assert(BinarySerializable<XmpAreaStruct>);
+static_assert(JsonSerializable<XmpAreaStruct>);
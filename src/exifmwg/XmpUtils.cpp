@@ -1,3 +1,5 @@
+#include <cerrno>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -185,4 +187,44 @@ std::string joinStrings(const std::vector<std::string>& vec, char delimiter) {
   return oss.str();
 }
 
+/**
+ * @brief Parses the leading number of a string, as std::stod does, without throwing.
+ *
+ * @param value The text to parse, leading whitespace is skipped and trailing text ignored.
+ * @return The number, or nothing if the text does not start with one or it is out of range.
+ */
+std::optional<double> parseDouble(const std::string& value) {
+  const char* begin = value.c_str();
+  char* end = nullptr;
+  errno = 0;
+  const double parsed = std::strtod(begin, &end);
+  if (end == begin || errno == ERANGE) {
+    return std::nullopt;
+  }
+  return parsed;
+}
+
+/**
+ * @brief Reads a required numeric field of an XMP struct.
+ *
+ * @param xmpData The XMP data to read from.
+ * @param key The full key of the field.
+ * @param field The name of the field, for the error message.
+ * @param structName The name of the struct, for the error message.
+ * @return The number, a MissingField error if the key does not exist, or an InvalidStructure
+ *         error if its value is not a number.
+ */
+Result<double> readRequiredDouble(const Exiv2::XmpData& xmpData, const std::string& key, const std::string& field,
+                                  const std::string& structName) {
+  auto it = xmpData.findKey(Exiv2::XmpKey(key));
+  if (it == xmpData.end()) {
+    return ErrorInfo{ErrorCode::MissingField, "No " + field + " found in " + structName, {}};
+  }
+  const std::string text = it->toString();
+  if (auto parsed = parseDouble(text)) {
+    return *parsed;
+  }
+  return ErrorInfo{ErrorCode::InvalidStructure, "Invalid " + field + " '" + text + "' in " + structName, {}};
+}
+
 } // namespace XmpUtils
@@ -2,8 +2,11 @@
 
 #include <exiv2/exiv2.hpp>
 
+#include <optional>
 #include <string>
 
+#include "Result.hpp"
+
 namespace XmpUtils {
 void clearXmpKey(Exiv2::XmpData& xmpData, const std::string& key);
 
@@ -18,4 +21,9 @@ std::vector<std::string> parseDelimitedString(const Exiv2::XmpData& xmpData, con
 
 std::string joinStrings(const std::vector<std::string>& vec, char delimiter);
 
+// Number parsing which reports failure as a value instead of throwing like std::stod
+std::optional<double> parseDouble(const std::string& value);
+Result<double> readRequiredDouble(const Exiv2::XmpData& xmpData, const std::string& key, const std::string& field,
+                                  const std::string& structName);
+
 } // namespace XmpUtils
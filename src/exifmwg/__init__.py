@@ -1,33 +1,115 @@
 from exifmwg.bindings import EXIV2_VERSION
 from exifmwg.bindings import EXPAT_VERSION
+from exifmwg.bindings import ArrowBatch
+from exifmwg.bindings import BatchOptions
+from exifmwg.bindings import BatchProgress
+from exifmwg.bindings import CancellationToken
+from exifmwg.bindings import CatalogReader
+from exifmwg.bindings import CatalogRefresh
+from exifmwg.bindings import CatalogWriter
 from exifmwg.bindings import Dimensions
+from exifmwg.bindings import DirectoryWatcher
+from exifmwg.bindings import DurabilityLevel
+from exifmwg.bindings import ErrorCode
+from exifmwg.bindings import ErrorInfo
 from exifmwg.bindings import ExifMwgBaseError
 from exifmwg.bindings import ExifOrientation
 from exifmwg.bindings import Exiv2Error
 from exifmwg.bindings import FileAccessError
+from exifmwg.bindings import FileResult
 from exifmwg.bindings import ImageMetadata
+from exifmwg.bindings import IndexedRegion
 from exifmwg.bindings import InvalidStructureError
 from exifmwg.bindings import Keyword
 from exifmwg.bindings import KeywordInfo
+from exifmwg.bindings import MemoryBudget
+from exifmwg.bindings import MetadataCacheStats
+from exifmwg.bindings import MetadataPipeline
+from exifmwg.bindings import MetadataSession
 from exifmwg.bindings import MissingFieldError
+from exifmwg.bindings import PersonIndex
+from exifmwg.bindings import PersonOccurrence
+from exifmwg.bindings import ReadOptions
+from exifmwg.bindings import ReadResult
 from exifmwg.bindings import Region
+from exifmwg.bindings import RegionIndex
 from exifmwg.bindings import RegionInfo
+from exifmwg.bindings import RegionSpace
+from exifmwg.bindings import SidecarPolicy
+from exifmwg.bindings import ThreadPoolStats
+from exifmwg.bindings import WriteOptions
 from exifmwg.bindings import XmpArea
+from exifmwg.bindings import build_catalog
+from exifmwg.bindings import clear_many
+from exifmwg.bindings import clear_metadata_cache
+from exifmwg.bindings import configure_metadata_cache
+from exifmwg.bindings import configure_thread_pool
+from exifmwg.bindings import metadata_cache_stats
+from exifmwg.bindings import read_many
+from exifmwg.bindings import read_many_arrow
+from exifmwg.bindings import refresh_catalog
+from exifmwg.bindings import rename_person
+from exifmwg.bindings import rotate_many
+from exifmwg.bindings import scan_directory
+from exifmwg.bindings import thread_pool_stats
+from exifmwg.bindings import update_catalog
+from exifmwg.bindings import write_many
 
 __all__ = [
     "EXIV2_VERSION",
     "EXPAT_VERSION",
+    "ArrowBatch",
+    "BatchOptions",
+    "BatchProgress",
+    "CancellationToken",
+    "CatalogReader",
+    "CatalogRefresh",
+    "CatalogWriter",
     "Dimensions",
+    "DirectoryWatcher",
+    "DurabilityLevel",
+    "ErrorCode",
+    "ErrorInfo",
     "ExifMwgBaseError",
     "ExifOrientation",
     "Exiv2Error",
     "FileAccessError",
+    "FileResult",
     "ImageMetadata",
+    "IndexedRegion",
     "InvalidStructureError",
     "Keyword",
     "KeywordInfo",
+    "MemoryBudget",
+    "MetadataCacheStats",
+    "MetadataPipeline",
+    "MetadataSession",
     "MissingFieldError",
+    "PersonIndex",
+    "PersonOccurrence",
+    "ReadOptions",
+    "ReadResult",
     "Region",
+    "RegionIndex",
     "RegionInfo",
+    "RegionSpace",
+    "SidecarPolicy",
+    "ThreadPoolStats",
+    "WriteOptions",
     "XmpArea",
+    "build_catalog",
+    "clear_many",
+    "clear_metadata_cache",
+    "configure_metadata_cache",
+    "configure_thread_pool",
+    "metadata_cache_stats",
+    "read_many",
+    "read_many_arrow",
+    "refresh_catalog",
+    "rename_person",
+    "rotate_many",
+    "scan_directory",
+    "thread_pool_stats",
+    "update_catalog",
+    "write_many",
 ]
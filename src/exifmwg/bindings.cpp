@@ -3,6 +3,7 @@
 #include <iostream>
 #include <map>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -11,20 +12,40 @@
 #include <expat.h>
 
 #include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
 #include <nanobind/operators.h>
 #include <nanobind/stl/filesystem.h>
+#include <nanobind/stl/function.h>
 #include <nanobind/stl/map.h>
 #include <nanobind/stl/optional.h>
+#include <nanobind/stl/pair.h>
 #include <nanobind/stl/string.h>
+#include <nanobind/stl/string_view.h>
 #include <nanobind/stl/vector.h>
 
+#include "ArrowBatch.hpp"
+#include "Batch.hpp"
+#include "BatchOptions.hpp"
+#include "BinarySerializable.hpp"
+#include "Catalog.hpp"
 #include "DimensionsStruct.hpp"
+#include "DirectoryWatcher.hpp"
 #include "Errors.hpp"
 #include "ImageMetadata.hpp"
 #include "KeywordInfoModel.hpp"
 #include "Logging.hpp"
+#include "MemoryBudget.hpp"
+#include "MetadataCache.hpp"
+#include "MetadataPipeline.hpp"
+#include "MetadataSession.hpp"
 #include "Orientation.hpp"
+#include "PersonIndex.hpp"
+#include "ReadOptions.hpp"
+#include "RegionIndex.hpp"
 #include "RegionInfoStruct.hpp"
+#include "RegionTransform.hpp"
+#include "ThreadPool.hpp"
+#include "WriteOptions.hpp"
 #include "XmpAreaStruct.hpp"
 
 namespace nb = nanobind;
@@ -32,8 +53,183 @@ namespace fs = std::filesystem;
 
 using namespace nb::literals;
 
+namespace {
+
+// The binary encoding doubles as the pickle state, so pickling costs one encode and one decode
+template <BinarySerializable T> nb::bytes toBytes(const T& value) {
+  const std::string bytes = value.toBytes();
+  return nb::bytes(bytes.data(), bytes.size());
+}
+
+template <BinarySerializable T> T fromBytes(const nb::bytes& bytes) {
+  return T::fromBytes(std::string_view(bytes.c_str(), bytes.size()));
+}
+
+template <BinarySerializable T> void setState(T& self, const nb::bytes& state) {
+  new (&self) T(fromBytes<T>(state));
+}
+
+using AreaArray = nb::ndarray<nb::numpy, double, nb::shape<-1, RegionInfoStruct::AREA_COLUMNS>, nb::c_contig>;
+using AreaInput = nb::ndarray<const double, nb::ndim<2>, nb::c_contig, nb::device::cpu>;
+
+void deleteAreas(void* pointer) noexcept {
+  delete static_cast<std::vector<double>*>(pointer);
+}
+
+// The areas are copied out of the regions once, into a vector the array then views and owns
+AreaArray areaArray(const RegionInfoStruct& regionInfo) {
+  auto* areas = new std::vector<double>(regionInfo.areaArray());
+  // NumPy wants a non-null pointer even for no regions
+  areas->reserve(RegionInfoStruct::AREA_COLUMNS);
+  nb::capsule owner(areas, &deleteAreas);
+  return AreaArray(areas->data(), {regionInfo.RegionList.size(), RegionInfoStruct::AREA_COLUMNS}, owner);
+}
+
+// Arrays of another float type or layout are converted to a C-contiguous float64 copy by nanobind
+RegionInfoStruct regionsFromArrays(const DimensionsStruct& appliedToDimensions, const AreaInput& areas,
+                                   const std::vector<std::string>& names, const std::vector<std::string>& types,
+                                   const std::string& unit,
+                                   const std::vector<std::optional<std::string>>& descriptions) {
+  return RegionInfoStruct(appliedToDimensions, std::span<const double>(areas.data(), areas.size()), areas.shape(1),
+                          names, types, unit, descriptions);
+}
+
+// A consumer importing from a capsule moves the struct out and clears its release callback, so the
+// capsule only releases what was never imported
+void releaseSchemaCapsule(void* pointer) noexcept {
+  auto* schema = static_cast<ArrowSchema*>(pointer);
+  if (schema->release != nullptr) {
+    schema->release(schema);
+  }
+  delete schema;
+}
+
+void releaseArrayCapsule(void* pointer) noexcept {
+  auto* array = static_cast<ArrowArray*>(pointer);
+  if (array->release != nullptr) {
+    array->release(array);
+  }
+  delete array;
+}
+
+nb::capsule arrowSchema(const ArrowBatch& batch) {
+  auto* schema = new ArrowSchema{};
+  batch.exportSchema(schema);
+  return nb::capsule(schema, "arrow_schema", &releaseSchemaCapsule);
+}
+
+// The requested schema is ignored, which the PyCapsule protocol allows, the consumer casts if needed
+nb::tuple arrowArray(const ArrowBatch& batch, const nb::object& requestedSchema) {
+  static_cast<void>(requestedSchema);
+  nb::capsule schema = arrowSchema(batch);
+  auto* array = new ArrowArray{};
+  batch.exportArray(array);
+  return nb::make_tuple(schema, nb::capsule(array, "arrow_array", &releaseArrayCapsule));
+}
+
+// Gives a Python transform a copy of the metadata which Python owns, so keeping it after the call is safe, and takes
+// the changes back from that copy
+class PythonTransform {
+public:
+  explicit PythonTransform(nb::handle callable) : m_callable(callable) {
+  }
+
+  bool operator()(ImageMetadata& metadata) const {
+    nb::gil_scoped_acquire acquire;
+    nb::object copy = nb::cast(metadata, nb::rv_policy::copy);
+    const bool write = nb::cast<bool>(this->m_callable(copy));
+    metadata = nb::cast<ImageMetadata&>(copy);
+    return write;
+  }
+
+private:
+  // Borrowed, so copies of the transform never touch reference counts without the GIL
+  nb::handle m_callable;
+};
+
+// The callable stays referenced by the arguments of this call for the whole run
+std::vector<FileResult> runPipeline(const MetadataPipeline& pipeline, const std::vector<fs::path>& paths,
+                                    const nb::callable& transform) {
+  const PythonTransform wrapped(transform);
+  nb::gil_scoped_release release;
+  return pipeline.run(paths, wrapped);
+}
+
+// The writer is copied while holding the GIL, so an add on another thread cannot change the records being written
+void writeCatalog(const CatalogWriter& writer, const fs::path& target, DurabilityLevel durability) {
+  const CatalogWriter snapshot = writer;
+  nb::gil_scoped_release release;
+  snapshot.write(target, durability);
+}
+
+// Only the wait runs without the GIL, the watcher state is updated while holding it
+std::vector<fs::path> pollWatcher(DirectoryWatcher& watcher, int timeoutMs) {
+  {
+    nb::gil_scoped_release release;
+    watcher.wait(timeoutMs);
+  }
+  return watcher.poll(0);
+}
+
+// The index is owned by Python, so it is only read and updated while holding the GIL
+std::vector<FileResult> renamePerson(PersonIndex& index, const std::string& from, const std::string& to,
+                                     const std::optional<std::string>& type, unsigned threads,
+                                     const WriteOptions& options, const BatchOptions& batch) {
+  const auto occurrences = index.find(from, type);
+  std::vector<ReadResult> written;
+  {
+    nb::gil_scoped_release release;
+    written = Batch::renameInFiles(occurrences, from, to, type, threads, options, batch);
+  }
+  index.add(written);
+
+  std::vector<FileResult> results;
+  results.reserve(written.size());
+  for (const auto& result : written) {
+    results.push_back(FileResult{result.Path, result.Error});
+  }
+  return results;
+}
+
+} // namespace
+
 NB_MODULE(bindings, m) {
   m.doc() = "C++ bindings to Exiv2 for reading and writing MWG information";
+  nb::enum_<SidecarPolicy>(m, "SidecarPolicy")
+      .value("Ignore", SidecarPolicy::Ignore, "The sidecar is never read")
+      .value("Merge", SidecarPolicy::Merge, "Fields set in the sidecar replace the embedded ones")
+      .value("Authoritative", SidecarPolicy::Authoritative,
+             "Every field comes from the sidecar when one exists, only the dimensions come from the image");
+
+  nb::class_<ReadOptions>(m, "ReadOptions", "Controls how metadata is read from a file")
+      .def(nb::init<>())
+      .def_rw("sidecar", &ReadOptions::Sidecar, "How an XMP sidecar next to the image is combined with it")
+      .def_rw("lenient", &ReadOptions::Lenient,
+              "Skip malformed regions and keyword nodes, recording them in `diagnostics`, instead of failing the read");
+
+  nb::enum_<DurabilityLevel>(m, "DurabilityLevel")
+      .value("Deferred", DurabilityLevel::Deferred, "Flushing is deferred to the operating system")
+      .value("FileData", DurabilityLevel::FileData, "The file contents are flushed (fdatasync)")
+      .value("FileAndDirectory", DurabilityLevel::FileAndDirectory,
+             "The file and its directory entry are flushed (fsync of both)");
+
+  nb::enum_<RegionSpace>(m, "RegionSpace")
+      .value("Stored", RegionSpace::Stored,
+             "Regions are relative to the image as stored, before the orientation is applied, as MWG specifies")
+      .value("Displayed", RegionSpace::Displayed,
+             "Regions are relative to the image as displayed, with the orientation applied");
+
+  nb::class_<WriteOptions>(m, "WriteOptions", "Controls how metadata is written to a file")
+      .def(nb::init<>())
+      .def_rw("xmp_padding", &WriteOptions::XmpPadding,
+              "Bytes of whitespace reserved in the XMP packet on a full rewrite, 0 for none")
+      .def_rw("in_place_xmp", &WriteOptions::InPlaceXmp,
+              "Overwrite the existing XMP packet in place when only XMP fields changed and the new packet fits")
+      .def_rw("sidecar", &WriteOptions::Sidecar, "Write only an XMP sidecar next to the image, leaving it untouched")
+      .def_rw("atomic", &WriteOptions::Atomic,
+              "Write a temporary copy next to the file and rename it over the file, instead of rewriting it in place")
+      .def_rw("durability", &WriteOptions::Durability, "How far the write is flushed to storage before returning");
+
   nb::class_<ImageMetadata>(m, "ImageMetadata")
       .def(nb::init<int, int, std::optional<std::string>, std::optional<std::string>, std::optional<RegionInfoStruct>,
                     std::optional<ExifOrientation>, std::optional<KeywordInfoModel>, std::optional<std::string>,
@@ -41,14 +237,35 @@ NB_MODULE(bindings, m) {
            "image_height"_a, "image_width"_a, "title"_a = nb::none(), "description"_a = nb::none(),
            "region_info"_a = nb::none(), "orientation"_a = nb::none(), "keyword_info"_a = nb::none(),
            "country"_a = nb::none(), "city"_a = nb::none(), "state"_a = nb::none(), "location"_a = nb::none())
-      .def(nb::init<const fs::path&>(), "path"_a)
+      .def(nb::init<const fs::path&, const ReadOptions&>(), "path"_a, "options"_a = ReadOptions())
       .def(nb::self == nb::self) // operator==
       .def(nb::self != nb::self) // operator!=
       .def("__repr__", &ImageMetadata::to_string)
-      .def("to_file", &ImageMetadata::toFile, "new_path"_a = nb::none(),
+      .def("to_bytes", &toBytes<ImageMetadata>, "A compact binary encoding, read back by `from_bytes`")
+      .def_static("from_bytes", &fromBytes<ImageMetadata>, "data"_a)
+      .def("__getstate__", &toBytes<ImageMetadata>)
+      .def("__setstate__", &setState<ImageMetadata>)
+      .def("to_json", &ImageMetadata::toJson, "JSON in the structure of the test fixtures")
+      .def_static("from_json", &ImageMetadata::fromJson, "json"_a)
+      .def_static("to_json_array", &ImageMetadata::toJsonArray, "metadata"_a,
+                  nb::call_guard<nb::gil_scoped_release>(), "Encodes a whole list as one JSON array")
+      .def_static("from_json_array", &ImageMetadata::fromJsonArray, "json"_a,
+                  nb::call_guard<nb::gil_scoped_release>())
+      .def("to_file", &ImageMetadata::toFile, "new_path"_a = nb::none(), "options"_a = WriteOptions(),
            "If `new_path` is provided, the original image is copied to the new location "
            "and the metadata is written to the new file. Otherwise, it overwrites "
-           "the original file with the updated metadata.")
+           "the original file with the updated metadata. The target is opened and parsed again, use "
+           "`MetadataSession` for a read-modify-write which parses the file once.")
+      .def("clear_file", &ImageMetadata::clearFile, "path"_a = nb::none(), "options"_a = WriteOptions(),
+           "Clears all supported metadata fields from the object and saves the changes back to `path`, or the "
+           "original file. `options` controls whether the rewrite is atomic and durable, the sidecar option does "
+           "not apply. This is a destructive operation.")
+      .def("rotate", &ImageMetadata::rotate, "operation"_a, "regions"_a = RegionSpace::Stored,
+           "Rotates or flips the image as displayed by composing `operation` with the orientation. The pixels are "
+           "untouched, regions relative to the displayed image are transformed along with it.")
+      .def_static("sidecar_path", &ImageMetadata::sidecarPath, "image_path"_a,
+                  "The XMP sidecar path which belongs to an image, `IMG_0001.CR2.xmp` when it exists, otherwise "
+                  "`IMG_0001.xmp`. A sidecar write uses the first form when another image shares the stem.")
       .def_ro("image_height", &ImageMetadata::ImageHeight)
       .def_ro("image_width", &ImageMetadata::ImageWidth)
       .def_rw("title", &ImageMetadata::Title)
@@ -59,7 +276,21 @@ NB_MODULE(bindings, m) {
       .def_rw("country", &ImageMetadata::Country)
       .def_rw("city", &ImageMetadata::City)
       .def_rw("state", &ImageMetadata::State)
-      .def_rw("location", &ImageMetadata::Location);
+      .def_rw("location", &ImageMetadata::Location)
+      .def_ro("diagnostics", &ImageMetadata::Diagnostics, "Entries skipped by a lenient read, in encounter order");
+
+  nb::class_<MetadataSession>(m, "MetadataSession",
+                              "Keeps an image open across a read-modify-write, so the file is only parsed once")
+      .def(nb::init<const fs::path&>(), "path"_a)
+      .def("read", &MetadataSession::read, "lenient"_a = false,
+           "Parses the metadata of the open image. With `lenient`, malformed entries are skipped into `diagnostics`.")
+      .def("stage", &MetadataSession::stage, "metadata"_a,
+           "Applies the set fields of `metadata` in memory. Nothing is written until `commit` is called.")
+      .def("clear", &MetadataSession::clear,
+           "Removes all supported metadata fields in memory. Nothing is written until `commit` is called.")
+      .def("commit", &MetadataSession::commit, "options"_a = WriteOptions(), "Writes all staged changes to the file")
+      .def_prop_ro("path", &MetadataSession::path)
+      .def_prop_ro("dirty", &MetadataSession::isDirty);
 
   nb::enum_<ExifOrientation>(m, "ExifOrientation", nb::is_arithmetic())
       .value("Undefined", ExifOrientation::Undefined, "Set but not a valid value")
@@ -86,7 +317,9 @@ NB_MODULE(bindings, m) {
       .def("__str__", &orientation_to_string, "String representation")
       .def("__repr__", &orientation_to_string, "String representation")
       .def_static("from_exif_value", &orientation_from_exif_value, "Create from EXIF orientation value")
-      .def_static("from_int", &orientation_from_int, "Create from integer");
+      .def_static("from_int", &orientation_from_int, "Create from integer")
+      .def("compose", &orientation_compose, "operation"_a,
+           "The orientation which displays the image as this one does, then rotated or flipped by `operation`");
 
   nb::class_<XmpAreaStruct>(m, "XmpArea")
       .def(nb::init<double, double, double, double, const std::string&, std::optional<double>>(), "h"_a, "w"_a, "x"_a,
@@ -94,6 +327,12 @@ NB_MODULE(bindings, m) {
       .def(nb::self == nb::self) // operator==
       .def(nb::self != nb::self) // operator!=
       .def("__repr__", &XmpAreaStruct::to_string)
+      .def("to_bytes", &toBytes<XmpAreaStruct>, "A compact binary encoding, read back by `from_bytes`")
+      .def_static("from_bytes", &fromBytes<XmpAreaStruct>, "data"_a)
+      .def("__getstate__", &toBytes<XmpAreaStruct>)
+      .def("__setstate__", &setState<XmpAreaStruct>)
+      .def("to_json", &XmpAreaStruct::toJson, "JSON in the structure of the test fixtures")
+      .def_static("from_json", &XmpAreaStruct::fromJson, "json"_a)
       .def_rw("h", &XmpAreaStruct::H)
       .def_rw("w", &XmpAreaStruct::W)
       .def_rw("x", &XmpAreaStruct::X)
@@ -107,6 +346,12 @@ NB_MODULE(bindings, m) {
       .def(nb::self != nb::self) // operator!=
       .def(nb::hash(nb::self))
       .def("__repr__", &DimensionsStruct::to_string)
+      .def("to_bytes", &toBytes<DimensionsStruct>, "A compact binary encoding, read back by `from_bytes`")
+      .def_static("from_bytes", &fromBytes<DimensionsStruct>, "data"_a)
+      .def("__getstate__", &toBytes<DimensionsStruct>)
+      .def("__setstate__", &setState<DimensionsStruct>)
+      .def("to_json", &DimensionsStruct::toJson, "JSON in the structure of the test fixtures")
+      .def_static("from_json", &DimensionsStruct::fromJson, "json"_a)
       .def_rw("h", &DimensionsStruct::H)
       .def_rw("w", &DimensionsStruct::W)
       .def_rw("unit", &DimensionsStruct::Unit);
@@ -117,6 +362,12 @@ NB_MODULE(bindings, m) {
       .def(nb::self == nb::self) // operator==
       .def(nb::self != nb::self) // operator!=
       .def("__repr__", &RegionInfoStruct::RegionStruct::to_string)
+      .def("to_bytes", &toBytes<RegionInfoStruct::RegionStruct>, "A compact binary encoding, read back by `from_bytes`")
+      .def_static("from_bytes", &fromBytes<RegionInfoStruct::RegionStruct>, "data"_a)
+      .def("__getstate__", &toBytes<RegionInfoStruct::RegionStruct>)
+      .def("__setstate__", &setState<RegionInfoStruct::RegionStruct>)
+      .def("to_json", &RegionInfoStruct::RegionStruct::toJson, "JSON in the structure of the test fixtures")
+      .def_static("from_json", &RegionInfoStruct::RegionStruct::fromJson, "json"_a)
       .def_rw("area", &RegionInfoStruct::RegionStruct::Area)
       .def_rw("name", &RegionInfoStruct::RegionStruct::Name)
       .def_rw("type", &RegionInfoStruct::RegionStruct::Type)
@@ -128,9 +379,49 @@ NB_MODULE(bindings, m) {
       .def(nb::self == nb::self) // operator==
       .def(nb::self != nb::self) // operator!=
       .def("__repr__", &RegionInfoStruct::to_string)
+      .def("to_bytes", &toBytes<RegionInfoStruct>, "A compact binary encoding, read back by `from_bytes`")
+      .def_static("from_bytes", &fromBytes<RegionInfoStruct>, "data"_a)
+      .def("__getstate__", &toBytes<RegionInfoStruct>)
+      .def("__setstate__", &setState<RegionInfoStruct>)
+      .def("to_json", &RegionInfoStruct::toJson, "JSON in the structure of the test fixtures")
+      .def_static("from_json", &RegionInfoStruct::fromJson, "json"_a)
+      .def("area_array", &areaArray,
+           "The areas as a float64 array of shape (N, 5), with columns h, w, x, y and d, NaN where d is unset")
+      .def_static("from_arrays", &regionsFromArrays, "applied_to_dimensions"_a, "areas"_a, "names"_a, "types"_a,
+                  "unit"_a = "normalized", "descriptions"_a = std::vector<std::optional<std::string>>(),
+                  "Builds the regions from an (N, 4) or (N, 5) array of h, w, x, y and optionally d, with a name "
+                  "and type per row. A NaN d is left unset.")
+      .def("to_display", &RegionInfoStruct::toDisplay, "orientation"_a,
+           "The regions on the image as displayed with `orientation`, with the dimensions swapped if it turns")
+      .def("to_stored", &RegionInfoStruct::toStored, "orientation"_a,
+           "The reverse of `to_display`, from regions on the displayed image back to the stored one")
       .def_rw("applied_to_dimensions", &RegionInfoStruct::AppliedToDimensions)
       .def_rw("region_list", &RegionInfoStruct::RegionList);
 
+  nb::class_<IndexedRegion>(m, "IndexedRegion", "A region of one image, as returned by RegionIndex queries")
+      .def_ro("image", &IndexedRegion::Image)
+      .def_ro("position", &IndexedRegion::Position, "The position of the region in the region list of its image")
+      .def_ro("name", &IndexedRegion::Name)
+      .def_ro("type", &IndexedRegion::Type)
+      .def_ro("left", &IndexedRegion::Left)
+      .def_ro("top", &IndexedRegion::Top)
+      .def_ro("right", &IndexedRegion::Right)
+      .def_ro("bottom", &IndexedRegion::Bottom)
+      .def_prop_ro("area", &IndexedRegion::area, "The fraction of the frame the region covers");
+
+  nb::class_<RegionIndex>(m, "RegionIndex",
+                          "A uniform grid over normalized coordinates, holding the regions of many images")
+      .def(nb::init<std::size_t>(), "cells_per_side"_a = 32)
+      .def("add", &RegionIndex::add, "image"_a, "regions"_a,
+           "Adds the regions of an image. Pixel areas are normalized against the applied dimensions.")
+      .def("overlapping", &RegionIndex::overlapping, "left"_a, "top"_a, "right"_a, "bottom"_a,
+           "Regions whose bounds overlap the box, in normalized coordinates, edges included")
+      .def("larger_than", &RegionIndex::largerThan, "fraction"_a, "Regions covering more than `fraction` of the frame")
+      .def("duplicates", &RegionIndex::duplicates, "min_overlap"_a = 0.5,
+           "Pairs of regions of the same image with the same name, whose intersection over union is at least "
+           "`min_overlap`")
+      .def("__len__", &RegionIndex::size);
+
   nb::class_<KeywordInfoModel::KeywordStruct>(m, "Keyword")
       .def(nb::init<const std::string&, const std::vector<KeywordInfoModel::KeywordStruct>&, std::optional<bool>>(),
            "keyword"_a, "children"_a, "applied"_a = nb::none())
@@ -141,6 +432,13 @@ NB_MODULE(bindings, m) {
       .def(nb::self == nb::self) // operator==
       .def(nb::self != nb::self) // operator!=
       .def("__repr__", &KeywordInfoModel::KeywordStruct::to_string)
+      .def("to_bytes", &toBytes<KeywordInfoModel::KeywordStruct>,
+           "A compact binary encoding, read back by `from_bytes`")
+      .def_static("from_bytes", &fromBytes<KeywordInfoModel::KeywordStruct>, "data"_a)
+      .def("__getstate__", &toBytes<KeywordInfoModel::KeywordStruct>)
+      .def("__setstate__", &setState<KeywordInfoModel::KeywordStruct>)
+      .def("to_json", &KeywordInfoModel::KeywordStruct::toJson, "JSON in the structure of the test fixtures")
+      .def_static("from_json", &KeywordInfoModel::KeywordStruct::fromJson, "json"_a)
       .def_rw("keyword", &KeywordInfoModel::KeywordStruct::Keyword)
       .def_rw("applied", &KeywordInfoModel::KeywordStruct::Applied)
       .def_rw("children", &KeywordInfoModel::KeywordStruct::Children);
@@ -154,9 +452,220 @@ NB_MODULE(bindings, m) {
       .def(nb::self | nb::self)                                     // operator|
       .def(nb::self |= nb::self, nb::rv_policy::reference_internal) // operator|=
       .def("__repr__", &KeywordInfoModel::to_string)
+      .def("to_bytes", &toBytes<KeywordInfoModel>, "A compact binary encoding, read back by `from_bytes`")
+      .def_static("from_bytes", &fromBytes<KeywordInfoModel>, "data"_a)
+      .def("__getstate__", &toBytes<KeywordInfoModel>)
+      .def("__setstate__", &setState<KeywordInfoModel>)
+      .def("to_json", &KeywordInfoModel::toJson, "JSON in the structure of the test fixtures")
+      .def_static("from_json", &KeywordInfoModel::fromJson, "json"_a)
       .def_rw("hierarchy", &KeywordInfoModel::Hierarchy);
   m.attr("EXIV2_VERSION") = Exiv2::versionString();
   m.attr("EXPAT_VERSION") = XML_ExpatVersion();
+  nb::enum_<ErrorCode>(m, "ErrorCode")
+      .value("FileAccess", ErrorCode::FileAccess, "Raised as FileAccessError")
+      .value("Exiv2", ErrorCode::Exiv2, "Raised as Exiv2Error")
+      .value("InvalidStructure", ErrorCode::InvalidStructure, "Raised as InvalidStructureError")
+      .value("MissingField", ErrorCode::MissingField, "Raised as MissingFieldError")
+      .value("Unknown", ErrorCode::Unknown, "Any other error")
+      .value("Cancelled", ErrorCode::Cancelled, "The batch was cancelled before the file was reached");
+
+  nb::class_<ErrorInfo>(m, "ErrorInfo", "An error reported as a value by a batch operation")
+      .def_ro("code", &ErrorInfo::Code)
+      .def_ro("message", &ErrorInfo::Message)
+      .def_ro("path", &ErrorInfo::Path);
+
+  nb::class_<FileResult>(m, "FileResult", "The outcome of one file in a batch operation")
+      .def_ro("path", &FileResult::Path)
+      .def_ro("error", &FileResult::Error)
+      .def_prop_ro("ok", &FileResult::ok);
+
+  nb::class_<ReadResult>(m, "ReadResult", "The metadata of one file in a batch read, or why it could not be read")
+      .def_ro("path", &ReadResult::Path)
+      .def_ro("metadata", &ReadResult::Metadata)
+      .def_ro("error", &ReadResult::Error)
+      .def_prop_ro("ok", &ReadResult::ok);
+
+  nb::class_<ThreadPoolStats>(m, "ThreadPoolStats", "A snapshot of the counters of the shared thread pool")
+      .def_ro("threads", &ThreadPoolStats::Threads)
+      .def_ro("queued", &ThreadPoolStats::Queued, "Tasks waiting in any queue")
+      .def_ro("active", &ThreadPoolStats::Active, "Tasks currently running")
+      .def_ro("submitted", &ThreadPoolStats::Submitted)
+      .def_ro("completed", &ThreadPoolStats::Completed)
+      .def_ro("stolen", &ThreadPoolStats::Stolen, "Tasks a worker took from another worker's queue");
+
+  nb::class_<MetadataCacheStats>(m, "MetadataCacheStats", "A snapshot of the counters of the metadata cache")
+      .def_ro("capacity", &MetadataCacheStats::Capacity)
+      .def_ro("entries", &MetadataCacheStats::Entries)
+      .def_ro("hits", &MetadataCacheStats::Hits)
+      .def_ro("misses", &MetadataCacheStats::Misses,
+              "Lookups with no entry, or an entry for a file which has changed since")
+      .def_ro("evictions", &MetadataCacheStats::Evictions);
+
+  nb::class_<MemoryBudget>(m, "MemoryBudget",
+                           "Caps the estimated memory of the files batch operations have open at once, shared by "
+                           "every batch it is passed to")
+      .def(nb::init<std::uint64_t>(), "limit"_a = 0)
+      .def_prop_ro("limit", &MemoryBudget::limit, "Bytes which may be in use at once, 0 for no limit")
+      .def_prop_ro("in_use", &MemoryBudget::inUse);
+
+  nb::class_<CancellationToken>(m, "CancellationToken",
+                                "Stops a running batch operation from another thread, between files")
+      .def(nb::init<>())
+      .def("cancel", &CancellationToken::cancel)
+      .def_prop_ro("cancelled", &CancellationToken::cancelled);
+
+  nb::class_<BatchProgress>(m, "BatchProgress", "How far a batch operation has come")
+      .def_ro("files_done", &BatchProgress::FilesDone)
+      .def_ro("files_total", &BatchProgress::FilesTotal, "0 when not known up front, as for a directory scan")
+      .def_ro("bytes_read", &BatchProgress::BytesRead)
+      .def_ro("errors", &BatchProgress::Errors);
+
+  nb::class_<BatchOptions>(m, "BatchOptions", "Progress reporting and cancellation for the batch operations")
+      .def(nb::init<>())
+      .def_rw("progress", &BatchOptions::Progress,
+              "Called with a BatchProgress at most once per interval, and once more when the batch ends")
+      .def_rw("progress_interval_ms", &BatchOptions::ProgressIntervalMs)
+      .def_rw("cancellation", &BatchOptions::Cancellation)
+      .def_rw("memory", &BatchOptions::Memory, "Files wait to be opened while their estimated footprint does not fit");
+
+  m.def("configure_thread_pool", &ThreadPool::configureShared, "threads"_a = 0,
+        nb::call_guard<nb::gil_scoped_release>(),
+        "Sets the number of workers of the thread pool shared by all batch operations, 0 for one per CPU. "
+        "Batches already running finish on the previous pool.");
+  m.def("thread_pool_stats", &ThreadPool::sharedStats,
+        "Returns the counters of the thread pool shared by all batch operations");
+
+  m.def("configure_metadata_cache", &MetadataCache::configureShared, "capacity"_a,
+        "Keeps the metadata of up to `capacity` recently read files, returned while the file is unchanged. "
+        "0 disables the cache.");
+  m.def("metadata_cache_stats", &MetadataCache::sharedStats, "Returns the counters of the metadata cache");
+  m.def("clear_metadata_cache", &MetadataCache::clearShared, "Drops every entry of the metadata cache");
+
+  m.def("write_many", &Batch::writeMany, "jobs"_a, "threads"_a = 0, "options"_a = WriteOptions(),
+        "batch"_a = BatchOptions(), nb::call_guard<nb::gil_scoped_release>(),
+        "Writes each (metadata, target_path) pair on the shared thread pool, at most `threads` at once (0 for "
+        "the pool size), returning one result per job instead of raising.");
+  m.def("clear_many", &Batch::clearMany, "paths"_a, "threads"_a = 0, "options"_a = WriteOptions(),
+        "batch"_a = BatchOptions(), nb::call_guard<nb::gil_scoped_release>(),
+        "Clears all supported metadata fields from each file on the shared thread pool, with a single rewrite per "
+        "file, returning one result per path instead of raising. This is a destructive operation.");
+  m.def("rotate_many", &Batch::rotateMany, "paths"_a, "operation"_a, "regions"_a = RegionSpace::Stored,
+        "threads"_a = 0, "options"_a = WriteOptions(), "batch"_a = BatchOptions(),
+        nb::call_guard<nb::gil_scoped_release>(),
+        "Rotates or flips each file like `ImageMetadata.rotate` on the shared thread pool, opening and writing each "
+        "file once, returning one result per path instead of raising.");
+  m.def("read_many", &Batch::readMany, "paths"_a, "threads"_a = 0, "options"_a = ReadOptions(),
+        "batch"_a = BatchOptions(), nb::call_guard<nb::gil_scoped_release>(),
+        "Reads each path on the shared thread pool, at most `threads` at once (0 for the pool size), returning "
+        "one result per path instead of raising.");
+  m.def("scan_directory", &Batch::scanDirectory, "root"_a, "recursive"_a = true,
+        "extensions"_a = std::vector<std::string>(), "batch"_a = BatchOptions(),
+        nb::call_guard<nb::gil_scoped_release>(),
+        "Lists the image files below `root`, sorted, scanning subdirectories in parallel on the shared thread "
+        "pool. `extensions` defaults to every format Exiv2 reads metadata from.");
+
+  nb::class_<ArrowBatch>(m, "ArrowBatch",
+                         "Batch read results as Arrow columns, one row per path, exported through the Arrow "
+                         "PyCapsule interface to pyarrow, polars and other Arrow consumers without copying")
+      .def(nb::init<const std::vector<ReadResult>&>(), "results"_a)
+      .def("__len__", &ArrowBatch::size)
+      .def("__arrow_c_schema__", &arrowSchema)
+      .def("__arrow_c_array__", &arrowArray, "requested_schema"_a = nb::none());
+  m.def("read_many_arrow", &Batch::readManyArrow, "paths"_a, "threads"_a = 0, "options"_a = ReadOptions(),
+        "batch"_a = BatchOptions(), nb::call_guard<nb::gil_scoped_release>(),
+        "Like `read_many`, returning the results as an ArrowBatch, such as for `pyarrow.record_batch`.");
+
+  nb::class_<PersonOccurrence>(m, "PersonOccurrence", "The regions of one image which carry a name")
+      .def_ro("image", &PersonOccurrence::Image)
+      .def_ro("positions", &PersonOccurrence::Positions,
+              "The positions of the regions in the region list of the image, ascending");
+
+  nb::class_<PersonIndex>(m, "PersonIndex", "An inverted index from region names to the images and regions which "
+                                            "carry them, built incrementally from batch reads")
+      .def(nb::init<>())
+      .def("add", nb::overload_cast<const fs::path&, const RegionInfoStruct&>(&PersonIndex::add), "image"_a,
+           "regions"_a, "Replaces the regions indexed for `image`")
+      .def("add_results", nb::overload_cast<const std::vector<ReadResult>&>(&PersonIndex::add), "results"_a,
+           "Adds each successful read, such as from `read_many`. Files read without regions are removed, failed "
+           "reads are skipped.")
+      .def("remove", &PersonIndex::remove, "image"_a)
+      .def("names", &PersonIndex::names, "type"_a = nb::none(),
+           "Every name, sorted, only those of regions of `type` when given")
+      .def("find", &PersonIndex::find, "name"_a, "type"_a = nb::none(),
+           "The images with a region of `name`, sorted by path, only regions of `type` when given")
+      .def_prop_ro("image_count", &PersonIndex::imageCount)
+      .def("__len__", &PersonIndex::size, "The number of distinct names");
+
+  m.def("rename_person", &renamePerson, "index"_a, "old_name"_a, "new_name"_a, "type"_a = nb::none(),
+        "threads"_a = 0, "options"_a = WriteOptions(), "batch"_a = BatchOptions(),
+        "Renames the regions called `old_name` in every file `index` lists for them, writing each file once, and "
+        "updates the index. Renaming onto a name which exists merges the two. Returns one result per file.");
+
+  nb::class_<CatalogWriter>(m, "CatalogWriter", "Collects metadata and writes it as a catalog which CatalogReader maps")
+      .def(nb::init<>())
+      .def("add", nb::overload_cast<const fs::path&, const ImageMetadata&>(&CatalogWriter::add), "path"_a, "metadata"_a,
+           "Adds the metadata of a file, keyed by its path and its current identity. Call it right after reading.")
+      .def("write", &writeCatalog, "target"_a, "durability"_a = DurabilityLevel::Deferred,
+           "Writes the catalog, replacing `target` atomically")
+      .def("__len__", &CatalogWriter::size);
+
+  nb::class_<CatalogReader>(m, "CatalogReader",
+                            "A catalog file mapped read-only, with records built only when they are looked up")
+      .def(nb::init<const fs::path&>(), "path"_a)
+      .def("find", &CatalogReader::find, "path"_a, "The index of the record of a file, in path order")
+      .def("path", &CatalogReader::path, "index"_a)
+      .def("metadata", &CatalogReader::metadata, "index"_a)
+      .def("lookup", &CatalogReader::lookup, "path"_a,
+           "The metadata of a file if it is in the catalog and has not changed since it was recorded")
+      .def("__len__", &CatalogReader::size);
+
+  m.def("build_catalog", &Batch::buildCatalog, "paths"_a, "target"_a, "threads"_a = 0, "options"_a = ReadOptions(),
+        "batch"_a = BatchOptions(), nb::call_guard<nb::gil_scoped_release>(),
+        "Reads each path on the shared thread pool and writes the metadata of every readable file into a catalog "
+        "at `target`, returning one result per path. A cancelled batch does not write the catalog.");
+
+  nb::class_<CatalogRefresh>(m, "CatalogRefresh", "What a catalog refresh found, and the files it could not read")
+      .def_ro("unchanged", &CatalogRefresh::Unchanged,
+              "Files whose identity matched their record, which was kept without reading them")
+      .def_ro("added", &CatalogRefresh::Added)
+      .def_ro("updated", &CatalogRefresh::Updated)
+      .def_ro("removed", &CatalogRefresh::Removed)
+      .def_ro("errors", &CatalogRefresh::Errors,
+              "New or changed files which could not be read, and are left out of the catalog");
+
+  m.def("refresh_catalog", &Batch::refreshCatalog, "paths"_a, "catalog"_a, "threads"_a = 0,
+        "options"_a = ReadOptions(), "batch"_a = BatchOptions(), nb::call_guard<nb::gil_scoped_release>(),
+        "Brings a catalog up to date with a complete listing of the files it should hold, such as from "
+        "`scan_directory`. Only new and changed files are read, records of files not listed are dropped.");
+  m.def("update_catalog", &Batch::updateCatalog, "paths"_a, "catalog"_a, "threads"_a = 0,
+        "options"_a = ReadOptions(), "batch"_a = BatchOptions(), nb::call_guard<nb::gil_scoped_release>(),
+        "Like `refresh_catalog` for the listed files only, such as those a `DirectoryWatcher` reported. Records "
+        "of other files are kept as they are.");
+
+  nb::class_<DirectoryWatcher>(m, "DirectoryWatcher",
+                               "Collects the image files created, changed, moved or removed below a directory, "
+                               "using inotify. Only available on Linux.")
+      .def(nb::init<const fs::path&, bool, const std::vector<std::string>&>(), "root"_a, "recursive"_a = true,
+           "extensions"_a = std::vector<std::string>())
+      .def("poll", &pollWatcher, "timeout_ms"_a = 0,
+           "Waits up to `timeout_ms` for a change, -1 for no limit, then returns the affected files, sorted")
+      .def_prop_ro("rescan_needed", &DirectoryWatcher::rescanNeeded,
+                   "Whether events were lost during the last poll, so a full refresh is needed")
+      .def_prop_ro("root", &DirectoryWatcher::root)
+      .def_static("supported", &DirectoryWatcher::supported);
+
+  nb::class_<MetadataPipeline>(m, "MetadataPipeline",
+                               "Reads, transforms and writes back many files, with the three stages running "
+                               "concurrently over bounded queues")
+      .def(nb::init<std::size_t, const WriteOptions&, const MemoryBudget&>(), "window"_a = 64,
+           "options"_a = WriteOptions(), "memory"_a = MemoryBudget())
+      .def("run", &runPipeline, "paths"_a, "transform"_a,
+           "Reads each path on the shared thread pool, calls `transform(metadata)` on this thread and writes the "
+           "metadata back on the pool when it returns True. The GIL is only held while `transform` runs. The "
+           "metadata is a copy, which stays valid if `transform` keeps it.")
+      .def_prop_ro("window", &MetadataPipeline::window)
+      .def_prop_ro("memory", &MetadataPipeline::memory);
+
   // Register base exception first
   auto base_exc = nb::exception<ExifMwgBaseError>(m, "ExifMwgBaseError");
   // Register derived exceptions with explicit parent
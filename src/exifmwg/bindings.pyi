@@ -1,8 +1,103 @@
 import enum
 import os
+import pathlib
+from collections.abc import Callable
 from collections.abc import Sequence
 from typing import overload
 
+import numpy
+from numpy.typing import ArrayLike
+from numpy.typing import NDArray
+
+class SidecarPolicy(enum.Enum):
+    Ignore = 0
+    """The sidecar is never read"""
+
+    Merge = 1
+    """Fields set in the sidecar replace the embedded ones"""
+
+    Authoritative = 2
+    """
+    Every field comes from the sidecar when one exists, only the dimensions come from the image
+    """
+
+class ReadOptions:
+    """Controls how metadata is read from a file"""
+
+    def __init__(self) -> None: ...
+    @property
+    def sidecar(self) -> SidecarPolicy:
+        """How an XMP sidecar next to the image is combined with it"""
+
+    @sidecar.setter
+    def sidecar(self, arg: SidecarPolicy, /) -> None: ...
+    @property
+    def lenient(self) -> bool:
+        """
+        Skip malformed regions and keyword nodes, recording them in `diagnostics`, instead of failing the read
+        """
+
+    @lenient.setter
+    def lenient(self, arg: bool, /) -> None: ...
+
+class DurabilityLevel(enum.Enum):
+    Deferred = 0
+    """Flushing is deferred to the operating system"""
+
+    FileData = 1
+    """The file contents are flushed (fdatasync)"""
+
+    FileAndDirectory = 2
+    """The file and its directory entry are flushed (fsync of both)"""
+
+class RegionSpace(enum.Enum):
+    Stored = 0
+    """
+    Regions are relative to the image as stored, before the orientation is applied, as MWG specifies
+    """
+
+    Displayed = 1
+    """Regions are relative to the image as displayed, with the orientation applied"""
+
+class WriteOptions:
+    """Controls how metadata is written to a file"""
+
+    def __init__(self) -> None: ...
+    @property
+    def xmp_padding(self) -> int:
+        """Bytes of whitespace reserved in the XMP packet on a full rewrite, 0 for none"""
+
+    @xmp_padding.setter
+    def xmp_padding(self, arg: int, /) -> None: ...
+    @property
+    def in_place_xmp(self) -> bool:
+        """
+        Overwrite the existing XMP packet in place when only XMP fields changed and the new packet fits
+        """
+
+    @in_place_xmp.setter
+    def in_place_xmp(self, arg: bool, /) -> None: ...
+    @property
+    def sidecar(self) -> bool:
+        """Write only an XMP sidecar next to the image, leaving it untouched"""
+
+    @sidecar.setter
+    def sidecar(self, arg: bool, /) -> None: ...
+    @property
+    def atomic(self) -> bool:
+        """
+        Write a temporary copy next to the file and rename it over the file, instead of rewriting it in place
+        """
+
+    @atomic.setter
+    def atomic(self, arg: bool, /) -> None: ...
+    @property
+    def durability(self) -> DurabilityLevel:
+        """How far the write is flushed to storage before returning"""
+
+    @durability.setter
+    def durability(self, arg: DurabilityLevel, /) -> None: ...
+
 class ImageMetadata:
     @overload
     def __init__(
@@ -20,19 +115,47 @@ class ImageMetadata:
         location: str | None = None,
     ) -> None: ...
     @overload
-    def __init__(self, path: str | os.PathLike) -> None: ...
+    def __init__(self, path: str | os.PathLike, options: ReadOptions = ...) -> None: ...
     def __eq__(self, arg: ImageMetadata, /) -> bool: ...
     def __ne__(self, arg: ImageMetadata, /) -> bool: ...
     def __repr__(self) -> str: ...
-    def to_file(self, new_path: str | os.PathLike | None = None) -> None:
+    def to_bytes(self) -> bytes:
+        """A compact binary encoding, read back by `from_bytes`"""
+
+    @staticmethod
+    def from_bytes(data: bytes) -> ImageMetadata: ...
+    def __getstate__(self) -> bytes: ...
+    def __setstate__(self, state: bytes) -> None: ...
+    def to_json(self) -> str:
+        """JSON in the structure of the test fixtures"""
+
+    @staticmethod
+    def from_json(json: str) -> ImageMetadata: ...
+    @staticmethod
+    def to_json_array(metadata: Sequence[ImageMetadata]) -> str:
+        """Encodes a whole list as one JSON array"""
+
+    @staticmethod
+    def from_json_array(json: str) -> list[ImageMetadata]: ...
+    def to_file(self, new_path: str | os.PathLike | None = None, options: WriteOptions = ...) -> None:
         """
-        If `new_path` is provided, the original image is copied to the new location and the metadata is written to the new file. Otherwise, it overwrites the original file with the updated metadata.
+        If `new_path` is provided, the original image is copied to the new location and the metadata is written to the new file. Otherwise, it overwrites the original file with the updated metadata. The target is opened and parsed again, use `MetadataSession` for a read-modify-write which parses the file once.
         """
 
     @staticmethod
-    def clear_file(path: str | os.PathLike) -> None:
+    def sidecar_path(image_path: str | os.PathLike) -> pathlib.Path:
+        """
+        The XMP sidecar path which belongs to an image, `IMG_0001.CR2.xmp` when it exists, otherwise `IMG_0001.xmp`. A sidecar write uses the first form when another image shares the stem.
         """
-        Clears all supported metadata fields from the object and saves the changes back to the original file. This is a destructive operation.
+
+    def clear_file(self, path: str | os.PathLike | None = None, options: WriteOptions = ...) -> None:
+        """
+        Clears all supported metadata fields from the object and saves the changes back to `path`, or the original file. `options` controls whether the rewrite is atomic and durable, the sidecar option does not apply. This is a destructive operation.
+        """
+
+    def rotate(self, operation: ExifOrientation, regions: RegionSpace = RegionSpace.Stored) -> None:
+        """
+        Rotates or flips the image as displayed by composing `operation` with the orientation. The pixels are untouched, regions relative to the displayed image are transformed along with it.
         """
 
     @property
@@ -75,6 +198,428 @@ class ImageMetadata:
     def location(self) -> str | None: ...
     @location.setter
     def location(self, arg: str, /) -> None: ...
+    @property
+    def diagnostics(self) -> list[ErrorInfo]:
+        """Entries skipped by a lenient read, in encounter order"""
+
+class MetadataSession:
+    """Keeps an image open across a read-modify-write, so the file is only parsed once"""
+
+    def __init__(self, path: str | os.PathLike) -> None: ...
+    def read(self, lenient: bool = False) -> ImageMetadata:
+        """
+        Parses the metadata of the open image. With `lenient`, malformed entries are skipped into `diagnostics`.
+        """
+
+    def stage(self, metadata: ImageMetadata) -> None:
+        """
+        Applies the set fields of `metadata` in memory. Nothing is written until `commit` is called.
+        """
+
+    def clear(self) -> None:
+        """
+        Removes all supported metadata fields in memory. Nothing is written until `commit` is called.
+        """
+
+    def commit(self, options: WriteOptions = ...) -> None:
+        """Writes all staged changes to the file"""
+
+    @property
+    def path(self) -> pathlib.Path: ...
+    @property
+    def dirty(self) -> bool: ...
+
+class ErrorCode(enum.Enum):
+    FileAccess = 0
+    """Raised as FileAccessError"""
+
+    Exiv2 = 1
+    """Raised as Exiv2Error"""
+
+    InvalidStructure = 2
+    """Raised as InvalidStructureError"""
+
+    MissingField = 3
+    """Raised as MissingFieldError"""
+
+    Unknown = 4
+    """Any other error"""
+
+    Cancelled = 5
+    """The batch was cancelled before the file was reached"""
+
+class ErrorInfo:
+    """An error reported as a value by a batch operation"""
+
+    @property
+    def code(self) -> ErrorCode: ...
+    @property
+    def message(self) -> str: ...
+    @property
+    def path(self) -> pathlib.Path: ...
+
+class FileResult:
+    """The outcome of one file in a batch operation"""
+
+    @property
+    def path(self) -> pathlib.Path: ...
+    @property
+    def error(self) -> ErrorInfo | None: ...
+    @property
+    def ok(self) -> bool: ...
+
+class ReadResult:
+    """The metadata of one file in a batch read, or why it could not be read"""
+
+    @property
+    def path(self) -> pathlib.Path: ...
+    @property
+    def metadata(self) -> ImageMetadata | None: ...
+    @property
+    def error(self) -> ErrorInfo | None: ...
+    @property
+    def ok(self) -> bool: ...
+
+class ThreadPoolStats:
+    """A snapshot of the counters of the shared thread pool"""
+
+    @property
+    def threads(self) -> int: ...
+    @property
+    def queued(self) -> int:
+        """Tasks waiting in any queue"""
+
+    @property
+    def active(self) -> int:
+        """Tasks currently running"""
+
+    @property
+    def submitted(self) -> int: ...
+    @property
+    def completed(self) -> int: ...
+    @property
+    def stolen(self) -> int:
+        """Tasks a worker took from another worker's queue"""
+
+class MetadataCacheStats:
+    """A snapshot of the counters of the metadata cache"""
+
+    @property
+    def capacity(self) -> int: ...
+    @property
+    def entries(self) -> int: ...
+    @property
+    def hits(self) -> int: ...
+    @property
+    def misses(self) -> int:
+        """Lookups with no entry, or an entry for a file which has changed since"""
+
+    @property
+    def evictions(self) -> int: ...
+
+class MemoryBudget:
+    """
+    Caps the estimated memory of the files batch operations have open at once, shared by every batch it is passed to
+    """
+
+    def __init__(self, limit: int = 0) -> None: ...
+    @property
+    def limit(self) -> int:
+        """Bytes which may be in use at once, 0 for no limit"""
+
+    @property
+    def in_use(self) -> int: ...
+
+class CancellationToken:
+    """Stops a running batch operation from another thread, between files"""
+
+    def __init__(self) -> None: ...
+    def cancel(self) -> None: ...
+    @property
+    def cancelled(self) -> bool: ...
+
+class BatchProgress:
+    """How far a batch operation has come"""
+
+    @property
+    def files_done(self) -> int: ...
+    @property
+    def files_total(self) -> int:
+        """0 when not known up front, as for a directory scan"""
+
+    @property
+    def bytes_read(self) -> int: ...
+    @property
+    def errors(self) -> int: ...
+
+class BatchOptions:
+    """Progress reporting and cancellation for the batch operations"""
+
+    def __init__(self) -> None: ...
+    @property
+    def progress(self) -> Callable[[BatchProgress], None] | None:
+        """Called with a BatchProgress at most once per interval, and once more when the batch ends"""
+
+    @progress.setter
+    def progress(self, arg: Callable[[BatchProgress], None] | None, /) -> None: ...
+    @property
+    def progress_interval_ms(self) -> int: ...
+    @progress_interval_ms.setter
+    def progress_interval_ms(self, arg: int, /) -> None: ...
+    @property
+    def cancellation(self) -> CancellationToken: ...
+    @cancellation.setter
+    def cancellation(self, arg: CancellationToken, /) -> None: ...
+    @property
+    def memory(self) -> MemoryBudget:
+        """Files wait to be opened while their estimated footprint does not fit"""
+
+    @memory.setter
+    def memory(self, arg: MemoryBudget, /) -> None: ...
+
+def configure_thread_pool(threads: int = 0) -> None:
+    """
+    Sets the number of workers of the thread pool shared by all batch operations, 0 for one per CPU. Batches already running finish on the previous pool.
+    """
+
+def thread_pool_stats() -> ThreadPoolStats:
+    """Returns the counters of the thread pool shared by all batch operations"""
+
+def configure_metadata_cache(capacity: int) -> None:
+    """
+    Keeps the metadata of up to `capacity` recently read files, returned while the file is unchanged. 0 disables the cache.
+    """
+
+def metadata_cache_stats() -> MetadataCacheStats:
+    """Returns the counters of the metadata cache"""
+
+def clear_metadata_cache() -> None:
+    """Drops every entry of the metadata cache"""
+
+def write_many(
+    jobs: Sequence[tuple[ImageMetadata, str | os.PathLike]],
+    threads: int = 0,
+    options: WriteOptions = ...,
+    batch: BatchOptions = ...,
+) -> list[FileResult]:
+    """
+    Writes each (metadata, target_path) pair on the shared thread pool, at most `threads` at once (0 for the pool size), returning one result per job instead of raising.
+    """
+
+def clear_many(
+    paths: Sequence[str | os.PathLike],
+    threads: int = 0,
+    options: WriteOptions = ...,
+    batch: BatchOptions = ...,
+) -> list[FileResult]:
+    """
+    Clears all supported metadata fields from each file on the shared thread pool, with a single rewrite per file, returning one result per path instead of raising. This is a destructive operation.
+    """
+
+def rotate_many(
+    paths: Sequence[str | os.PathLike],
+    operation: ExifOrientation,
+    regions: RegionSpace = RegionSpace.Stored,
+    threads: int = 0,
+    options: WriteOptions = ...,
+    batch: BatchOptions = ...,
+) -> list[FileResult]:
+    """
+    Rotates or flips each file like `ImageMetadata.rotate` on the shared thread pool, opening and writing each file once, returning one result per path instead of raising.
+    """
+
+def read_many(
+    paths: Sequence[str | os.PathLike], threads: int = 0, options: ReadOptions = ..., batch: BatchOptions = ...
+) -> list[ReadResult]:
+    """
+    Reads each path on the shared thread pool, at most `threads` at once (0 for the pool size), returning one result per path instead of raising.
+    """
+
+def scan_directory(
+    root: str | os.PathLike, recursive: bool = True, extensions: Sequence[str] = [], batch: BatchOptions = ...
+) -> list[pathlib.Path]:
+    """
+    Lists the image files below `root`, sorted, scanning subdirectories in parallel on the shared thread pool. `extensions` defaults to every format Exiv2 reads metadata from.
+    """
+
+class ArrowBatch:
+    """
+    Batch read results as Arrow columns, one row per path, exported through the Arrow PyCapsule interface to pyarrow, polars and other Arrow consumers without copying
+    """
+
+    def __init__(self, results: Sequence[ReadResult]) -> None: ...
+    def __len__(self) -> int: ...
+    def __arrow_c_schema__(self) -> object: ...
+    def __arrow_c_array__(self, requested_schema: object | None = None) -> tuple[object, object]: ...
+
+def read_many_arrow(
+    paths: Sequence[str | os.PathLike], threads: int = 0, options: ReadOptions = ..., batch: BatchOptions = ...
+) -> ArrowBatch:
+    """Like `read_many`, returning the results as an ArrowBatch, such as for `pyarrow.record_batch`."""
+
+class PersonOccurrence:
+    """The regions of one image which carry a name"""
+
+    @property
+    def image(self) -> pathlib.Path: ...
+    @property
+    def positions(self) -> list[int]:
+        """The positions of the regions in the region list of the image, ascending"""
+
+class PersonIndex:
+    """
+    An inverted index from region names to the images and regions which carry them, built incrementally from batch reads
+    """
+
+    def __init__(self) -> None: ...
+    def add(self, image: str | os.PathLike, regions: RegionInfo) -> None:
+        """Replaces the regions indexed for `image`"""
+
+    def add_results(self, results: Sequence[ReadResult]) -> None:
+        """
+        Adds each successful read, such as from `read_many`. Files read without regions are removed, failed reads are skipped.
+        """
+
+    def remove(self, image: str | os.PathLike) -> None: ...
+    def names(self, type: str | None = None) -> list[str]:
+        """Every name, sorted, only those of regions of `type` when given"""
+
+    def find(self, name: str, type: str | None = None) -> list[PersonOccurrence]:
+        """The images with a region of `name`, sorted by path, only regions of `type` when given"""
+
+    @property
+    def image_count(self) -> int: ...
+    def __len__(self) -> int:
+        """The number of distinct names"""
+
+def rename_person(
+    index: PersonIndex,
+    old_name: str,
+    new_name: str,
+    type: str | None = None,
+    threads: int = 0,
+    options: WriteOptions = ...,
+    batch: BatchOptions = ...,
+) -> list[FileResult]:
+    """
+    Renames the regions called `old_name` in every file `index` lists for them, writing each file once, and updates the index. Renaming onto a name which exists merges the two. Returns one result per file.
+    """
+
+class CatalogWriter:
+    """Collects metadata and writes it as a catalog which CatalogReader maps"""
+
+    def __init__(self) -> None: ...
+    def add(self, path: str | os.PathLike, metadata: ImageMetadata) -> None:
+        """
+        Adds the metadata of a file, keyed by its path and its current identity. Call it right after reading.
+        """
+
+    def write(self, target: str | os.PathLike, durability: DurabilityLevel = DurabilityLevel.Deferred) -> None:
+        """Writes the catalog, replacing `target` atomically"""
+
+    def __len__(self) -> int: ...
+
+class CatalogReader:
+    """A catalog file mapped read-only, with records built only when they are looked up"""
+
+    def __init__(self, path: str | os.PathLike) -> None: ...
+    def find(self, path: str | os.PathLike) -> int | None:
+        """The index of the record of a file, in path order"""
+
+    def path(self, index: int) -> str: ...
+    def metadata(self, index: int) -> ImageMetadata: ...
+    def lookup(self, path: str | os.PathLike) -> ImageMetadata | None:
+        """The metadata of a file if it is in the catalog and has not changed since it was recorded"""
+
+    def __len__(self) -> int: ...
+
+def build_catalog(
+    paths: Sequence[str | os.PathLike],
+    target: str | os.PathLike,
+    threads: int = 0,
+    options: ReadOptions = ...,
+    batch: BatchOptions = ...,
+) -> list[FileResult]:
+    """
+    Reads each path on the shared thread pool and writes the metadata of every readable file into a catalog at `target`, returning one result per path. A cancelled batch does not write the catalog.
+    """
+
+class CatalogRefresh:
+    """What a catalog refresh found, and the files it could not read"""
+
+    @property
+    def unchanged(self) -> int:
+        """Files whose identity matched their record, which was kept without reading them"""
+
+    @property
+    def added(self) -> list[pathlib.Path]: ...
+    @property
+    def updated(self) -> list[pathlib.Path]: ...
+    @property
+    def removed(self) -> list[pathlib.Path]: ...
+    @property
+    def errors(self) -> list[ErrorInfo]:
+        """New or changed files which could not be read, and are left out of the catalog"""
+
+def refresh_catalog(
+    paths: Sequence[str | os.PathLike],
+    catalog: str | os.PathLike,
+    threads: int = 0,
+    options: ReadOptions = ...,
+    batch: BatchOptions = ...,
+) -> CatalogRefresh:
+    """
+    Brings a catalog up to date with a complete listing of the files it should hold, such as from `scan_directory`. Only new and changed files are read, records of files not listed are dropped.
+    """
+
+def update_catalog(
+    paths: Sequence[str | os.PathLike],
+    catalog: str | os.PathLike,
+    threads: int = 0,
+    options: ReadOptions = ...,
+    batch: BatchOptions = ...,
+) -> CatalogRefresh:
+    """
+    Like `refresh_catalog` for the listed files only, such as those a `DirectoryWatcher` reported. Records of other files are kept as they are.
+    """
+
+class DirectoryWatcher:
+    """
+    Collects the image files created, changed, moved or removed below a directory, using inotify. Only available on Linux.
+    """
+
+    def __init__(self, root: str | os.PathLike, recursive: bool = True, extensions: Sequence[str] = []) -> None: ...
+    def poll(self, timeout_ms: int = 0) -> list[pathlib.Path]:
+        """
+        Waits up to `timeout_ms` for a change, -1 for no limit, then returns the affected files, sorted
+        """
+
+    @property
+    def rescan_needed(self) -> bool:
+        """Whether events were lost during the last poll, so a full refresh is needed"""
+
+    @property
+    def root(self) -> pathlib.Path: ...
+    @staticmethod
+    def supported() -> bool: ...
+
+class MetadataPipeline:
+    """
+    Reads, transforms and writes back many files, with the three stages running concurrently over bounded queues
+    """
+
+    def __init__(self, window: int = 64, options: WriteOptions = ..., memory: MemoryBudget = ...) -> None: ...
+    def run(
+        self, paths: Sequence[str | os.PathLike], transform: Callable[[ImageMetadata], bool]
+    ) -> list[FileResult]:
+        """
+        Reads each path on the shared thread pool, calls `transform(metadata)` on this thread and writes the metadata back on the pool when it returns True. The GIL is only held while `transform` runs. The metadata is a copy, which stays valid if `transform` keeps it.
+        """
+
+    @property
+    def window(self) -> int: ...
+    @property
+    def memory(self) -> MemoryBudget: ...
 
 class ExifOrientation(enum.IntEnum):
     def __str__(self) -> str:
@@ -134,6 +679,11 @@ class ExifOrientation(enum.IntEnum):
     LeftBottom = 8
     """90° CCW rotation"""
 
+    def compose(self, operation: ExifOrientation) -> ExifOrientation:
+        """
+        The orientation which displays the image as this one does, then rotated or flipped by `operation`
+        """
+
     def to_exif_value(self) -> int:
         """Convert to EXIF orientation value"""
 
@@ -153,6 +703,18 @@ class XmpArea:
     def __eq__(self, arg: XmpArea, /) -> bool: ...
     def __ne__(self, arg: XmpArea, /) -> bool: ...
     def __repr__(self) -> str: ...
+    def to_bytes(self) -> bytes:
+        """A compact binary encoding, read back by `from_bytes`"""
+
+    @staticmethod
+    def from_bytes(data: bytes) -> XmpArea: ...
+    def __getstate__(self) -> bytes: ...
+    def __setstate__(self, state: bytes) -> None: ...
+    def to_json(self) -> str:
+        """JSON in the structure of the test fixtures"""
+
+    @staticmethod
+    def from_json(json: str) -> XmpArea: ...
     @property
     def h(self) -> float: ...
     @h.setter
@@ -184,6 +746,18 @@ class Dimensions:
     def __ne__(self, arg: Dimensions, /) -> bool: ...
     def __hash__(self) -> int: ...
     def __repr__(self) -> str: ...
+    def to_bytes(self) -> bytes:
+        """A compact binary encoding, read back by `from_bytes`"""
+
+    @staticmethod
+    def from_bytes(data: bytes) -> Dimensions: ...
+    def __getstate__(self) -> bytes: ...
+    def __setstate__(self, state: bytes) -> None: ...
+    def to_json(self) -> str:
+        """JSON in the structure of the test fixtures"""
+
+    @staticmethod
+    def from_json(json: str) -> Dimensions: ...
     @property
     def h(self) -> float: ...
     @h.setter
@@ -202,6 +776,18 @@ class Region:
     def __eq__(self, arg: Region, /) -> bool: ...
     def __ne__(self, arg: Region, /) -> bool: ...
     def __repr__(self) -> str: ...
+    def to_bytes(self) -> bytes:
+        """A compact binary encoding, read back by `from_bytes`"""
+
+    @staticmethod
+    def from_bytes(data: bytes) -> Region: ...
+    def __getstate__(self) -> bytes: ...
+    def __setstate__(self, state: bytes) -> None: ...
+    def to_json(self) -> str:
+        """JSON in the structure of the test fixtures"""
+
+    @staticmethod
+    def from_json(json: str) -> Region: ...
     @property
     def area(self) -> XmpArea: ...
     @area.setter
@@ -224,6 +810,40 @@ class RegionInfo:
     def __eq__(self, arg: RegionInfo, /) -> bool: ...
     def __ne__(self, arg: RegionInfo, /) -> bool: ...
     def __repr__(self) -> str: ...
+    def to_bytes(self) -> bytes:
+        """A compact binary encoding, read back by `from_bytes`"""
+
+    @staticmethod
+    def from_bytes(data: bytes) -> RegionInfo: ...
+    def __getstate__(self) -> bytes: ...
+    def __setstate__(self, state: bytes) -> None: ...
+    def to_json(self) -> str:
+        """JSON in the structure of the test fixtures"""
+
+    @staticmethod
+    def from_json(json: str) -> RegionInfo: ...
+    def area_array(self) -> NDArray[numpy.float64]:
+        """The areas as a float64 array of shape (N, 5), with columns h, w, x, y and d, NaN where d is unset"""
+
+    @staticmethod
+    def from_arrays(
+        applied_to_dimensions: Dimensions,
+        areas: ArrayLike,
+        names: Sequence[str],
+        types: Sequence[str],
+        unit: str = "normalized",
+        descriptions: Sequence[str | None] = [],
+    ) -> RegionInfo:
+        """
+        Builds the regions from an (N, 4) or (N, 5) array of h, w, x, y and optionally d, with a name and type per row. A NaN d is left unset.
+        """
+
+    def to_display(self, orientation: ExifOrientation) -> RegionInfo:
+        """The regions on the image as displayed with `orientation`, with the dimensions swapped if it turns"""
+
+    def to_stored(self, orientation: ExifOrientation) -> RegionInfo:
+        """The reverse of `to_display`, from regions on the displayed image back to the stored one"""
+
     @property
     def applied_to_dimensions(self) -> Dimensions: ...
     @applied_to_dimensions.setter
@@ -233,6 +853,51 @@ class RegionInfo:
     @region_list.setter
     def region_list(self, arg: Sequence[Region], /) -> None: ...
 
+class IndexedRegion:
+    """A region of one image, as returned by RegionIndex queries"""
+
+    @property
+    def image(self) -> pathlib.Path: ...
+    @property
+    def position(self) -> int:
+        """The position of the region in the region list of its image"""
+
+    @property
+    def name(self) -> str: ...
+    @property
+    def type(self) -> str: ...
+    @property
+    def left(self) -> float: ...
+    @property
+    def top(self) -> float: ...
+    @property
+    def right(self) -> float: ...
+    @property
+    def bottom(self) -> float: ...
+    @property
+    def area(self) -> float:
+        """The fraction of the frame the region covers"""
+
+class RegionIndex:
+    """A uniform grid over normalized coordinates, holding the regions of many images"""
+
+    def __init__(self, cells_per_side: int = 32) -> None: ...
+    def add(self, image: str | os.PathLike, regions: RegionInfo) -> None:
+        """Adds the regions of an image. Pixel areas are normalized against the applied dimensions."""
+
+    def overlapping(self, left: float, top: float, right: float, bottom: float) -> list[IndexedRegion]:
+        """Regions whose bounds overlap the box, in normalized coordinates, edges included"""
+
+    def larger_than(self, fraction: float) -> list[IndexedRegion]:
+        """Regions covering more than `fraction` of the frame"""
+
+    def duplicates(self, min_overlap: float = 0.5) -> list[tuple[IndexedRegion, IndexedRegion]]:
+        """
+        Pairs of regions of the same image with the same name, whose intersection over union is at least `min_overlap`
+        """
+
+    def __len__(self) -> int: ...
+
 class Keyword:
     def __init__(self, keyword: str, children: Sequence[Keyword], applied: bool | None = None) -> None: ...
     def __lt__(self, arg: Keyword, /) -> bool: ...
@@ -242,6 +907,18 @@ class Keyword:
     def __eq__(self, arg: Keyword, /) -> bool: ...
     def __ne__(self, arg: Keyword, /) -> bool: ...
     def __repr__(self) -> str: ...
+    def to_bytes(self) -> bytes:
+        """A compact binary encoding, read back by `from_bytes`"""
+
+    @staticmethod
+    def from_bytes(data: bytes) -> Keyword: ...
+    def __getstate__(self) -> bytes: ...
+    def __setstate__(self, state: bytes) -> None: ...
+    def to_json(self) -> str:
+        """JSON in the structure of the test fixtures"""
+
+    @staticmethod
+    def from_json(json: str) -> Keyword: ...
     @property
     def keyword(self) -> str: ...
     @keyword.setter
@@ -267,6 +944,18 @@ class KeywordInfo:
     def __or__(self, arg: KeywordInfo, /) -> KeywordInfo: ...
     def __ior__(self, arg: KeywordInfo, /) -> KeywordInfo: ...
     def __repr__(self) -> str: ...
+    def to_bytes(self) -> bytes:
+        """A compact binary encoding, read back by `from_bytes`"""
+
+    @staticmethod
+    def from_bytes(data: bytes) -> KeywordInfo: ...
+    def __getstate__(self) -> bytes: ...
+    def __setstate__(self, state: bytes) -> None: ...
+    def to_json(self) -> str:
+        """JSON in the structure of the test fixtures"""
+
+    @staticmethod
+    def from_json(json: str) -> KeywordInfo: ...
     @property
     def hierarchy(self) -> list[Keyword]: ...
     @hierarchy.setter
@@ -1,19 +1,58 @@
 from __future__ import annotations
 
+import json
+import pickle
+import re
+import shutil
 from typing import TYPE_CHECKING
 
 import pytest
 
 from exifmwg import EXIV2_VERSION
 from exifmwg import EXPAT_VERSION
+from exifmwg import ArrowBatch
+from exifmwg import BatchOptions
+from exifmwg import BatchProgress
+from exifmwg import CancellationToken
+from exifmwg import CatalogReader
+from exifmwg import CatalogWriter
 from exifmwg import Dimensions
+from exifmwg import DirectoryWatcher
+from exifmwg import DurabilityLevel
+from exifmwg import ErrorCode
 from exifmwg import ExifOrientation
 from exifmwg import ImageMetadata
+from exifmwg import InvalidStructureError
 from exifmwg import Keyword
 from exifmwg import KeywordInfo
+from exifmwg import MemoryBudget
+from exifmwg import MetadataPipeline
+from exifmwg import MissingFieldError
+from exifmwg import MetadataSession
+from exifmwg import PersonIndex
 from exifmwg import Region
+from exifmwg import ReadOptions
+from exifmwg import RegionIndex
 from exifmwg import RegionInfo
+from exifmwg import RegionSpace
+from exifmwg import SidecarPolicy
+from exifmwg import WriteOptions
 from exifmwg import XmpArea
+from exifmwg import build_catalog
+from exifmwg import clear_many
+from exifmwg import clear_metadata_cache
+from exifmwg import configure_metadata_cache
+from exifmwg import configure_thread_pool
+from exifmwg import metadata_cache_stats
+from exifmwg import read_many
+from exifmwg import read_many_arrow
+from exifmwg import refresh_catalog
+from exifmwg import rename_person
+from exifmwg import rotate_many
+from exifmwg import scan_directory
+from exifmwg import thread_pool_stats
+from exifmwg import update_catalog
+from exifmwg import write_many
 from tests.utils import verify_image_metadata
 from tests.utils import verify_keyword_info
 
@@ -138,13 +177,562 @@ class TestWriteImageMetadata:
         verify_image_metadata(sample_one_metadata, changed_metadata)
 
 
+class TestMetadataSession:
+    def test_read_modify_write(self, sample_one_image_copy: Path, sample_one_metadata: ImageMetadata):
+        session = MetadataSession(sample_one_image_copy)
+        metadata = session.read()
+
+        verify_image_metadata(sample_one_metadata, metadata)
+
+        metadata.title = "A session title"
+        session.stage(metadata)
+        assert session.dirty
+        session.commit()
+        assert not session.dirty
+
+        assert ImageMetadata(sample_one_image_copy).title == "A session title"
+
+    def test_write_options(self, sample_one_image_copy: Path):
+        options = WriteOptions()
+        assert options.xmp_padding > 0
+        assert options.in_place_xmp
+        options.xmp_padding = 0
+        options.in_place_xmp = False
+
+        metadata = ImageMetadata(sample_one_image_copy)
+        metadata.title = "Written without padding"
+        metadata.to_file(options=options)
+
+        assert ImageMetadata(sample_one_image_copy).title == "Written without padding"
+
+    def test_atomic_write(self, sample_one_image_copy: Path):
+        options = WriteOptions()
+        options.atomic = True
+        options.durability = DurabilityLevel.FileAndDirectory
+
+        metadata = ImageMetadata(sample_one_image_copy)
+        metadata.title = "Written atomically"
+        metadata.to_file(options=options)
+
+        assert ImageMetadata(sample_one_image_copy).title == "Written atomically"
+        assert [p.name for p in sample_one_image_copy.parent.iterdir()] == [sample_one_image_copy.name]
+
+
+class TestBatch:
+    def test_write_many(self, sample_one_image_copy: Path, sample_two_image_copy: Path, tmp_path: Path):
+        first = ImageMetadata(sample_one_image_copy)
+        first.title = "First"
+        second = ImageMetadata(sample_two_image_copy)
+        second.title = "Second"
+        missing = tmp_path / "missing.jpg"
+
+        results = write_many(
+            [(first, sample_one_image_copy), (ImageMetadata(10, 10), missing), (second, sample_two_image_copy)],
+            threads=2,
+        )
+
+        assert [result.ok for result in results] == [True, False, True]
+        assert results[1].error is not None
+        assert results[1].error.code == ErrorCode.FileAccess
+        assert results[1].error.path == missing
+        assert ImageMetadata(sample_one_image_copy).title == "First"
+        assert ImageMetadata(sample_two_image_copy).title == "Second"
+
+    def test_pipeline(self, sample_one_image_copy: Path, sample_two_image_copy: Path):
+        def add_title(metadata: ImageMetadata) -> bool:
+            if metadata.title == "Pipeline title":
+                return False
+            metadata.title = "Pipeline title"
+            return True
+
+        results = MetadataPipeline(window=1).run(
+            [sample_one_image_copy, sample_two_image_copy], add_title
+        )
+
+        assert all(result.ok for result in results)
+        assert ImageMetadata(sample_one_image_copy).title == "Pipeline title"
+        assert ImageMetadata(sample_two_image_copy).title == "Pipeline title"
+
+    def test_pipeline_keeps_metadata(self, sample_one_image_copy: Path, sample_two_image_copy: Path):
+        kept: list[ImageMetadata] = []
+
+        def keep(metadata: ImageMetadata) -> bool:
+            metadata.city = f"City {len(kept)}"
+            kept.append(metadata)
+            return True
+
+        paths = [sample_one_image_copy, sample_two_image_copy]
+        results = MetadataPipeline(window=1).run(paths, keep)
+
+        assert all(result.ok for result in results)
+        # The kept arguments outlive the pipeline slots they were read into
+        assert [metadata.city for metadata in kept] == ["City 0", "City 1"]
+        assert kept[0].image_width == ImageMetadata(sample_one_image_copy).image_width
+        assert ImageMetadata(sample_one_image_copy).city == "City 0"
+        assert ImageMetadata(sample_two_image_copy).city == "City 1"
+
+    def test_read_many(self, sample_one_image_copy: Path, tmp_path: Path):
+        results = read_many([sample_one_image_copy, tmp_path / "missing.jpg"], threads=2)
+
+        assert results[0].ok
+        assert results[0].metadata == ImageMetadata(sample_one_image_copy)
+        assert not results[1].ok
+        assert results[1].metadata is None
+        assert results[1].error is not None
+        assert results[1].error.code == ErrorCode.FileAccess
+
+    def test_scan_directory(self, sample_one_image_copy: Path, sample_two_image_copy: Path, tmp_path: Path):
+        nested = tmp_path / "nested"
+        nested.mkdir()
+        moved = sample_two_image_copy.rename(nested / sample_two_image_copy.name)
+        (tmp_path / "notes.txt").write_text("not an image")
+
+        assert scan_directory(tmp_path) == sorted([sample_one_image_copy, moved])
+        assert scan_directory(tmp_path, recursive=False) == [sample_one_image_copy]
+        assert scan_directory(tmp_path, extensions=["txt"]) == [tmp_path / "notes.txt"]
+
+    def test_progress_and_cancellation(self, sample_one_image_copy: Path, sample_two_image_copy: Path):
+        reports: list[BatchProgress] = []
+        batch = BatchOptions()
+        batch.progress = reports.append
+        batch.progress_interval_ms = 0
+
+        results = read_many([sample_one_image_copy, sample_two_image_copy], batch=batch)
+
+        assert all(result.ok for result in results)
+        assert reports[-1].files_done == 2
+        assert reports[-1].files_total == 2
+        assert reports[-1].errors == 0
+        assert reports[-1].bytes_read == sample_one_image_copy.stat().st_size + sample_two_image_copy.stat().st_size
+
+        token = CancellationToken()
+        batch = BatchOptions()
+        batch.cancellation = token
+        token.cancel()
+        results = read_many([sample_one_image_copy], batch=batch)
+        assert results[0].error is not None
+        assert results[0].error.code == ErrorCode.Cancelled
+        # Appended, so the earlier codes keep their values
+        assert (ErrorCode.Unknown.value, ErrorCode.Cancelled.value) == (4, 5)
+
+    def test_memory_budget(self, sample_one_image_copy: Path, sample_two_image_copy: Path):
+        budget = MemoryBudget(1024)
+        batch = BatchOptions()
+        batch.memory = budget
+
+        results = read_many([sample_one_image_copy, sample_two_image_copy], threads=2, batch=batch)
+
+        assert all(result.ok for result in results)
+        assert budget.limit == 1024
+        assert budget.in_use == 0
+
+    def test_thread_pool(self):
+        configure_thread_pool(2)
+        try:
+            stats = thread_pool_stats()
+            assert stats.threads == 2
+            assert stats.queued == 0
+        finally:
+            configure_thread_pool()
+
+
+class TestMetadataCache:
+    def test_cached_reads(self, sample_one_image_copy: Path):
+        clear_metadata_cache()
+        configure_metadata_cache(16)
+        try:
+            first = ImageMetadata(sample_one_image_copy)
+            assert ImageMetadata(sample_one_image_copy) == first
+            stats = metadata_cache_stats()
+            assert stats.hits == 1
+            assert stats.misses == 1
+
+            first.title = "Changed"
+            first.to_file()
+            assert ImageMetadata(sample_one_image_copy).title == "Changed"
+            assert metadata_cache_stats().hits == 1
+        finally:
+            configure_metadata_cache(0)
+            clear_metadata_cache()
+
+
+class TestCatalog:
+    def test_build_and_lookup(self, sample_one_image_copy: Path, sample_two_image_copy: Path, tmp_path: Path):
+        catalog = tmp_path / "images.cat"
+        results = build_catalog([sample_one_image_copy, tmp_path / "missing.jpg", sample_two_image_copy], catalog)
+        assert [result.ok for result in results] == [True, False, True]
+
+        reader = CatalogReader(catalog)
+        assert len(reader) == 2
+        assert reader.lookup(sample_one_image_copy) == ImageMetadata(sample_one_image_copy)
+        assert reader.lookup(tmp_path / "missing.jpg") is None
+
+        writer = CatalogWriter()
+        writer.add(sample_two_image_copy, ImageMetadata(sample_two_image_copy))
+        writer.write(catalog)
+        assert len(CatalogReader(catalog)) == 1
+
+    def test_refresh(self, sample_one_image_copy: Path, sample_two_image_copy: Path, tmp_path: Path):
+        catalog = tmp_path / "images.cat"
+        summary = refresh_catalog([sample_one_image_copy], catalog)
+        assert summary.added == [sample_one_image_copy]
+
+        summary = refresh_catalog([sample_one_image_copy, sample_two_image_copy], catalog)
+        assert summary.unchanged == 1
+        assert summary.added == [sample_two_image_copy]
+
+        summary = update_catalog([tmp_path / "missing.jpg"], catalog)
+        assert summary.added == []
+        assert summary.errors == []
+        assert len(CatalogReader(catalog)) == 2
+
+    @pytest.mark.skipif(not DirectoryWatcher.supported(), reason="inotify is only available on Linux")
+    def test_directory_watcher(self, sample_one_image_copy: Path, tmp_path: Path):
+        watched = tmp_path / "watched"
+        watched.mkdir()
+        watcher = DirectoryWatcher(watched, extensions=[".jpg"])
+        assert watcher.poll() == []
+
+        target = watched / "new.jpg"
+        target.write_bytes(sample_one_image_copy.read_bytes())
+        (watched / "notes.txt").write_text("ignored")
+        assert watcher.poll(1000) == [target]
+        assert not watcher.rescan_needed
+
+
+class TestPickling:
+    def test_model_types_round_trip(self):
+        area = XmpArea(0.25, 0.125, 0.5, 0.5, "normalized", 0.75)
+        region_info = RegionInfo(Dimensions(3000, 4000, "pixel"), [Region(area, "Jane Doe", "Face", "Smiling")])
+        keyword_info = KeywordInfo([Keyword("People", [Keyword("Jane Doe", [], True)])])
+        metadata = ImageMetadata(
+            3000, 4000, title="A title", region_info=region_info, keyword_info=keyword_info, country="Country"
+        )
+
+        for value in (area, region_info.applied_to_dimensions, region_info.region_list[0], region_info, metadata):
+            assert pickle.loads(pickle.dumps(value)) == value
+            assert type(value).from_bytes(value.to_bytes()) == value
+        assert pickle.loads(pickle.dumps(keyword_info)) == keyword_info
+        assert Keyword.from_bytes(keyword_info.hierarchy[0].to_bytes()) == keyword_info.hierarchy[0]
+
+    def test_unpickled_metadata_writes_to_its_file(self, sample_one_image_copy: Path):
+        metadata = pickle.loads(pickle.dumps(ImageMetadata(sample_one_image_copy)))
+        metadata.title = "Written after unpickling"
+        metadata.to_file()
+        assert ImageMetadata(sample_one_image_copy).title == "Written after unpickling"
+
+    def test_malformed_bytes(self):
+        data = ImageMetadata(10, 20, title="A title").to_bytes()
+        with pytest.raises(InvalidStructureError):
+            ImageMetadata.from_bytes(data[:-1])
+        with pytest.raises(InvalidStructureError):
+            KeywordInfo.from_bytes(data)
+
+
+class TestJson:
+    def test_fixtures_round_trip(self, fixture_directory: Path, sample_one_original_file: Path):
+        text = (fixture_directory / "sample1.jpg.json").read_text()
+        metadata = ImageMetadata.from_json(text)
+        assert metadata == ImageMetadata(sample_one_original_file)
+
+        expected = json.loads(text)
+        for flat_tag in ("LastKeywordXMP", "TagsList", "CatalogSets", "HierarchicalSubject"):
+            del expected[flat_tag]
+        assert json.loads(metadata.to_json()) == expected
+
+    def test_nested_types_and_arrays(self, sample_one_metadata: ImageMetadata):
+        region_info = sample_one_metadata.region_info
+        assert region_info is not None
+        assert RegionInfo.from_json(region_info.to_json()) == region_info
+        assert Region.from_json(region_info.region_list[0].to_json()) == region_info.region_list[0]
+        assert json.loads(region_info.region_list[0].area.to_json())["Unit"] == "normalized"
+
+        text = ImageMetadata.to_json_array([sample_one_metadata, ImageMetadata(1, 2)])
+        assert len(json.loads(text)) == 2
+        assert ImageMetadata.from_json_array(text) == [sample_one_metadata, ImageMetadata(1, 2)]
+
+    def test_missing_field(self):
+        with pytest.raises(MissingFieldError):
+            ImageMetadata.from_json('{"ImageWidth": 2}')
+        with pytest.raises(InvalidStructureError):
+            ImageMetadata.from_json('{"ImageHeight": 1, "ImageWidth": 2,}')
+
+
+class TestArrow:
+    def test_capsules(self, sample_one_original_file: Path, tmp_path: Path):
+        batch = read_many_arrow([sample_one_original_file, tmp_path / "missing.jpg"])
+        assert len(batch) == 2
+        assert type(batch.__arrow_c_schema__()).__name__ == "PyCapsule"
+        schema, array = batch.__arrow_c_array__()
+        assert type(schema).__name__ == "PyCapsule"
+        assert type(array).__name__ == "PyCapsule"
+
+    def test_pyarrow_record_batch(self, sample_one_original_file: Path, tmp_path: Path):
+        pa = pytest.importorskip("pyarrow")
+        metadata = ImageMetadata(sample_one_original_file)
+        records = pa.record_batch(read_many_arrow([sample_one_original_file, tmp_path / "missing.jpg"]))
+        assert records.num_rows == 2
+        assert records.column("path").to_pylist() == [str(sample_one_original_file), str(tmp_path / "missing.jpg")]
+        assert records.column("error")[0].as_py() is None
+        assert records.column("error")[1].as_py() is not None
+        assert records.column("image_width").to_pylist() == [metadata.image_width, None]
+        assert records.column("title")[0].as_py() == metadata.title
+        assert metadata.region_info is not None
+        assert len(records.column("regions")[0]) == len(metadata.region_info.region_list)
+
+    def test_from_results(self):
+        pa = pytest.importorskip("pyarrow")
+        records = pa.record_batch(ArrowBatch([]))
+        assert records.num_rows == 0
+        assert "keywords" in records.schema.names
+
+
+class TestRegionArrays:
+    def test_round_trip(self, sample_one_metadata: ImageMetadata):
+        np = pytest.importorskip("numpy")
+        region_info = sample_one_metadata.region_info
+        assert region_info is not None
+        areas = region_info.area_array()
+        assert areas.shape == (len(region_info.region_list), 5)
+        assert areas.dtype == np.float64
+        assert areas[0, 2] == pytest.approx(region_info.region_list[0].area.x)
+
+        rebuilt = RegionInfo.from_arrays(
+            region_info.applied_to_dimensions,
+            areas,
+            [region.name for region in region_info.region_list],
+            [region.type for region in region_info.region_list],
+            descriptions=[region.description for region in region_info.region_list],
+        )
+        assert rebuilt == region_info
+
+    def test_detector_output(self):
+        np = pytest.importorskip("numpy")
+        boxes = np.array([[0.1, 0.2, 0.3, 0.4], [0.5, 0.6, 0.7, 0.8]], dtype=np.float32)
+        region_info = RegionInfo.from_arrays(Dimensions(10, 20, "pixel"), boxes, ["A", "B"], ["Face", "Face"])
+        assert len(region_info.region_list) == 2
+        assert region_info.region_list[1].area.w == pytest.approx(0.6)
+        assert region_info.region_list[1].area.d is None
+        assert np.isnan(region_info.area_array()[:, 4]).all()
+
+        with pytest.raises(InvalidStructureError):
+            RegionInfo.from_arrays(Dimensions(10, 20, "pixel"), boxes, ["A"], ["Face"])
+
+
+class TestRegionOrientation:
+    def test_quarter_turn(self):
+        region_info = RegionInfo(
+            Dimensions(300, 400, "pixel"),
+            [Region(XmpArea(0.2, 0.1, 0.3, 0.4, "normalized"), "A", "Face", None)],
+        )
+        shown = region_info.to_display(ExifOrientation.Rotate90CW)
+        assert shown.applied_to_dimensions == Dimensions(400, 300, "pixel")
+        area = shown.region_list[0].area
+        assert (area.x, area.y, area.w, area.h) == pytest.approx((0.6, 0.3, 0.2, 0.1))
+
+    def test_round_trip(self, sample_one_metadata: ImageMetadata):
+        region_info = sample_one_metadata.region_info
+        assert region_info is not None
+        for orientation in (
+            ExifOrientation.Horizontal,
+            ExifOrientation.MirrorHorizontal,
+            ExifOrientation.Rotate180,
+            ExifOrientation.MirrorVertical,
+            ExifOrientation.MirrorHorizontalAndRotate270CW,
+            ExifOrientation.Rotate90CW,
+            ExifOrientation.MirrorHorizontalAndRotate90CW,
+            ExifOrientation.Rotate270CW,
+        ):
+            assert region_info.to_display(orientation).to_stored(orientation) == region_info
+
+
+class TestRotate:
+    def test_compose(self):
+        assert ExifOrientation.Rotate90CW.compose(ExifOrientation.Rotate90CW) == ExifOrientation.Rotate180
+        assert ExifOrientation.Rotate90CW.compose(ExifOrientation.Rotate270CW) == ExifOrientation.Horizontal
+        assert (
+            ExifOrientation.MirrorHorizontal.compose(ExifOrientation.Rotate90CW)
+            == ExifOrientation.MirrorHorizontalAndRotate90CW
+        )
+
+    def test_rotate(self, sample_one_metadata: ImageMetadata):
+        region_info = sample_one_metadata.region_info
+        assert region_info is not None
+        sample_one_metadata.orientation = None
+        sample_one_metadata.rotate(ExifOrientation.Rotate270CW)
+        assert sample_one_metadata.orientation == ExifOrientation.Rotate270CW
+        assert sample_one_metadata.region_info == region_info
+
+        sample_one_metadata.rotate(ExifOrientation.Rotate90CW, RegionSpace.Displayed)
+        assert sample_one_metadata.orientation == ExifOrientation.Horizontal
+        assert sample_one_metadata.region_info == region_info.to_display(ExifOrientation.Rotate90CW)
+
+    def test_rotate_many(self, sample_one_image_copy: Path, tmp_path: Path):
+        before = ImageMetadata(sample_one_image_copy)
+        results = rotate_many([sample_one_image_copy, tmp_path / "missing.jpg"], ExifOrientation.Rotate180)
+        assert results[0].ok
+        assert not results[1].ok
+        assert results[1].error is not None
+        assert results[1].error.code == ErrorCode.FileAccess
+
+        after = ImageMetadata(sample_one_image_copy)
+        assert after.orientation == (before.orientation or ExifOrientation.Horizontal).compose(
+            ExifOrientation.Rotate180
+        )
+        assert after.region_info == before.region_info
+
+
+class TestRegionIndex:
+    def test_queries(self, sample_one_original_file: Path, sample_one_metadata: ImageMetadata):
+        region_info = sample_one_metadata.region_info
+        assert region_info is not None
+        index = RegionIndex()
+        index.add(sample_one_original_file, region_info)
+        first = region_info.region_list[0]
+        shifted = XmpArea(first.area.h, first.area.w, first.area.x + 0.001, first.area.y, "normalized")
+        duplicated = [first, Region(shifted, first.name, first.type)]
+        index.add("copy.jpg", RegionInfo(region_info.applied_to_dimensions, duplicated))
+        assert len(index) == len(region_info.region_list) + 2
+
+        found = index.overlapping(first.area.x, first.area.y, first.area.x, first.area.y)
+        assert any(region.name == first.name and region.image == sample_one_original_file for region in found)
+        assert all(region.area > 0.0 for region in index.larger_than(0.0))
+        assert index.larger_than(1.0) == []
+
+        pairs = index.duplicates(0.9)
+        assert len(pairs) == 1
+        assert (pairs[0][0].position, pairs[0][1].position) == (0, 1)
+        assert pairs[0][0].image.name == "copy.jpg"
+
+
+class TestPersonIndex:
+    def test_lookups(self, sample_one_original_file: Path, sample_one_metadata: ImageMetadata):
+        region_info = sample_one_metadata.region_info
+        assert region_info is not None
+        index = PersonIndex()
+        index.add(sample_one_original_file, region_info)
+        assert len(index) == 2
+        assert index.image_count == 1
+        assert index.names("Pet") == ["Bo"]
+        found = index.find("Barack Obama")
+        assert len(found) == 1
+        assert found[0].image == sample_one_original_file
+        assert found[0].positions == [0]
+        assert index.find("Bo", "Face") == []
+        index.remove(sample_one_original_file.parent / "missing" / ".." / sample_one_original_file.name)
+        assert len(index) == 0
+
+    def test_rename(self, sample_one_image_copy: Path, tmp_path: Path):
+        index = PersonIndex()
+        index.add_results(read_many([sample_one_image_copy, tmp_path / "missing.jpg"]))
+        assert index.names() == ["Barack Obama", "Bo"]
+
+        results = rename_person(index, "Bo", "Barack Obama")
+        assert len(results) == 1
+        assert results[0].ok
+        assert index.names() == ["Barack Obama"]
+        assert index.find("Barack Obama")[0].positions == [0, 1]
+
+        region_info = ImageMetadata(sample_one_image_copy).region_info
+        assert region_info is not None
+        assert [region.name for region in region_info.region_list] == ["Barack Obama", "Barack Obama"]
+
+
+class TestSidecar:
+    def test_sidecar_round_trip(self, sample_one_image_copy: Path):
+        sidecar = ImageMetadata.sidecar_path(sample_one_image_copy)
+        image_bytes = sample_one_image_copy.read_bytes()
+
+        metadata = ImageMetadata(sample_one_image_copy)
+        metadata.title = "A sidecar title"
+        options = WriteOptions()
+        options.sidecar = True
+        metadata.to_file(options=options)
+
+        assert sidecar.exists()
+        assert sample_one_image_copy.read_bytes() == image_bytes
+
+        read_options = ReadOptions()
+        assert ImageMetadata(sample_one_image_copy, read_options).title != "A sidecar title"
+        read_options.sidecar = SidecarPolicy.Merge
+        assert ImageMetadata(sample_one_image_copy, read_options) == metadata
+
+    def test_pair_sidecars(self, tmp_path: Path, sample_one_original_file: Path):
+        jpeg = tmp_path / "IMG_0001.jpg"
+        raw = tmp_path / "IMG_0001.CR2"
+        shutil.copy(sample_one_original_file, jpeg)
+        shutil.copy(sample_one_original_file, raw)
+        options = WriteOptions()
+        options.sidecar = True
+        options.atomic = True
+        for path in (jpeg, raw):
+            metadata = ImageMetadata(path)
+            metadata.title = path.suffix
+            metadata.to_file(options=options)
+
+        assert not (tmp_path / "IMG_0001.xmp").exists()
+        read_options = ReadOptions()
+        read_options.sidecar = SidecarPolicy.Merge
+        for path in (jpeg, raw):
+            assert ImageMetadata.sidecar_path(path) == tmp_path / (path.name + ".xmp")
+            assert ImageMetadata(path, read_options).title == path.suffix
+
+
 class TestMetadataClear:
-    def test_clear_existing_metadata(self):
-        pass
+    def test_clear_existing_metadata(self, sample_one_image_copy: Path):
+        metadata = ImageMetadata(sample_one_image_copy)
+        assert metadata.title is not None
+
+        options = WriteOptions()
+        options.atomic = True
+        metadata.clear_file(options=options)
+
+        assert metadata.title is None
+        assert metadata.region_info is None
+        cleared = ImageMetadata(sample_one_image_copy)
+        assert cleared.title is None
+        assert cleared.description is None
+        assert cleared.region_info is None
+        assert cleared.city is None
+
+    def test_clear_many_files(self, sample_one_image_copy: Path, sample_two_image_copy: Path):
+        paths = [sample_one_image_copy, sample_two_image_copy]
+        results = clear_many([*paths, sample_one_image_copy.with_name("missing.jpg")])
+
+        assert [result.ok for result in results] == [True, True, False]
+        assert results[2].error is not None
+        assert results[2].error.code == ErrorCode.FileAccess
+        for path in paths:
+            cleared = ImageMetadata(path)
+            assert cleared.title is None
+            assert cleared.orientation is None
 
 
 class TestErrorCases:
-    pass
+    def test_lenient_read(self, sample_one_image_copy: Path):
+        metadata = ImageMetadata(sample_one_image_copy)
+        options = WriteOptions()
+        options.sidecar = True
+        metadata.to_file(options=options)
+
+        # Drop the type of the first region only, in either serialized form
+        sidecar = ImageMetadata.sidecar_path(sample_one_image_copy)
+        text = sidecar.read_text()
+        text = re.sub(r'mwg-rs:Type="[^"]*"|<mwg-rs:Type>[^<]*</mwg-rs:Type>', "", text, count=1)
+        sidecar.write_text(text)
+
+        read_options = ReadOptions()
+        read_options.sidecar = SidecarPolicy.Authoritative
+        with pytest.raises(MissingFieldError):
+            ImageMetadata(sample_one_image_copy, read_options)
+
+        read_options.lenient = True
+        lenient = ImageMetadata(sample_one_image_copy, read_options)
+        assert lenient.region_info is not None
+        assert len(lenient.region_info.region_list) == len(metadata.region_info.region_list) - 1
+        assert len(lenient.diagnostics) == 1
+        assert lenient.diagnostics[0].code == ErrorCode.MissingField
+        assert lenient.diagnostics[0].path == sidecar
 
 
 class TestVersionInfo:
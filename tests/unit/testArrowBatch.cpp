@@ -0,0 +1,150 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "ArrowBatch.hpp"
+#include "Batch.hpp"
+#include "ImageMetadata.hpp"
+
+namespace {
+
+bool isValid(const ArrowArray& array, std::int64_t row) {
+  const auto* validity = static_cast<const std::uint8_t*>(array.buffers[0]);
+  return validity == nullptr || ((validity[row / 8] >> (row % 8)) & 1U) != 0;
+}
+
+std::string stringAt(const ArrowArray& array, std::int64_t row) {
+  const auto* offsets = static_cast<const std::int64_t*>(array.buffers[1]);
+  const auto* data = static_cast<const char*>(array.buffers[2]);
+  return std::string(data + offsets[row], static_cast<std::size_t>(offsets[row + 1] - offsets[row]));
+}
+
+template <typename T> T valueAt(const ArrowArray& array, std::int64_t row) {
+  return static_cast<const T*>(array.buffers[1])[row];
+}
+
+// The child of a struct array or schema by name
+std::int64_t childIndex(const ArrowSchema& schema, const std::string& name) {
+  for (std::int64_t i = 0; i < schema.n_children; i++) {
+    if (schema.children[i]->name == name) {
+      return i;
+    }
+  }
+  FAIL("No column " << name);
+  return -1;
+}
+
+} // namespace
+
+TEST_CASE("Read results export as Arrow columns", "[arrow]") {
+  ImageMetadata first(20, 10, "A title", std::nullopt,
+                      RegionInfoStruct(DimensionsStruct(20, 10, "pixel"),
+                                       {RegionInfoStruct::RegionStruct(XmpAreaStruct(0.5, 0.25, 0.1, 0.2, "normalized"),
+                                                                       "Jane Doe", "Face", "Smiling")}),
+                      ExifOrientation::Rotate90CW,
+                      KeywordInfoModel(std::vector<std::string>{"People/Jane Doe", "Places/Park"}));
+  first.City = "Springfield";
+
+  std::vector<ReadResult> results(3);
+  results[0].Path = "first.jpg";
+  results[0].Metadata = first;
+  results[1].Path = "broken.jpg";
+  results[1].Error = ErrorInfo{ErrorCode::Exiv2, "Not an image", "broken.jpg"};
+  results[2].Path = "empty.jpg";
+  results[2].Metadata = ImageMetadata(1, 2);
+
+  ArrowBatch batch(results);
+  REQUIRE(batch.size() == 3);
+
+  ArrowSchema schema;
+  ArrowArray array;
+  batch.exportSchema(&schema);
+  batch.exportArray(&array);
+
+  CHECK(std::string(schema.format) == "+s");
+  REQUIRE(schema.n_children == array.n_children);
+  CHECK(array.length == 3);
+  CHECK(array.null_count == 0);
+
+  const auto column = [&](const std::string& name) -> const ArrowArray& {
+    return *array.children[childIndex(schema, name)];
+  };
+
+  SECTION("Scalar columns") {
+    CHECK(std::string(schema.children[childIndex(schema, "path")]->format) == "U");
+    CHECK(stringAt(column("path"), 1) == "broken.jpg");
+    CHECK(valueAt<std::uint32_t>(column("image_height"), 0) == 20);
+    CHECK(valueAt<std::uint32_t>(column("image_width"), 2) == 2);
+    CHECK(stringAt(column("title"), 0) == "A title");
+    CHECK_FALSE(isValid(column("title"), 2));
+    CHECK(valueAt<std::uint8_t>(column("orientation"), 0) == 6);
+    CHECK(stringAt(column("city"), 0) == "Springfield");
+    CHECK_FALSE(isValid(column("country"), 0));
+  }
+
+  SECTION("A failed read only has its path and error") {
+    CHECK(stringAt(column("error"), 1) == "Not an image");
+    CHECK_FALSE(isValid(column("error"), 0));
+    for (std::int64_t i = 0; i < schema.n_children; i++) {
+      const std::string name = schema.children[i]->name;
+      if (name != "path" && name != "error") {
+        INFO(name);
+        CHECK_FALSE(isValid(*array.children[i], 1));
+      }
+    }
+  }
+
+  SECTION("Keywords are a list of paths") {
+    const ArrowArray& keywords = column("keywords");
+    const auto* offsets = static_cast<const std::int64_t*>(keywords.buffers[1]);
+    REQUIRE(offsets[1] - offsets[0] == 2);
+    CHECK(stringAt(*keywords.children[0], 0) == "People/Jane Doe");
+    CHECK(stringAt(*keywords.children[0], 1) == "Places/Park");
+    CHECK_FALSE(isValid(keywords, 2));
+  }
+
+  SECTION("Regions are a list of structs") {
+    const ArrowArray& regions = column("regions");
+    const ArrowSchema& regionSchema = *schema.children[childIndex(schema, "regions")]->children[0];
+    CHECK(std::string(regionSchema.format) == "+s");
+    const ArrowArray& region = *regions.children[0];
+    REQUIRE(region.length == 1);
+    CHECK(stringAt(*region.children[childIndex(regionSchema, "name")], 0) == "Jane Doe");
+    CHECK(stringAt(*region.children[childIndex(regionSchema, "description")], 0) == "Smiling");
+    CHECK(valueAt<double>(*region.children[childIndex(regionSchema, "w")], 0) == 0.25);
+    CHECK_FALSE(isValid(*region.children[childIndex(regionSchema, "d")], 0));
+  }
+
+  SECTION("Released arrays outlive the batch") {
+    ArrowArray other;
+    {
+      ArrowBatch temporary(results);
+      temporary.exportArray(&other);
+    }
+    CHECK(stringAt(*other.children[0], 2) == "empty.jpg");
+    other.release(&other);
+    CHECK(other.release == nullptr);
+  }
+
+  array.release(&array);
+  schema.release(&schema);
+  CHECK(array.release == nullptr);
+  CHECK(schema.release == nullptr);
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "readManyArrow has a row per path", "[arrow][batch]") {
+  std::vector<std::filesystem::path> paths = {getTempSample(SampleImage::Sample1), "nonexistent_image.jpg"};
+  ArrowBatch batch = Batch::readManyArrow(paths, 2);
+  CHECK(batch.size() == 2);
+
+  ArrowArray array;
+  batch.exportArray(&array);
+  CHECK(stringAt(*array.children[0], 0) == paths[0].string());
+  CHECK(isValid(*array.children[1], 1));
+  CHECK(valueAt<std::uint32_t>(*array.children[2], 0) == ImageMetadata(paths[0]).ImageHeight);
+  array.release(&array);
+}
@@ -0,0 +1,248 @@
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "Batch.hpp"
+#include "BatchOptions.hpp"
+#include "Errors.hpp"
+#include "ImageMetadata.hpp"
+#include "ReadOptions.hpp"
+
+TEST_CASE("Batch worker count", "[batch]") {
+  CHECK(Batch::resolveThreadCount(4, 100) == 4);
+  CHECK(Batch::resolveThreadCount(8, 3) == 3);
+  CHECK(Batch::resolveThreadCount(4, 0) == 1);
+  CHECK(Batch::resolveThreadCount(0, 100) >= 1);
+}
+
+TEST_CASE("Errors reported as values", "[batch]") {
+  const auto describe = [](const auto& thrown) {
+    try {
+      throw thrown;
+    } catch (...) {
+      return currentErrorInfo("image.jpg");
+    }
+  };
+
+  CHECK(describe(MissingFieldError("missing")).Code == ErrorCode::MissingField);
+  CHECK(describe(FileAccessError("access")).Code == ErrorCode::FileAccess);
+  CHECK(describe(std::runtime_error("runtime")).Message == "runtime");
+
+  // Exceptions of any other type are reported instead of escaping the worker
+  const ErrorInfo other = describe(42);
+  CHECK(other.Code == ErrorCode::Unknown);
+  CHECK_FALSE(other.Message.empty());
+  CHECK(other.Path == std::filesystem::path("image.jpg"));
+
+  // The codes are public, Cancelled was appended after them
+  CHECK(static_cast<int>(ErrorCode::Unknown) == 4);
+  CHECK(static_cast<int>(ErrorCode::Cancelled) == 5);
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Writing many files", "[batch][writing]") {
+  SECTION("Every job is written, on several workers") {
+    std::vector<WriteJob> jobs;
+    for (int i = 0; i < 8; ++i) {
+      auto path = getTempSample(i % 2 == 0 ? SampleImage::Sample1 : SampleImage::Sample2);
+      ImageMetadata metadata(path);
+      metadata.Title = "Batch title " + std::to_string(i);
+      jobs.emplace_back(metadata, path);
+    }
+
+    auto results = Batch::writeMany(jobs, 4);
+
+    REQUIRE(results.size() == jobs.size());
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+      CHECK(results[i].ok());
+      CHECK(results[i].Path == jobs[i].second);
+      CHECK(ImageMetadata(jobs[i].second).Title == "Batch title " + std::to_string(i));
+    }
+  }
+
+  SECTION("A failure does not stop the batch") {
+    auto goodPath = getTempSample(SampleImage::Sample3);
+    ImageMetadata good(goodPath);
+    good.Title = "Still written";
+    ImageMetadata unknown(100, 100, "No such file");
+
+    std::vector<WriteJob> jobs = {{unknown, "nonexistent_image.jpg"}, {good, goodPath}};
+    auto results = Batch::writeMany(jobs, 2);
+
+    REQUIRE(results.size() == 2);
+    REQUIRE_FALSE(results[0].ok());
+    CHECK(results[0].Error->Code == ErrorCode::FileAccess);
+    CHECK(results[0].Error->Path == std::filesystem::path("nonexistent_image.jpg"));
+    CHECK_FALSE(results[0].Error->Message.empty());
+    CHECK(results[1].ok());
+    CHECK(ImageMetadata(goodPath).Title == "Still written");
+  }
+
+  SECTION("An empty batch") {
+    CHECK(Batch::writeMany({}).empty());
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Rotating many files", "[batch][writing]") {
+  std::vector<std::filesystem::path> paths = {getTempSample(SampleImage::Sample1), "nonexistent_image.jpg",
+                                              getTempSample(SampleImage::Sample2)};
+  const ImageMetadata first(paths[0]);
+  const ImageMetadata second(paths[2]);
+
+  auto results = Batch::rotateMany(paths, ExifOrientation::Rotate90CW, RegionSpace::Stored, 2);
+
+  REQUIRE(results.size() == paths.size());
+  CHECK(results[0].ok());
+  REQUIRE_FALSE(results[1].ok());
+  CHECK(results[1].Error->Code == ErrorCode::FileAccess);
+  CHECK(results[2].ok());
+
+  ImageMetadata expected = first;
+  expected.rotate(ExifOrientation::Rotate90CW);
+  CHECK(ImageMetadata(paths[0]) == expected);
+  expected = second;
+  expected.rotate(ExifOrientation::Rotate90CW);
+  CHECK(ImageMetadata(paths[2]) == expected);
+
+  SECTION("Regions on the displayed image are rewritten") {
+    Batch::rotateMany({paths[0]}, ExifOrientation::Rotate270CW, RegionSpace::Displayed);
+    ImageMetadata rotatedBack(paths[0]);
+    CHECK(rotatedBack.Orientation == first.Orientation.value_or(ExifOrientation::Horizontal));
+    CHECK(rotatedBack.RegionInfo == first.RegionInfo.value().toDisplay(ExifOrientation::Rotate270CW));
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Reading many files", "[batch][reading]") {
+  std::vector<std::filesystem::path> paths = {getOriginalSample(SampleImage::Sample1), "nonexistent_image.jpg",
+                                              getOriginalSample(SampleImage::Sample2)};
+
+  auto results = Batch::readMany(paths, 2);
+
+  REQUIRE(results.size() == paths.size());
+  REQUIRE(results[0].ok());
+  CHECK(results[0].Metadata == ImageMetadata(paths[0]));
+  REQUIRE_FALSE(results[1].ok());
+  CHECK_FALSE(results[1].Metadata.has_value());
+  CHECK(results[1].Error->Code == ErrorCode::FileAccess);
+  CHECK(results[1].Path == paths[1]);
+  REQUIRE(results[2].ok());
+  CHECK(results[2].Metadata == ImageMetadata(paths[2]));
+
+  CHECK(Batch::readMany({}).empty());
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Scanning a directory", "[batch]") {
+  namespace fs = std::filesystem;
+  const fs::path root = fs::temp_directory_path() / ("test_scan_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+  fs::create_directories(root / "nested" / "deeper");
+  fs::create_directories(root / "empty");
+  fs::copy_file(getOriginalSample(SampleImage::Sample1), root / "a.jpg");
+  fs::copy_file(getOriginalSample(SampleImage::Sample2), root / "nested" / "b.JPG");
+  fs::copy_file(getOriginalSample(SampleImage::SamplePNG), root / "nested" / "deeper" / "c.png");
+  fs::copy_file(getOriginalSample(SampleImage::Sample1), root / "nested" / "notes.txt");
+
+  SECTION("Recursive, with the default extensions") {
+    auto found = Batch::scanDirectory(root);
+    std::vector<fs::path> expected = {root / "a.jpg", root / "nested" / "b.JPG", root / "nested" / "deeper" / "c.png"};
+    CHECK(found == expected);
+  }
+
+  SECTION("Only the top level") {
+    CHECK(Batch::scanDirectory(root, false) == std::vector<fs::path>{root / "a.jpg"});
+  }
+
+  SECTION("Explicit extensions") {
+    auto found = Batch::scanDirectory(root, true, {".png", "txt"});
+    CHECK(found == std::vector<fs::path>{root / "nested" / "deeper" / "c.png", root / "nested" / "notes.txt"});
+  }
+
+  SECTION("A missing root") {
+    CHECK_THROWS_AS(Batch::scanDirectory(root / "missing"), FileAccessError);
+  }
+
+  fs::remove_all(root);
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Batch progress and cancellation", "[batch]") {
+  std::vector<std::filesystem::path> paths;
+  for (int i = 0; i < 6; ++i) {
+    paths.push_back(getOriginalSample(i % 2 == 0 ? SampleImage::Sample1 : SampleImage::Sample2));
+  }
+  paths.push_back("nonexistent_image.jpg");
+
+  SECTION("Progress is reported, with a final report") {
+    std::mutex reportsMutex;
+    std::vector<BatchProgress> reports;
+    BatchOptions batch;
+    batch.ProgressIntervalMs = 0;
+    batch.Progress = [&](const BatchProgress& progress) {
+      std::lock_guard lock(reportsMutex);
+      reports.push_back(progress);
+    };
+
+    auto results = Batch::readMany(paths, 2, {}, batch);
+
+    REQUIRE_FALSE(reports.empty());
+    const auto& last = reports.back();
+    CHECK(last.FilesDone == paths.size());
+    CHECK(last.FilesTotal == paths.size());
+    CHECK(last.Errors == 1);
+    CHECK(last.BytesRead == 3 * std::filesystem::file_size(paths[0]) + 3 * std::filesystem::file_size(paths[1]));
+    for (const auto& report : reports) {
+      CHECK(report.FilesDone <= last.FilesDone);
+    }
+  }
+
+  SECTION("A cancelled batch fails the files it did not reach") {
+    BatchOptions batch;
+    batch.Cancellation.cancel();
+
+    auto results = Batch::readMany(paths, 2, {}, batch);
+
+    REQUIRE(results.size() == paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      REQUIRE_FALSE(results[i].ok());
+      CHECK(results[i].Error->Code == ErrorCode::Cancelled);
+      CHECK(results[i].Path == paths[i]);
+    }
+  }
+
+  SECTION("Cancelling from the progress callback stops the batch") {
+    BatchOptions batch;
+    batch.ProgressIntervalMs = 0;
+    CancellationToken token = batch.Cancellation;
+    batch.Progress = [token](const BatchProgress&) mutable { token.cancel(); };
+
+    auto results = Batch::readMany(paths, 1, {}, batch);
+
+    CHECK(results[0].ok());
+    CHECK(results.back().Error->Code == ErrorCode::Cancelled);
+    CHECK(batch.Cancellation.cancelled());
+  }
+
+  SECTION("A memory budget smaller than any file still reads every file") {
+    BatchOptions batch;
+    batch.Memory = MemoryBudget(1);
+
+    auto results = Batch::readMany(paths, 4, {}, batch);
+
+    REQUIRE(results.size() == paths.size());
+    for (std::size_t i = 0; i + 1 < paths.size(); ++i) {
+      CHECK(results[i].ok());
+    }
+    CHECK_FALSE(results.back().ok());
+    CHECK(batch.Memory.inUse() == 0);
+  }
+
+  SECTION("A cancelled scan reads no directories") {
+    BatchOptions batch;
+    batch.Cancellation.cancel();
+    CHECK(Batch::scanDirectory(paths[0].parent_path(), true, {}, batch).empty());
+  }
+}
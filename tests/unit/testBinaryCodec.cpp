@@ -0,0 +1,108 @@
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "BinaryCodec.hpp"
+#include "Errors.hpp"
+#include "ImageMetadata.hpp"
+
+namespace {
+
+ImageMetadata fullMetadata() {
+  XmpAreaStruct face(0.25, 0.125, 0.5, 0.5, "normalized", 0.75);
+  XmpAreaStruct pet(0.1, 0.2, 0.3, 0.4, "normalized");
+  RegionInfoStruct regions(DimensionsStruct(3000, 4000, "pixel"),
+                           {RegionInfoStruct::RegionStruct(face, "Jane Doe", "Face", "Smiling"),
+                            RegionInfoStruct::RegionStruct(pet, "Rex", "Pet", std::nullopt)});
+  KeywordInfoModel keywords(
+      {KeywordInfoModel::KeywordStruct("People", {KeywordInfoModel::KeywordStruct("Jane Doe", {}, true)}, false),
+       KeywordInfoModel::KeywordStruct("Places")});
+  return ImageMetadata(3000, 4000, "A title", "Ünïcödé description", regions, ExifOrientation::Rotate90CW, keywords,
+                       "Country", std::nullopt, "State", "");
+}
+
+} // namespace
+
+TEST_CASE("Model types round trip through bytes", "[binary]") {
+  const ImageMetadata metadata = fullMetadata();
+  const auto& regions = metadata.RegionInfo.value();
+  const auto& keywords = metadata.KeywordInfo.value();
+
+  CHECK(XmpAreaStruct::fromBytes(regions.RegionList[0].Area.toBytes()) == regions.RegionList[0].Area);
+  CHECK(XmpAreaStruct::fromBytes(regions.RegionList[1].Area.toBytes()) == regions.RegionList[1].Area);
+  CHECK(DimensionsStruct::fromBytes(regions.AppliedToDimensions.toBytes()) == regions.AppliedToDimensions);
+  CHECK(RegionInfoStruct::RegionStruct::fromBytes(regions.RegionList[1].toBytes()) == regions.RegionList[1]);
+  CHECK(RegionInfoStruct::fromBytes(regions.toBytes()) == regions);
+  CHECK(KeywordInfoModel::KeywordStruct::fromBytes(keywords.Hierarchy[0].toBytes()) == keywords.Hierarchy[0]);
+  CHECK(KeywordInfoModel::fromBytes(keywords.toBytes()) == keywords);
+
+  const ImageMetadata decoded = ImageMetadata::fromBytes(metadata.toBytes());
+  CHECK(decoded == metadata);
+  CHECK(decoded.Location == "");
+  CHECK_FALSE(decoded.City.has_value());
+
+  SECTION("Unset fields take no space") {
+    CHECK(ImageMetadata(10, 20).toBytes().size() == 6);
+    CHECK(ImageMetadata::fromBytes(ImageMetadata(10, 20).toBytes()) == ImageMetadata(10, 20));
+  }
+
+  SECTION("Diagnostics are kept") {
+    ImageMetadata withDiagnostics = metadata;
+    withDiagnostics.Diagnostics.push_back({ErrorCode::MissingField, "Missing name", "a.jpg"});
+    const auto copy = ImageMetadata::fromBytes(withDiagnostics.toBytes());
+    REQUIRE(copy.Diagnostics.size() == 1);
+    CHECK(copy.Diagnostics[0].Code == ErrorCode::MissingField);
+    CHECK(copy.Diagnostics[0].Message == "Missing name");
+    CHECK(copy.Diagnostics[0].Path == "a.jpg");
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Decoded metadata can be written back to its file", "[binary]") {
+  const auto path = getTempSample(SampleImage::Sample1);
+  const auto bytes = ImageMetadata(path).toBytes();
+
+  ImageMetadata decoded = ImageMetadata::fromBytes(bytes);
+  CHECK(decoded == ImageMetadata(path));
+  decoded.Title = "Written after decoding";
+  decoded.toFile();
+  CHECK(ImageMetadata(path).Title == "Written after decoding");
+}
+
+TEST_CASE("Malformed bytes are rejected", "[binary]") {
+  const std::string bytes = fullMetadata().toBytes();
+
+  SECTION("Every truncation") {
+    for (std::size_t length = 0; length < bytes.size(); length++) {
+      CHECK_THROWS_AS(ImageMetadata::fromBytes(std::string_view(bytes).substr(0, length)), InvalidStructureError);
+    }
+  }
+
+  SECTION("Trailing bytes") {
+    CHECK_THROWS_AS(ImageMetadata::fromBytes(bytes + '\0'), InvalidStructureError);
+  }
+
+  SECTION("Another type or version") {
+    CHECK_THROWS_AS(RegionInfoStruct::fromBytes(bytes), InvalidStructureError);
+    std::string otherVersion = bytes;
+    otherVersion[0] = static_cast<char>(BinaryCodec::VERSION + 1);
+    CHECK_THROWS_AS(ImageMetadata::fromBytes(otherVersion), InvalidStructureError);
+  }
+
+  SECTION("Counts larger than the input") {
+    std::string huge = KeywordInfoModel(std::vector<KeywordInfoModel::KeywordStruct>{}).toBytes();
+    huge.back() = '\x7f';
+    CHECK_THROWS_AS(KeywordInfoModel::fromBytes(huge), InvalidStructureError);
+  }
+
+  SECTION("Keywords nested too deep") {
+    KeywordInfoModel::KeywordStruct keyword("Leaf");
+    for (std::size_t depth = 1; depth <= BinaryCodec::MAX_KEYWORD_DEPTH; depth++) {
+      keyword = KeywordInfoModel::KeywordStruct("Node", {keyword});
+    }
+    CHECK_THROWS_AS(KeywordInfoModel::KeywordStruct::fromBytes(keyword.toBytes()), InvalidStructureError);
+    CHECK(KeywordInfoModel::KeywordStruct::fromBytes(keyword.Children[0].toBytes()) == keyword.Children[0]);
+  }
+}
@@ -0,0 +1,63 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "BoundedQueue.hpp"
+
+TEST_CASE("BoundedQueue basics", "[queue]") {
+  BoundedQueue<int> queue(2);
+
+  SECTION("Items come out in order") {
+    REQUIRE(queue.push(1));
+    REQUIRE(queue.push(2));
+    CHECK(queue.pop() == 1);
+    CHECK(queue.pop() == 2);
+  }
+
+  SECTION("Closing drains, then refuses") {
+    REQUIRE(queue.push(1));
+    queue.close();
+    CHECK_FALSE(queue.push(2));
+    CHECK(queue.pop() == 1);
+    CHECK_FALSE(queue.pop().has_value());
+  }
+
+  SECTION("A zero capacity holds one item") {
+    BoundedQueue<int> tiny(0);
+    CHECK(tiny.capacity() == 1);
+  }
+}
+
+TEST_CASE("BoundedQueue across threads", "[queue]") {
+  BoundedQueue<int> queue(4);
+  constexpr int perProducer = 1000;
+  std::atomic<long> sum{0};
+
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < 3; ++i) {
+    consumers.emplace_back([&]() {
+      while (auto item = queue.pop()) {
+        sum += item.value();
+      }
+    });
+  }
+  std::vector<std::thread> producers;
+  for (int i = 0; i < 2; ++i) {
+    producers.emplace_back([&]() {
+      for (int value = 1; value <= perProducer; ++value) {
+        queue.push(value);
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  queue.close();
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+
+  CHECK(sum == 2L * perProducer * (perProducer + 1) / 2);
+}
@@ -0,0 +1,282 @@
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "Batch.hpp"
+#include "Catalog.hpp"
+#include "CatalogFormat.hpp"
+#include "Errors.hpp"
+#include "ImageMetadata.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path tempCatalogPath() {
+  return fs::temp_directory_path() /
+         ("test_catalog_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".cat");
+}
+
+} // namespace
+
+TEST_CASE_METHOD(ImageTestFixture, "Catalog round trip", "[catalog]") {
+  const fs::path catalogPath = tempCatalogPath();
+  std::vector<fs::path> images = {getTempSample(SampleImage::Sample1), getTempSample(SampleImage::Sample2),
+                                  getTempSample(SampleImage::Sample3), getTempSample(SampleImage::Sample4)};
+
+  CatalogWriter writer;
+  std::vector<ImageMetadata> expected;
+  for (const auto& image : images) {
+    expected.emplace_back(image);
+    writer.add(image, expected.back());
+  }
+  // Adding a path again replaces its record
+  writer.add(images[0], expected[0]);
+  REQUIRE(writer.size() == images.size());
+  writer.write(catalogPath);
+
+  SECTION("Every record reads back equal") {
+    CatalogReader reader(catalogPath);
+    REQUIRE(reader.size() == images.size());
+    for (std::size_t i = 0; i < images.size(); i++) {
+      auto index = reader.find(images[i]);
+      REQUIRE(index.has_value());
+      CHECK(reader.path(index.value()) == FileUtils::lookupKey(images[i]));
+      CHECK(reader.identity(index.value()) == FileUtils::identify(images[i]).value());
+      CHECK(reader.metadata(index.value()) == expected[i]);
+      auto found = reader.lookup(images[i]);
+      REQUIRE(found.has_value());
+      CHECK(found.value() == expected[i]);
+    }
+    CHECK_FALSE(reader.find(catalogPath).has_value());
+  }
+
+  SECTION("Records are in path order") {
+    CatalogReader reader(catalogPath);
+    for (std::size_t i = 1; i < reader.size(); i++) {
+      CHECK(reader.path(i - 1) < reader.path(i));
+    }
+  }
+
+  SECTION("A changed file is not returned") {
+    {
+      std::ofstream out(images[1], std::ios::binary | std::ios::app);
+      out << '\0';
+    }
+    CatalogReader reader(catalogPath);
+    CHECK(reader.find(images[1]).has_value());
+    CHECK_FALSE(reader.lookup(images[1]).has_value());
+    fs::remove(images[2]);
+    CHECK_FALSE(reader.lookup(images[2]).has_value());
+  }
+
+  SECTION("Readers can be moved") {
+    CatalogReader reader(catalogPath);
+    CatalogReader moved(std::move(reader));
+    CHECK(moved.size() == images.size());
+  }
+
+  fs::remove(catalogPath);
+}
+
+TEST_CASE("Catalog records with unset fields", "[catalog]") {
+  const fs::path catalogPath = tempCatalogPath();
+  const fs::path imagePath = tempCatalogPath();
+  {
+    std::ofstream out(imagePath);
+    out << "not an image";
+  }
+
+  ImageMetadata metadata(10, 20);
+  metadata.Title = "";
+  metadata.KeywordInfo = KeywordInfoModel(std::vector<std::string>{"A/B/C", "A/D", "E"});
+  metadata.RegionInfo = RegionInfoStruct(DimensionsStruct(10, 20, "pixel"), {});
+
+  CatalogWriter writer;
+  writer.add(imagePath, metadata);
+  writer.write(catalogPath);
+
+  CatalogReader reader(catalogPath);
+  auto found = reader.lookup(imagePath);
+  REQUIRE(found.has_value());
+  CHECK(found.value() == metadata);
+  CHECK(found->Title == "");
+  CHECK_FALSE(found->Description.has_value());
+  CHECK_FALSE(found->Orientation.has_value());
+
+  fs::remove(catalogPath);
+  fs::remove(imagePath);
+}
+
+TEST_CASE("Catalog rejects other files", "[catalog]") {
+  const fs::path catalogPath = tempCatalogPath();
+
+  SECTION("A missing file") {
+    CHECK_THROWS_AS(CatalogReader(catalogPath), FileAccessError);
+  }
+
+  SECTION("A file which is not a catalog") {
+    {
+      std::ofstream out(catalogPath, std::ios::binary);
+      out << std::string(200, 'x');
+    }
+    CHECK_THROWS_AS(CatalogReader(catalogPath), InvalidStructureError);
+  }
+
+  SECTION("A truncated catalog") {
+    CatalogWriter writer;
+    writer.add(catalogPath.string() + ".jpg", FileUtils::FileIdentity{}, ImageMetadata(1, 1));
+    writer.write(catalogPath);
+    fs::resize_file(catalogPath, fs::file_size(catalogPath) - 8);
+    CHECK_THROWS_AS(CatalogReader(catalogPath), InvalidStructureError);
+  }
+
+  SECTION("Keywords which share their children") {
+    ImageMetadata metadata(1, 1);
+    metadata.KeywordInfo = KeywordInfoModel(std::vector<std::string>{"A/B", "C"});
+    CatalogWriter writer;
+    writer.add(catalogPath.string() + ".jpg", FileUtils::FileIdentity{}, metadata);
+    writer.write(catalogPath);
+
+    std::string bytes;
+    {
+      std::ifstream in(catalogPath, std::ios::binary);
+      bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    CatalogFormat::Header header{};
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    REQUIRE(header.KeywordCount == 3);
+    // The roots A and C, then the child B of A. C is pointed at the children of A as well.
+    CatalogFormat::Keyword parent{};
+    std::memcpy(&parent, bytes.data() + header.KeywordsOffset, sizeof(parent));
+    REQUIRE(parent.ChildCount == 1);
+    const std::size_t second = header.KeywordsOffset + sizeof(CatalogFormat::Keyword);
+    std::memcpy(bytes.data() + second + offsetof(CatalogFormat::Keyword, FirstChild), &parent.FirstChild,
+                sizeof(parent.FirstChild));
+    std::memcpy(bytes.data() + second + offsetof(CatalogFormat::Keyword, ChildCount), &parent.ChildCount,
+                sizeof(parent.ChildCount));
+    {
+      std::ofstream out(catalogPath, std::ios::binary | std::ios::trunc);
+      out << bytes;
+    }
+
+    CatalogReader reader(catalogPath);
+    CHECK_THROWS_AS(reader.metadata(0), InvalidStructureError);
+  }
+
+  SECTION("An empty catalog") {
+    CatalogWriter().write(catalogPath);
+    CatalogReader reader(catalogPath);
+    CHECK(reader.size() == 0);
+    CHECK_FALSE(reader.find("anything.jpg").has_value());
+  }
+
+  fs::remove(catalogPath);
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "buildCatalog writes the files it could read", "[catalog][batch]") {
+  const fs::path catalogPath = tempCatalogPath();
+  std::vector<fs::path> paths = {getTempSample(SampleImage::Sample1), "nonexistent_image.jpg",
+                                 getTempSample(SampleImage::Sample2)};
+
+  auto results = Batch::buildCatalog(paths, catalogPath, 2);
+  REQUIRE(results.size() == 3);
+  CHECK(results[0].ok());
+  REQUIRE_FALSE(results[1].ok());
+  CHECK(results[1].Error->Code == ErrorCode::FileAccess);
+  CHECK(results[2].ok());
+
+  CatalogReader reader(catalogPath);
+  CHECK(reader.size() == 2);
+  CHECK(reader.lookup(paths[0]).value() == ImageMetadata(paths[0]));
+  CHECK(reader.lookup(paths[2]).value() == ImageMetadata(paths[2]));
+
+  SECTION("A cancelled build leaves the catalog alone") {
+    BatchOptions batch;
+    batch.Cancellation.cancel();
+    auto cancelled = Batch::buildCatalog({paths[0]}, catalogPath, 1, {}, batch);
+    CHECK(cancelled[0].Error->Code == ErrorCode::Cancelled);
+    CHECK(CatalogReader(catalogPath).size() == 2);
+  }
+
+  fs::remove(catalogPath);
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Refreshing a catalog reads only new and changed files", "[catalog][batch]") {
+  const fs::path catalogPath = tempCatalogPath();
+  const fs::path first = getTempSample(SampleImage::Sample1);
+  const fs::path second = getTempSample(SampleImage::Sample2);
+  const fs::path third = getTempSample(SampleImage::Sample3);
+
+  SECTION("Without a catalog every file is new") {
+    auto summary = Batch::refreshCatalog({first, second}, catalogPath);
+    CHECK(summary.Unchanged == 0);
+    CHECK(summary.Added == std::vector<fs::path>{first, second});
+    CHECK(CatalogReader(catalogPath).size() == 2);
+  }
+
+  SECTION("A complete listing adds, updates and removes") {
+    Batch::refreshCatalog({first, second}, catalogPath);
+
+    ImageMetadata changed(second);
+    changed.Title = "Changed since the last refresh";
+    changed.toFile();
+
+    auto summary = Batch::refreshCatalog({second, third}, catalogPath);
+    CHECK(summary.Unchanged == 0);
+    CHECK(summary.Updated == std::vector<fs::path>{second});
+    CHECK(summary.Added == std::vector<fs::path>{third});
+    REQUIRE(summary.Removed.size() == 1);
+    CHECK(summary.Removed[0] == fs::path(FileUtils::lookupKey(first)));
+    CHECK(summary.Errors.empty());
+
+    CatalogReader reader(catalogPath);
+    CHECK(reader.size() == 2);
+    CHECK(reader.lookup(second)->Title == "Changed since the last refresh");
+
+    auto again = Batch::refreshCatalog({second, third}, catalogPath);
+    CHECK(again.Unchanged == 2);
+    CHECK(again.Added.empty());
+    CHECK(again.Updated.empty());
+  }
+
+  SECTION("An update keeps the records of files it does not list") {
+    Batch::refreshCatalog({first, second}, catalogPath);
+    fs::remove(second);
+
+    auto summary = Batch::updateCatalog({second, third}, catalogPath);
+    CHECK(summary.Added == std::vector<fs::path>{third});
+    REQUIRE(summary.Removed.size() == 1);
+    CHECK(summary.Removed[0] == fs::path(FileUtils::lookupKey(second)));
+
+    CatalogReader reader(catalogPath);
+    CHECK(reader.size() == 2);
+    CHECK(reader.lookup(first).has_value());
+    CHECK(reader.lookup(third).has_value());
+  }
+
+  SECTION("A file which cannot be read is reported and left out") {
+    const fs::path broken = tempCatalogPath().replace_extension(".jpg");
+    {
+      std::ofstream out(broken, std::ios::binary);
+      out << "not an image";
+    }
+    auto summary = Batch::refreshCatalog({first, broken}, catalogPath);
+    CHECK(summary.Added == std::vector<fs::path>{first});
+    REQUIRE(summary.Errors.size() == 1);
+    CHECK(summary.Errors[0].Path == broken);
+    CHECK(CatalogReader(catalogPath).size() == 1);
+    fs::remove(broken);
+  }
+
+  fs::remove(catalogPath);
+}
@@ -1,6 +1,143 @@
+#include <cstddef>
 #include <filesystem>
 #include <fstream>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
-// TODO
+#include <exiv2/exiv2.hpp>
+
+#include "TestUtils.hpp"
+
+#include "Batch.hpp"
+#include "Errors.hpp"
+#include "ImageMetadata.hpp"
+#include "MetadataKeys.hpp"
+#include "MetadataSession.hpp"
+
+namespace {
+void requireCleared(const ImageMetadata& metadata) {
+  CHECK_FALSE(metadata.Title.has_value());
+  CHECK_FALSE(metadata.Description.has_value());
+  CHECK_FALSE(metadata.RegionInfo.has_value());
+  CHECK_FALSE(metadata.Orientation.has_value());
+  CHECK(metadata.KeywordInfo->Hierarchy.empty());
+  CHECK_FALSE(metadata.Country.has_value());
+  CHECK_FALSE(metadata.City.has_value());
+  CHECK_FALSE(metadata.State.has_value());
+  CHECK_FALSE(metadata.Location.has_value());
+}
+} // namespace
+
+TEST_CASE_METHOD(ImageTestFixture, "Clearing metadata from a file", "[clearing][writing]") {
+  SECTION("Every managed field is removed") {
+    auto tempPath = getTempSample(SampleImage::Sample1);
+    ImageMetadata metadata(tempPath);
+    REQUIRE(metadata.Title.has_value());
+    REQUIRE(metadata.RegionInfo.has_value());
+
+    metadata.clearFile();
+
+    requireCleared(metadata);
+    ImageMetadata readBack(tempPath);
+    requireCleared(readBack);
+    CHECK(readBack.ImageHeight == metadata.ImageHeight);
+    CHECK(readBack.ImageWidth == metadata.ImageWidth);
+  }
+
+  SECTION("The mirrored IPTC and Exif sources are removed too") {
+    auto tempPath = getTempSample(SampleImage::Sample2);
+    ImageMetadata metadata(tempPath);
+    metadata.Description = "Mirrored description";
+    metadata.City = "Mirrored city";
+    metadata.toFile();
+
+    metadata.clearFile();
+
+    auto image = Exiv2::ImageFactory::open(tempPath.string());
+    image->readMetadata();
+    const auto& iptcData = image->iptcData();
+    const auto& exifData = image->exifData();
+    CHECK(iptcData.findKey(Exiv2::IptcKey(MetadataKeys::Iptc::Caption)) == iptcData.end());
+    CHECK(iptcData.findKey(Exiv2::IptcKey(MetadataKeys::Iptc::City)) == iptcData.end());
+    CHECK(exifData.findKey(Exiv2::ExifKey(MetadataKeys::Exif::Orientation)) == exifData.end());
+    CHECK(exifData.findKey(Exiv2::ExifKey(MetadataKeys::Exif::ImageDescription)) == exifData.end());
+  }
+
+  SECTION("An explicit path is cleared instead of the original") {
+    auto originalPath = getTempSample(SampleImage::Sample1);
+    auto otherPath = getTempSample(SampleImage::Sample3);
+    ImageMetadata metadata(originalPath);
+
+    metadata.clearFile(otherPath);
+
+    requireCleared(ImageMetadata(otherPath));
+    CHECK(ImageMetadata(originalPath).Title.has_value());
+  }
+
+  SECTION("An atomic clear") {
+    auto tempPath = getTempSample(SampleImage::Sample1);
+    ImageMetadata metadata(tempPath);
+    WriteOptions options;
+    options.Atomic = true;
+    options.Durability = DurabilityLevel::FileAndDirectory;
+    options.Sidecar = true;
+
+    metadata.clearFile(std::nullopt, options);
+
+    requireCleared(ImageMetadata(tempPath));
+    CHECK_FALSE(std::filesystem::exists(ImageMetadata::sidecarPath(tempPath)));
+  }
+
+  SECTION("Without a known path") {
+    ImageMetadata metadata(100, 100, "Title");
+    CHECK_THROWS_AS(metadata.clearFile(), FileAccessError);
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Clearing metadata from many files", "[clearing][writing]") {
+  SECTION("Every file is cleared") {
+    std::vector<std::filesystem::path> paths = {getTempSample(SampleImage::Sample1),
+                                                getTempSample(SampleImage::Sample2),
+                                                getTempSample(SampleImage::Sample3)};
+
+    auto results = Batch::clearMany(paths, 2);
+
+    REQUIRE(results.size() == paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      CHECK(results[i].ok());
+      CHECK(results[i].Path == paths[i]);
+      requireCleared(ImageMetadata(paths[i]));
+    }
+  }
+
+  SECTION("A missing file does not stop the batch") {
+    std::vector<std::filesystem::path> paths = {getTempSample(SampleImage::Sample1), "nonexistent_image.jpg",
+                                                getTempSample(SampleImage::Sample2)};
+
+    auto results = Batch::clearMany(paths);
+
+    REQUIRE(results.size() == 3);
+    CHECK(results[0].ok());
+    REQUIRE_FALSE(results[1].ok());
+    CHECK(results[1].Error->Code == ErrorCode::FileAccess);
+    CHECK(results[1].Path == paths[1]);
+    CHECK(results[2].ok());
+    requireCleared(ImageMetadata(paths[0]));
+    requireCleared(ImageMetadata(paths[2]));
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Clearing metadata through a session", "[clearing][session]") {
+  auto tempPath = getTempSample(SampleImage::Sample1);
+  MetadataSession session(tempPath);
+
+  session.clear();
+  CHECK(session.isDirty());
+  requireCleared(session.read());
+
+  // Nothing is written until the commit
+  CHECK(ImageMetadata(tempPath).Title.has_value());
+  session.commit();
+  requireCleared(ImageMetadata(tempPath));
+}
@@ -111,6 +111,32 @@ TEST_CASE("DimensionsStruct::toXmp and fromXmp roundtrip", "[DimensionsStruct]")
                            Catch::Matchers::Message("No height found in dimensions struct"));
   }
 
+  SECTION("fromXmp with a height which is not a number") {
+    Exiv2::XmpData xmpData;
+    xmpData[baseKey + "/stDim:h"] = "tall";
+    xmpData[baseKey + "/stDim:w"] = "200.0";
+    xmpData[baseKey + "/stDim:unit"] = "pixels";
+
+    REQUIRE_THROWS_MATCHES(DimensionsStruct::fromXmp(xmpData, baseKey), InvalidStructureError,
+                           Catch::Matchers::Message("Invalid height 'tall' in dimensions struct"));
+  }
+
+  SECTION("tryFromXmp returns errors as values") {
+    Exiv2::XmpData xmpData;
+    xmpData[baseKey + "/stDim:h"] = "100.0";
+
+    auto missing = DimensionsStruct::tryFromXmp(xmpData, baseKey);
+    REQUIRE_FALSE(missing.ok());
+    CHECK(missing.error().Code == ErrorCode::MissingField);
+    CHECK(missing.error().Message == "No width found in dimensions struct");
+
+    xmpData[baseKey + "/stDim:w"] = "200.0";
+    xmpData[baseKey + "/stDim:unit"] = "pixels";
+    auto parsed = DimensionsStruct::tryFromXmp(xmpData, baseKey);
+    REQUIRE(parsed.ok());
+    CHECK(parsed.value() == DimensionsStruct(100.0, 200.0, "pixels"));
+  }
+
   SECTION("toXmp writes correct precision for doubles") {
     Exiv2::XmpData xmpData;
     DimensionsStruct dims(123.456789, 987.654321, "mm");
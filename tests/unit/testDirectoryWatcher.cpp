@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "DirectoryWatcher.hpp"
+#include "Errors.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path tempRoot() {
+  return fs::temp_directory_path() /
+         ("test_watch_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+}
+
+void touch(const fs::path& path) {
+  std::ofstream out(path, std::ios::binary);
+  out << "x";
+}
+
+} // namespace
+
+TEST_CASE("DirectoryWatcher reports changed images", "[watcher]") {
+  const fs::path root = tempRoot();
+  fs::create_directories(root / "existing");
+
+  if (!DirectoryWatcher::supported()) {
+    CHECK_THROWS_AS(DirectoryWatcher(root), ExifMwgBaseError);
+    fs::remove_all(root);
+    return;
+  }
+
+  DirectoryWatcher watcher(root);
+  CHECK(watcher.poll(0).empty());
+
+  SECTION("Written files are reported once, others are ignored") {
+    touch(root / "a.jpg");
+    touch(root / "existing" / "b.TIF");
+    touch(root / "notes.txt");
+    touch(root / "a.jpg");
+    CHECK(watcher.poll(1000) == std::vector<fs::path>{root / "a.jpg", root / "existing" / "b.TIF"});
+    CHECK_FALSE(watcher.rescanNeeded());
+    CHECK(watcher.poll(0).empty());
+  }
+
+  SECTION("Waiting does not collect the events") {
+    CHECK_FALSE(watcher.wait(0));
+    touch(root / "a.jpg");
+    CHECK(watcher.wait(1000));
+    CHECK(watcher.wait(0));
+    CHECK(watcher.poll(0) == std::vector<fs::path>{root / "a.jpg"});
+    CHECK_FALSE(watcher.wait(0));
+  }
+
+  SECTION("New directories are watched, with the images already inside them") {
+    fs::create_directories(root / "new" / "nested");
+    touch(root / "new" / "nested" / "c.png");
+    auto changed = watcher.poll(1000);
+    CHECK(std::find(changed.begin(), changed.end(), root / "new" / "nested" / "c.png") != changed.end());
+
+    touch(root / "new" / "nested" / "d.png");
+    CHECK(watcher.poll(1000) == std::vector<fs::path>{root / "new" / "nested" / "d.png"});
+  }
+
+  SECTION("Removed and renamed files are reported") {
+    touch(root / "a.jpg");
+    watcher.poll(1000);
+    fs::rename(root / "a.jpg", root / "b.jpg");
+    CHECK(watcher.poll(1000) == std::vector<fs::path>{root / "a.jpg", root / "b.jpg"});
+    fs::remove(root / "b.jpg");
+    CHECK(watcher.poll(1000) == std::vector<fs::path>{root / "b.jpg"});
+  }
+
+  SECTION("Moving a directory out of the tree needs a rescan") {
+    const fs::path outside = tempRoot();
+    fs::rename(root / "existing", outside);
+    watcher.poll(1000);
+    CHECK(watcher.rescanNeeded());
+
+    touch(outside / "e.jpg");
+    CHECK(watcher.poll(1000).empty());
+    fs::remove_all(outside);
+  }
+
+  SECTION("A directory renamed within the tree is still watched") {
+    fs::create_directories(root / "existing" / "nested");
+    watcher.poll(1000);
+    fs::rename(root / "existing", root / "renamed");
+    watcher.poll(1000);
+
+    touch(root / "renamed" / "f.jpg");
+    touch(root / "renamed" / "nested" / "g.jpg");
+    CHECK(watcher.poll(1000) ==
+          std::vector<fs::path>{root / "renamed" / "f.jpg", root / "renamed" / "nested" / "g.jpg"});
+  }
+
+  fs::remove_all(root);
+}
+
+TEST_CASE("DirectoryWatcher rejects a missing root", "[watcher]") {
+  CHECK_THROWS_AS(DirectoryWatcher(tempRoot()), ExifMwgBaseError);
+}
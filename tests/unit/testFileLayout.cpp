@@ -0,0 +1,112 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "FileLayout.hpp"
+#include "ImageMetadata.hpp"
+
+namespace {
+std::vector<char> readAllBytes(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+} // namespace
+
+TEST_CASE_METHOD(ImageTestFixture, "FileLayout locates the orientation value", "[layout]") {
+  SECTION("JPEG with an orientation tag") {
+    auto layout = FileLayout::scan(getOriginalSample(SampleImage::Sample2));
+    REQUIRE(layout.OrientationOffset.has_value());
+
+    auto bytes = readAllBytes(getOriginalSample(SampleImage::Sample2));
+    auto offset = static_cast<std::size_t>(layout.OrientationOffset.value());
+    REQUIRE(offset + 1 < bytes.size());
+    // Sample 2 is stored with orientation 1
+    CHECK(bytes[offset + (layout.BigEndian ? 1 : 0)] == 1);
+    CHECK(bytes[offset + (layout.BigEndian ? 0 : 1)] == 0);
+  }
+
+  SECTION("JPEG without an orientation tag") {
+    CHECK_FALSE(FileLayout::scan(getOriginalSample(SampleImage::Sample1)).OrientationOffset.has_value());
+  }
+
+  SECTION("Formats which are not scanned") {
+    CHECK_FALSE(FileLayout::scan(getOriginalSample(SampleImage::SamplePNG)).OrientationOffset.has_value());
+    CHECK_FALSE(FileLayout::scan(getOriginalSample(SampleImage::SampleWEBP)).OrientationOffset.has_value());
+  }
+
+  SECTION("Missing file") {
+    CHECK_FALSE(FileLayout::scan("nonexistent_image.jpg").OrientationOffset.has_value());
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "FileLayout patches the orientation in place", "[layout][writing]") {
+  auto tempPath = getTempSample(SampleImage::Sample3);
+  auto layout = FileLayout::scan(tempPath);
+  REQUIRE(layout.OrientationOffset.has_value());
+
+  SECTION("Only the orientation bytes change") {
+    auto before = readAllBytes(tempPath);
+    REQUIRE(layout.patchOrientation(tempPath, ExifOrientation::Horizontal, ExifOrientation::Rotate90CW));
+    auto after = readAllBytes(tempPath);
+
+    REQUIRE(before.size() == after.size());
+    std::size_t differences = 0;
+    for (std::size_t i = 0; i < before.size(); ++i) {
+      if (before[i] != after[i]) {
+        ++differences;
+      }
+    }
+    CHECK(differences == 1);
+    CHECK(ImageMetadata(tempPath).Orientation == ExifOrientation::Rotate90CW);
+  }
+
+  SECTION("A mismatched expected value is refused") {
+    auto before = readAllBytes(tempPath);
+    CHECK_FALSE(layout.patchOrientation(tempPath, ExifOrientation::Rotate180, ExifOrientation::Rotate90CW));
+    CHECK(readAllBytes(tempPath) == before);
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "FileLayout locates the XMP packet", "[layout]") {
+  SECTION("JPEG with an XMP packet") {
+    auto layout = FileLayout::scan(getOriginalSample(SampleImage::Sample1));
+    REQUIRE(layout.XmpPacketOffset.has_value());
+
+    auto bytes = readAllBytes(getOriginalSample(SampleImage::Sample1));
+    auto offset = static_cast<std::size_t>(layout.XmpPacketOffset.value());
+    REQUIRE(offset + layout.XmpPacketLength <= bytes.size());
+    CHECK(std::string(bytes.data() + offset, 9) == "<?xpacket");
+    CHECK(std::string(bytes.data() + offset + layout.XmpPacketLength - 2, 2) == "?>");
+  }
+
+  SECTION("Formats which are not scanned") {
+    CHECK_FALSE(FileLayout::scan(getOriginalSample(SampleImage::SamplePNG)).XmpPacketOffset.has_value());
+    CHECK_FALSE(FileLayout::scan(getOriginalSample(SampleImage::SampleWEBP)).XmpPacketOffset.has_value());
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "FileLayout patches the XMP packet in place", "[layout][writing]") {
+  auto tempPath = getTempSample(SampleImage::Sample4);
+  auto layout = FileLayout::scan(tempPath);
+  REQUIRE(layout.XmpPacketOffset.has_value());
+  auto before = readAllBytes(tempPath);
+
+  SECTION("A packet of a different length is refused") {
+    CHECK_FALSE(layout.patchXmpPacket(tempPath, "<?xpacket end='w'?>"));
+    CHECK(readAllBytes(tempPath) == before);
+  }
+
+  SECTION("A packet of the same length replaces the existing one") {
+    auto offset = static_cast<std::size_t>(layout.XmpPacketOffset.value());
+    std::string packet(before.begin() + static_cast<std::ptrdiff_t>(offset),
+                       before.begin() + static_cast<std::ptrdiff_t>(offset + layout.XmpPacketLength));
+    REQUIRE(layout.patchXmpPacket(tempPath, packet));
+    CHECK(readAllBytes(tempPath) == before);
+  }
+}
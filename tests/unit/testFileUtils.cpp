@@ -0,0 +1,257 @@
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "Errors.hpp"
+#include "FileUtils.hpp"
+#include "ImageMetadata.hpp"
+#include "MetadataSession.hpp"
+#include "WriteOptions.hpp"
+
+namespace {
+// Temporary files are hidden files in the directory of the target
+bool hasLeftoverTemporaries(const std::filesystem::path& target) {
+  const std::string prefix = "." + target.filename().string() + ".exifmwg-";
+  for (const auto& entry : std::filesystem::directory_iterator(target.parent_path())) {
+    if (entry.path().filename().string().rfind(prefix, 0) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<char> readAllBytes(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+WriteOptions atomicOptions(DurabilityLevel level) {
+  WriteOptions options;
+  options.Atomic = true;
+  options.Durability = level;
+  return options;
+}
+} // namespace
+
+TEST_CASE_METHOD(ImageTestFixture, "FileUtils helpers", "[fileutils]") {
+  auto tempPath = getTempSample(SampleImage::Sample1);
+
+  SECTION("Temporary paths are unused and next to the target") {
+    auto first = FileUtils::temporaryPathFor(tempPath);
+    auto second = FileUtils::temporaryPathFor(tempPath);
+    CHECK(first.parent_path() == tempPath.parent_path());
+    CHECK(first != second);
+    CHECK_FALSE(std::filesystem::exists(first));
+  }
+
+  SECTION("Every durability level syncs an existing file") {
+    CHECK_NOTHROW(FileUtils::syncFile(tempPath, DurabilityLevel::Deferred));
+    CHECK_NOTHROW(FileUtils::syncFile(tempPath, DurabilityLevel::FileData));
+    CHECK_NOTHROW(FileUtils::syncFile(tempPath, DurabilityLevel::FileAndDirectory));
+    CHECK_NOTHROW(FileUtils::syncDirectory(tempPath.parent_path()));
+  }
+
+  SECTION("Syncing a missing file") {
+    CHECK_THROWS_AS(FileUtils::syncFile("nonexistent_image.jpg", DurabilityLevel::FileData), FileAccessError);
+    CHECK_NOTHROW(FileUtils::syncFile("nonexistent_image.jpg", DurabilityLevel::Deferred));
+  }
+
+  SECTION("Replacing a file") {
+    auto source = FileUtils::temporaryPathFor(tempPath);
+    {
+      std::ofstream file(source, std::ios::binary);
+      file << "replacement";
+    }
+    FileUtils::replaceFile(source, tempPath, DurabilityLevel::FileAndDirectory);
+    CHECK_FALSE(std::filesystem::exists(source));
+    CHECK(std::filesystem::file_size(tempPath) == std::string("replacement").size());
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Copying files", "[fileutils]") {
+  auto source = getOriginalSample(SampleImage::Sample3);
+  auto target = FileUtils::temporaryPathFor(getTempSample(SampleImage::Sample1));
+
+  SECTION("The copy matches the source") {
+    auto method = FileUtils::copyFile(source, target, false);
+    CHECK_FALSE(FileUtils::copyMethodName(method).empty());
+    CHECK(readAllBytes(target) == readAllBytes(source));
+    CHECK(std::filesystem::status(target).permissions() == std::filesystem::status(source).permissions());
+  }
+
+  SECTION("An existing target is only replaced when asked") {
+    {
+      std::ofstream file(target, std::ios::binary);
+      file << "existing";
+    }
+    CHECK_THROWS_AS(FileUtils::copyFile(source, target, false), FileAccessError);
+    FileUtils::copyFile(source, target, true);
+    CHECK(readAllBytes(target) == readAllBytes(source));
+  }
+
+  SECTION("A missing source") {
+    CHECK_THROWS_AS(FileUtils::copyFile("nonexistent_image.jpg", target, true), FileAccessError);
+    CHECK_FALSE(std::filesystem::exists(target));
+  }
+
+  SECTION("A file is never copied onto itself") {
+    FileUtils::copyFile(source, target, false);
+    const auto bytes = readAllBytes(target);
+    std::filesystem::path link = FileUtils::temporaryPathFor(target);
+    std::filesystem::create_hard_link(target, link);
+
+    CHECK(FileUtils::sameFile(target, target.parent_path() / "." / target.filename()));
+    CHECK(FileUtils::sameFile(target, link));
+    CHECK_FALSE(FileUtils::sameFile(target, source));
+    CHECK_THROWS_AS(FileUtils::copyFile(target, target.parent_path() / "." / target.filename(), true),
+                    FileAccessError);
+    CHECK_THROWS_AS(FileUtils::copyFile(link, target, true), FileAccessError);
+    CHECK(readAllBytes(target) == bytes);
+    std::filesystem::remove(link);
+  }
+
+  std::filesystem::remove(target);
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Writing back to the original under another name", "[fileutils][writing]") {
+  auto tempPath = getTempSample(SampleImage::Sample1);
+  ImageMetadata metadata(tempPath);
+  metadata.Title = "Written in place";
+  const std::filesystem::path respelled = tempPath.parent_path() / "." / tempPath.filename();
+
+  SECTION("A second spelling") {
+    metadata.toFile(respelled);
+    CHECK(ImageMetadata(tempPath) == metadata);
+  }
+
+  SECTION("A second spelling, atomically") {
+    metadata.toFile(respelled, atomicOptions(DurabilityLevel::Deferred));
+    CHECK(ImageMetadata(tempPath) == metadata);
+  }
+
+  SECTION("A hardlink") {
+    const std::filesystem::path link = FileUtils::temporaryPathFor(tempPath);
+    std::filesystem::create_hard_link(tempPath, link);
+    metadata.toFile(link);
+
+    CHECK(ImageMetadata(link) == metadata);
+    // Neither name was emptied by copying the file onto itself
+    CHECK(ImageMetadata(tempPath).ImageWidth == metadata.ImageWidth);
+    std::filesystem::remove(link);
+  }
+
+  CHECK_FALSE(hasLeftoverTemporaries(tempPath));
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Atomic writes", "[fileutils][writing]") {
+  SECTION("In place") {
+    auto tempPath = getTempSample(SampleImage::Sample1);
+    ImageMetadata metadata(tempPath);
+    metadata.Title = "Atomic title";
+    metadata.toFile(std::nullopt, atomicOptions(DurabilityLevel::FileAndDirectory));
+
+    CHECK(ImageMetadata(tempPath) == metadata);
+    CHECK_FALSE(hasLeftoverTemporaries(tempPath));
+  }
+
+  SECTION("To a new path") {
+    auto originalPath = getTempSample(SampleImage::Sample2);
+    auto newPath = getTempSample(SampleImage::Sample3);
+    ImageMetadata metadata(originalPath);
+    metadata.City = "Atomic city";
+    metadata.toFile(newPath, atomicOptions(DurabilityLevel::FileData));
+
+    ImageMetadata readBack(newPath);
+    CHECK(readBack.City == "Atomic city");
+    CHECK(readBack.ImageWidth == metadata.ImageWidth);
+    CHECK_FALSE(ImageMetadata(originalPath).City == "Atomic city");
+    CHECK_FALSE(hasLeftoverTemporaries(newPath));
+  }
+
+  SECTION("Patchable changes are rewritten too") {
+    auto tempPath = getTempSample(SampleImage::Sample2);
+    MetadataSession session(tempPath);
+    ImageMetadata metadata = session.read();
+    metadata.Orientation = ExifOrientation::Rotate180;
+    session.stage(metadata);
+    session.commit(atomicOptions(DurabilityLevel::Deferred));
+
+    CHECK(ImageMetadata(tempPath).Orientation == ExifOrientation::Rotate180);
+    CHECK_FALSE(hasLeftoverTemporaries(tempPath));
+  }
+
+  SECTION("A failed write leaves the original untouched") {
+    auto tempPath = getTempSample(SampleImage::Sample1);
+    ImageMetadata metadata(tempPath);
+    const auto sizeBefore = std::filesystem::file_size(tempPath);
+    metadata.Title = "Never written";
+    CHECK_THROWS(metadata.toFile(tempPath.parent_path() / "missing_directory" / "image.jpg",
+                                 atomicOptions(DurabilityLevel::FileData)));
+    CHECK(std::filesystem::file_size(tempPath) == sizeBefore);
+  }
+
+  // A directory in place of the source makes the copy fail after the temporary file was created
+  SECTION("A failed copy to a new path leaves no temporary file") {
+    auto originalPath = getTempSample(SampleImage::Sample2);
+    auto newPath = getTempSample(SampleImage::Sample3);
+    ImageMetadata metadata(originalPath);
+    std::filesystem::remove(originalPath);
+    std::filesystem::create_directory(originalPath);
+
+    CHECK_THROWS_AS(metadata.toFile(newPath, atomicOptions(DurabilityLevel::Deferred)), FileAccessError);
+    CHECK_FALSE(hasLeftoverTemporaries(newPath));
+    std::filesystem::remove(originalPath);
+  }
+
+  SECTION("A failed copy in place leaves no temporary file") {
+    auto tempPath = getTempSample(SampleImage::Sample2);
+    MetadataSession session(tempPath);
+    ImageMetadata metadata = session.read();
+    metadata.Title = "Never written";
+    session.stage(metadata);
+    std::filesystem::remove(tempPath);
+    std::filesystem::create_directory(tempPath);
+
+    CHECK_THROWS_AS(session.commit(atomicOptions(DurabilityLevel::Deferred)), FileAccessError);
+    CHECK_FALSE(hasLeftoverTemporaries(tempPath));
+    std::filesystem::remove(tempPath);
+  }
+}
+
+// Run explicitly with: tests "[benchmark]"
+TEST_CASE_METHOD(ImageTestFixture, "Write durability modes", "[.][benchmark]") {
+  auto tempPath = getTempSample(SampleImage::Sample3);
+  ImageMetadata metadata(tempPath);
+  int counter = 0;
+
+  auto writeWith = [&](WriteOptions options) {
+    // A description change always needs a full rewrite
+    metadata.Description = "Benchmark " + std::to_string(++counter);
+    metadata.toFile(std::nullopt, options);
+  };
+
+  WriteOptions inPlace;
+  BENCHMARK("In place, deferred") {
+    writeWith(inPlace);
+  };
+  inPlace.Durability = DurabilityLevel::FileData;
+  BENCHMARK("In place, file data") {
+    writeWith(inPlace);
+  };
+  BENCHMARK("Atomic, deferred") {
+    writeWith(atomicOptions(DurabilityLevel::Deferred));
+  };
+  BENCHMARK("Atomic, file data") {
+    writeWith(atomicOptions(DurabilityLevel::FileData));
+  };
+  BENCHMARK("Atomic, file and directory") {
+    writeWith(atomicOptions(DurabilityLevel::FileAndDirectory));
+  };
+}
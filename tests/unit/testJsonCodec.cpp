@@ -0,0 +1,119 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "Errors.hpp"
+#include "ImageMetadata.hpp"
+#include "JsonCodec.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string readFixture(const std::string& name) {
+  std::ifstream in(fs::path(__FILE__).parent_path().parent_path() / "fixtures" / name);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+} // namespace
+
+TEST_CASE_METHOD(ImageTestFixture, "Fixtures decode to the metadata of their sample", "[json]") {
+  const std::vector<std::pair<SampleImage, std::string>> fixtures = {{SampleImage::Sample1, "sample1.jpg.json"},
+                                                                     {SampleImage::Sample2, "sample2.jpg.json"},
+                                                                     {SampleImage::Sample3, "sample3.jpg.json"},
+                                                                     {SampleImage::Sample4, "sample4.jpg.json"}};
+  for (const auto& [sample, fixture] : fixtures) {
+    INFO(fixture);
+    const ImageMetadata decoded = ImageMetadata::fromJson(readFixture(fixture));
+    const ImageMetadata read(getOriginalSample(sample));
+    CHECK(decoded == read);
+    CHECK(ImageMetadata::fromJson(read.toJson()) == read);
+  }
+}
+
+TEST_CASE("JSON uses the structure of the fixtures", "[json]") {
+  const XmpAreaStruct area(0.5, 0.25, 0.5, 0.5, "normalized");
+  const RegionInfoStruct regions(DimensionsStruct(10, 20, "pixel"),
+                                 {RegionInfoStruct::RegionStruct(area, "Name", "Face", std::nullopt)});
+  const KeywordInfoModel keywords({KeywordInfoModel::KeywordStruct("A", {}, true)});
+  const ImageMetadata metadata(10, 20, "Title", std::nullopt, regions, ExifOrientation::Rotate180, keywords);
+
+  CHECK(metadata.toJson() ==
+        R"({"SourceFile":null,"ImageHeight":10,"ImageWidth":20,"Title":"Title","Description":null,)"
+        R"("RegionInfo":{"AppliedToDimensions":{"H":10.0,"W":20.0,"Unit":"pixel"},"RegionList":[{"Area":{"H":0.5,)"
+        R"("Unit":"normalized","W":0.25,"X":0.5,"Y":0.5,"D":null},"Name":"Name","Type":"Face","Description":null}]},)"
+        R"("Orientation":3,"KeywordInfo":{"Hierarchy":[{"Keyword":"A","Applied":true,"Children":[]}]},)"
+        R"("Country":null,"City":null,"State":null,"Location":null})");
+
+  SECTION("Nested structs on their own") {
+    const auto& region = metadata.RegionInfo->RegionList[0];
+    CHECK(XmpAreaStruct::fromJson(region.Area.toJson()) == region.Area);
+    CHECK(RegionInfoStruct::RegionStruct::fromJson(region.toJson()) == region);
+    CHECK(RegionInfoStruct::fromJson(metadata.RegionInfo->toJson()) == metadata.RegionInfo.value());
+    CHECK(DimensionsStruct::fromJson(R"({"H":1,"W":2,"Unit":"pixel"})") == DimensionsStruct(1, 2, "pixel"));
+    CHECK(KeywordInfoModel::fromJson(metadata.KeywordInfo->toJson()) == metadata.KeywordInfo.value());
+    CHECK(KeywordInfoModel::KeywordStruct::fromJson(R"({"Keyword":"A","Applied":null})") ==
+          KeywordInfoModel::KeywordStruct("A"));
+  }
+
+  SECTION("Lists encode as one array") {
+    const std::string array = ImageMetadata::toJsonArray({metadata, ImageMetadata(1, 2)});
+    CHECK(array == "[" + metadata.toJson() + "," + ImageMetadata(1, 2).toJson() + "]");
+    const auto decoded = ImageMetadata::fromJsonArray(array);
+    REQUIRE(decoded.size() == 2);
+    CHECK(decoded[0] == metadata);
+    CHECK(decoded[1] == ImageMetadata(1, 2));
+  }
+}
+
+TEST_CASE("JSON strings are escaped and unescaped", "[json]") {
+  ImageMetadata metadata(1, 2);
+  metadata.Title = "Quote \" backslash \\ newline \n tab \t bell \x07 é";
+  CHECK(metadata.toJson().find(R"("Quote \" backslash \\ newline \n tab \t bell \u0007 é")") != std::string::npos);
+  CHECK(ImageMetadata::fromJson(metadata.toJson()) == metadata);
+
+  const auto decoded = ImageMetadata::fromJson(R"({"ImageHeight":1,"ImageWidth":2,"Title":"é😀\/"})");
+  CHECK(decoded.Title == "\xc3\xa9\xf0\x9f\x98\x80/");
+}
+
+TEST_CASE("Malformed JSON is rejected", "[json]") {
+  SECTION("Missing required fields") {
+    CHECK_THROWS_AS(ImageMetadata::fromJson(R"({"ImageWidth":2})"), MissingFieldError);
+    CHECK_THROWS_AS(XmpAreaStruct::fromJson(R"({"H":1,"W":1,"X":1})"), MissingFieldError);
+    CHECK_THROWS_AS(KeywordInfoModel::KeywordStruct::fromJson(R"({"Children":[]})"), MissingFieldError);
+  }
+
+  SECTION("Invalid syntax or values") {
+    const std::vector<std::string> invalid = {
+        "",
+        "{",
+        R"({"ImageHeight":1,"ImageWidth":2,})",
+        R"({"ImageHeight":1,"ImageWidth":2} x)",
+        R"({"ImageHeight":-1,"ImageWidth":2})",
+        R"({"ImageHeight":1.5,"ImageWidth":2})",
+        R"({"ImageHeight":1,"ImageWidth":2,"Orientation":9})",
+        R"({"ImageHeight":1,"ImageWidth":2,"Title":"\ud83d"})",
+        R"({"ImageHeight":1,"ImageWidth":2,"Title":3})",
+        "{\"ImageHeight\":1,\"ImageWidth\":2,\"Title\":\"a\nb\"}",
+        R"({"ImageHeight":1,"ImageWidth":2,"Other":)" + std::string(JsonCodec::MAX_DEPTH, '['),
+    };
+    for (const auto& json : invalid) {
+      CHECK_THROWS_AS(ImageMetadata::fromJson(json), InvalidStructureError);
+    }
+  }
+
+  SECTION("Non-finite numbers cannot be encoded") {
+    CHECK_THROWS_AS(DimensionsStruct(std::numeric_limits<double>::infinity(), 1, "pixel").toJson(),
+                    InvalidStructureError);
+  }
+}
@@ -139,6 +139,26 @@ TEST_CASE("KeywordInfoModel fromXmp and toXmp round trip", "[KeywordInfoModel][X
     REQUIRE(model == roundTrip);
   }
 
+  SECTION("Malformed nodes are skipped when collecting") {
+    XmpData xmp;
+    xmp["Xmp.mwg-kw.Keywords/mwg-kw:Hierarchy[1]/mwg-kw:Applied"] = "True";
+    xmp["Xmp.mwg-kw.Keywords/mwg-kw:Hierarchy[2]/mwg-kw:Keyword"] = "Places";
+    xmp["Xmp.mwg-kw.Keywords/mwg-kw:Hierarchy[2]/mwg-kw:Children[1]/mwg-kw:Applied"] = "False";
+    xmp["Xmp.mwg-kw.Keywords/mwg-kw:Hierarchy[2]/mwg-kw:Children[2]/mwg-kw:Keyword"] = "Home";
+
+    std::vector<ErrorInfo> skipped;
+    KeywordInfoModel model = KeywordInfoModel::fromXmp(xmp, &skipped);
+    REQUIRE(model.Hierarchy.size() == 1);
+    REQUIRE(model.Hierarchy[0].Keyword == "Places");
+    REQUIRE(model.Hierarchy[0].Children.size() == 1);
+    REQUIRE(model.Hierarchy[0].Children[0].Keyword == "Home");
+    REQUIRE(skipped.size() == 2);
+    REQUIRE(skipped[0].Code == ::ErrorCode::MissingField);
+
+    // Without collecting, the scan stops at the first malformed node
+    REQUIRE(KeywordInfoModel::fromXmp(xmp).Hierarchy.empty());
+  }
+
   SECTION("Empty hierarchy results in no output") {
     XmpData xmp;
     KeywordInfoModel model(std::vector<KeywordInfoModel::KeywordStruct>{});
@@ -0,0 +1,76 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "MemoryBudget.hpp"
+
+TEST_CASE("MemoryBudget admission", "[memory]") {
+  SECTION("Unlimited admits everything") {
+    MemoryBudget budget;
+    CHECK_FALSE(budget.limited());
+    CHECK(budget.tryAcquire(1ULL << 40));
+    CHECK(budget.inUse() == 0);
+  }
+
+  SECTION("Requests within the limit are admitted") {
+    MemoryBudget budget(100);
+    CHECK(budget.tryAcquire(60));
+    CHECK(budget.tryAcquire(40));
+    CHECK_FALSE(budget.tryAcquire(1));
+    CHECK(budget.inUse() == 100);
+    budget.release(40);
+    CHECK(budget.tryAcquire(30));
+    CHECK(budget.inUse() == 90);
+  }
+
+  SECTION("A request larger than the limit runs alone") {
+    MemoryBudget budget(100);
+    CHECK(budget.tryAcquire(10));
+    CHECK_FALSE(budget.tryAcquire(500));
+    budget.release(10);
+    CHECK(budget.tryAcquire(500));
+    CHECK_FALSE(budget.tryAcquire(1));
+    budget.release(500);
+    CHECK(budget.inUse() == 0);
+  }
+
+  SECTION("Copies share the budget") {
+    MemoryBudget budget(100);
+    MemoryBudget copy = budget;
+    CHECK(copy.tryAcquire(80));
+    CHECK(budget.inUse() == 80);
+    CHECK_FALSE(budget.tryAcquire(30));
+  }
+}
+
+TEST_CASE("MemoryBudget deferred requests", "[memory]") {
+  MemoryBudget budget(100);
+  std::vector<int> admitted;
+
+  CHECK(budget.acquireOrDefer(90, [&]() { admitted.push_back(0); }));
+  CHECK_FALSE(budget.acquireOrDefer(50, [&]() { admitted.push_back(1); }));
+  CHECK_FALSE(budget.acquireOrDefer(5, [&]() { admitted.push_back(2); }));
+  // Would fit, but waits behind the earlier requests
+  CHECK_FALSE(budget.tryAcquire(5));
+  CHECK(admitted.empty());
+
+  budget.release(90);
+  CHECK(admitted == std::vector<int>{1, 2});
+  CHECK(budget.inUse() == 55);
+}
+
+TEST_CASE("MemoryBudget blocking acquire", "[memory]") {
+  MemoryBudget budget(100);
+  REQUIRE(budget.tryAcquire(100));
+
+  std::thread releaser([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    budget.release(100);
+  });
+  budget.acquire(70);
+  releaser.join();
+
+  CHECK(budget.inUse() == 70);
+}
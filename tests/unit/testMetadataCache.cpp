@@ -0,0 +1,170 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "FileUtils.hpp"
+#include "ImageMetadata.hpp"
+#include "MetadataCache.hpp"
+#include "WriteOptions.hpp"
+
+namespace {
+
+MetadataCache::Stamp stampOf(std::uint64_t size, std::int64_t modifiedNs = 1) {
+  MetadataCache::Stamp stamp;
+  stamp.Image.Inode = 1;
+  stamp.Image.Size = size;
+  stamp.Image.ModifiedNs = modifiedNs;
+  return stamp;
+}
+
+ImageMetadata titled(const std::string& title) {
+  ImageMetadata metadata(10, 20);
+  metadata.Title = title;
+  return metadata;
+}
+
+// Enables the shared cache for one test and leaves it disabled and empty afterwards
+struct SharedCacheScope {
+  explicit SharedCacheScope(std::size_t capacity) {
+    MetadataCache::clearShared();
+    MetadataCache::configureShared(capacity);
+  }
+  ~SharedCacheScope() {
+    MetadataCache::configureShared(0);
+    MetadataCache::clearShared();
+  }
+};
+
+} // namespace
+
+TEST_CASE("MetadataCache entries", "[cache]") {
+  SECTION("A capacity of 0 stores nothing") {
+    MetadataCache cache;
+    CHECK_FALSE(cache.enabled());
+    cache.store("a.jpg", stampOf(1), cache.generation(), titled("a"));
+    CHECK_FALSE(cache.lookup("a.jpg", stampOf(1)).has_value());
+    CHECK(cache.stats().Entries == 0);
+  }
+
+  SECTION("A matching stamp hits, a changed one misses and drops the entry") {
+    MetadataCache cache(4);
+    cache.store("a.jpg", stampOf(1), cache.generation(), titled("a"));
+
+    auto hit = cache.lookup("a.jpg", stampOf(1));
+    REQUIRE(hit.has_value());
+    CHECK(hit->Title == "a");
+
+    CHECK_FALSE(cache.lookup("a.jpg", stampOf(1, 2)).has_value());
+    CHECK_FALSE(cache.lookup("a.jpg", stampOf(1)).has_value());
+
+    auto stats = cache.stats();
+    CHECK(stats.Hits == 1);
+    CHECK(stats.Misses == 2);
+    CHECK(stats.Entries == 0);
+  }
+
+  SECTION("The read options are part of the stamp") {
+    MetadataCache cache(4);
+    cache.store("a.jpg", stampOf(1), cache.generation(), titled("a"));
+    auto lenient = stampOf(1);
+    lenient.Lenient = true;
+    CHECK_FALSE(cache.lookup("a.jpg", lenient).has_value());
+  }
+
+  SECTION("Equivalent spellings of a path share an entry") {
+    MetadataCache cache(4);
+    cache.store("dir/../a.jpg", stampOf(1), cache.generation(), titled("a"));
+    CHECK(cache.lookup("a.jpg", stampOf(1)).has_value());
+  }
+
+  SECTION("The least recently used entry is evicted") {
+    MetadataCache cache(2);
+    cache.store("a.jpg", stampOf(1), cache.generation(), titled("a"));
+    cache.store("b.jpg", stampOf(1), cache.generation(), titled("b"));
+    REQUIRE(cache.lookup("a.jpg", stampOf(1)).has_value());
+    cache.store("c.jpg", stampOf(1), cache.generation(), titled("c"));
+
+    CHECK(cache.lookup("a.jpg", stampOf(1)).has_value());
+    CHECK_FALSE(cache.lookup("b.jpg", stampOf(1)).has_value());
+    CHECK(cache.lookup("c.jpg", stampOf(1)).has_value());
+    CHECK(cache.stats().Evictions == 1);
+
+    cache.resize(1);
+    CHECK(cache.stats().Entries == 1);
+    CHECK(cache.lookup("c.jpg", stampOf(1)).has_value());
+  }
+
+  SECTION("A read which overlapped an invalidation is not stored") {
+    MetadataCache cache(4);
+    const auto generation = cache.generation();
+    cache.invalidate("a.jpg");
+    cache.store("a.jpg", stampOf(1), generation, titled("stale"));
+    CHECK_FALSE(cache.lookup("a.jpg", stampOf(1)).has_value());
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Reads go through the shared MetadataCache", "[cache][metadata]") {
+  SharedCacheScope scope(8);
+  auto imagePath = getTempSample(SampleImage::Sample1);
+
+  SECTION("An unchanged file is parsed once") {
+    ImageMetadata first(imagePath);
+    ImageMetadata second(imagePath);
+    CHECK(first == second);
+    auto stats = MetadataCache::sharedStats();
+    CHECK(stats.Misses == 1);
+    CHECK(stats.Hits == 1);
+    CHECK(stats.Entries == 1);
+  }
+
+  SECTION("Writing through the library invalidates the entry") {
+    ImageMetadata metadata(imagePath);
+    metadata.Title = "Cached no more";
+    metadata.toFile();
+    CHECK(MetadataCache::sharedStats().Entries == 0);
+    CHECK(ImageMetadata(imagePath).Title == "Cached no more");
+  }
+
+  SECTION("A file changed by someone else misses") {
+    ImageMetadata before(imagePath);
+    const auto identity = FileUtils::identify(imagePath);
+    REQUIRE(identity.has_value());
+    {
+      std::ofstream out(imagePath, std::ios::binary | std::ios::app);
+      out << '\0';
+    }
+    REQUIRE(FileUtils::identify(imagePath) != identity);
+    ImageMetadata after(imagePath);
+    CHECK(MetadataCache::sharedStats().Hits == 0);
+  }
+
+  SECTION("Changing the sidecar misses") {
+    ReadOptions options;
+    options.Sidecar = SidecarPolicy::Merge;
+    ImageMetadata metadata(imagePath, options);
+    metadata.Title = "From the sidecar";
+    WriteOptions sidecar;
+    sidecar.Sidecar = true;
+    metadata.toFile(std::nullopt, sidecar);
+    CHECK(ImageMetadata(imagePath, options).Title == "From the sidecar");
+  }
+
+  SECTION("A hit is returned with the path it was read through") {
+    const std::filesystem::path respelled = imagePath.parent_path() / "." / imagePath.filename();
+    ImageMetadata first(respelled);
+    ImageMetadata second(imagePath);
+    REQUIRE(MetadataCache::sharedStats().Hits == 1);
+
+    CHECK(first.to_string().find("OriginalPath='" + respelled.string() + "'") != std::string::npos);
+    CHECK(second.to_string().find("OriginalPath='" + imagePath.string() + "'") != std::string::npos);
+  }
+
+  SECTION("Missing files are not cached") {
+    CHECK_FALSE(ImageMetadata::tryRead(imagePath.parent_path() / "missing.jpg").ok());
+    CHECK(MetadataCache::sharedStats().Entries == 0);
+  }
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "Errors.hpp"
+#include "ImageMetadata.hpp"
+#include "KeywordInfoModel.hpp"
+#include "MemoryBudget.hpp"
+#include "MetadataPipeline.hpp"
+
+TEST_CASE_METHOD(ImageTestFixture, "MetadataPipeline runs every stage", "[pipeline][writing]") {
+  std::vector<std::filesystem::path> paths;
+  for (int i = 0; i < 12; ++i) {
+    paths.push_back(getTempSample(i % 2 == 0 ? SampleImage::Sample1 : SampleImage::Sample4));
+  }
+  MetadataPipeline pipeline(3);
+
+  SECTION("Changed files are written back") {
+    const KeywordInfoModel added(std::vector<std::string>{"pipeline/added"});
+    auto results = pipeline.run(paths, [&](ImageMetadata& metadata) {
+      metadata.KeywordInfo = metadata.KeywordInfo.value_or(KeywordInfoModel(std::vector<std::string>{})) | added;
+      return true;
+    });
+
+    REQUIRE(results.size() == paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      CHECK(results[i].ok());
+      CHECK(results[i].Path == paths[i]);
+      auto keywords = ImageMetadata(paths[i]).KeywordInfo.value();
+      CHECK((keywords | added) == keywords);
+    }
+  }
+
+  SECTION("A memory budget limits the files in flight") {
+    const MemoryBudget memory(2 * std::max(MemoryBudget::estimateFootprint(paths[0]),
+                                           MemoryBudget::estimateFootprint(paths[1])));
+    MetadataPipeline limited(8, {}, memory);
+    auto results = limited.run(paths, [&](ImageMetadata& metadata) {
+      CHECK(memory.inUse() <= memory.limit());
+      metadata.Title = "Within budget";
+      return true;
+    });
+
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      CHECK(results[i].ok());
+      CHECK(ImageMetadata(paths[i]).Title == "Within budget");
+    }
+    CHECK(memory.inUse() == 0);
+  }
+
+  SECTION("Declined files are not written") {
+    const auto before = std::filesystem::last_write_time(paths[0]);
+    auto results = pipeline.run(paths, [](ImageMetadata& metadata) {
+      metadata.Title = "Not written";
+      return false;
+    });
+
+    for (const auto& result : results) {
+      CHECK(result.ok());
+    }
+    CHECK(std::filesystem::last_write_time(paths[0]) == before);
+    CHECK(ImageMetadata(paths[0]).Title != "Not written");
+  }
+
+  SECTION("Failures are recorded per file") {
+    paths.insert(paths.begin() + 3, "nonexistent_image.jpg");
+    const std::string failingTitle = ImageMetadata(paths[0]).Title.value();
+    auto results = pipeline.run(paths, [&](ImageMetadata& metadata) {
+      if (metadata.Title == failingTitle) {
+        throw std::runtime_error("Transform failed");
+      }
+      metadata.Title = "Transformed";
+      return true;
+    });
+
+    REQUIRE(results.size() == paths.size());
+    REQUIRE_FALSE(results[3].ok());
+    CHECK(results[3].Error->Code == ErrorCode::FileAccess);
+    REQUIRE_FALSE(results[0].ok());
+    CHECK(results[0].Error->Code == ErrorCode::Unknown);
+    CHECK(results[0].Error->Message == "Transform failed");
+    CHECK(results[1].ok());
+    CHECK(ImageMetadata(paths[1]).Title == "Transformed");
+  }
+}
+
+TEST_CASE("MetadataPipeline configuration", "[pipeline]") {
+  MetadataPipeline defaults;
+  CHECK(defaults.window() == 64);
+
+  MetadataPipeline configured(0);
+  CHECK(configured.window() == 1);
+
+  CHECK(configured.run({}, [](ImageMetadata&) { return true; }).empty());
+}
@@ -0,0 +1,225 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <exiv2/exiv2.hpp>
+
+#include "TestUtils.hpp"
+
+#include "Errors.hpp"
+#include "ImageMetadata.hpp"
+#include "KeywordInfoModel.hpp"
+#include "MetadataSession.hpp"
+
+TEST_CASE_METHOD(ImageTestFixture, "MetadataSession reads the same metadata as ImageMetadata", "[session][reading]") {
+  auto imagePath = getOriginalSample(SampleImage::Sample1);
+
+  MetadataSession session(imagePath);
+  ImageMetadata fromSession = session.read();
+  ImageMetadata direct(imagePath);
+
+  CHECK(session.path() == imagePath);
+  CHECK_FALSE(session.isDirty());
+  CHECK(fromSession == direct);
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "MetadataSession read-modify-write", "[session][writing]") {
+  auto tempPath = getTempSample(SampleImage::Sample2);
+
+  SECTION("Staged changes are visible before commit and persisted after") {
+    MetadataSession session(tempPath);
+    ImageMetadata metadata = session.read();
+    metadata.Title = "Session Title";
+    metadata.City = "Session City";
+
+    session.stage(metadata);
+    CHECK(session.isDirty());
+    CHECK(session.read().Title == "Session Title");
+
+    // Nothing written yet
+    CHECK_FALSE(ImageMetadata(tempPath).Title.has_value());
+
+    session.commit();
+    CHECK_FALSE(session.isDirty());
+
+    ImageMetadata readBack(tempPath);
+    CHECK(readBack.Title == "Session Title");
+    CHECK(readBack.City == "Session City");
+  }
+
+  SECTION("Commit without staged changes leaves the file untouched") {
+    auto before = std::filesystem::last_write_time(tempPath);
+    MetadataSession session(tempPath);
+    REQUIRE_NOTHROW(session.commit());
+    CHECK(std::filesystem::last_write_time(tempPath) == before);
+  }
+
+  SECTION("Multiple commits from one session") {
+    MetadataSession session(tempPath);
+    ImageMetadata metadata = session.read();
+    metadata.Title = "First";
+    session.stage(metadata);
+    session.commit();
+
+    metadata.Title = "Second";
+    session.stage(metadata);
+    session.commit();
+
+    CHECK(ImageMetadata(tempPath).Title == "Second");
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "MetadataSession orientation fast path", "[session][writing][orientation]") {
+  SECTION("Orientation-only change keeps the file size") {
+    auto tempPath = getTempSample(SampleImage::Sample2);
+    auto sizeBefore = std::filesystem::file_size(tempPath);
+
+    ImageMetadata metadata(tempPath);
+    metadata.Orientation = ExifOrientation::Rotate270CW;
+    metadata.toFile();
+
+    CHECK(std::filesystem::file_size(tempPath) == sizeBefore);
+    ImageMetadata readBack(tempPath);
+    CHECK(readBack.Orientation == ExifOrientation::Rotate270CW);
+    readBack.Orientation = metadata.Orientation;
+    CHECK(readBack == metadata);
+  }
+
+  SECTION("Repeated orientation commits from one session") {
+    auto tempPath = getTempSample(SampleImage::Sample3);
+    MetadataSession session(tempPath);
+    ImageMetadata metadata = session.read();
+
+    metadata.Orientation = ExifOrientation::Rotate180;
+    session.stage(metadata);
+    session.commit();
+    metadata.Orientation = ExifOrientation::Rotate90CW;
+    session.stage(metadata);
+    session.commit();
+
+    CHECK(ImageMetadata(tempPath).Orientation == ExifOrientation::Rotate90CW);
+  }
+
+  SECTION("Orientation combined with other changes") {
+    auto tempPath = getTempSample(SampleImage::Sample2);
+    ImageMetadata metadata(tempPath);
+    metadata.Orientation = ExifOrientation::Rotate180;
+    metadata.Title = "Rotated";
+    metadata.toFile();
+
+    ImageMetadata readBack(tempPath);
+    CHECK(readBack.Orientation == ExifOrientation::Rotate180);
+    CHECK(readBack.Title == "Rotated");
+  }
+
+  SECTION("Absent orientation tag falls back to a full rewrite") {
+    auto tempPath = getTempSample(SampleImage::Sample1);
+    ImageMetadata metadata(tempPath);
+    REQUIRE_FALSE(metadata.Orientation.has_value());
+    metadata.Orientation = ExifOrientation::Rotate90CW;
+    metadata.toFile();
+
+    CHECK(ImageMetadata(tempPath).Orientation == ExifOrientation::Rotate90CW);
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "MetadataSession in place XMP updates", "[session][writing][xmp]") {
+  SECTION("Title-only change within the existing padding keeps the file size") {
+    auto tempPath = getTempSample(SampleImage::Sample1);
+    auto sizeBefore = std::filesystem::file_size(tempPath);
+
+    ImageMetadata metadata(tempPath);
+    metadata.Title = "A new title";
+    metadata.toFile();
+
+    CHECK(std::filesystem::file_size(tempPath) == sizeBefore);
+    CHECK(ImageMetadata(tempPath) == metadata);
+  }
+
+  SECTION("A packet which does not fit falls back to a padded rewrite") {
+    auto tempPath = getTempSample(SampleImage::Sample4);
+    auto sizeBefore = std::filesystem::file_size(tempPath);
+
+    ImageMetadata metadata(tempPath);
+    metadata.Title = std::string(10000, 'x');
+    metadata.toFile();
+
+    auto sizeAfterRewrite = std::filesystem::file_size(tempPath);
+    CHECK(sizeAfterRewrite > sizeBefore + 10000);
+    CHECK(ImageMetadata(tempPath) == metadata);
+
+    // The reserved padding absorbs the next keyword change
+    metadata.KeywordInfo = KeywordInfoModel(std::vector<std::string>{"padded/keyword"});
+    metadata.toFile();
+
+    CHECK(std::filesystem::file_size(tempPath) == sizeAfterRewrite);
+    CHECK(ImageMetadata(tempPath) == metadata);
+  }
+
+  SECTION("In place XMP can be disabled") {
+    auto tempPath = getTempSample(SampleImage::Sample1);
+    MetadataSession session(tempPath);
+    ImageMetadata metadata = session.read();
+    metadata.Title = "Rewritten";
+    session.stage(metadata);
+
+    WriteOptions options;
+    options.InPlaceXmp = false;
+    options.XmpPadding = 0;
+    session.commit(options);
+
+    CHECK(ImageMetadata(tempPath) == metadata);
+  }
+
+  SECTION("Changes mirrored into IPTC are never patched") {
+    auto tempPath = getTempSample(SampleImage::Sample1);
+    ImageMetadata metadata(tempPath);
+    metadata.City = "Somewhere";
+    metadata.toFile();
+
+    CHECK(ImageMetadata(tempPath).City == "Somewhere");
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "MetadataSession writes over malformed metadata", "[session][writing][error]") {
+  auto tempPath = getTempSample(SampleImage::Sample1);
+  {
+    auto image = Exiv2::ImageFactory::open(tempPath.string());
+    image->readMetadata();
+    auto& xmp = image->xmpData();
+    xmp.erase(xmp.findKey(Exiv2::XmpKey("Xmp.mwg-rs.Regions/mwg-rs:RegionList[1]/mwg-rs:Type")));
+    image->writeMetadata();
+  }
+
+  MetadataSession session(tempPath);
+  ImageMetadata metadata = session.read(true);
+  REQUIRE(metadata.Diagnostics.size() == 1);
+  metadata.Title = "Written back";
+  REQUIRE_NOTHROW(session.stage(metadata));
+  session.commit();
+
+  // The malformed region was dropped by the lenient read, so the file is valid again
+  ImageMetadata readBack(tempPath);
+  CHECK(readBack.Title == "Written back");
+  REQUIRE(readBack.RegionInfo.has_value());
+  REQUIRE(readBack.RegionInfo->RegionList.size() == 1);
+  CHECK(readBack.RegionInfo->RegionList[0].Name == "Bo");
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "MetadataSession error handling", "[session][error]") {
+  SECTION("Missing file") {
+    CHECK_THROWS_AS(MetadataSession("nonexistent_image.jpg"), FileAccessError);
+  }
+
+  SECTION("Corrupted file") {
+    auto tempPath = std::filesystem::temp_directory_path() / "corrupted_session_test.jpg";
+    {
+      std::ofstream file(tempPath, std::ios::binary);
+      file << "This is not a valid image file";
+    }
+    CHECK_THROWS_AS(MetadataSession(tempPath), Exiv2Error);
+    std::filesystem::remove(tempPath);
+  }
+}
@@ -1,6 +1,10 @@
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
+#include "ImageMetadata.hpp"
 #include "Orientation.hpp"
+#include "RegionTransform.hpp"
 
 TEST_CASE("ExifOrientation conversion functions", "[orientation]") {
 
@@ -82,3 +86,65 @@ TEST_CASE("ExifOrientation conversion functions", "[orientation]") {
     REQUIRE(std::string(orientation_to_string(static_cast<ExifOrientation>(99))) == "Unknown");
   }
 }
+
+TEST_CASE("ExifOrientation composition", "[orientation]") {
+  SECTION("The table agrees with transforming a point by each orientation in turn") {
+    for (int first = 1; first <= 8; ++first) {
+      for (int second = 1; second <= 8; ++second) {
+        INFO(first << " then " << second);
+        const ExifOrientation composed =
+            orientation_compose(orientation_from_int(first), orientation_from_int(second));
+        // Two corners and a point off the diagonal tell the 8 orientations apart
+        std::vector<double> h = {0.0, 0.0, 0.0};
+        std::vector<double> w = {0.0, 0.0, 0.0};
+        std::vector<double> x = {0.0, 1.0, 0.25};
+        std::vector<double> y = {0.0, 0.0, 0.75};
+        std::vector<double> expectedX = x;
+        std::vector<double> expectedY = y;
+        RegionTransform::toDisplay(orientation_from_int(first), {h, w, x, y});
+        RegionTransform::toDisplay(orientation_from_int(second), {h, w, x, y});
+        RegionTransform::toDisplay(composed, {h, w, expectedX, expectedY});
+        CHECK(x == expectedX);
+        CHECK(y == expectedY);
+      }
+    }
+  }
+
+  SECTION("Undefined acts as Horizontal") {
+    REQUIRE(orientation_compose(ExifOrientation::Undefined, ExifOrientation::Rotate90CW) ==
+            ExifOrientation::Rotate90CW);
+    REQUIRE(orientation_compose(ExifOrientation::Rotate180, ExifOrientation::Undefined) ==
+            ExifOrientation::Rotate180);
+    REQUIRE(orientation_compose(static_cast<ExifOrientation>(99), ExifOrientation::Rotate180) ==
+            ExifOrientation::Rotate180);
+  }
+}
+
+TEST_CASE("ImageMetadata rotate", "[orientation]") {
+  ImageMetadata metadata(300, 400);
+  metadata.RegionInfo = RegionInfoStruct(
+      DimensionsStruct(300, 400, "pixel"),
+      {RegionInfoStruct::RegionStruct({0.2, 0.1, 0.3, 0.4, "normalized"}, "A", "Face", std::nullopt)});
+  const RegionInfoStruct original = metadata.RegionInfo.value();
+
+  SECTION("Regions on the stored image are kept") {
+    metadata.rotate(ExifOrientation::Rotate90CW);
+    CHECK(metadata.Orientation == ExifOrientation::Rotate90CW);
+    metadata.rotate(ExifOrientation::Rotate90CW);
+    CHECK(metadata.Orientation == ExifOrientation::Rotate180);
+    CHECK(metadata.RegionInfo == original);
+    CHECK(metadata.ImageWidth == 400);
+  }
+
+  SECTION("Regions on the displayed image turn with it") {
+    metadata.Orientation = ExifOrientation::Rotate180;
+    metadata.rotate(ExifOrientation::Rotate270CW, RegionSpace::Displayed);
+    CHECK(metadata.Orientation == ExifOrientation::Rotate90CW);
+    CHECK(metadata.RegionInfo == original.toDisplay(ExifOrientation::Rotate270CW));
+    CHECK(metadata.RegionInfo->AppliedToDimensions.W == 300);
+
+    metadata.rotate(ExifOrientation::Rotate90CW, RegionSpace::Displayed);
+    CHECK(metadata.Orientation == ExifOrientation::Rotate180);
+    CHECK(metadata.RegionInfo == original);
+  }
+}
@@ -0,0 +1,121 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "Batch.hpp"
+#include "ImageMetadata.hpp"
+#include "PersonIndex.hpp"
+
+namespace {
+
+RegionInfoStruct::RegionStruct region(const std::string& name, const std::string& type) {
+  return RegionInfoStruct::RegionStruct(XmpAreaStruct(0.1, 0.1, 0.5, 0.5, "normalized"), name, type, std::nullopt);
+}
+
+RegionInfoStruct regions(const std::vector<RegionInfoStruct::RegionStruct>& list) {
+  return RegionInfoStruct(DimensionsStruct(10, 10, "pixel"), list);
+}
+
+} // namespace
+
+TEST_CASE("PersonIndex lookups", "[regions]") {
+  PersonIndex index;
+  index.add("b.jpg", regions({region("Jane", "Face"), region("Rex", "Pet"), region("Jane", "Face")}));
+  index.add("a.jpg", regions({region("Rex", "Face"), region("", "Face"), region("Jane", "Face")}));
+
+  CHECK(index.size() == 2);
+  CHECK(index.imageCount() == 2);
+  CHECK(index.names() == std::vector<std::string>{"Jane", "Rex"});
+  CHECK(index.names("Pet") == std::vector<std::string>{"Rex"});
+
+  auto jane = index.find("Jane");
+  REQUIRE(jane.size() == 2);
+  CHECK(jane[0].Image == std::filesystem::path("a.jpg"));
+  CHECK(jane[0].Positions == std::vector<std::size_t>{2});
+  CHECK(jane[1].Positions == std::vector<std::size_t>{0, 2});
+
+  auto pets = index.find("Rex", "Pet");
+  REQUIRE(pets.size() == 1);
+  CHECK(pets[0].Image == std::filesystem::path("b.jpg"));
+  CHECK(index.find("Nobody").empty());
+
+  SECTION("Adding an image again replaces it") {
+    index.add("b.jpg", regions({region("John", "Face")}));
+    CHECK(index.names() == std::vector<std::string>{"Jane", "John", "Rex"});
+    CHECK(index.find("Jane").size() == 1);
+    CHECK(index.find("Rex", "Pet").empty());
+  }
+
+  SECTION("Removing an image drops names only it had") {
+    index.remove("a.jpg");
+    index.remove("missing.jpg");
+    CHECK(index.imageCount() == 1);
+    CHECK(index.find("Rex", "Face").empty());
+    index.remove("b.jpg");
+    CHECK(index.size() == 0);
+  }
+
+  SECTION("Every spelling of a path is the same image") {
+    index.add("./b.jpg", regions({region("John", "Face")}));
+    CHECK(index.imageCount() == 2);
+    auto john = index.find("John");
+    REQUIRE(john.size() == 1);
+    CHECK(john[0].Image == std::filesystem::path("./b.jpg"));
+    index.remove("missing/../a.jpg");
+    CHECK(index.names() == std::vector<std::string>{"John"});
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "PersonIndex from batch reads and renames", "[regions][batch]") {
+  std::vector<std::filesystem::path> paths = {getTempSample(SampleImage::Sample1), getTempSample(SampleImage::Sample2),
+                                              "nonexistent_image.jpg"};
+  PersonIndex index;
+  index.add(Batch::readMany(paths, 2));
+  REQUIRE(index.imageCount() == 2);
+  REQUIRE(index.find("Barack Obama").size() == 2);
+  REQUIRE(index.find("Bo", "Pet").size() == 1);
+
+  SECTION("Renaming rewrites every file and the index") {
+    auto results = Batch::renamePerson(index, "Barack Obama", "President Obama");
+    REQUIRE(results.size() == 2);
+    CHECK(results[0].ok());
+    CHECK(results[1].ok());
+    CHECK(index.find("Barack Obama").empty());
+    CHECK(index.find("President Obama").size() == 2);
+
+    ImageMetadata first(paths[0]);
+    CHECK(first.RegionInfo->RegionList[0].Name == "President Obama");
+    CHECK(first.RegionInfo->RegionList[1].Name == "Bo");
+  }
+
+  SECTION("Renaming onto an existing name merges") {
+    Batch::renamePerson(index, "Bo", "Barack Obama", "Pet");
+    CHECK(index.names() == std::vector<std::string>{"Barack Obama"});
+    auto merged = index.find("Barack Obama");
+    REQUIRE(merged.size() == 2);
+    CHECK(merged[0].Positions.size() + merged[1].Positions.size() == 3);
+    CHECK(index.find("Barack Obama", "Pet").size() == 1);
+  }
+
+  SECTION("Renaming in the files leaves the index to the caller") {
+    auto written = Batch::renameInFiles(index.find("Bo"), "Bo", "Rex");
+    REQUIRE(written.size() == 1);
+    REQUIRE(written[0].ok());
+    CHECK(written[0].Metadata->RegionInfo->RegionList[1].Name == "Rex");
+    CHECK(index.find("Bo").size() == 1);
+
+    index.add(written);
+    CHECK(index.find("Bo").empty());
+    CHECK(index.find("Rex").size() == 1);
+  }
+
+  SECTION("A type filter leaves other regions alone") {
+    Batch::renamePerson(index, "Bo", "Rex", "Face");
+    CHECK(index.find("Bo").size() == 1);
+    CHECK(ImageMetadata(paths[0]).RegionInfo->RegionList[1].Name == "Bo");
+  }
+}
@@ -1,5 +1,8 @@
+#include <filesystem>
 #include <fstream>
 
+#include <exiv2/exiv2.hpp>
+
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
@@ -7,6 +10,7 @@
 
 #include "Errors.hpp"
 #include "ImageMetadata.hpp"
+#include "ReadOptions.hpp"
 
 TEST_CASE_METHOD(ImageTestFixture, "read_metadata extracts complete metadata from sample1.jpg", "[metadata][reading]") {
   REQUIRE(hasSample(SampleImage::Sample1)); // Ensure test file exists
@@ -278,6 +282,80 @@ TEST_CASE_METHOD(ImageTestFixture, "read_metadata handles corrupted file", "[met
   std::filesystem::remove(tempPath);
 }
 
+TEST_CASE_METHOD(ImageTestFixture, "tryRead returns errors as values", "[metadata][reading][error]") {
+  SECTION("A readable file") {
+    auto imagePath = getOriginalSample(SampleImage::Sample1);
+    auto result = ImageMetadata::tryRead(imagePath);
+    REQUIRE(result.ok());
+    CHECK(result.value() == ImageMetadata(imagePath));
+  }
+
+  SECTION("A missing file") {
+    auto result = ImageMetadata::tryRead("nonexistent_image.jpg");
+    REQUIRE_FALSE(result.ok());
+    CHECK(result.error().Code == ErrorCode::FileAccess);
+    CHECK(result.error().Path == std::filesystem::path("nonexistent_image.jpg"));
+    CHECK_THROWS_AS(result.value(), FileAccessError);
+  }
+
+  SECTION("A malformed region structure") {
+    auto imagePath = getTempSample(SampleImage::Sample1);
+    {
+      auto image = Exiv2::ImageFactory::open(imagePath.string());
+      image->readMetadata();
+      auto& xmp = image->xmpData();
+      xmp["Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions/stDim:w"] = "100";
+      xmp["Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions/stDim:unit"] = "pixel";
+      image->writeMetadata();
+    }
+
+    auto result = ImageMetadata::tryRead(imagePath);
+    REQUIRE_FALSE(result.ok());
+    CHECK(result.error().Code == ErrorCode::MissingField);
+    CHECK(result.error().Message == "No height found in dimensions struct");
+    CHECK(result.error().Path == imagePath);
+    CHECK_THROWS_AS(ImageMetadata(imagePath), MissingFieldError);
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "lenient reads keep the valid entries", "[metadata][reading][error]") {
+  auto imagePath = getTempSample(SampleImage::Sample1);
+  {
+    auto image = Exiv2::ImageFactory::open(imagePath.string());
+    image->readMetadata();
+    auto& xmp = image->xmpData();
+    xmp.erase(xmp.findKey(Exiv2::XmpKey("Xmp.mwg-rs.Regions/mwg-rs:RegionList[1]/mwg-rs:Type")));
+    image->writeMetadata();
+  }
+
+  ReadOptions options;
+  options.Lenient = true;
+
+  SECTION("The malformed region is skipped and recorded") {
+    auto result = ImageMetadata::tryRead(imagePath, options);
+    REQUIRE(result.ok());
+    const auto& metadata = result.value();
+    REQUIRE(metadata.RegionInfo.has_value());
+    REQUIRE(metadata.RegionInfo->RegionList.size() == 1);
+    CHECK(metadata.RegionInfo->RegionList[0].Name == "Bo");
+    REQUIRE(metadata.Diagnostics.size() == 1);
+    CHECK(metadata.Diagnostics[0].Code == ErrorCode::MissingField);
+    CHECK(metadata.Diagnostics[0].Message == "Skipped region 1: No type found in region info struct");
+    CHECK(metadata.Diagnostics[0].Path == imagePath);
+  }
+
+  SECTION("A strict read still fails") {
+    CHECK_THROWS_AS(ImageMetadata(imagePath), MissingFieldError);
+  }
+
+  SECTION("Diagnostics do not take part in equality") {
+    ImageMetadata lenient(imagePath, options);
+    ImageMetadata copy = lenient;
+    copy.Diagnostics.clear();
+    CHECK(lenient == copy);
+  }
+}
+
 TEST_CASE_METHOD(ImageTestFixture, "read_metadata handles multiple file formats", "[metadata][reading]") {
   SECTION("works with different image files") {
     std::vector<SampleImage> samplesToTest = {SampleImage::Sample1, SampleImage::Sample2,   SampleImage::Sample3,
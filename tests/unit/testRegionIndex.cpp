@@ -0,0 +1,97 @@
+#include <filesystem>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "Errors.hpp"
+#include "RegionIndex.hpp"
+
+namespace {
+
+RegionInfoStruct::RegionStruct face(double h, double w, double x, double y, const std::string& name) {
+  return RegionInfoStruct::RegionStruct(XmpAreaStruct(h, w, x, y, "normalized"), name, "Face", std::nullopt);
+}
+
+RegionIndex sampleIndex() {
+  RegionIndex index(8);
+  index.add("first.jpg", RegionInfoStruct(DimensionsStruct(100, 200, "pixel"),
+                                          {face(0.2, 0.2, 0.5, 0.5, "Jane"), face(0.2, 0.2, 0.51, 0.5, "Jane"),
+                                           face(0.2, 0.2, 0.5, 0.5, "John"),
+                                           RegionInfoStruct::RegionStruct(XmpAreaStruct(80, 160, 100, 50, "pixel"),
+                                                                          "Rex", "Pet", std::nullopt)}));
+  // Pixel areas of an image without dimensions cannot be normalized
+  index.add("second.jpg", RegionInfoStruct(DimensionsStruct(0, 0, "pixel"),
+                                           {face(0.1, 0.1, 0.9, 0.9, "Jane"),
+                                            RegionInfoStruct::RegionStruct(XmpAreaStruct(10, 10, 1, 1, "pixel"),
+                                                                           "Skipped", "Face", std::nullopt)}));
+  return index;
+}
+
+} // namespace
+
+TEST_CASE("RegionIndex: regions overlapping a box", "[regions]") {
+  const RegionIndex index = sampleIndex();
+  REQUIRE(index.size() == 5);
+
+  auto found = index.overlapping(0.45, 0.45, 0.46, 0.46);
+  REQUIRE(found.size() == 4);
+  CHECK(found[0].Image == std::filesystem::path("first.jpg"));
+  CHECK(found[1].Position == 1);
+  CHECK(found[3].Name == "Rex");
+  CHECK(found[3].Type == "Pet");
+  CHECK_THAT(found[3].Left, Catch::Matchers::WithinAbs(0.1, 1e-9));
+  CHECK_THAT(found[3].Bottom, Catch::Matchers::WithinAbs(0.9, 1e-9));
+
+  // Edges count as overlapping
+  found = index.overlapping(0.95, 0.95, 2.0, 2.0);
+  REQUIRE(found.size() == 1);
+  CHECK(found[0].Image == std::filesystem::path("second.jpg"));
+
+  CHECK(index.overlapping(-1.0, -1.0, 2.0, 2.0).size() == 5);
+  CHECK(index.overlapping(0.96, 0.96, 2.0, 2.0).empty());
+  CHECK(index.overlapping(1.0, 1.0, 0.0, 0.0).empty());
+}
+
+TEST_CASE("RegionIndex: regions larger than a fraction of the frame", "[regions]") {
+  const RegionIndex index = sampleIndex();
+  auto found = index.largerThan(0.5);
+  REQUIRE(found.size() == 1);
+  CHECK(found[0].Name == "Rex");
+  CHECK_THAT(found[0].area(), Catch::Matchers::WithinAbs(0.64, 1e-9));
+  CHECK(index.largerThan(0.0).size() == 5);
+  CHECK(index.largerThan(1.0).empty());
+}
+
+TEST_CASE("RegionIndex: duplicate boxes for the same name", "[regions]") {
+  const RegionIndex index = sampleIndex();
+
+  auto found = index.duplicates(0.5);
+  REQUIRE(found.size() == 1);
+  CHECK(found[0].first.Position == 0);
+  CHECK(found[0].second.Position == 1);
+  CHECK(found[0].first.Name == "Jane");
+
+  // The two boxes of Jane overlap by 0.19 / 0.21
+  CHECK(index.duplicates(0.95).empty());
+  CHECK(RegionIndex().duplicates().empty());
+}
+
+TEST_CASE("RegionIndex: grid resolution", "[regions]") {
+  CHECK_THROWS_AS(RegionIndex(0), InvalidStructureError);
+
+  RegionIndex coarse(1);
+  coarse.add("image.jpg", RegionInfoStruct(DimensionsStruct(1, 1, "pixel"), {face(0.1, 0.1, 0.2, 0.2, "A")}));
+  CHECK(coarse.overlapping(0.15, 0.15, 0.16, 0.16).size() == 1);
+  CHECK(coarse.overlapping(0.5, 0.5, 0.6, 0.6).empty());
+
+  // Only the cells touched are stored, whichever way a query walks them
+  RegionIndex fine(4096);
+  fine.add("image.jpg", RegionInfoStruct(DimensionsStruct(1, 1, "pixel"),
+                                         {face(0.01, 0.01, 0.2, 0.2, "A"), face(0.01, 0.01, 0.8, 0.8, "B")}));
+  CHECK(fine.overlapping(0.2, 0.2, 0.2, 0.2).size() == 1);
+  CHECK(fine.overlapping(0.5, 0.5, 0.6, 0.6).empty());
+  auto found = fine.overlapping(-1.0, -1.0, 2.0, 2.0);
+  REQUIRE(found.size() == 2);
+  CHECK(found[1].Name == "B");
+}
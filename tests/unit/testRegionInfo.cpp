@@ -1,9 +1,12 @@
+#include <cmath>
+#include <limits>
 #include <sstream>
 
 #include <catch2/catch_test_macros.hpp>
 
 #include <exiv2/exiv2.hpp>
 
+#include "Errors.hpp"
 #include "RegionInfoStruct.hpp"
 #include "TestUtils.hpp"
 
@@ -118,3 +121,86 @@ TEST_CASE("RegionInfoStruct: fromXmp terminates on missing region entry") {
   auto result = RegionInfoStruct::fromXmp(xmp);
   REQUIRE(result.RegionList.size() == 1);
 }
+
+TEST_CASE("RegionInfoStruct: tryFromXmp reports a malformed region") {
+  Exiv2::XmpData xmp;
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions/stDim:w"] = "100";
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions/stDim:h"] = "100";
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions/stDim:unit"] = "pixel";
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:RegionList[1]/mwg-rs:Type"] = "Face";
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:RegionList[1]/mwg-rs:Area/stArea:x"] = "0.1";
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:RegionList[1]/mwg-rs:Area/stArea:y"] = "0.2";
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:RegionList[1]/mwg-rs:Area/stArea:w"] = "0.3";
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:RegionList[1]/mwg-rs:Area/stArea:h"] = "0.4";
+
+  auto result = RegionInfoStruct::tryFromXmp(xmp);
+  REQUIRE_FALSE(result.ok());
+  CHECK(result.error().Code == ErrorCode::MissingField);
+  CHECK(result.error().Message == "No name found in region info struct");
+  REQUIRE_THROWS_AS(RegionInfoStruct::fromXmp(xmp), MissingFieldError);
+}
+
+TEST_CASE("RegionInfoStruct: tryFromXmp skips a malformed region when collecting") {
+  Exiv2::XmpData xmp;
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions/stDim:w"] = "100";
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions/stDim:h"] = "100";
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:AppliedToDimensions/stDim:unit"] = "pixel";
+  for (const std::string index : {"1", "2"}) {
+    const std::string base = "Xmp.mwg-rs.Regions/mwg-rs:RegionList[" + index + "]";
+    xmp[base + "/mwg-rs:Name"] = "Face" + index;
+    xmp[base + "/mwg-rs:Type"] = "Face";
+    xmp[base + "/mwg-rs:Area/stArea:x"] = "0.1";
+    xmp[base + "/mwg-rs:Area/stArea:y"] = "0.2";
+    xmp[base + "/mwg-rs:Area/stArea:w"] = "0.3";
+    xmp[base + "/mwg-rs:Area/stArea:h"] = "0.4";
+    xmp[base + "/mwg-rs:Area/stArea:unit"] = "normalized";
+  }
+  xmp["Xmp.mwg-rs.Regions/mwg-rs:RegionList[1]/mwg-rs:Area/stArea:w"] = "wide";
+
+  std::vector<ErrorInfo> skipped;
+  auto result = RegionInfoStruct::tryFromXmp(xmp, &skipped);
+  REQUIRE(result.ok());
+  REQUIRE(result.value().RegionList.size() == 1);
+  CHECK(result.value().RegionList[0].Name == "Face2");
+  REQUIRE(skipped.size() == 1);
+  CHECK(skipped[0].Code == ErrorCode::InvalidStructure);
+  CHECK(skipped[0].Message.starts_with("Skipped region 1: "));
+
+  REQUIRE_FALSE(RegionInfoStruct::tryFromXmp(xmp).ok());
+}
+
+TEST_CASE("RegionInfoStruct: area array round-trip") {
+  RegionInfoStruct original(
+      DimensionsStruct(100, 200, "pixel"),
+      {RegionInfoStruct::RegionStruct({0.4, 0.3, 0.1, 0.2, "normalized"}, "Alice", "Face", "Smiling"),
+       RegionInfoStruct::RegionStruct({0.5, 0.6, 0.7, 0.8, "normalized", 0.9}, "Bob", "Pet", std::nullopt)});
+
+  std::vector<double> areas = original.areaArray();
+  REQUIRE(areas.size() == 2 * RegionInfoStruct::AREA_COLUMNS);
+  CHECK(areas[0] == 0.4);
+  CHECK(areas[3] == 0.2);
+  CHECK(std::isnan(areas[4]));
+  CHECK(areas[9] == 0.9);
+
+  RegionInfoStruct rebuilt(original.AppliedToDimensions, areas, RegionInfoStruct::AREA_COLUMNS, {"Alice", "Bob"},
+                           {"Face", "Pet"}, "normalized", {"Smiling", std::nullopt});
+  CHECK(rebuilt == original);
+}
+
+TEST_CASE("RegionInfoStruct: areas without d") {
+  const std::vector<double> areas = {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8};
+  RegionInfoStruct regions(DimensionsStruct(10, 10, "pixel"), areas, 4, {"A", "B"}, {"Face", "Face"});
+  REQUIRE(regions.RegionList.size() == 2);
+  CHECK(regions.RegionList[1].Area == XmpAreaStruct(0.5, 0.6, 0.7, 0.8, "normalized"));
+  CHECK_FALSE(regions.RegionList[0].Description.has_value());
+}
+
+TEST_CASE("RegionInfoStruct: mismatched area arrays") {
+  const DimensionsStruct dimensions(10, 10, "pixel");
+  const std::vector<double> areas = {0.1, 0.2, 0.3, 0.4};
+  CHECK_THROWS_AS(RegionInfoStruct(dimensions, areas, 4, {"A", "B"}, {"Face", "Face"}), InvalidStructureError);
+  CHECK_THROWS_AS(RegionInfoStruct(dimensions, areas, 4, {"A"}, {}), InvalidStructureError);
+  CHECK_THROWS_AS(RegionInfoStruct(dimensions, areas, 2, {"A", "B"}, {"Face", "Face"}), InvalidStructureError);
+  const std::vector<double> infinite = {0.1, 0.2, std::numeric_limits<double>::infinity(), 0.4};
+  CHECK_THROWS_AS(RegionInfoStruct(dimensions, infinite, 4, {"A"}, {"Face"}), InvalidStructureError);
+}
@@ -0,0 +1,102 @@
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "Errors.hpp"
+#include "RegionInfoStruct.hpp"
+#include "RegionTransform.hpp"
+
+namespace {
+
+const std::vector<ExifOrientation> ALL_ORIENTATIONS = {ExifOrientation::Horizontal,
+                                                       ExifOrientation::MirrorHorizontal,
+                                                       ExifOrientation::Rotate180,
+                                                       ExifOrientation::MirrorVertical,
+                                                       ExifOrientation::MirrorHorizontalAndRotate270CW,
+                                                       ExifOrientation::Rotate90CW,
+                                                       ExifOrientation::MirrorHorizontalAndRotate90CW,
+                                                       ExifOrientation::Rotate270CW};
+
+// Where a stored point lands on the displayed image
+std::pair<double, double> displayed(ExifOrientation orientation, double x, double y) {
+  std::vector<double> h = {0.0};
+  std::vector<double> w = {0.0};
+  std::vector<double> xs = {x};
+  std::vector<double> ys = {y};
+  RegionTransform::toDisplay(orientation, {h, w, xs, ys});
+  return {xs[0], ys[0]};
+}
+
+RegionInfoStruct sampleRegions() {
+  return RegionInfoStruct(
+      DimensionsStruct(300, 400, "pixel"),
+      {RegionInfoStruct::RegionStruct({0.2, 0.1, 0.3, 0.4, "normalized"}, "A", "Face", std::nullopt),
+       RegionInfoStruct::RegionStruct({0.5, 0.25, 0.75, 0.6, "normalized", 0.1}, "B", "Pet", "Circle"),
+       RegionInfoStruct::RegionStruct({30, 40, 100, 50, "pixel"}, "C", "Focus", std::nullopt)});
+}
+
+} // namespace
+
+TEST_CASE("RegionTransform: the corners of the stored image", "[orientation]") {
+  // The displayed position of the stored top left and top right corners, from the EXIF specification
+  const std::vector<std::pair<std::pair<double, double>, std::pair<double, double>>> expected = {
+      {{0, 0}, {1, 0}}, {{1, 0}, {0, 0}}, {{1, 1}, {0, 1}}, {{0, 1}, {1, 1}},
+      {{0, 0}, {0, 1}}, {{1, 0}, {1, 1}}, {{1, 1}, {1, 0}}, {{0, 1}, {0, 0}}};
+  for (std::size_t i = 0; i < ALL_ORIENTATIONS.size(); i++) {
+    INFO(orientation_to_string(ALL_ORIENTATIONS[i]));
+    CHECK(displayed(ALL_ORIENTATIONS[i], 0, 0) == expected[i].first);
+    CHECK(displayed(ALL_ORIENTATIONS[i], 1, 0) == expected[i].second);
+  }
+  CHECK(displayed(ExifOrientation::Undefined, 0.25, 0.5) == std::make_pair(0.25, 0.5));
+}
+
+TEST_CASE("RegionTransform: inverses", "[orientation]") {
+  CHECK(RegionTransform::inverse(ExifOrientation::Rotate90CW) == ExifOrientation::Rotate270CW);
+  CHECK(RegionTransform::inverse(ExifOrientation::Rotate270CW) == ExifOrientation::Rotate90CW);
+  CHECK(RegionTransform::inverse(ExifOrientation::MirrorHorizontalAndRotate90CW) ==
+        ExifOrientation::MirrorHorizontalAndRotate90CW);
+  CHECK(RegionTransform::inverse(ExifOrientation::Undefined) == ExifOrientation::Horizontal);
+  CHECK(RegionTransform::swapsAxes(ExifOrientation::MirrorHorizontalAndRotate270CW));
+  CHECK_FALSE(RegionTransform::swapsAxes(ExifOrientation::Rotate180));
+}
+
+TEST_CASE("RegionInfoStruct: display and stored round trip", "[orientation]") {
+  const RegionInfoStruct regions = sampleRegions();
+  for (ExifOrientation orientation : ALL_ORIENTATIONS) {
+    INFO(orientation_to_string(orientation));
+    const RegionInfoStruct shown = regions.toDisplay(orientation);
+    CHECK(shown.toStored(orientation) == regions);
+    CHECK(shown.RegionList[1].Area.D == regions.RegionList[1].Area.D);
+    if (RegionTransform::swapsAxes(orientation)) {
+      CHECK(shown.AppliedToDimensions.W == regions.AppliedToDimensions.H);
+      CHECK(shown.RegionList[0].Area.W == regions.RegionList[0].Area.H);
+    } else {
+      CHECK(shown.AppliedToDimensions == regions.AppliedToDimensions);
+    }
+  }
+}
+
+TEST_CASE("RegionInfoStruct: rotating a quarter turn", "[orientation]") {
+  const RegionInfoStruct shown = sampleRegions().toDisplay(ExifOrientation::Rotate90CW);
+  CHECK(shown.AppliedToDimensions == DimensionsStruct(400, 300, "pixel"));
+
+  const XmpAreaStruct& normalized = shown.RegionList[0].Area;
+  CHECK_THAT(normalized.X, Catch::Matchers::WithinAbs(0.6, 1e-9));
+  CHECK_THAT(normalized.Y, Catch::Matchers::WithinAbs(0.3, 1e-9));
+  CHECK_THAT(normalized.W, Catch::Matchers::WithinAbs(0.2, 1e-9));
+  CHECK_THAT(normalized.H, Catch::Matchers::WithinAbs(0.1, 1e-9));
+
+  // Pixel areas flip against the stored height, which is the displayed width
+  const XmpAreaStruct& pixels = shown.RegionList[2].Area;
+  CHECK_THAT(pixels.X, Catch::Matchers::WithinAbs(250.0, 1e-9));
+  CHECK_THAT(pixels.Y, Catch::Matchers::WithinAbs(100.0, 1e-9));
+}
+
+TEST_CASE("RegionTransform: columns of different lengths", "[orientation]") {
+  std::vector<double> one = {0.5};
+  std::vector<double> two = {0.5, 0.5};
+  CHECK_THROWS_AS(RegionTransform::toDisplay(ExifOrientation::Rotate90CW, {one, one, two, one}),
+                  InvalidStructureError);
+}
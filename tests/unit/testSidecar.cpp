@@ -0,0 +1,184 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestUtils.hpp"
+
+#include "FileUtils.hpp"
+#include "ImageMetadata.hpp"
+#include "ReadOptions.hpp"
+#include "WriteOptions.hpp"
+
+namespace {
+std::vector<char> readAllBytes(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+// Removes the sidecar of a temporary image, which the fixture does not know about
+class SidecarGuard {
+public:
+  explicit SidecarGuard(const std::filesystem::path& imagePath) : m_path(ImageMetadata::sidecarPath(imagePath)) {
+    std::filesystem::remove(m_path);
+  }
+  ~SidecarGuard() {
+    std::filesystem::remove(m_path);
+  }
+  SidecarGuard(const SidecarGuard&) = delete;
+  SidecarGuard& operator=(const SidecarGuard&) = delete;
+
+  const std::filesystem::path& path() const {
+    return m_path;
+  }
+
+private:
+  std::filesystem::path m_path;
+};
+
+ReadOptions withPolicy(SidecarPolicy policy) {
+  ReadOptions options;
+  options.Sidecar = policy;
+  return options;
+}
+} // namespace
+
+TEST_CASE("Sidecar path replaces the image extension", "[sidecar]") {
+  CHECK(ImageMetadata::sidecarPath("/photos/IMG_0001.CR2") == std::filesystem::path("/photos/IMG_0001.xmp"));
+  CHECK(ImageMetadata::sidecarPath("scan.tiff") == std::filesystem::path("scan.xmp"));
+  CHECK(ImageMetadata::sidecarPath("noextension") == std::filesystem::path("noextension.xmp"));
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Images sharing a stem do not share a sidecar", "[sidecar][writing]") {
+  namespace fs = std::filesystem;
+  const fs::path root =
+      fs::temp_directory_path() / ("test_sidecar_pair_" +
+                                   std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+  fs::create_directories(root);
+  // Exiv2 detects the format from the contents, only the names matter here
+  const fs::path jpeg = root / "IMG_0001.jpg";
+  const fs::path raw = root / "IMG_0001.CR2";
+  fs::copy_file(getOriginalSample(SampleImage::Sample1), jpeg);
+
+  WriteOptions options;
+  options.Sidecar = true;
+
+  SECTION("A single image uses the short form") {
+    ImageMetadata metadata(jpeg);
+    metadata.toFile(std::nullopt, options);
+    CHECK(fs::exists(root / "IMG_0001.xmp"));
+    CHECK(ImageMetadata::sidecarPath(jpeg) == root / "IMG_0001.xmp");
+  }
+
+  SECTION("A pair uses the full file name form") {
+    fs::copy_file(getOriginalSample(SampleImage::Sample1), raw);
+    ImageMetadata jpegMetadata(jpeg);
+    jpegMetadata.Title = "The JPEG";
+    jpegMetadata.toFile(std::nullopt, options);
+    ImageMetadata rawMetadata(raw);
+    rawMetadata.Title = "The RAW";
+    rawMetadata.toFile(std::nullopt, options);
+
+    CHECK_FALSE(fs::exists(root / "IMG_0001.xmp"));
+    CHECK(ImageMetadata::sidecarPath(jpeg) == root / "IMG_0001.jpg.xmp");
+    CHECK(ImageMetadata::sidecarPath(raw) == root / "IMG_0001.CR2.xmp");
+    CHECK(ImageMetadata(jpeg, withPolicy(SidecarPolicy::Merge)).Title == "The JPEG");
+    CHECK(ImageMetadata(raw, withPolicy(SidecarPolicy::Merge)).Title == "The RAW");
+  }
+
+  fs::remove_all(root);
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Writing a sidecar leaves the image untouched", "[sidecar][writing]") {
+  auto imagePath = getTempSample(SampleImage::Sample1);
+  SidecarGuard sidecar(imagePath);
+  auto imageBefore = readAllBytes(imagePath);
+
+  ImageMetadata metadata(imagePath);
+  const ImageMetadata embedded = metadata;
+  metadata.Title = "Sidecar title";
+  metadata.Orientation = ExifOrientation::Rotate90CW;
+
+  WriteOptions options;
+  options.Sidecar = true;
+  metadata.toFile(std::nullopt, options);
+
+  REQUIRE(std::filesystem::exists(sidecar.path()));
+  CHECK(readAllBytes(imagePath) == imageBefore);
+
+  SECTION("Ignored by default") {
+    CHECK(ImageMetadata(imagePath) == embedded);
+  }
+
+  SECTION("Merged over the embedded metadata") {
+    ImageMetadata merged(imagePath, withPolicy(SidecarPolicy::Merge));
+    CHECK(merged == metadata);
+  }
+
+  SECTION("Authoritative when it sets every field") {
+    ImageMetadata authoritative(imagePath, withPolicy(SidecarPolicy::Authoritative));
+    CHECK(authoritative == metadata);
+  }
+
+  SECTION("An existing sidecar is updated") {
+    metadata.Title = "Updated sidecar title";
+    metadata.toFile(std::nullopt, options);
+
+    CHECK(ImageMetadata(imagePath, withPolicy(SidecarPolicy::Merge)).Title == "Updated sidecar title");
+    CHECK(readAllBytes(imagePath) == imageBefore);
+  }
+
+  SECTION("An atomic write replaces the sidecar") {
+    metadata.Title = "Atomic sidecar title";
+    options.Atomic = true;
+    options.Durability = DurabilityLevel::FileAndDirectory;
+    metadata.toFile(std::nullopt, options);
+
+    CHECK(ImageMetadata(imagePath, withPolicy(SidecarPolicy::Merge)).Title == "Atomic sidecar title");
+    // The temporary copy was renamed over the sidecar
+    const std::string tempPrefix = "." + sidecar.path().filename().string() + ".exifmwg-";
+    for (const auto& entry : std::filesystem::directory_iterator(sidecar.path().parent_path())) {
+      CHECK(entry.path().filename().string().rfind(tempPrefix, 0) != 0);
+    }
+    CHECK(readAllBytes(imagePath) == imageBefore);
+  }
+}
+
+TEST_CASE_METHOD(ImageTestFixture, "Sidecar read policies", "[sidecar][reading]") {
+  auto imagePath = getTempSample(SampleImage::Sample1);
+  SidecarGuard sidecar(imagePath);
+  const ImageMetadata embedded(imagePath);
+  REQUIRE(embedded.Description.has_value());
+
+  // A sidecar which only sets the title
+  ImageMetadata sparse;
+  sparse.Title = "Only the title";
+  WriteOptions options;
+  options.Sidecar = true;
+  sparse.toFile(imagePath, options);
+
+  SECTION("Merge keeps embedded fields the sidecar does not set") {
+    ImageMetadata merged(imagePath, withPolicy(SidecarPolicy::Merge));
+    CHECK(merged.Title == "Only the title");
+    CHECK(merged.Description == embedded.Description);
+    CHECK(merged.KeywordInfo == embedded.KeywordInfo);
+  }
+
+  SECTION("Authoritative drops embedded fields the sidecar does not set") {
+    ImageMetadata authoritative(imagePath, withPolicy(SidecarPolicy::Authoritative));
+    CHECK(authoritative.Title == "Only the title");
+    CHECK_FALSE(authoritative.Description.has_value());
+    CHECK_FALSE(authoritative.RegionInfo.has_value());
+    CHECK(authoritative.ImageHeight == embedded.ImageHeight);
+    CHECK(authoritative.ImageWidth == embedded.ImageWidth);
+  }
+
+  SECTION("Without a sidecar every policy reads the embedded metadata") {
+    std::filesystem::remove(sidecar.path());
+    CHECK(ImageMetadata(imagePath, withPolicy(SidecarPolicy::Merge)) == embedded);
+    CHECK(ImageMetadata(imagePath, withPolicy(SidecarPolicy::Authoritative)) == embedded);
+  }
+}
@@ -0,0 +1,121 @@
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "ThreadPool.hpp"
+
+TEST_CASE("ThreadPool runs submitted tasks", "[threadpool]") {
+  ThreadPool pool(4);
+  REQUIRE(pool.size() == 4);
+
+  std::atomic<int> sum{0};
+  TaskGroup group;
+  group.add(100);
+  for (int i = 1; i <= 100; ++i) {
+    pool.submit([&, i]() {
+      sum += i;
+      group.done();
+    });
+  }
+  pool.wait(group);
+
+  CHECK(group.finished());
+  CHECK(sum == 5050);
+  const auto stats = pool.stats();
+  CHECK(stats.Threads == 4);
+  CHECK(stats.Submitted == 100);
+  CHECK(stats.Queued == 0);
+}
+
+TEST_CASE("ThreadPool spawns nested tasks", "[threadpool]") {
+  ThreadPool pool(3);
+
+  SECTION("Tasks spawned from workers all run") {
+    std::atomic<int> leaves{0};
+    TaskGroup group;
+    group.add();
+    pool.submit([&]() {
+      group.add(50);
+      for (int i = 0; i < 50; ++i) {
+        pool.spawn([&]() {
+          ++leaves;
+          group.done();
+        });
+      }
+      group.done();
+    });
+    pool.wait(group);
+
+    CHECK(leaves == 50);
+    CHECK(pool.stats().Submitted == 51);
+  }
+
+  SECTION("A worker waiting on its own tasks does not deadlock") {
+    // More outer tasks than workers, each waiting on inner tasks
+    std::atomic<int> inner{0};
+    TaskGroup outer;
+    outer.add(8);
+    for (int i = 0; i < 8; ++i) {
+      pool.submit([&]() {
+        TaskGroup children;
+        children.add(4);
+        for (int j = 0; j < 4; ++j) {
+          pool.spawn([&]() {
+            ++inner;
+            children.done();
+          });
+        }
+        pool.wait(children);
+        outer.done();
+      });
+    }
+    pool.wait(outer);
+
+    CHECK(inner == 32);
+  }
+
+  SECTION("spawn outside the pool queues on the shared queue") {
+    std::atomic<bool> ran{false};
+    TaskGroup group;
+    group.add();
+    pool.spawn([&]() {
+      ran = true;
+      group.done();
+    });
+    pool.wait(group);
+    CHECK(ran);
+  }
+}
+
+TEST_CASE("ThreadPool drains its queues on destruction", "[threadpool]") {
+  std::atomic<int> count{0};
+  {
+    ThreadPool pool(2);
+    for (int i = 0; i < 20; ++i) {
+      pool.submit([&]() {
+        std::this_thread::yield();
+        ++count;
+      });
+    }
+  }
+  CHECK(count == 20);
+}
+
+TEST_CASE("The shared ThreadPool can be resized", "[threadpool]") {
+  ThreadPool::configureShared(2);
+  auto pool = ThreadPool::shared();
+  CHECK(pool->size() == 2);
+  CHECK(ThreadPool::sharedStats().Threads == 2);
+
+  ThreadPool::configureShared(0);
+  CHECK(ThreadPool::shared() != pool);
+  CHECK(ThreadPool::shared()->size() >= 1);
+  // The previous pool stays usable while referenced
+  TaskGroup group;
+  group.add();
+  pool->submit([&]() { group.done(); });
+  pool->wait(group);
+  CHECK(group.finished());
+}
@@ -152,6 +152,19 @@ TEST_CASE("XmpAreaStruct::toXmp and fromXmp roundtrip", "[XmpAreaStruct]") {
     REQUIRE_THROWS_MATCHES(XmpAreaStruct::fromXmp(xmpData, baseKey), MissingFieldError,
                            Catch::Matchers::Message("No y found in xmp area struct"));
   }
+  SECTION("tryFromXmp with an invalid optional d") {
+    Exiv2::XmpData xmpData;
+    xmpData[baseKey + "/stArea:h"] = "0.5";
+    xmpData[baseKey + "/stArea:w"] = "0.6";
+    xmpData[baseKey + "/stArea:x"] = "0.25";
+    xmpData[baseKey + "/stArea:y"] = "0.25";
+    xmpData[baseKey + "/stArea:d"] = "wide";
+
+    auto result = XmpAreaStruct::tryFromXmp(xmpData, baseKey);
+    REQUIRE_FALSE(result.ok());
+    CHECK(result.error().Code == ErrorCode::InvalidStructure);
+    CHECK(result.error().Message == "Invalid d 'wide' in xmp area struct");
+  }
 }
 
 TEST_CASE("XmpAreaStruct Equality Operator", "[XmpAreaStruct]") {
@@ -189,3 +189,19 @@ TEST_CASE("parseDelimitedString", "xmp-utils") {
     REQUIRE(XmpUtils::parseDelimitedString(xmpData, "Xmp.dc.description", ';') == expected);
   }
 }
+
+TEST_CASE("parseDouble", "xmp-utils") {
+  SECTION("Plain numbers") {
+    REQUIRE(XmpUtils::parseDouble("0.25") == 0.25);
+    REQUIRE(XmpUtils::parseDouble("-3") == -3.0);
+    REQUIRE(XmpUtils::parseDouble(" 1e3") == 1000.0);
+  }
+  SECTION("Trailing text is ignored, as with std::stod") {
+    REQUIRE(XmpUtils::parseDouble("12px") == 12.0);
+  }
+  SECTION("Text which does not start with a number") {
+    REQUIRE_FALSE(XmpUtils::parseDouble("").has_value());
+    REQUIRE_FALSE(XmpUtils::parseDouble("abc").has_value());
+    REQUIRE_FALSE(XmpUtils::parseDouble("1e999").has_value());
+  }
+}